@@ -0,0 +1,109 @@
+#ifndef BENCH_BENCH_H
+#define BENCH_BENCH_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+#include <functional>
+#include <ostream>
+
+#include <gpumatrix/Context.h>
+#include <gpumatrix/Half.h>
+
+/*
+* A small timing harness. Every case is a setup function that allocates
+* its operands and returns the body to time; operands live only while
+* their case runs, so a sweep never holds more than one set on the device.
+*
+* The body is run once to warm up, then in batches of doubling size until
+* a batch takes at least min_time. The reported time per iteration is the
+* best of a few such batches. Device work is synchronised at the end of
+* every batch, so launch overhead is amortised the same way for every case.
+*/
+
+namespace bench
+{
+	typedef std::function<void()> Body;
+	typedef std::function<Body()> Setup;
+
+	struct Case
+	{
+		std::string group;		/**< primitive or expression family, e.g. "impl::gemm" */
+		std::string name;		/**< what runs, e.g. "A*B" */
+		std::string backend;	/**< "gpumatrix" or "eigen" */
+		std::string type;		/**< element type */
+		std::string shape;
+		double flops;			/**< per iteration */
+		double bytes;			/**< moved per iteration */
+		Setup setup;
+	};
+
+	struct Result
+	{
+		const Case * c;
+		std::size_t iterations;
+		double seconds;			/**< per iteration */
+	};
+
+	class Suite
+	{
+	public:
+		Suite() : min_time(0.1), repetitions(3), quick(false) { }
+
+		void add(const std::string & group, const std::string & name, const std::string & backend,
+			const std::string & type, const std::string & shape, double flops, double bytes, const Setup & setup)
+		{
+			Case c = { group, name, backend, type, shape, flops, bytes, setup };
+			cases.push_back(c);
+		}
+
+		/** Run every case whose group or name contains filter. */
+		void run(const std::string & filter, std::ostream & log);
+
+		void write_json(std::ostream & os) const;
+
+		/** Vector lengths and square matrix sizes to sweep over. */
+		std::vector<std::size_t> lengths() const;
+		std::vector<std::size_t> sizes() const;
+
+		double min_time;
+		int repetitions;
+		bool quick;
+
+		std::vector<Case> cases;
+		std::vector<Result> results;
+	};
+
+	std::string shape(std::size_t n);
+	std::string shape(std::size_t r, std::size_t c);
+	std::string shape(std::size_t m, std::size_t n, std::size_t k);
+
+	template <typename T> inline const char * type_name();
+	template <> inline const char * type_name<float>() { return "float"; }
+	template <> inline const char * type_name<double>() { return "double"; }
+	template <> inline const char * type_name<gpumatrix::half>() { return "half"; }
+	template <> inline const char * type_name<gpumatrix::bfloat16>() { return "bfloat16"; }
+
+	inline void synchronize()
+	{
+		gpumatrix::synchronize();
+	}
+
+	template <typename T> struct Sink
+	{
+		static volatile T value;
+	};
+
+	template <typename T> volatile T Sink<T>::value;
+
+	/** Keeps the compiler from dropping a host computation. */
+	template <typename T> inline void keep(const T & value)
+	{
+		Sink<T>::value = value;
+	}
+
+	void register_primitives(Suite & suite);
+	void register_expressions(Suite & suite);
+}
+
+#endif
@@ -0,0 +1,243 @@
+// The eval overloads of impl/EvalImpl.h through the expressions that reach
+// them, each next to the same expression in Eigen on the host, and the CSV
+// reader and writer next to iostream.
+
+#include "Bench.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <Eigen/Dense>
+
+#include <gpumatrix/Matrix.h>
+#include <gpumatrix/Vector.h>
+#include <gpumatrix/Array.h>
+#include <gpumatrix/Mask.h>
+#include <gpumatrix/KernelMatrix.h>
+#include <gpumatrix/Csv.h>
+
+namespace bench
+{
+	using namespace gpumatrix;
+
+	namespace
+	{
+		template <typename T>
+		struct Device
+		{
+			explicit Device(std::size_t n)
+				: A(Matrix<T>::Uniform(n,n,T(0.01),T(1))), B(Matrix<T>::Uniform(n,n,T(0.01),T(1))), C(n,n),
+				  x(Eigen::Matrix<T,Eigen::Dynamic,1>::Random(n)), y(n)
+			{
+			}
+
+			Matrix<T> A, B, C;
+			Vector<T> x, y;
+		};
+
+		template <typename T>
+		struct Host
+		{
+			typedef Eigen::Matrix<T,Eigen::Dynamic,Eigen::Dynamic> MatrixX;
+			typedef Eigen::Matrix<T,Eigen::Dynamic,1> VectorX;
+
+			explicit Host(std::size_t n)
+				: A((MatrixX::Random(n,n).array()*T(0.495) + T(0.505)).matrix()),
+				  B((MatrixX::Random(n,n).array()*T(0.495) + T(0.505)).matrix()), C(n,n),
+				  x(VectorX::Random(n)), y(n)
+			{
+			}
+
+			MatrixX A, B, C;
+			VectorX x, y;
+		};
+
+		// One gpumatrix case and one Eigen case per size. GPU sees A, B, C, x, y
+		// as device objects, HOST the same names as Eigen objects.
+		#define BENCH_EXPR(GROUP, NAME, T, FLOPS, BYTES, GPU, HOST)								\
+		for (std::size_t i = 0; i < sizes.size(); ++i)												\
+		{																							\
+			const std::size_t n = sizes[i];															\
+			suite.add(GROUP, NAME, "gpumatrix", type_name<T>(), shape(n,n), double(FLOPS), double(BYTES),	\
+				[n]() -> Body {																		\
+					std::shared_ptr<Device<T> > o(new Device<T>(n));								\
+					return [o]() {																	\
+						Matrix<T> & A = o->A; Matrix<T> & B = o->B; Matrix<T> & C = o->C;			\
+						Vector<T> & x = o->x; Vector<T> & y = o->y;									\
+						(void)A; (void)B; (void)C; (void)x; (void)y;								\
+						GPU;																		\
+					};																				\
+				});																					\
+			suite.add(GROUP, NAME, "eigen", type_name<T>(), shape(n,n), double(FLOPS), double(BYTES),	\
+				[n]() -> Body {																		\
+					std::shared_ptr<Host<T> > o(new Host<T>(n));									\
+					return [o]() {																	\
+						typename Host<T>::MatrixX & A = o->A, & B = o->B, & C = o->C;				\
+						typename Host<T>::VectorX & x = o->x, & y = o->y;							\
+						(void)A; (void)B; (void)C; (void)x; (void)y;								\
+						HOST;																		\
+					};																				\
+				});																					\
+		}
+
+		template <typename T>
+		void register_typed(Suite & suite)
+		{
+			const std::vector<std::size_t> sizes = suite.sizes();
+			const double S = sizeof(T);
+
+			// XprMMProduct and friends
+			BENCH_EXPR("XprMMProduct", "C=A*B", T, 2.0*n*n*n, 3*n*n*S, C = A*B, C.noalias() = A*B)
+			BENCH_EXPR("XprMtMProduct", "C=A.transpose()*B", T, 2.0*n*n*n, 3*n*n*S, C = A.transpose()*B, C.noalias() = A.transpose()*B)
+			BENCH_EXPR("XprMMtProduct", "C=A*B.transpose()", T, 2.0*n*n*n, 3*n*n*S, C = A*B.transpose(), C.noalias() = A*B.transpose())
+			BENCH_EXPR("XprMtMtProduct", "C=A.transpose()*B.transpose()", T, 2.0*n*n*n, 3*n*n*S,
+				C = A.transpose()*B.transpose(), C.noalias() = A.transpose()*B.transpose())
+			BENCH_EXPR("XprMtMProduct", "C=A.transpose()*A", T, 2.0*n*n*n, 2*n*n*S, C = A.transpose()*A, C.noalias() = A.transpose()*A)
+			BENCH_EXPR("XprMMtProduct", "C=A*A.transpose()", T, 2.0*n*n*n, 2*n*n*S, C = A*A.transpose(), C.noalias() = A*A.transpose())
+			BENCH_EXPR("XprMVProduct", "y=A*x", T, 2.0*n*n, (n*n + 2*n)*S, y = A*x, y.noalias() = A*x)
+			BENCH_EXPR("XprMtVProduct", "y=A.transpose()*x", T, 2.0*n*n, (n*n + 2*n)*S, y = A.transpose()*x, y.noalias() = A.transpose()*x)
+			BENCH_EXPR("XprMatrixTranspose", "C=A.transpose()", T, 0, 2*n*n*S, C = A.transpose(), C = A.transpose())
+
+			// scalar and matrix/vector arithmetic
+			BENCH_EXPR("XprBinOp<Fcnl_mul>", "C=2*A", T, n*n, 2*n*n*S, C = T(2)*A, C = T(2)*A)
+			BENCH_EXPR("XprBinOp<Fcnl_div>", "C=A/2", T, n*n, 2*n*n*S, C = A/T(2), C = A/T(2))
+			BENCH_EXPR("XprBinOp<Fcnl_add>", "C=A+B", T, n*n, 3*n*n*S, C = A + B, C = A + B)
+			BENCH_EXPR("XprBinOp<Fcnl_sub>", "C=A-B", T, n*n, 3*n*n*S, C = A - B, C = A - B)
+			BENCH_EXPR("XprBinOp<Fcnl_add>", "y=x+x", T, n, 3*n*S, y = x + x, y = x + x)
+			BENCH_EXPR("XprBinOp<Fcnl_mul>", "y=2*x", T, n, 2*n*S, y = T(2)*x, y = T(2)*x)
+			BENCH_EXPR("compound", "C+=A", T, n*n, 3*n*n*S, C += A, C += A)
+			BENCH_EXPR("compound", "C*=2", T, n*n, 2*n*n*S, C *= T(2), C *= T(2))
+
+			// arrays
+			BENCH_EXPR("XprBinOp<Fcnl_mul> array", "C=A.array()*B.array()", T, n*n, 3*n*n*S,
+				C = (A.array()*B.array()).matrix(), C = (A.array()*B.array()).matrix())
+			BENCH_EXPR("XprBinOp<Fcnl_div> array", "C=A.array()/B.array()", T, n*n, 3*n*n*S,
+				C = (A.array()/B.array()).matrix(), C = (A.array()/B.array()).matrix())
+			BENCH_EXPR("XprBinOp<Fcnl_add> array", "C=A.array()+1", T, n*n, 2*n*n*S,
+				C = (A.array() + T(1)).matrix(), C = (A.array() + T(1)).matrix())
+			BENCH_EXPR("XprBinOp<Fcnl_sub> array", "C=1-A.array()", T, n*n, 2*n*n*S,
+				C = (T(1) - A.array()).matrix(), C = (T(1) - A.array()).matrix())
+			BENCH_EXPR("XprBinOp<Fcnl_pow>", "C=pow(A.array(),B.array())", T, n*n, 3*n*n*S,
+				C = pow(A.array(),B.array()).matrix(), C = A.array().pow(B.array()).matrix())
+			BENCH_EXPR("XprBinOp<Fcnl_max>", "C=cwiseMax(A,B)", T, n*n, 3*n*n*S,
+				C = cwiseMax(A,B), C = A.cwiseMax(B))
+			BENCH_EXPR("XprSelect", "C=select(A>0.5,A,0)", T, 2*n*n, 2*n*n*S,
+				C = select(A.array() > T(0.5),A.array(),T(0)).matrix(), C = (A.array() > T(0.5)).select(A.array(),T(0)).matrix())
+
+			// unary functions
+			BENCH_EXPR("XprUnOp<Fcnl_exp>", "C=exp(A)", T, n*n, 2*n*n*S, C = exp(A), C = A.array().exp().matrix())
+			BENCH_EXPR("XprUnOp<Fcnl_exp> array", "C=A.array().exp()", T, n*n, 2*n*n*S,
+				C = A.array().exp().matrix(), C = A.array().exp().matrix())
+			BENCH_EXPR("XprUnOp<Fcnl_logistic> array", "C=A.array().logistic()", T, 3*n*n, 2*n*n*S,
+				C = A.array().logistic().matrix(), C = (T(1) + (-A.array()).exp()).inverse().matrix())
+
+			// reductions and broadcasts
+			BENCH_EXPR("RowWiseSum", "y=A.rowwise().sum()", T, n*n, (n*n + n)*S, y = A.rowwise().sum(), y = A.rowwise().sum())
+			BENCH_EXPR("ColWiseSum", "y=A.colwise().sum()", T, n*n, (n*n + n)*S, y = A.colwise().sum(), y = A.colwise().sum().transpose())
+			BENCH_EXPR("XprBroadcast", "C=A.colwise()+x", T, n*n, (2*n*n + n)*S, C = A.colwise() + x, C = A.colwise() + x)
+			BENCH_EXPR("XprBroadcast", "C=A.rowwise()*x", T, n*n, (2*n*n + n)*S,
+				C = A.rowwise()*x, C = (A.array().rowwise()*x.transpose().array()).matrix())
+			BENCH_EXPR("sum", "A.sum()", T, n*n, n*n*S, keep(A.sum()), keep(A.sum()))
+			BENCH_EXPR("squaredNorm", "(A-B).squaredNorm()", T, 3*n*n, 2*n*n*S, keep((A - B).squaredNorm()), keep((A - B).squaredNorm()))
+
+			// an RBF kernel matrix, fused against norms, broadcasts and exp
+			BENCH_EXPR("kernelMatrix", "C=kernelMatrix(A,B,Rbf)", T, 2.0*n*n*n + 6*n*n, 3*n*n*S,
+				C = kernelMatrix(A,B,Kernel<T>::Rbf(T(0.5))),
+				C.noalias() = A.transpose()*B; C = (T(-0.5)*(A.colwise().squaredNorm().transpose().replicate(1,B.cols())
+					+ B.colwise().squaredNorm().replicate(A.cols(),1) - T(2)*C).array()).exp().matrix())
+
+			// a dense layer: logistic(A*B + bias)
+			BENCH_EXPR("layer", "C=logistic(A*B colwise+ x)", T, 2.0*n*n*n + 4*n*n, 3*n*n*S,
+				C = A*B; C.colwise() += x; C = C.array().logistic().matrix(),
+				C.noalias() = A*B; C.colwise() += x; C = (T(1) + (-C.array()).exp()).inverse().matrix())
+		}
+
+		#undef BENCH_EXPR
+
+		const char * const csv_path = "benchGPUMatrix.csv";
+
+		/** An n x n matrix and its 7 digit CSV text on disk, removed with the case. */
+		template <typename T>
+		struct CsvOperands
+		{
+			explicit CsvOperands(std::size_t n)
+				: A(Matrix<T>::Random(n,n)), h(A)
+			{
+				digits7.precision = 7;
+				write_csv(csv_path,A,digits7);
+			}
+
+			~CsvOperands()
+			{
+				std::remove(csv_path);
+			}
+
+			Matrix<T> A;
+			typename Host<T>::MatrixX h;
+			CsvFormat digits7;
+		};
+
+		// The parallel reader and writer of Csv.h against iostream on typical
+		// 7 digit feature dumps. Bytes count the binary data, not the text.
+		template <typename T>
+		void register_csv(Suite & suite)
+		{
+			const std::vector<std::size_t> sizes = suite.sizes();
+
+			for (std::size_t i = 0; i < sizes.size(); ++i)
+			{
+				const std::size_t n = sizes[i];
+				const double bytes = double(n)*n*sizeof(T);
+
+				suite.add("csv", "write_csv", "gpumatrix", type_name<T>(), shape(n,n), 0, bytes,
+					[n]() -> Body {
+						std::shared_ptr<CsvOperands<T> > o(new CsvOperands<T>(n));
+						return [o]() { write_csv(csv_path,o->A,o->digits7); };
+					});
+				suite.add("csv", "read_csv", "gpumatrix", type_name<T>(), shape(n,n), 0, bytes,
+					[n]() -> Body {
+						std::shared_ptr<CsvOperands<T> > o(new CsvOperands<T>(n));
+						return [o]() { read_csv(csv_path,o->A); };
+					});
+				suite.add("csv", "write_csv", "iostream", type_name<T>(), shape(n,n), 0, bytes,
+					[n]() -> Body {
+						std::shared_ptr<CsvOperands<T> > o(new CsvOperands<T>(n));
+						return [o]() {
+							std::ofstream out(csv_path);
+							out.precision(7);
+							for (int r = 0; r < o->h.rows(); r++)
+								for (int c = 0; c < o->h.cols(); c++)
+									out << o->h(r,c) << (c + 1 < o->h.cols() ? ',' : '\n');
+						};
+					});
+				suite.add("csv", "read_csv", "iostream", type_name<T>(), shape(n,n), 0, bytes,
+					[n]() -> Body {
+						std::shared_ptr<CsvOperands<T> > o(new CsvOperands<T>(n));
+						return [o]() {
+							std::ifstream in(csv_path);
+							std::string line, cell;
+							for (int r = 0; std::getline(in,line); r++)
+							{
+								std::stringstream ss(line);
+								for (int c = 0; std::getline(ss,cell,','); c++)
+									o->h(r,c) = T(std::strtod(cell.c_str(),0));
+							}
+						};
+					});
+			}
+		}
+	}
+
+	void register_expressions(Suite & suite)
+	{
+		register_typed<double>(suite);
+		register_typed<float>(suite);
+		register_csv<double>(suite);
+		register_csv<float>(suite);
+	}
+}
@@ -0,0 +1,287 @@
+// Every impl:: backend entry point on raw device buffers.
+
+#include "Bench.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gpumatrix/Matrix.h>
+#include <gpumatrix/Vector.h>
+#include <gpumatrix/Array.h>
+#include <gpumatrix/Mask.h>
+
+namespace bench
+{
+	using namespace gpumatrix;
+
+	namespace
+	{
+		/** Uniform device matrix; the 16 bit types are drawn in float and narrowed. */
+		template <typename T>
+		Matrix<T> uniform(std::size_t r, std::size_t c, float low, float high)
+		{
+			return Matrix<T>::Uniform(r,c,T(low),T(high));
+		}
+
+		template <>
+		Matrix<half> uniform<half>(std::size_t r, std::size_t c, float low, float high)
+		{
+			return Matrix<float>::Uniform(r,c,low,high).cast<half>();
+		}
+
+		template <>
+		Matrix<bfloat16> uniform<bfloat16>(std::size_t r, std::size_t c, float low, float high)
+		{
+			return Matrix<float>::Uniform(r,c,low,high).cast<bfloat16>();
+		}
+
+		/** Three n element device operands in (0,1], and a mask of about half set. */
+		template <typename T>
+		struct Operands
+		{
+			explicit Operands(std::size_t n)
+				: a(uniform<T>(n,1,0.01f,1.0f)), b(uniform<T>(n,1,0.01f,1.0f)), c(n,1),
+				  mask(uniform<float>(n,1,0.0f,1.0f).array() > 0.5f), host(n)
+			{
+			}
+
+			Matrix<T> a, b, c;
+			Mask mask;
+			std::vector<T> host;
+		};
+
+		/** Square n x n operands. */
+		template <typename T>
+		struct MatrixOperands
+		{
+			explicit MatrixOperands(std::size_t n)
+				: A(uniform<T>(n,n,-1.0f,1.0f)), B(uniform<T>(n,n,-1.0f,1.0f)), C(n,n), x(uniform<T>(n,1,-1.0f,1.0f)), y(n,1)
+			{
+			}
+
+			Matrix<T> A, B, C, x, y;
+		};
+
+		// Adds a case on n element operands. BODY sees a, b, c, mask, host and n.
+		#define BENCH_ARRAY(GROUP, NAME, T, FLOPS, BYTES, BODY)									\
+		for (std::size_t i = 0; i < lengths.size(); ++i)											\
+		{																							\
+			const std::size_t n = lengths[i];														\
+			suite.add(GROUP, NAME, "gpumatrix", type_name<T>(), shape(n), double(FLOPS), double(BYTES),	\
+				[n]() -> Body {																		\
+					std::shared_ptr<Operands<T> > o(new Operands<T>(n));							\
+					return [o,n]() {																\
+						T * a = o->a.data(); T * b = o->b.data(); T * c = o->c.data();				\
+						bool * mask = o->mask.data(); T * host = &o->host[0];						\
+						(void)a; (void)b; (void)c; (void)mask; (void)host;							\
+						BODY;																		\
+					};																				\
+				});																					\
+		}
+
+		// Adds a case on n x n operands. BODY sees A, B, C, x, y and n.
+		#define BENCH_MATRIX(GROUP, NAME, T, FLOPS, BYTES, BODY)									\
+		for (std::size_t i = 0; i < sizes.size(); ++i)												\
+		{																							\
+			const std::size_t n = sizes[i];															\
+			suite.add(GROUP, NAME, "gpumatrix", type_name<T>(), shape(n,n), double(FLOPS), double(BYTES),	\
+				[n]() -> Body {																		\
+					std::shared_ptr<MatrixOperands<T> > o(new MatrixOperands<T>(n));				\
+					return [o,n]() {																\
+						T * A = o->A.data(); T * B = o->B.data(); T * C = o->C.data();				\
+						T * x = o->x.data(); T * y = o->y.data();									\
+						(void)A; (void)B; (void)C; (void)x; (void)y;								\
+						BODY;																		\
+					};																				\
+				});																					\
+		}
+
+		template <typename T>
+		void register_typed(Suite & suite)
+		{
+			const std::vector<std::size_t> lengths = suite.lengths();
+			const std::vector<std::size_t> sizes = suite.sizes();
+			const double S = sizeof(T);
+
+			// Memory
+			BENCH_ARRAY("impl::alloc", "alloc+free", T, 0, 0, impl::free(impl::alloc<T>(n)))
+			BENCH_ARRAY("impl::set", "host to device", T, 0, n*S, impl::set(c,(const T *)host,n))
+			BENCH_ARRAY("impl::get", "device to host", T, 0, n*S, impl::get(host,(const T *)a,n))
+			BENCH_ARRAY("impl::copy", "device to device", T, 0, 2*n*S, impl::copy(c,(const T *)a,n))
+			BENCH_ARRAY("impl::zero", "zero", T, 0, n*S, impl::zero(c,n))
+
+			// ArrayOperation
+			BENCH_ARRAY("impl::array_add", "c=a+b", T, n, 3*n*S, impl::array_add(c,a,b,n))
+			BENCH_ARRAY("impl::array_sub", "c=a-b", T, n, 3*n*S, impl::array_sub(c,a,b,n))
+			BENCH_ARRAY("impl::array_mul", "c=a*b", T, n, 3*n*S, impl::array_mul(c,a,b,n))
+			BENCH_ARRAY("impl::array_div", "c=a/b", T, n, 3*n*S, impl::array_div(c,a,b,n))
+			BENCH_ARRAY("impl::scalar_array_add", "c=2+a", T, n, 2*n*S, impl::scalar_array_add(c,T(2),a,n))
+			BENCH_ARRAY("impl::scalar_array_sub", "c=2-a", T, n, 2*n*S, impl::scalar_array_sub(c,T(2),a,n))
+			BENCH_ARRAY("impl::scalar_array_mul", "c=2*a", T, n, 2*n*S, impl::scalar_array_mul(c,T(2),a,n))
+			BENCH_ARRAY("impl::scalar_array_div", "c=2/a", T, n, 2*n*S, impl::scalar_array_div(c,T(2),a,n))
+			BENCH_ARRAY("impl::array_compound_op", "c+=a", T, n, 3*n*S, impl::array_compound_op(c,a,n,Fcnl_add_eq<T,T>()))
+			BENCH_ARRAY("impl::array_compound_op", "c*=a", T, n, 3*n*S, impl::array_compound_op(c,a,n,Fcnl_mul_eq<T,T>()))
+			BENCH_ARRAY("impl::scalar_array_compound_op", "c+=2", T, n, 2*n*S, impl::scalar_array_compound_op(c,T(2),n,Fcnl_add_eq<T,T>()))
+			BENCH_ARRAY("impl::scalar_array_compound_op", "c*=2", T, n, 2*n*S, impl::scalar_array_compound_op(c,T(2),n,Fcnl_mul_eq<T,T>()))
+			BENCH_ARRAY("impl::array_compare", "mask=a>b", T, n, n*(2*S+1), impl::array_compare(mask,a,b,n,Fcnl_greater<T,T>()))
+			BENCH_ARRAY("impl::array_scalar_compare", "mask=a>0.5", T, n, n*(S+1), impl::array_scalar_compare(mask,a,T(0.5),n,Fcnl_greater<T,T>()))
+			BENCH_ARRAY("impl::array_select", "c=mask?a:b", T, 0, n*(3*S+1), impl::array_select(c,mask,a,b,n))
+			BENCH_ARRAY("impl::array_select", "c=mask?a:0", T, 0, n*(2*S+1), impl::array_select(c,mask,a,T(0),n))
+
+			// Function
+			BENCH_ARRAY("impl::sum", "sum(a)", T, n, n*S, keep(impl::sum((const T *)a,n)))
+			BENCH_ARRAY("impl::max_element", "max(a)", T, n, n*S, keep(impl::max_element((const T *)a,n)))
+			BENCH_ARRAY("impl::min_element", "min(a)", T, n, n*S, keep(impl::min_element((const T *)a,n)))
+			BENCH_ARRAY("impl::masked_sum", "sum(a,mask)", T, n, n*(S+1), keep(impl::masked_sum((const T *)a,mask,n)))
+			BENCH_ARRAY("impl::unary_array_op", "exp", T, n, 2*n*S, impl::unary_array_op(c,a,n,Fcnl_exp<T>()))
+			BENCH_ARRAY("impl::unary_array_op", "fast_exp", T, n, 2*n*S, impl::unary_array_op(c,a,n,Fcnl_fast_exp<T>()))
+			BENCH_ARRAY("impl::unary_array_op", "log", T, n, 2*n*S, impl::unary_array_op(c,a,n,Fcnl_log<T>()))
+			BENCH_ARRAY("impl::unary_array_op", "tanh", T, n, 2*n*S, impl::unary_array_op(c,a,n,Fcnl_tanh<T>()))
+			BENCH_ARRAY("impl::unary_array_op", "logistic", T, n, 2*n*S, impl::unary_array_op(c,a,n,Fcnl_logistic<T>()))
+			BENCH_ARRAY("impl::unary_array_op", "fast_logistic", T, n, 2*n*S, impl::unary_array_op(c,a,n,Fcnl_fast_logistic<T>()))
+			BENCH_ARRAY("impl::unary_array_op", "sqrt", T, n, 2*n*S, impl::unary_array_op(c,a,n,Fcnl_sqrt<T>()))
+			BENCH_ARRAY("impl::binary_array_op", "pow(a,b)", T, n, 3*n*S, impl::binary_array_op(c,(const T *)a,(const T *)b,n,Fcnl_pow<T,T>()))
+			BENCH_ARRAY("impl::binary_array_op", "pow(a,2)", T, n, 2*n*S, impl::binary_array_op(c,(const T *)a,T(2),n,Fcnl_pow<T,T>()))
+			BENCH_ARRAY("impl::binary_array_op", "atan2(a,b)", T, n, 3*n*S, impl::binary_array_op(c,(const T *)a,(const T *)b,n,Fcnl_atan2<T,T>()))
+			BENCH_ARRAY("impl::binary_array_op", "max(a,b)", T, n, 3*n*S, impl::binary_array_op(c,(const T *)a,(const T *)b,n,Fcnl_max<T,T>()))
+
+			// Random
+			BENCH_ARRAY("impl::random_uniform", "uniform", T, 0, n*S, impl::random_uniform(c,n,T(0),T(1),1,0))
+			BENCH_ARRAY("impl::random_normal", "normal", T, 0, n*S, impl::random_normal(c,n,T(0),T(1),1,0))
+			BENCH_ARRAY("impl::random_bernoulli", "bernoulli", T, 0, n*S, impl::random_bernoulli(c,n,T(0.5),1,0))
+
+			// Blas on vectors
+			BENCH_ARRAY("impl::axpy", "b+=2*a", T, 2*n, 3*n*S, impl::axpy(n,T(2),(const T *)a,1,b,1))
+			BENCH_ARRAY("impl::scal", "c*=2", T, n, 2*n*S, impl::scal(n,T(2),c,1))
+			BENCH_ARRAY("impl::nrm2", "norm(a)", T, 2*n, n*S, keep(impl::nrm2(n,(const T *)a,1)))
+			BENCH_ARRAY("impl::dot", "dot(a,b)", T, 2*n, 2*n*S, keep(impl::dot(n,(const T *)a,1,(const T *)b,1)))
+
+			// Matrix shaped
+			BENCH_MATRIX("impl::gemm", "C=A*B", T, 2.0*n*n*n, 3*n*n*S, impl::gemm('N','N',n,n,n,T(1),(const T *)A,n,(const T *)B,n,T(0),C,n))
+			BENCH_MATRIX("impl::gemm", "C=A'*B", T, 2.0*n*n*n, 3*n*n*S, impl::gemm('T','N',n,n,n,T(1),(const T *)A,n,(const T *)B,n,T(0),C,n))
+			BENCH_MATRIX("impl::gemm", "C=A*B'", T, 2.0*n*n*n, 3*n*n*S, impl::gemm('N','T',n,n,n,T(1),(const T *)A,n,(const T *)B,n,T(0),C,n))
+			BENCH_MATRIX("impl::gemv", "y=A*x", T, 2.0*n*n, (n*n + 2*n)*S, impl::gemv('N',n,n,T(1),(const T *)A,n,(const T *)x,1,T(0),y,1))
+			BENCH_MATRIX("impl::gemv", "y=A'*x", T, 2.0*n*n, (n*n + 2*n)*S, impl::gemv('T',n,n,T(1),(const T *)A,n,(const T *)x,1,T(0),y,1))
+			BENCH_MATRIX("impl::transpose", "C=A'", T, 0, 2*n*n*S, impl::transpose(C,(const T *)A,n,n))
+			BENCH_MATRIX("impl::rowwise_sum", "y=A.rowwise().sum()", T, n*n, (n*n + n)*S, impl::rowwise_sum(y,(const T *)A,n,n))
+			BENCH_MATRIX("impl::colwise_sum", "y=A.colwise().sum()", T, n*n, (n*n + n)*S, impl::colwise_sum(y,(const T *)A,n,n))
+			BENCH_MATRIX("impl::colwise_array_op", "C=A.colwise()+x", T, n*n, (2*n*n + n)*S, impl::colwise_array_op(C,(const T *)A,n,n,(const T *)x,Fcnl_add<T,T>()))
+			BENCH_MATRIX("impl::rowwise_array_op", "C=A.rowwise()*x", T, n*n, (2*n*n + n)*S, impl::rowwise_array_op(C,(const T *)A,n,n,(const T *)x,Fcnl_mul<T,T>()))
+			BENCH_MATRIX("impl::colwise_array_compound_op", "A.colwise()+=x", T, n*n, (2*n*n + n)*S, impl::colwise_array_compound_op(A,n,n,(const T *)x,Fcnl_colwise_add_eq<T,T>()))
+			BENCH_MATRIX("impl::rowwise_array_compound_op", "A.rowwise()-=x", T, n*n, (2*n*n + n)*S, impl::rowwise_array_compound_op(A,n,n,(const T *)x,Fcnl_rowwise_sub_eq<T,T>()))
+		}
+
+		// The half and bfloat16 entry points. They compute in float, so the
+		// bytes moved are what changes against register_typed<float>.
+		template <typename T>
+		void register_storage16(Suite & suite)
+		{
+			const std::vector<std::size_t> lengths = suite.lengths();
+			const std::vector<std::size_t> sizes = suite.sizes();
+			const double S = sizeof(T);
+
+			// Memory
+			BENCH_ARRAY("impl::set", "host to device", T, 0, n*S, impl::set(c,(const T *)host,n))
+			BENCH_ARRAY("impl::get", "device to host", T, 0, n*S, impl::get(host,(const T *)a,n))
+			BENCH_ARRAY("impl::copy", "device to device", T, 0, 2*n*S, impl::copy(c,(const T *)a,n))
+
+			// ArrayOperation
+			BENCH_ARRAY("impl::array_add", "c=a+b", T, n, 3*n*S, impl::array_add(c,a,b,n))
+			BENCH_ARRAY("impl::array_mul", "c=a*b", T, n, 3*n*S, impl::array_mul(c,a,b,n))
+			BENCH_ARRAY("impl::array_div", "c=a/b", T, n, 3*n*S, impl::array_div(c,a,b,n))
+			BENCH_ARRAY("impl::scalar_array_mul", "c=2*a", T, n, 2*n*S, impl::scalar_array_mul(c,T(2),a,n))
+			BENCH_ARRAY("impl::array_compound_op", "c+=a", T, n, 3*n*S, impl::array_compound_op(c,a,n,Fcnl_add_eq<T,T>()))
+			BENCH_ARRAY("impl::scalar_array_compound_op", "c*=2", T, n, 2*n*S, impl::scalar_array_compound_op(c,T(2),n,Fcnl_mul_eq<T,T>()))
+			BENCH_ARRAY("impl::array_scalar_compare", "mask=a>0.5", T, n, n*(S+1), impl::array_scalar_compare(mask,a,T(0.5),n,Fcnl_greater<T,T>()))
+			BENCH_ARRAY("impl::array_select", "c=mask?a:b", T, 0, n*(3*S+1), impl::array_select(c,mask,a,b,n))
+
+			// Function, reductions accumulate in float
+			BENCH_ARRAY("impl::sum", "sum(a)", T, n, n*S, keep(float(impl::sum((const T *)a,n))))
+			BENCH_ARRAY("impl::max_element", "max(a)", T, n, n*S, keep(float(impl::max_element((const T *)a,n))))
+			BENCH_ARRAY("impl::masked_sum", "sum(a,mask)", T, n, n*(S+1), keep(float(impl::masked_sum((const T *)a,mask,n))))
+			BENCH_ARRAY("impl::unary_array_op", "exp", T, n, 2*n*S, impl::unary_array_op(c,a,n,Fcnl_exp<T>()))
+			BENCH_ARRAY("impl::unary_array_op", "logistic", T, n, 2*n*S, impl::unary_array_op(c,a,n,Fcnl_logistic<T>()))
+			BENCH_ARRAY("impl::binary_array_op", "max(a,b)", T, n, 3*n*S, impl::binary_array_op(c,(const T *)a,(const T *)b,n,Fcnl_max<T,T>()))
+			BENCH_ARRAY("impl::nrm2", "norm(a)", T, 2*n, n*S, keep(float(impl::nrm2(n,(const T *)a,1))))
+			BENCH_ARRAY("impl::dot", "dot(a,b)", T, 2*n, 2*n*S, keep(float(impl::dot(n,(const T *)a,1,(const T *)b,1))))
+
+			for (std::size_t i = 0; i < lengths.size(); ++i)
+			{
+				const std::size_t n = lengths[i];
+
+				suite.add("impl::array_convert", std::string("float<-") + type_name<T>(), "gpumatrix", type_name<T>(), shape(n), 0, n*(S + 4),
+					[n]() -> Body {
+						std::shared_ptr<Operands<T> > o(new Operands<T>(n));
+						std::shared_ptr<Matrix<float> > f(new Matrix<float>(n,1));
+						return [o,f,n]() { impl::array_convert(f->data(),(const T *)o->a.data(),n); };
+					});
+
+				suite.add("impl::array_convert", std::string(type_name<T>()) + "<-float", "gpumatrix", type_name<T>(), shape(n), 0, n*(S + 4),
+					[n]() -> Body {
+						std::shared_ptr<Operands<T> > o(new Operands<T>(n));
+						std::shared_ptr<Matrix<float> > f(new Matrix<float>(uniform<float>(n,1,0.01f,1.0f)));
+						return [o,f,n]() { impl::array_convert(o->c.data(),(const float *)f->data(),n); };
+					});
+			}
+
+			// Matrix shaped, the tiled 16 bit kernels
+			BENCH_MATRIX("impl::gemm", "C=A*B", T, 2.0*n*n*n, 3*n*n*S, impl::gemm('N','N',n,n,n,T(1),(const T *)A,n,(const T *)B,n,T(0),C,n))
+			BENCH_MATRIX("impl::gemm", "C=A'*B", T, 2.0*n*n*n, 3*n*n*S, impl::gemm('T','N',n,n,n,T(1),(const T *)A,n,(const T *)B,n,T(0),C,n))
+			BENCH_MATRIX("impl::gemv", "y=A*x", T, 2.0*n*n, (n*n + 2*n)*S, impl::gemv('N',n,n,T(1),(const T *)A,n,(const T *)x,1,T(0),y,1))
+			BENCH_MATRIX("impl::gemv", "y=A'*x", T, 2.0*n*n, (n*n + 2*n)*S, impl::gemv('T',n,n,T(1),(const T *)A,n,(const T *)x,1,T(0),y,1))
+			BENCH_MATRIX("impl::syrk", "C=A'*A", T, 1.0*n*n*n, 2*n*n*S, impl::syrk('U','T',n,n,T(1),(const T *)A,n,T(0),C,n))
+			BENCH_MATRIX("impl::transpose", "C=A'", T, 0, 2*n*n*S, impl::transpose(C,(const T *)A,n,n))
+			BENCH_MATRIX("impl::colwise_array_op", "C=A.colwise()+x", T, n*n, (2*n*n + n)*S, impl::colwise_array_op(C,(const T *)A,n,n,(const T *)x,Fcnl_add<T,T>()))
+		}
+
+		#undef BENCH_ARRAY
+		#undef BENCH_MATRIX
+	}
+
+	void register_primitives(Suite & suite)
+	{
+		register_typed<double>(suite);
+		register_typed<float>(suite);
+		register_storage16<half>(suite);
+		register_storage16<bfloat16>(suite);
+
+		const std::vector<std::size_t> lengths = suite.lengths();
+
+		for (std::size_t i = 0; i < lengths.size(); ++i)
+		{
+			const std::size_t n = lengths[i];
+
+			suite.add("impl::array_convert", "float<-double", "gpumatrix", "double", shape(n), 0, n*12.0,
+				[n]() -> Body {
+					std::shared_ptr<Operands<double> > o(new Operands<double>(n));
+					std::shared_ptr<Matrix<float> > f(new Matrix<float>(n,1));
+					return [o,f,n]() { impl::array_convert(f->data(),(const double *)o->a.data(),n); };
+				});
+
+			suite.add("impl::count", "count(mask)", "gpumatrix", "bool", shape(n), n, n,
+				[n]() -> Body {
+					std::shared_ptr<Operands<float> > o(new Operands<float>(n));
+					return [o,n]() { keep(impl::count((const bool *)o->mask.data(),n)); };
+				});
+
+			suite.add("impl::wide_sum", "sum(a) in double", "gpumatrix", "float", shape(n), n, n*4.0,
+				[n]() -> Body {
+					std::shared_ptr<Operands<float> > o(new Operands<float>(n));
+					return [o,n]() { keep(impl::wide_sum((const float *)o->a.data(),n)); };
+				});
+
+			suite.add("impl::wide_dot", "dot(a,b) in double", "gpumatrix", "float", shape(n), 2*n, n*8.0,
+				[n]() -> Body {
+					std::shared_ptr<Operands<float> > o(new Operands<float>(n));
+					return [o,n]() { keep(impl::wide_dot((const float *)o->a.data(),(const float *)o->b.data(),n)); };
+				});
+
+			suite.add("impl::array_cross_entropy", "c=xent(a,b)", "gpumatrix", "double", shape(n), 3*n, n*24.0,
+				[n]() -> Body {
+					std::shared_ptr<Operands<double> > o(new Operands<double>(n));
+					return [o,n]() { impl::array_cross_entropy(o->c.data(),o->a.data(),o->b.data(),n); };
+				});
+		}
+	}
+}
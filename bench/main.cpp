@@ -0,0 +1,185 @@
+#include "Bench.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include <cublas.h>
+
+namespace bench
+{
+	std::string shape(std::size_t n)
+	{
+		std::ostringstream os;
+		os << n;
+		return os.str();
+	}
+
+	std::string shape(std::size_t r, std::size_t c)
+	{
+		std::ostringstream os;
+		os << r << "x" << c;
+		return os.str();
+	}
+
+	std::string shape(std::size_t m, std::size_t n, std::size_t k)
+	{
+		std::ostringstream os;
+		os << m << "x" << n << "x" << k;
+		return os.str();
+	}
+
+	std::vector<std::size_t> Suite::lengths() const
+	{
+		std::vector<std::size_t> n;
+		for (std::size_t s = 1 << 12; s <= (quick ? 1u << 16 : 1u << 24); s <<= 4)
+			n.push_back(s);
+		return n;
+	}
+
+	std::vector<std::size_t> Suite::sizes() const
+	{
+		std::vector<std::size_t> n;
+		for (std::size_t s = 64; s <= (quick ? 256u : 2048u); s <<= 1)
+			n.push_back(s);
+		return n;
+	}
+
+	static double time_batch(const Body & body, std::size_t iterations)
+	{
+		typedef std::chrono::steady_clock clock;
+
+		clock::time_point start = clock::now();
+		for (std::size_t i = 0; i < iterations; ++i)
+			body();
+		synchronize();
+		return std::chrono::duration<double>(clock::now() - start).count();
+	}
+
+	void Suite::run(const std::string & filter, std::ostream & log)
+	{
+		for (std::size_t i = 0; i < cases.size(); ++i)
+		{
+			const Case & c = cases[i];
+			if (!filter.empty() && c.group.find(filter) == std::string::npos && c.name.find(filter) == std::string::npos)
+				continue;
+
+			Body body = c.setup();
+			time_batch(body,1);
+
+			std::size_t iterations = 1;
+			while (time_batch(body,iterations) < min_time && iterations < (1u << 30))
+				iterations *= 2;
+
+			double best = time_batch(body,iterations);
+			for (int r = 1; r < repetitions; ++r)
+			{
+				double t = time_batch(body,iterations);
+				best = t < best ? t : best;
+			}
+
+			Result result = { &c, iterations, best/iterations };
+			results.push_back(result);
+
+			log << c.group << " " << c.name << " [" << c.backend << "," << c.type << "," << c.shape << "] "
+				<< result.seconds*1e6 << " us";
+			if (c.flops > 0)
+				log << ", " << c.flops/result.seconds*1e-9 << " GFLOP/s";
+			if (c.bytes > 0)
+				log << ", " << c.bytes/result.seconds*1e-9 << " GB/s";
+			log << std::endl;
+		}
+	}
+
+	static std::string quote(const std::string & s)
+	{
+		std::string q = "\"";
+		for (std::size_t i = 0; i < s.size(); ++i)
+		{
+			if (s[i] == '"' || s[i] == '\\')
+				q += '\\';
+			q += s[i];
+		}
+		return q + "\"";
+	}
+
+	void Suite::write_json(std::ostream & os) const
+	{
+		char date[64];
+		std::time_t now = std::time(0);
+		std::strftime(date,sizeof(date),"%Y-%m-%dT%H:%M:%S",std::gmtime(&now));
+
+		os.precision(6);
+		os << "{\n  \"context\": { \"date\": " << quote(date) << ", \"min_time\": " << min_time
+			<< ", \"repetitions\": " << repetitions << " },\n  \"benchmarks\": [";
+
+		for (std::size_t i = 0; i < results.size(); ++i)
+		{
+			const Result & r = results[i];
+			const Case & c = *r.c;
+
+			os << (i ? "," : "") << "\n    { \"group\": " << quote(c.group) << ", \"name\": " << quote(c.name)
+				<< ", \"backend\": " << quote(c.backend) << ", \"type\": " << quote(c.type)
+				<< ", \"shape\": " << quote(c.shape) << ", \"iterations\": " << r.iterations
+				<< ", \"seconds\": " << r.seconds
+				<< ", \"gflops\": " << (c.flops > 0 ? c.flops/r.seconds*1e-9 : 0)
+				<< ", \"gbps\": " << (c.bytes > 0 ? c.bytes/r.seconds*1e-9 : 0) << " }";
+		}
+
+		os << "\n  ]\n}\n";
+	}
+}
+
+static void usage()
+{
+	std::cerr << "benchGPUMatrix [--filter TEXT] [--json FILE] [--min-time SECONDS] [--quick]" << std::endl;
+}
+
+int main(int argc, char ** argv)
+{
+	bench::Suite suite;
+	std::string filter, json = "benchGPUMatrix.json";
+
+	for (int i = 1; i < argc; ++i)
+	{
+		if (!std::strcmp(argv[i],"--filter") && i + 1 < argc)
+			filter = argv[++i];
+		else if (!std::strcmp(argv[i],"--json") && i + 1 < argc)
+			json = argv[++i];
+		else if (!std::strcmp(argv[i],"--min-time") && i + 1 < argc)
+			suite.min_time = std::atof(argv[++i]);
+		else if (!std::strcmp(argv[i],"--quick"))
+			suite.quick = true;
+		else
+		{
+			usage();
+			return 1;
+		}
+	}
+
+	cublasInit();
+
+	try
+	{
+		bench::register_primitives(suite);
+		bench::register_expressions(suite);
+		suite.run(filter,std::cout);
+	}
+	catch (const std::exception & e)
+	{
+		std::cerr << "benchmark failed: " << e.what() << std::endl;
+		cublasShutdown();
+		return 1;
+	}
+
+	cublasShutdown();
+
+	std::ofstream out(json.c_str());
+	suite.write_json(out);
+	return out ? 0 : 1;
+}
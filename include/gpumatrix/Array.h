@@ -37,6 +37,7 @@
 
 #include <Eigen/Core>
 #include <gpumatrix/impl/Interface.h>
+#include <gpumatrix/SharedStorage.h>
 
 namespace gpumatrix {
 
@@ -105,7 +106,7 @@ namespace gpumatrix {
 			TVMET_RT_CONDITION((i < Rows) && (j < Cols), "ArrayConstReference Bounce Violation")
 				// Do not Call This When Using GPU!
 				value_type val;
-			cublasGetVector (1, sizeof(value_type), m_data + i + j*Rows,1, &val, 1);
+			impl::get(&val, m_data + i + j*Rows, 1);
 			return val;
 
 		}
@@ -140,6 +141,11 @@ namespace gpumatrix {
 			return 	impl::squaredNorm(*this);
 		}
 
+		value_type sum() const
+		{
+			return 	impl::sum(*this);
+		}
+
 		///** assign this to a Array  of a different type T2 using
 		//    the functional assign_fn. */
 		template<class Assign>
@@ -218,16 +224,16 @@ namespace gpumatrix {
 
 	public: // STL  interface
 		/** STL iterator interface. */
-		iterator begin() { return m_data; }
+		iterator begin() { return data(); }
 
 		/** STL iterator interface. */
-		iterator end() { return m_data + Rows*Cols;; }
+		iterator end() { return data() + Rows*Cols;; }
 
 		/** STL const_iterator interface. */
-		const_iterator begin() const { return m_data; }
+		const_iterator begin() const { return m_storage.data(); }
 
 		/** STL const_iterator interface. */
-		const_iterator end() const { return m_data + Rows*Cols;; }
+		const_iterator end() const { return m_storage.data() + Rows*Cols;; }
 
 		/** STL reverse iterator interface reverse begin. */
 		reverse_iterator rbegin() { return reverse_iterator( end() ); }
@@ -254,7 +260,7 @@ namespace gpumatrix {
 		/** STL vector empty() - returns allways false. */
 		bool empty() 
 		{ 
-			if (m_data == 0)
+			if (m_storage.data() == 0)
 				return true; 
 			else 
 				return false;
@@ -272,52 +278,36 @@ namespace gpumatrix {
 			return NoAliasProxy<Array<T,D>>(*this);
 		}
 	public:
-		/** Default Destructor */
-		~Array() {
-			impl::free(m_data);
-		}
-
 		/** Default Constructor. The allocated memory region isn't cleared. If you want
 		a clean use the constructor argument zero. */
-		explicit Array():m_data(0),Rows(0),Cols(0)
+		explicit Array():Rows(0),Cols(0)
 		{ 
 		}
 
 		explicit Array(std::size_t size):Rows(size),Cols(1)
 		{
-			m_data = impl::alloc<value_type>(Rows*Cols);
+			m_storage.reset(Rows*Cols);
 
 		}
 
 		explicit Array(std::size_t nRows, std::size_t nCols):Rows(nRows),Cols(nCols)
 		{
 
-			m_data = impl::alloc<value_type>(Rows*Cols);
+			m_storage.reset(Rows*Cols);
 
 		}
 
-		/** Copy Constructor, not explicit! */
-		Array(const Array& rhs):Rows(rhs.rows()),Cols(rhs.cols())
+		/** Copy Constructor, not explicit! The copy shares the buffer of rhs
+		until either of them is written, see SharedStorage.h. */
+		Array(const Array& rhs):Rows(rhs.rows()),Cols(rhs.cols()),m_storage(rhs.m_storage)
 		{
-			if (this != &rhs)
-			{
-				if (rhs.data() == 0)
-				{
-					m_data = 0;
-					return;
-				}
-
-				m_data = impl::alloc<value_type>(Rows*Cols);
-				impl::copy(m_data,rhs.data(),rhs.size());
-			}
-			//		*this = XprArray<ConstReference>(rhs.as_expr());
 		}
 
 
 		Array(const Eigen::Array<T,Eigen::Dynamic,Eigen::Dynamic> & EigenArray):Rows(EigenArray.rows()),Cols(EigenArray.cols())
 		{
-			m_data = impl::alloc<value_type>(Rows*Cols);
-			impl::set(m_data,EigenArray.data(),Rows*Cols);
+			m_storage.reset(Rows*Cols);
+			impl::set(data(),EigenArray.data(),Rows*Cols);
 
 		}
 
@@ -365,7 +355,7 @@ namespace gpumatrix {
 		template<class E>
 		Array(const XprArray<E,D>& e):Rows(e.rows()),Cols(e.cols())
 		{
-			m_data = impl::alloc<value_type>(Rows*Cols);
+			m_storage.reset(Rows*Cols);
 
 			(*this).noalias() = e;
 		}
@@ -382,7 +372,7 @@ namespace gpumatrix {
 
 		Map<Matrix<value_type> > matrix ()
 		{
-			return Map<Matrix<value_type>>(m_data,Rows,Cols);
+			return Map<Matrix<value_type>>(data(),Rows,Cols);
 		}
 
 		operator Eigen::Matrix<value_type,Eigen::Dynamic,Eigen::Dynamic> () const
@@ -390,7 +380,7 @@ namespace gpumatrix {
 
 			Eigen::Matrix<value_type,Eigen::Dynamic,Eigen::Dynamic> M(Rows,Cols);
 
-			impl::get(M.data(),m_data,size());
+			impl::get(M.data(),m_storage.data(),size());
 
 			return M;
 		}
@@ -402,11 +392,9 @@ namespace gpumatrix {
 
 				return;
 
-			impl::free(m_data);
-
 			Rows = r; Cols = c;
 
-			m_data = impl::alloc<value_type>(Rows*Cols);
+			m_storage.reset(Rows*Cols);
 
 		}
 		///** assign a value_type on array, this can be used for a single value
@@ -416,8 +404,9 @@ namespace gpumatrix {
 		//}
 
 	public: // access operators
-		value_type* _tvmet_restrict data() { return m_data; }
-		const value_type* _tvmet_restrict data() const { return m_data; }
+		/** The buffer for writing, copied first if other objects share it. */
+		value_type* _tvmet_restrict data() { return m_storage.unique(); }
+		const value_type* _tvmet_restrict data() const { return m_storage.data(); }
 
 	public: // index access operators
 		//value_type& _tvmet_restrict operator()(std::size_t i, std::size_t j) {
@@ -454,6 +443,32 @@ namespace gpumatrix {
 			return XprArray<ConstReference,D>(this->const_ref());
 		}
 
+		// the views of a const array can't be written and leave a shared
+		// buffer shared, as for Matrix
+		RowWiseView<XprArray<ConstReference,D>,true> rowwise()
+		{
+			// op= on the view updates this array in place
+			m_storage.unique();
+			return RowWiseView<XprArray<ConstReference,D>,true>(this->as_expr());
+		}
+
+		RowWiseView<XprArray<ConstReference,D>,false> rowwise() const
+		{
+			return RowWiseView<XprArray<ConstReference,D>,false>(this->as_expr());
+		}
+
+		ColWiseView<XprArray<ConstReference,D>,true> colwise()
+		{
+			// op= on the view updates this array in place
+			m_storage.unique();
+			return ColWiseView<XprArray<ConstReference,D>,true>(this->as_expr());
+		}
+
+		ColWiseView<XprArray<ConstReference,D>,false> colwise() const
+		{
+			return ColWiseView<XprArray<ConstReference,D>,false>(this->as_expr());
+		}
+
 	private:
 		///** Wrapper for meta assign. */
 		//template<class Dest, class Src, class Assign>
@@ -482,9 +497,9 @@ namespace gpumatrix {
 		to this Array. The operator=(const Array&) is compiler
 		generated. */
 		Array& operator=(const Array & rhs) {
-			resize(rhs.rows(),rhs.cols());
-			/*cudaMemcpy(m_data, rhs.m_data*Cols*sizeof(value_type), cudaMemcpyDeviceToDevice);*/
-			rhs.assign_to(*this, Fcnl_assign<value_type, value_type>());
+			// see SharedStorage::assign
+			m_storage.assign(rhs.m_storage);
+			Rows = rhs.rows(); Cols = rhs.cols();
 			return *this;
 		}
 
@@ -663,6 +678,11 @@ namespace gpumatrix {
 			return 	impl::squaredNorm(*this);
 		}
 
+		value_type squaredNorm(AccumulationPolicy policy) const
+		{
+			return 	impl::squaredNorm(*this,policy);
+		}
+
 		
 		value_type sum() const
 		{
@@ -671,12 +691,17 @@ namespace gpumatrix {
 			return impl::sum(*this);
 		}
 
+		value_type sum(AccumulationPolicy policy) const
+		{
+			return impl::sum(*this,policy);
+		}
+
 
 		void setZero(std::size_t rows, std::size_t cols)
 		{
 			resize(rows,cols);
 
-			impl::zero(m_data,size());
+			impl::zero(m_storage.overwrite(),size());
 		}
 
 		//Array& operator%=(std::size_t) TVMET_CXX_ALWAYS_INLINE;
@@ -756,9 +781,9 @@ namespace gpumatrix {
 		//std::ostream& print_on(std::ostream& os) const;
 
 	private:
-		/** The data of Array self. */
+		/** The data of Array self, see SharedStorage.h. */
 
-		value_type*						m_data;
+		impl::SharedStorage<value_type>	m_storage;
 
 	};
 
@@ -769,6 +794,9 @@ namespace gpumatrix {
 #include <gpumatrix/MapArray.h>
 #include <gpumatrix/ArrayFunctions.h>
 #include <gpumatrix/ArrayOperators.h>
+#include <gpumatrix/Mask.h>
+#include <gpumatrix/ArrayUnaryFunctions.h>
+#include <gpumatrix/ArrayBinaryFunctions.h>
 #include <gpumatrix/NoAliasProxy.h>
 
 
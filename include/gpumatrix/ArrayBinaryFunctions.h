@@ -0,0 +1,85 @@
+#ifndef GPUMATRIX_ARRAY_BINARY_FUNCTIONS_H
+#define GPUMATRIX_ARRAY_BINARY_FUNCTIONS_H
+
+namespace gpumatrix
+{
+	/*
+	* binary_function(A, B), binary_function(A, beta), binary_function(alpha, B)
+	* for Array, Map<Array> and XprArray operands, e.g. pow(A.array(), 2) or
+	* cwiseMax(A.array(), 0). The scalar takes the element type of the array.
+	* Note: per se element wise, evaluated by the kernel of Fcnl_FCNL
+	*/
+#define GPUMATRIX_ARRAY_BINARY_FUNCTION(NAME, FCNL)						\
+	template<class A, class B>											\
+	inline																\
+	XprArray<															\
+		XprBinOp<														\
+			Fcnl_##FCNL<typename impl::ArrayOperand<A>::value_type, typename impl::ArrayOperand<B>::value_type>,	\
+			typename impl::ArrayOperand<A>::expr_type,					\
+			typename impl::ArrayOperand<B>::expr_type					\
+		>, impl::ArrayOperand<A>::dim									\
+	>																	\
+	NAME(const A & a, const B & b)										\
+	{																	\
+		typedef XprBinOp<												\
+			Fcnl_##FCNL<typename impl::ArrayOperand<A>::value_type, typename impl::ArrayOperand<B>::value_type>,	\
+			typename impl::ArrayOperand<A>::expr_type,					\
+			typename impl::ArrayOperand<B>::expr_type					\
+		> expr_type;													\
+		return XprArray<expr_type,impl::ArrayOperand<A>::dim>(			\
+			expr_type(impl::ArrayOperand<A>::as_expr(a), impl::ArrayOperand<B>::as_expr(b)));	\
+	}																	\
+																		\
+	template<class A>													\
+	inline																\
+	XprArray<															\
+		XprBinOp<														\
+			Fcnl_##FCNL<typename impl::ArrayOperand<A>::value_type, typename impl::ArrayOperand<A>::value_type>,	\
+			typename impl::ArrayOperand<A>::expr_type,					\
+			XprLiteral<typename impl::ArrayOperand<A>::value_type>		\
+		>, impl::ArrayOperand<A>::dim									\
+	>																	\
+	NAME(const A & a, typename impl::ArrayOperand<A>::value_type beta)	\
+	{																	\
+		typedef typename impl::ArrayOperand<A>::value_type value_type;	\
+		typedef XprBinOp<												\
+			Fcnl_##FCNL<value_type, value_type>,						\
+			typename impl::ArrayOperand<A>::expr_type,					\
+			XprLiteral<value_type>										\
+		> expr_type;													\
+		return XprArray<expr_type,impl::ArrayOperand<A>::dim>(			\
+			expr_type(impl::ArrayOperand<A>::as_expr(a), XprLiteral<value_type>(beta)));	\
+	}																	\
+																		\
+	template<class B>													\
+	inline																\
+	XprArray<															\
+		XprBinOp<														\
+			Fcnl_##FCNL<typename impl::ArrayOperand<B>::value_type, typename impl::ArrayOperand<B>::value_type>,	\
+			XprLiteral<typename impl::ArrayOperand<B>::value_type>,		\
+			typename impl::ArrayOperand<B>::expr_type					\
+		>, impl::ArrayOperand<B>::dim									\
+	>																	\
+	NAME(typename impl::ArrayOperand<B>::value_type alpha, const B & b)	\
+	{																	\
+		typedef typename impl::ArrayOperand<B>::value_type value_type;	\
+		typedef XprBinOp<												\
+			Fcnl_##FCNL<value_type, value_type>,						\
+			XprLiteral<value_type>,										\
+			typename impl::ArrayOperand<B>::expr_type					\
+		> expr_type;													\
+		return XprArray<expr_type,impl::ArrayOperand<B>::dim>(			\
+			expr_type(XprLiteral<value_type>(alpha), impl::ArrayOperand<B>::as_expr(b)));	\
+	}
+
+	GPUMATRIX_ARRAY_BINARY_FUNCTION(pow, pow)
+	GPUMATRIX_ARRAY_BINARY_FUNCTION(atan2, atan2)
+	GPUMATRIX_ARRAY_BINARY_FUNCTION(hypot, hypot)
+	GPUMATRIX_ARRAY_BINARY_FUNCTION(fmod, fmod)
+	GPUMATRIX_ARRAY_BINARY_FUNCTION(cwiseMin, min)
+	GPUMATRIX_ARRAY_BINARY_FUNCTION(cwiseMax, max)
+
+#undef GPUMATRIX_ARRAY_BINARY_FUNCTION
+}
+
+#endif
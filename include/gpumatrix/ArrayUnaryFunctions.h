@@ -0,0 +1,92 @@
+#ifndef GPUMATRIX_ARRAY_UNARY_FUNCTIONS_H
+#define GPUMATRIX_ARRAY_UNARY_FUNCTIONS_H
+
+namespace gpumatrix {
+
+
+/*********************************************************
+ * PART I: DECLARATION
+ *********************************************************/
+
+/*
+ * unary_function(Array<T,D>)
+ * unary_function(Map<Array<T,D> >)
+ * Note: per se element wise, evaluated by the kernel of Fcnl_NAME
+ */
+#define TVMET_DECLARE_MACRO(NAME)					\
+template<class T, int D>						\
+inline									\
+XprArray<								\
+  XprUnOp<								\
+    Fcnl_##NAME<T>,							\
+    XprArray<ArrayConstReference<T,D>,D>				\
+  >,D									\
+>									\
+NAME(const Array<T,D>& rhs) TVMET_CXX_ALWAYS_INLINE;			\
+									\
+template<class T, int D>						\
+inline									\
+XprArray<								\
+  XprUnOp<								\
+    Fcnl_##NAME<T>,							\
+    XprArray<ArrayConstReference<T,D>,D>				\
+  >,D									\
+>									\
+NAME(const Map<Array<T,D> >& rhs) TVMET_CXX_ALWAYS_INLINE;
+
+GPUMATRIX_UNARY_FUNCTIONS(TVMET_DECLARE_MACRO)
+
+#undef TVMET_DECLARE_MACRO
+
+
+/*********************************************************
+ * PART II: IMPLEMENTATION
+ *********************************************************/
+
+
+#define TVMET_IMPLEMENT_MACRO(NAME)					\
+template<class T, int D>						\
+inline									\
+XprArray<								\
+  XprUnOp<								\
+    Fcnl_##NAME<T>,							\
+    XprArray<ArrayConstReference<T,D>,D>				\
+  >,D									\
+>									\
+NAME(const Array<T,D>& rhs) {						\
+  typedef XprUnOp<							\
+    Fcnl_##NAME<T>,							\
+    XprArray<ArrayConstReference<T,D>,D>				\
+  >							expr_type;	\
+  return XprArray<expr_type,D>(expr_type(rhs.as_expr()));		\
+}									\
+									\
+template<class T, int D>						\
+inline									\
+XprArray<								\
+  XprUnOp<								\
+    Fcnl_##NAME<T>,							\
+    XprArray<ArrayConstReference<T,D>,D>				\
+  >,D									\
+>									\
+NAME(const Map<Array<T,D> >& rhs) {					\
+  typedef XprUnOp<							\
+    Fcnl_##NAME<T>,							\
+    XprArray<ArrayConstReference<T,D>,D>				\
+  >							expr_type;	\
+  return XprArray<expr_type,D>(expr_type(rhs.as_expr()));		\
+}
+
+GPUMATRIX_UNARY_FUNCTIONS(TVMET_IMPLEMENT_MACRO)
+
+#undef TVMET_IMPLEMENT_MACRO
+
+
+} // namespace gpumatrix
+
+#endif // GPUMATRIX_ARRAY_UNARY_FUNCTIONS_H
+
+// Local Variables:
+// mode:C++
+// tab-width:8
+// End:
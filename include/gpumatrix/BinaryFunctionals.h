@@ -27,6 +27,7 @@
 #include <ostream>
 
 #include <gpumatrix/Functional.h>
+#include <gpumatrix/Half.h>				// GPUMATRIX_HOST_DEVICE
 
 namespace gpumatrix {
 
@@ -96,7 +97,13 @@ TVMET_IMPLEMENT_MACRO(shl_eq, <<=)
 TVMET_IMPLEMENT_MACRO(shr_eq, >>=)
 
 TVMET_IMPLEMENT_MACRO(colwise_add_eq, +=)
+TVMET_IMPLEMENT_MACRO(colwise_sub_eq, -=)
+TVMET_IMPLEMENT_MACRO(colwise_mul_eq, *=)
+TVMET_IMPLEMENT_MACRO(colwise_div_eq, /=)
 TVMET_IMPLEMENT_MACRO(rowwise_add_eq, +=)
+TVMET_IMPLEMENT_MACRO(rowwise_sub_eq, -=)
+TVMET_IMPLEMENT_MACRO(rowwise_mul_eq, *=)
+TVMET_IMPLEMENT_MACRO(rowwise_div_eq, /=)
 
 #undef TVMET_IMPLEMENT_MACRO
 
@@ -116,7 +123,7 @@ template <class T1, class T2>						\
 struct Fcnl_##NAME : public BinaryFunctional {				\
   typedef typename  PromoteTraits<T1, T2>::value_type	value_type;	\
   									\
-  static inline 							\
+  GPUMATRIX_HOST_DEVICE static inline					\
   value_type apply_on(T1 lhs, T2 rhs) {					\
     return lhs OP rhs;							\
   }									\
@@ -186,14 +193,15 @@ TVMET_IMPLEMENT_MACRO(or, ||)
 /** \class Fcnl_atan2 		BinaryFunctionals.h "gpumatrix/BinaryFunctionals.h" */
 /** \class Fcnl_fmod 		BinaryFunctionals.h "gpumatrix/BinaryFunctionals.h" */
 /** \class Fcnl_pow 		BinaryFunctionals.h "gpumatrix/BinaryFunctionals.h" */
+/** \class Fcnl_hypot 		BinaryFunctionals.h "gpumatrix/BinaryFunctionals.h" */
 #define TVMET_IMPLEMENT_MACRO(NAME)					\
 template <class T1, class T2>						\
 struct Fcnl_##NAME : public BinaryFunctional {				\
   typedef typename PromoteTraits<T1, T2>::value_type	value_type;	\
 									\
-  static inline 							\
+  GPUMATRIX_HOST_DEVICE static inline					\
   value_type apply_on(T1 lhs, T2 rhs) {					\
-    return TVMET_STD_SCOPE(NAME)(lhs, rhs);				\
+    return TVMET_GLOBAL_SCOPE(NAME)(lhs, rhs);				\
   }									\
    									\
   static 								\
@@ -208,12 +216,12 @@ struct Fcnl_##NAME : public BinaryFunctional {				\
 TVMET_IMPLEMENT_MACRO(atan2)
 TVMET_IMPLEMENT_MACRO(fmod)
 TVMET_IMPLEMENT_MACRO(pow)
+TVMET_IMPLEMENT_MACRO(hypot)
 
 #undef TVMET_IMPLEMENT_MACRO
 
 //
 ///** \class Fcnl_drem 		BinaryFunctionals.h "gpumatrix/BinaryFunctionals.h" */
-///** \class Fcnl_hypot 		BinaryFunctionals.h "gpumatrix/BinaryFunctionals.h" */
 ///** \class Fcnl_jn 		BinaryFunctionals.h "gpumatrix/BinaryFunctionals.h" */
 ///** \class Fcnl_yn 		BinaryFunctionals.h "gpumatrix/BinaryFunctionals.h" */
 #define TVMET_IMPLEMENT_MACRO(NAME)					\
@@ -232,13 +240,47 @@ struct Fcnl_##NAME : public BinaryFunctional {				\
 };
 
 TVMET_IMPLEMENT_MACRO(drem)
-TVMET_IMPLEMENT_MACRO(hypot)
 TVMET_IMPLEMENT_MACRO(jn)
 TVMET_IMPLEMENT_MACRO(yn)
 
 #undef TVMET_IMPLEMENT_MACRO
 
 
+/** \class Fcnl_min 		BinaryFunctionals.h "gpumatrix/BinaryFunctionals.h" */
+/** \class Fcnl_max 		BinaryFunctionals.h "gpumatrix/BinaryFunctionals.h" */
+#define TVMET_IMPLEMENT_MACRO(NAME, OP)					\
+template <class T1, class T2>						\
+struct Fcnl_##NAME : public BinaryFunctional {				\
+  typedef typename PromoteTraits<T1, T2>::value_type	value_type;	\
+									\
+  GPUMATRIX_HOST_DEVICE static inline					\
+  value_type apply_on(T1 lhs, T2 rhs) {					\
+    return rhs OP lhs ? value_type(rhs) : value_type(lhs);		\
+  }									\
+   									\
+  static 								\
+  void print_xpr(std::ostream& os, std::size_t l=0) {			\
+    os << IndentLevel(l)						\
+       << "Fcnl_" << #NAME << "<T1="					\
+       << typeid(T1).name() << ", T2=" << typeid(T2).name() << ">,"	\
+       << std::endl;							\
+  }									\
+};
+
+TVMET_IMPLEMENT_MACRO(min, <)
+TVMET_IMPLEMENT_MACRO(max, >)
+
+#undef TVMET_IMPLEMENT_MACRO
+
+
+/*
+ * Element wise binary functionals with a kernel in the library, for
+ * double, float, half and bfloat16 with T1 == T2. X(NAME) names Fcnl_NAME.
+ */
+#define GPUMATRIX_BINARY_FUNCTIONALS(X)					\
+  X(min) X(max) X(pow) X(atan2) X(hypot) X(fmod)
+
+
 #if defined(TVMET_HAVE_COMPLEX)
 /**
  * \class Fcnl_polar BinaryFunctionals.h "gpumatrix/BinaryFunctionals.h"
@@ -0,0 +1,103 @@
+#ifndef GPUMATRIX_CHOLESKY_H
+#define GPUMATRIX_CHOLESKY_H
+
+#include <stdexcept>
+
+#include <gpumatrix/Matrix.h>
+#include <gpumatrix/Vector.h>
+
+namespace gpumatrix
+{
+	/**
+	* \class LLT Cholesky.h "gpumatrix/Cholesky.h"
+	* \brief Cholesky factorisation A = L*L^T of a symmetric positive
+	* definite matrix, as Eigen::LLT. Only the lower part of A is read.
+	*
+	* The factor stays on the device: impl::potrf works in blocks with gemm
+	* trailing updates, solve() runs two triangular solves.
+	*/
+	template <class T>
+	class LLT
+	{
+	public:
+		typedef T		value_type;
+
+		LLT() : m_info(Eigen::InvalidInput) { }
+
+		explicit LLT(const Matrix<T> & A) : m_info(Eigen::InvalidInput)
+		{
+			compute(A);
+		}
+
+		LLT & compute(const Matrix<T> & A)
+		{
+			if (A.rows() != A.cols())
+				throw std::runtime_error("Cholesky of a Non Square Matrix");
+
+			m_matrix = A;
+			int info = impl::potrf(m_matrix.rows(),m_matrix.data(),m_matrix.rows());
+			m_info = info == 0 ? Eigen::Success : Eigen::NumericalIssue;
+
+			return *this;
+		}
+
+		/** Success, or NumericalIssue when A is not positive definite. */
+		Eigen::ComputationInfo info() const { return m_info; }
+
+		/** L, zero above the diagonal. */
+		const Matrix<T> & matrixL() const { return m_matrix; }
+
+		/** X with A*X = B. */
+		Matrix<T> solve(const Matrix<T> & B) const
+		{
+			check_solve(B.rows());
+
+			Matrix<T> X(B);
+			int n = m_matrix.rows();
+			impl::trsm('L','L','N','N',n,X.cols(),T(1),m_matrix.data(),n,X.data(),n);
+			impl::trsm('L','L','T','N',n,X.cols(),T(1),m_matrix.data(),n,X.data(),n);
+
+			return X;
+		}
+
+		template <class E>
+		Matrix<T> solve(const XprMatrix<E> & B) const
+		{
+			return solve(Matrix<T>(B));
+		}
+
+		/** x with A*x = b. */
+		Vector<T> solve(const Vector<T> & b) const
+		{
+			check_solve(b.size());
+
+			Vector<T> x(b);
+			int n = m_matrix.rows();
+			impl::trsv('L','N','N',n,m_matrix.data(),n,x.data(),1);
+			impl::trsv('L','T','N',n,m_matrix.data(),n,x.data(),1);
+
+			return x;
+		}
+
+		template <class E>
+		Vector<T> solve(const XprVector<E> & b) const
+		{
+			return solve(Vector<T>(b));
+		}
+
+	private:
+		void check_solve(std::size_t rows) const
+		{
+			if (m_info != Eigen::Success)
+				throw std::runtime_error("Cholesky Factorisation Failed");
+			if (rows != m_matrix.rows())
+				throw std::runtime_error("Dimension not Match for Cholesky Solve");
+		}
+
+	private:
+		Matrix<T>					m_matrix;
+		Eigen::ComputationInfo		m_info;
+	};
+}
+
+#endif
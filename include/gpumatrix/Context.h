@@ -0,0 +1,40 @@
+#ifndef GPUMATRIX_CONTEXT_H
+#define GPUMATRIX_CONTEXT_H
+
+#include <cstddef>
+
+/*
+* Every host thread runs the backend through its own execution context,
+* made on the thread's first device call and released when it exits:
+*
+*  - a cuBLAS handle, bound to the thread's queue;
+*  - the queue itself, cudaStreamPerThread, which the library kernels,
+*    copies and cuBLAS calls all go to;
+*  - an allocator cache keeping freed blocks for reuse by the thread;
+*  - a workspace for the temporaries of the decompositions.
+*
+* Contexts share only the record of which one owns each block, updated on
+* cudaMalloc and cudaFree, so independent threads reusing their caches run
+* concurrently without taking a lock. Objects may still be handed from one
+* thread to another once the first has called synchronize(); a block freed
+* by a thread that did not allocate it goes back to its owner's cache,
+* which takes it in on its next allocation, or to the device once the
+* owner has exited.
+*/
+
+namespace gpumatrix
+{
+	/** Wait until the work queued by this thread has finished. */
+	void synchronize();
+
+	/** Device bytes held by the live objects this thread allocated. */
+	std::size_t allocated_bytes();
+
+	/** Device bytes this thread keeps cached for reuse, workspace included. */
+	std::size_t cached_bytes();
+
+	/** Return this thread's cached blocks and workspace to the device. */
+	void release_cached_memory();
+}
+
+#endif
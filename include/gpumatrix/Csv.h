@@ -0,0 +1,427 @@
+#ifndef GPUMATRIX_CSV_H
+#define GPUMATRIX_CSV_H
+
+#include <algorithm>
+#include <cctype>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <string>
+#include <thread>
+#include <vector>
+#include <stdexcept>
+
+#include <gpumatrix/Matrix.h>
+#include <gpumatrix/Half.h>
+#include <gpumatrix/MappedFile.h>
+
+/*
+* Numeric delimited text. One row per line, no quoting, an optional header
+* line that is skipped on read. Blank lines are ignored.
+*
+* Both directions cut the data into one slice of whole rows per thread.
+* Reading takes two passes over the mapped file: count the rows of every
+* slice, then parse each slice straight into its rows of a column major
+* staging buffer that goes to the device in one impl::set.
+*/
+
+namespace gpumatrix
+{
+	struct CsvFormat
+	{
+		char delimiter;
+		bool header;
+		unsigned int threads;	/**< 0 for one per hardware thread */
+		int precision;			/**< significant digits written, 0 to round trip */
+
+		explicit CsvFormat(char d = ',', bool h = false)
+			: delimiter(d), header(h), threads(0), precision(0) { }
+	};
+
+	namespace impl
+	{
+		/** Type the text is parsed as, and exact fast-path limits for it:
+		a mantissa up to 2^MantissaBits scaled by 10^e, |e| <= MaxPow10,
+		is one correctly rounded multiply or divide. */
+		template <typename T> struct CsvParseTraits
+		{
+			typedef float parse_type;
+			enum { MantissaBits = 24, MaxPow10 = 10, Digits = 9 };
+		};
+
+		template <> struct CsvParseTraits<double>
+		{
+			typedef double parse_type;
+			enum { MantissaBits = 53, MaxPow10 = 22, Digits = 17 };
+		};
+
+		template <> struct CsvParseTraits<half>
+		{
+			typedef float parse_type;
+			enum { MantissaBits = 24, MaxPow10 = 10, Digits = 5 };
+		};
+
+		template <> struct CsvParseTraits<bfloat16>
+		{
+			typedef float parse_type;
+			enum { MantissaBits = 24, MaxPow10 = 10, Digits = 4 };
+		};
+
+		template <typename F> inline F csv_pow10(int e)
+		{
+			static const double p[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10,
+				1e11, 1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+			return F(p[e]);
+		}
+
+		inline void csv_strto(const char * s, char ** stop, double & value) { value = std::strtod(s,stop); }
+		inline void csv_strto(const char * s, char ** stop, float & value) { value = std::strtof(s,stop); }
+
+		/**
+		* Parse one number from [p, end). Returns the first character after
+		* it, or 0 if there is none. Short decimals take Clinger's fast path,
+		* everything else (long mantissas, large exponents, inf, nan) goes
+		* through strtod on a copy of the token.
+		*/
+		template <typename F>
+		const char * csv_parse(const char * p, const char * end, F & value)
+		{
+			const char * start = p;
+			bool negative = false;
+
+			if (p < end && (*p == '-' || *p == '+'))
+				negative = *p++ == '-';
+
+			unsigned long long mantissa = 0;
+			int digits = 0, exponent = 0;
+			bool exact = true;
+
+			for (; p < end && *p >= '0' && *p <= '9'; ++p, ++digits)
+			{
+				if (digits < 19)
+					mantissa = mantissa*10 + (*p - '0');
+				else
+				{
+					++exponent;
+					exact = false;
+				}
+			}
+
+			if (p < end && *p == '.')
+			{
+				for (++p; p < end && *p >= '0' && *p <= '9'; ++p, ++digits)
+				{
+					if (digits < 19)
+					{
+						mantissa = mantissa*10 + (*p - '0');
+						--exponent;
+					}
+					else
+						exact = false;
+				}
+			}
+
+			if (digits > 0 && p < end && (*p == 'e' || *p == 'E'))
+			{
+				const char * q = p + 1;
+				bool negexp = false;
+				if (q < end && (*q == '-' || *q == '+'))
+					negexp = *q++ == '-';
+
+				if (q < end && *q >= '0' && *q <= '9')
+				{
+					int e = 0;
+					for (; q < end && *q >= '0' && *q <= '9'; ++q)
+						if (e < 100000) e = e*10 + (*q - '0');
+					exponent += negexp ? -e : e;
+					p = q;
+				}
+			}
+
+			const int MaxPow10 = CsvParseTraits<F>::MaxPow10;
+
+			if (digits > 0 && exact && (mantissa >> CsvParseTraits<F>::MantissaBits) == 0
+				&& exponent >= -MaxPow10 && exponent <= MaxPow10)
+			{
+				F v = F(mantissa);
+				v = exponent < 0 ? v/csv_pow10<F>(-exponent) : v*csv_pow10<F>(exponent);
+				value = negative ? -v : v;
+				return p;
+			}
+
+			// slow path: copy out the token and let the C library decide
+			const char * q = start;
+			while (q < end && (std::isalnum((unsigned char)*q) || *q == '+' || *q == '-' || *q == '.'))
+				++q;
+			if (q == start)
+				return 0;
+
+			char local[64];
+			std::string heap;
+			const char * token = local;
+
+			if (q - start < (std::ptrdiff_t)sizeof(local))
+			{
+				std::memcpy(local,start,q - start);
+				local[q - start] = '\0';
+			}
+			else
+			{
+				heap.assign(start,q);
+				token = heap.c_str();
+			}
+
+			char * stop;
+			csv_strto(token,&stop,value);
+			if (stop == token)
+				return 0;
+
+			return start + (stop - token);
+		}
+
+		inline const char * csv_line_end(const char * p, const char * end)
+		{
+			const char * q = (const char *)std::memchr(p,'\n',end - p);
+			return q ? q : end;
+		}
+
+		inline bool csv_blank(const char * p, const char * eol)
+		{
+			for (; p < eol; ++p)
+				if (*p != ' ' && *p != '\t' && *p != '\r')
+					return false;
+			return true;
+		}
+
+		/** Blanks around a value are skipped unless they are the delimiter itself. */
+		inline bool csv_padding(char c, char delimiter)
+		{
+			return (c == ' ' || c == '\t') && c != delimiter;
+		}
+
+		inline unsigned int csv_threads(const CsvFormat & format, std::size_t work)
+		{
+			unsigned int n = format.threads ? format.threads : std::thread::hardware_concurrency();
+			if (n == 0)
+				n = 1;
+			return work < n ? (work > 0 ? (unsigned int)work : 1) : n;
+		}
+
+		/** Run f(t) for t in [0, n) on n threads and rethrow the first failure. */
+		template <typename F>
+		void csv_parallel(unsigned int n, F f)
+		{
+			std::vector<std::exception_ptr> errors(n);
+			std::vector<std::thread> threads;
+
+			for (unsigned int t = 1; t < n; ++t)
+				threads.push_back(std::thread([&errors,&f,t]() {
+					try { f(t); } catch (...) { errors[t] = std::current_exception(); }
+				}));
+
+			try { f(0); } catch (...) { errors[0] = std::current_exception(); }
+
+			for (std::size_t t = 0; t < threads.size(); ++t)
+				threads[t].join();
+
+			for (unsigned int t = 0; t < n; ++t)
+				if (errors[t])
+					std::rethrow_exception(errors[t]);
+		}
+
+		/**
+		* Parse [begin, end) into a column major host buffer of type T.
+		* The text is split into one slice of whole lines per thread.
+		*/
+		template <typename T>
+		void parse_csv(const char * begin, const char * end, const CsvFormat & format,
+			std::vector<T> & buffer, std::size_t & rows, std::size_t & cols)
+		{
+			typedef typename CsvParseTraits<T>::parse_type F;
+			const char delimiter = format.delimiter;
+
+			if (format.header && begin < end)
+				begin = std::min(csv_line_end(begin,end) + 1,end);
+
+			// columns from the first data line
+			cols = 0;
+			for (const char * p = begin; p < end; )
+			{
+				const char * eol = csv_line_end(p,end);
+				if (!csv_blank(p,eol))
+				{
+					cols = 1;
+					for (const char * q = p; q < eol; ++q)
+						if (*q == delimiter)
+							++cols;
+					break;
+				}
+				p = eol + 1;
+			}
+
+			rows = 0;
+			if (cols == 0)
+			{
+				buffer.clear();
+				return;
+			}
+
+			unsigned int n = csv_threads(format,(end - begin)/(1 << 16) + 1);
+
+			std::vector<const char *> slice(n + 1);
+			slice[0] = begin;
+			slice[n] = end;
+			for (unsigned int t = 1; t < n; ++t)
+			{
+				const char * p = begin + (end - begin)*t/n;
+				p = p > slice[t-1] ? p : slice[t-1];
+				slice[t] = p == begin ? p : std::min(csv_line_end(p - 1,end) + 1,end);
+			}
+
+			std::vector<std::size_t> first(n + 1,0);
+
+			csv_parallel(n,[&](unsigned int t) {
+				std::size_t count = 0;
+				for (const char * p = slice[t]; p < slice[t+1]; )
+				{
+					const char * eol = csv_line_end(p,slice[t+1]);
+					if (!csv_blank(p,eol))
+						++count;
+					p = eol + 1;
+				}
+				first[t+1] = count;
+			});
+
+			for (unsigned int t = 0; t < n; ++t)
+				first[t+1] += first[t];
+			rows = first[n];
+
+			buffer.resize(rows*cols);
+			T * out = buffer.empty() ? 0 : &buffer[0];
+			const std::size_t R = rows, C = cols;
+
+			csv_parallel(n,[&](unsigned int t) {
+				std::size_t r = first[t];
+				for (const char * p = slice[t]; p < slice[t+1]; )
+				{
+					const char * eol = csv_line_end(p,slice[t+1]);
+					if (csv_blank(p,eol))
+					{
+						p = eol + 1;
+						continue;
+					}
+
+					for (std::size_t c = 0; c < C; ++c)
+					{
+						while (p < eol && csv_padding(*p,delimiter))
+							++p;
+
+						F value;
+						const char * q = csv_parse(p,eol,value);
+						if (q == 0)
+							throw std::runtime_error("Malformed CSV in data row " + std::to_string(r + 1));
+						out[c*R + r] = T(value);
+						p = q;
+
+						while (p < eol && (*p == '\r' || csv_padding(*p,delimiter)))
+							++p;
+
+						if (c + 1 < C)
+						{
+							if (p == eol || *p != delimiter)
+								throw std::runtime_error("Too Few Columns in data row " + std::to_string(r + 1));
+							++p;
+						}
+						else if (p != eol)
+							throw std::runtime_error("Too Many Columns in data row " + std::to_string(r + 1));
+					}
+
+					++r;
+					p = eol + 1;
+				}
+			});
+		}
+
+		/** Format rows [r0, r1) of a column major host buffer. */
+		template <typename T>
+		void format_csv(std::string & text, const T * data, std::size_t rows, std::size_t cols,
+			std::size_t r0, std::size_t r1, const CsvFormat & format)
+		{
+			int precision = format.precision > 0 ? format.precision : int(CsvParseTraits<T>::Digits);
+			char number[64];
+
+			text.clear();
+			text.reserve((r1 - r0)*cols*(precision + 8));
+
+			for (std::size_t r = r0; r < r1; ++r)
+			{
+				for (std::size_t c = 0; c < cols; ++c)
+				{
+					int len = std::snprintf(number,sizeof(number),"%.*g",precision,double(data[c*rows + r]));
+					text.append(number,len);
+					text += c + 1 < cols ? format.delimiter : '\n';
+				}
+			}
+		}
+	}
+
+	/** Read a delimited text file into m, sized from the file. */
+	template <typename T>
+	void read_csv(const std::string & path, Matrix<T> & m, const CsvFormat & format = CsvFormat())
+	{
+		impl::MappedFile file(path);
+		file.advise(file.data(),file.size(),MADV_SEQUENTIAL);
+
+		std::vector<T> buffer;
+		std::size_t rows, cols;
+		impl::parse_csv(file.data(),file.data() + file.size(),format,buffer,rows,cols);
+
+		m.resize(rows,cols);
+		if (!buffer.empty())
+			impl::set(m.data(),(const T *)&buffer[0],buffer.size());
+	}
+
+	/** Write m as delimited text, formatting slices of rows in parallel. */
+	template <typename T>
+	void write_csv(const std::string & path, const Matrix<T> & m, const CsvFormat & format = CsvFormat())
+	{
+		std::size_t rows = m.rows(), cols = m.cols();
+		std::vector<T> buffer(rows*cols);
+		if (!buffer.empty())
+			impl::get(&buffer[0],m.data(),buffer.size());
+
+		std::FILE * file = std::fopen(path.c_str(),"wb");
+		if (file == 0)
+			throw std::runtime_error("Cannot Open " + path);
+
+		std::string header;
+		if (format.header)
+		{
+			for (std::size_t c = 0; c < cols; ++c)
+				header += (c ? std::string(1,format.delimiter) : std::string()) + "c" + std::to_string(c);
+			header += '\n';
+		}
+
+		unsigned int n = impl::csv_threads(format,rows*cols/(1 << 14) + 1);
+		n = rows < n ? (rows > 0 ? (unsigned int)rows : 1) : n;
+
+		std::vector<std::string> text(n);
+		const T * data = buffer.empty() ? 0 : &buffer[0];
+
+		impl::csv_parallel(n,[&](unsigned int t) {
+			impl::format_csv(text[t],data,rows,cols,rows*t/n,rows*(t+1)/n,format);
+		});
+
+		bool ok = std::fwrite(header.data(),1,header.size(),file) == header.size();
+		for (unsigned int t = 0; t < n && ok; ++t)
+			ok = std::fwrite(text[t].data(),1,text[t].size(),file) == text[t].size();
+		ok = std::fclose(file) == 0 && ok;
+
+		if (!ok)
+			throw std::runtime_error("CSV Write Failed");
+	}
+}
+
+#endif
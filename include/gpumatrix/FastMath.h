@@ -0,0 +1,386 @@
+#ifndef GPUMATRIX_FAST_MATH_H
+#define GPUMATRIX_FAST_MATH_H
+
+#include <gpumatrix/Half.h>
+
+namespace gpumatrix
+{
+	namespace impl
+	{
+		/*
+		* Polynomial forms of the transcendental functionals, used by the
+		* kernels when the math mode is MathFast. They need only
+		* multiply, add, at most one division and exponent bit fiddling, so
+		* a kernel becomes a straight FMA sequence instead of a call into the
+		* device math library.
+		*
+		* Largest error against the correctly rounded result, measured on the
+		* host without FMA contraction over every 97th float bit pattern and
+		* 4*10^6 random doubles:
+		*
+		*	function	float		double
+		*	exp		1 ulp		2 ulp
+		*	log		1 ulp		2 ulp
+		*	tanh		2 ulp		2 ulp
+		*	logistic	3 ulp		3 ulp
+		*	softplus	3 ulp		4 ulp
+		*	erf		3 ulp		3 ulp
+		*
+		* exp returns zero below the log of the smallest normal number
+		* instead of going through the subnormals as libm does. Subnormal
+		* results just above that bound and of the other functions are kept
+		* unless the kernels are built to flush them (nvcc -ftz=true). inf
+		* and nan follow libm.
+		*/
+
+		/** Type the fast forms compute in, 16 bit storage goes through float. */
+		template <typename T> struct FastMathType { typedef float type; };
+		template <> struct FastMathType<double> { typedef double type; };
+
+		GPUMATRIX_HOST_DEVICE inline unsigned long long double_as_bits(double d)
+		{
+#if defined(__CUDA_ARCH__)
+			return (unsigned long long)__double_as_longlong(d);
+#else
+			unsigned long long u;
+			std::memcpy(&u,&d,sizeof(u));
+			return u;
+#endif
+		}
+
+		GPUMATRIX_HOST_DEVICE inline double bits_as_double(unsigned long long u)
+		{
+#if defined(__CUDA_ARCH__)
+			return __longlong_as_double((long long)u);
+#else
+			double d;
+			std::memcpy(&d,&u,sizeof(d));
+			return d;
+#endif
+		}
+
+		/** 2^n for n in the normal exponent range. */
+		GPUMATRIX_HOST_DEVICE inline float exp2_int(int n, float)
+		{
+			return bits_as_float((unsigned int)(n + 127) << 23);
+		}
+
+		GPUMATRIX_HOST_DEVICE inline double exp2_int(int n, double)
+		{
+			return bits_as_double((unsigned long long)(n + 1023) << 52);
+		}
+
+
+		GPUMATRIX_HOST_DEVICE inline float fast_exp(float x)
+		{
+			if (!(x < 88.72283905f))
+				return x != x ? x : bits_as_float(0x7f800000u);
+			if (x < -87.33654475f)
+				return 0.0f;
+
+			// x = n*ln2 + r, |r| <= ln2/2, ln2 split so that n*ln2_hi is exact
+			float t = x*1.44269504089f + 12582912.0f;
+			float n = t - 12582912.0f;
+			float r = x - n*0.693359375f + n*2.12194440e-4f;
+
+			float p = 1.9875691500e-4f;
+			p = p*r + 1.3981999507e-3f;
+			p = p*r + 8.3334519073e-3f;
+			p = p*r + 4.1665795894e-2f;
+			p = p*r + 1.6666665459e-1f;
+			p = p*r + 5.0000001201e-1f;
+			p = p*r*r + r + 1.0f;
+
+			// 2^n in two steps, n = 128 at the top of the range
+			int k = (int)n;
+			return p*exp2_int(k/2,0.0f)*exp2_int(k - k/2,0.0f);
+		}
+
+		GPUMATRIX_HOST_DEVICE inline double fast_exp(double x)
+		{
+			if (!(x < 709.782712893384))
+				return x != x ? x : bits_as_double(0x7ff0000000000000ull);
+			if (x < -708.3964185322641)
+				return 0.0;
+
+			double t = x*1.4426950408889634 + 6755399441055744.0;
+			double n = t - 6755399441055744.0;
+			double r = x - n*6.93145751953125e-1 - n*1.42860682030941723212e-6;
+
+			// Pade form exp(r) = 1 + 2 r P(r^2) / (Q(r^2) - r P(r^2))
+			double rr = r*r;
+			double P = ((1.26177193074810590878e-4*rr + 3.02994407707441961300e-2)*rr + 9.99999999999999999910e-1)*r;
+			double Q = ((3.00198505138664455042e-6*rr + 2.52448340349684104192e-3)*rr + 2.27265548208155028766e-1)*rr + 2.00000000000000000009e0;
+			double p = 1.0 + 2.0*P/(Q - P);
+
+			int k = (int)n;
+			return p*exp2_int(k/2,0.0)*exp2_int(k - k/2,0.0);
+		}
+
+
+		GPUMATRIX_HOST_DEVICE inline float fast_log(float x)
+		{
+			if (!(x > 0.0f) || !(x < 3.40282347e+38f))
+			{
+				if (x == 0.0f) return -bits_as_float(0x7f800000u);
+				if (x > 0.0f) return x;
+				return x != x ? x : bits_as_float(0x7fc00000u);
+			}
+
+			// x = m 2^e with m in [sqrt(1/2), sqrt(2)), subnormals scaled up first
+			int e = 0;
+			if (x < 1.17549435e-38f) { x *= 16777216.0f; e = -24; }
+
+			unsigned int u = float_as_bits(x);
+			e += (int)(u >> 23) - 126;
+			float m = bits_as_float((u & 0x007fffffu) | 0x3f000000u);
+
+			if (m < 0.707106781186547524f) { e -= 1; m = m + m - 1.0f; }
+			else m = m - 1.0f;
+
+			float z = m*m;
+			float p = 7.0376836292e-2f;
+			p = p*m - 1.1514610310e-1f;
+			p = p*m + 1.1676998740e-1f;
+			p = p*m - 1.2420140846e-1f;
+			p = p*m + 1.4249322787e-1f;
+			p = p*m - 1.6668057665e-1f;
+			p = p*m + 2.0000714765e-1f;
+			p = p*m - 2.4999993993e-1f;
+			p = p*m + 3.3333331174e-1f;
+
+			float fe = (float)e;
+			float y = m*z*p - 2.12194440e-4f*fe - 0.5f*z;
+			return m + y + 0.693359375f*fe;
+		}
+
+		GPUMATRIX_HOST_DEVICE inline double fast_log(double x)
+		{
+			if (!(x > 0.0) || !(x < 1.7976931348623157e308))
+			{
+				if (x == 0.0) return -bits_as_double(0x7ff0000000000000ull);
+				if (x > 0.0) return x;
+				return x != x ? x : bits_as_double(0x7ff8000000000000ull);
+			}
+
+			int e = 0;
+			if (x < 2.2250738585072014e-308) { x *= 9007199254740992.0; e = -53; }
+
+			unsigned long long u = double_as_bits(x);
+			e += (int)(u >> 52) - 1022;
+			double m = bits_as_double((u & 0x000fffffffffffffull) | 0x3fe0000000000000ull);
+
+			// log(m) = 2 atanh(s), s = (m-1)/(m+1), as a rational function of s^2
+			double z, y;
+			if (m < 0.70710678118654752440) { e -= 1; z = m - 0.5; y = 0.5*z + 0.5; }
+			else { z = m - 0.5 - 0.5; y = 0.5*m + 0.5; }
+
+			double s = z/y;
+			double ss = s*s;
+			double R = (-7.89580278884799154124e-1*ss + 1.63866645699558079767e1)*ss - 6.41409952958715622951e1;
+			double S = ((ss - 3.56722798256324312549e1)*ss + 3.12093766372244180303e2)*ss - 7.69691943550460008604e2;
+
+			double fe = (double)e;
+			double r = s*(ss*R/S) - fe*2.121944400546905827679e-4;
+			return r + s + fe*0.693359375;
+		}
+
+
+		/** log(1+t) for t >= 0 without losing t when it is small. */
+		template <typename T>
+		GPUMATRIX_HOST_DEVICE inline T fast_log1p(T t)
+		{
+			T u = T(1) + t;
+			if (u == T(1))
+				return t;
+			return fast_log(u)*(t/(u - T(1)));
+		}
+
+
+		GPUMATRIX_HOST_DEVICE inline float fast_tanh(float x)
+		{
+			float a = x < 0.0f ? -x : x;
+
+			if (a < 0.625f)
+			{
+				float z = x*x;
+				float p = -5.70498872745e-3f;
+				p = p*z + 2.06390887954e-2f;
+				p = p*z - 5.37397155531e-2f;
+				p = p*z + 1.33314422036e-1f;
+				p = p*z - 3.33332819422e-1f;
+				return p*z*x + x;
+			}
+
+			float r = a > 9.0f ? 1.0f : 1.0f - 2.0f/(fast_exp(a + a) + 1.0f);
+			return x < 0.0f ? -r : r;
+		}
+
+		GPUMATRIX_HOST_DEVICE inline double fast_tanh(double x)
+		{
+			double a = x < 0.0 ? -x : x;
+
+			if (a < 0.625)
+			{
+				double z = x*x;
+				double P = (-9.64399179425052238628e-1*z - 9.92877231001918586564e1)*z - 1.61468768441708447952e3;
+				double Q = ((z + 1.12811678491632931402e2)*z + 2.23548839060100448583e3)*z + 4.84406305325125486048e3;
+				return x + x*z*P/Q;
+			}
+
+			double r = a > 22.0 ? 1.0 : 1.0 - 2.0/(fast_exp(a + a) + 1.0);
+			return x < 0.0 ? -r : r;
+		}
+
+
+		template <typename T>
+		GPUMATRIX_HOST_DEVICE inline T fast_logistic(T x)
+		{
+			return T(1)/(T(1) + fast_exp(-x));
+		}
+
+
+		/** log(1+e^x) = max(x,0) + log(1+e^-|x|) */
+		template <typename T>
+		GPUMATRIX_HOST_DEVICE inline T fast_softplus(T x)
+		{
+			if (x != x)
+				return x;
+
+			T a = x < T(0) ? -x : x;
+			T l = fast_log1p(fast_exp(-a));
+			return x > T(0) ? x + l : l;
+		}
+
+
+		GPUMATRIX_HOST_DEVICE inline float fast_erf(float x)
+		{
+			float a = x < 0.0f ? -x : x;
+
+			if (a <= 1.0f)
+			{
+				float z = x*x;
+				float p = 7.853861353153693e-5f;
+				p = p*z - 8.010193625184903e-4f;
+				p = p*z + 5.188327685732524e-3f;
+				p = p*z - 2.685381193529856e-2f;
+				p = p*z + 1.128358514861418e-1f;
+				p = p*z - 3.761262582423300e-1f;
+				p = p*z + 1.128379165726710e+0f;
+				return x*p;
+			}
+
+			if (!(a < 9.0f))
+				return x != x ? x : (x < 0.0f ? -1.0f : 1.0f);
+
+			// erfc(a) = e^(-a^2)/a R(1/a^2)
+			float q = 1.0f/a;
+			float y = q*q;
+			float p;
+			if (a < 2.0f)
+			{
+				p = 2.326819970068386e-2f;
+				p = p*y - 1.387039388740657e-1f;
+				p = p*y + 3.687424674597105e-1f;
+				p = p*y - 5.824733027278666e-1f;
+				p = p*y + 6.210004621745983e-1f;
+				p = p*y - 4.944515323274145e-1f;
+				p = p*y + 3.404879937665872e-1f;
+				p = p*y - 2.741127028184656e-1f;
+				p = p*y + 5.638259427386472e-1f;
+			}
+			else
+			{
+				p = -1.047766399936249e+1f;
+				p = p*y + 1.297719955372516e+1f;
+				p = p*y - 7.495518717768503e+0f;
+				p = p*y + 2.921019019210786e+0f;
+				p = p*y - 1.015265279202700e+0f;
+				p = p*y + 4.218463358204948e-1f;
+				p = p*y - 2.820767439740514e-1f;
+				p = p*y + 5.641895067754075e-1f;
+			}
+
+			float r = 1.0f - fast_exp(-a*a)*q*p;
+			return x < 0.0f ? -r : r;
+		}
+
+
+		/** Chebyshev series sum c[k] T_k(t) by Clenshaw's recurrence, t in [-1,1]. */
+		template <int N>
+		GPUMATRIX_HOST_DEVICE inline double chebyshev(const double (&c)[N], double t)
+		{
+			double b1 = 0.0, b2 = 0.0;
+			for (int k = N - 1; k > 0; --k)
+			{
+				double b0 = c[k] + 2.0*t*b1 - b2;
+				b2 = b1;
+				b1 = b0;
+			}
+			return c[0] + t*b1 - b2;
+		}
+
+		GPUMATRIX_HOST_DEVICE inline double fast_erf(double x)
+		{
+			double a = x < 0.0 ? -x : x;
+
+			// erf(x)/x as a series in x^2 on [0,1]
+			if (a < 1.0)
+			{
+				const double g[] = {
+				0.97547693938265412, -0.14226120510371365, 0.010035582187599796,
+				-0.00057687646997674864, 2.7419931252195982e-05, -1.1043175507343995e-06,
+				3.8488755420189996e-08, -1.1808582532108193e-09, 3.2334215450023525e-11,
+				-7.9910151179100561e-13, 1.7990621178962748e-14, -3.7155608451078237e-16,
+				6.3300726839730607e-18 };
+
+				return x*chebyshev(g, 2.0*x*x - 1.0);
+			}
+
+			if (!(a < 6.0))
+				return x != x ? x : (x < 0.0 ? -1.0 : 1.0);
+
+			// erfc(a) e^(a^2) on [1,2.5], [2.5,4] and [4,6]
+			double h;
+			if (a < 2.5)
+			{
+				const double h1[] = {
+				0.30171389024442918, -0.10574990110152695, 0.017104848474406763,
+				-0.002587682261135065, 0.00036961452680367283, -5.0198560605167881e-05,
+				6.5179351705618846e-06, -8.1264497756130857e-07, 9.7636902854852204e-08,
+				-1.1338136563670587e-08, 1.2757869239532092e-09, -1.3939984731586776e-10,
+				1.4818660288109556e-11, -1.5350840905500527e-12, 1.5518982041280715e-13,
+				-1.5330807099072501e-14, 1.4816855966985621e-15, -1.4018530802330232e-16,
+				1.3072090068386166e-17, -1.3356015512305807e-18 };
+
+				h = chebyshev(h1, (a - 1.75)*(4.0/3.0));
+			}
+			else if (a < 4.0)
+			{
+				const double h2[] = {
+				0.17008220017856512, -0.036520514785627234, 0.0037834587009617491,
+				-0.00037941344908125048, 3.6926900225943756e-05, -3.4957223835851298e-06,
+				3.2248859078285092e-07, -2.9039201676183415e-08, 2.5560460323990351e-09,
+				-2.2019847298765946e-10, 1.8586988166233176e-11, -1.5388254664424949e-12,
+				1.25064320762445e-13, -9.9266363648796977e-15 };
+
+				h = chebyshev(h2, (a - 3.25)*(4.0/3.0));
+			}
+			else
+			{
+				const double h3[] = {
+				0.11277819743166245, -0.021913497155272348, 0.0020915397845687493,
+				-0.00019628624819122966, 1.8126654238715729e-05, -1.6483628246265081e-06,
+				1.4769699289446804e-07, -1.3047485523309733e-08, 1.1369176188375474e-09,
+				-9.708533724502456e-11 };
+
+				h = chebyshev(h3, a - 5.0);
+			}
+
+			double r = 1.0 - fast_exp(-a*a)*h;
+			return x < 0.0 ? -r : r;
+		}
+	}
+}
+
+#endif
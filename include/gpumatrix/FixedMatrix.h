@@ -0,0 +1,298 @@
+#ifndef GPUMATRIX_FIXED_MATRIX_H
+#define GPUMATRIX_FIXED_MATRIX_H
+
+#include <stdexcept>
+
+#include <Eigen/Core>
+
+#include <gpumatrix/Matrix.h>
+#include <gpumatrix/xpr/FixedProduct.h>
+
+namespace gpumatrix
+{
+	namespace impl
+	{
+		/** Unroll<N>::run(f) calls f(0), ..., f(N-1), the loop unrolled at
+		compile time. */
+		template <int N>
+		struct Unroll
+		{
+			template <class F> static void run(const F & f) TVMET_CXX_ALWAYS_INLINE
+			{
+				Unroll<N-1>::run(f);
+				f(N-1);
+			}
+		};
+
+		template <>
+		struct Unroll<0>
+		{
+			template <class F> static void run(const F &) TVMET_CXX_ALWAYS_INLINE { }
+		};
+	}
+
+	/**
+	* \class FixedMatrix FixedMatrix.h "gpumatrix/FixedMatrix.h"
+	* \brief A R x C matrix whose size is known at compile time, for 3x3 and
+	* 4x4 transforms and other per-sample operands too small to be worth a
+	* device allocation.
+	*
+	* The entries are stored inline and column-major on the host. Arithmetic
+	* among FixedMatrix runs on the host with every loop unrolled; a product
+	* with a dense Matrix, Map<Matrix> or XprMatrix is a matrix expression
+	* whose kernel takes the fixed factor by value, see
+	* impl/backend/FixedInterface.h.
+	*/
+	template <class T, int R, int C>
+	class FixedMatrix
+	{
+		static_assert(R > 0 && C > 0, "FixedMatrix needs positive dimensions");
+
+	public:
+		typedef T		value_type;
+
+		/** Dimensions. */
+		enum {
+			Rows = R,			/**< Number of rows. */
+			Cols = C,			/**< Number of cols. */
+			Size = R * C		/**< Complete Size of Matrix. */
+		};
+
+	public:
+		/** Default Constructor. The entries aren't cleared, as in Eigen. */
+		FixedMatrix() { }
+
+		FixedMatrix(const Eigen::Matrix<value_type,R,C> & EigenMat)
+		{
+			impl::Unroll<Size>::run([&](int i) { m_data[i] = EigenMat.data()[i]; });
+		}
+
+		/** Copy a R x C device matrix to the host. */
+		explicit FixedMatrix(const Matrix<value_type> & m)
+		{
+			if (m.rows() != R || m.cols() != C)
+				throw std::runtime_error("Dimension not Match for Fixed Matrix");
+
+			impl::get(m_data,m.data(),Size);
+		}
+
+		operator Eigen::Matrix<value_type,R,C> () const
+		{
+			Eigen::Matrix<value_type,R,C> M;
+			impl::Unroll<Size>::run([&](int i) { M.data()[i] = m_data[i]; });
+			return M;
+		}
+
+		/** Copy to a R x C device matrix. */
+		Matrix<value_type> toDevice() const
+		{
+			Matrix<value_type> m(R,C);
+			impl::set(m.data(),m_data,Size);
+			return m;
+		}
+
+	public:
+		static std::size_t rows() { return R; }
+		static std::size_t cols() { return C; }
+		static std::size_t size() { return Size; }
+
+		value_type* data() { return m_data; }
+		const value_type* data() const { return m_data; }
+
+		value_type& operator()(std::size_t i, std::size_t j)
+		{
+			TVMET_RT_CONDITION((i < R) && (j < C), "FixedMatrix Bounce Violation")
+			return m_data[i + j*R];
+		}
+
+		value_type operator()(std::size_t i, std::size_t j) const
+		{
+			TVMET_RT_CONDITION((i < R) && (j < C), "FixedMatrix Bounce Violation")
+			return m_data[i + j*R];
+		}
+
+	public:
+		static FixedMatrix Constant(value_type value)
+		{
+			FixedMatrix m;
+			impl::Unroll<Size>::run([&](int i) { m.m_data[i] = value; });
+			return m;
+		}
+
+		static FixedMatrix Zero()
+		{
+			return Constant(value_type(0));
+		}
+
+		static FixedMatrix Identity()
+		{
+			FixedMatrix m;
+			impl::Unroll<Size>::run([&](int i) { m.m_data[i] = value_type(i % R == i / R ? 1 : 0); });
+			return m;
+		}
+
+		void setZero() { *this = Zero(); }
+
+		void setIdentity() { *this = Identity(); }
+
+		FixedMatrix<value_type,C,R> transpose() const
+		{
+			FixedMatrix<value_type,C,R> t;
+			impl::Unroll<Size>::run([&](int i) { t(i / R, i % R) = m_data[i]; });
+			return t;
+		}
+
+		value_type sum() const
+		{
+			value_type s = 0;
+			impl::Unroll<Size>::run([&](int i) { s += m_data[i]; });
+			return s;
+		}
+
+		value_type squaredNorm() const
+		{
+			value_type s = 0;
+			impl::Unroll<Size>::run([&](int i) { s += m_data[i]*m_data[i]; });
+			return s;
+		}
+
+	public: // math operators
+		FixedMatrix& operator+=(const FixedMatrix & m) TVMET_CXX_ALWAYS_INLINE
+		{
+			impl::Unroll<Size>::run([&](int i) { m_data[i] += m.m_data[i]; });
+			return *this;
+		}
+
+		FixedMatrix& operator-=(const FixedMatrix & m) TVMET_CXX_ALWAYS_INLINE
+		{
+			impl::Unroll<Size>::run([&](int i) { m_data[i] -= m.m_data[i]; });
+			return *this;
+		}
+
+		template <typename POD>
+		FixedMatrix& operator*=(POD alpha) TVMET_CXX_ALWAYS_INLINE
+		{
+			impl::Unroll<Size>::run([&](int i) { m_data[i] *= (value_type)alpha; });
+			return *this;
+		}
+
+		template <typename POD>
+		FixedMatrix& operator/=(POD alpha) TVMET_CXX_ALWAYS_INLINE
+		{
+			impl::Unroll<Size>::run([&](int i) { m_data[i] /= (value_type)alpha; });
+			return *this;
+		}
+
+	public: // io
+		std::ostream& print_xpr(std::ostream& os, std::size_t l=0) const
+		{
+		  os << IndentLevel(l++) << "FixedMatrix<"
+			 << typeid(T).name() << ", " << R << ", " << C << ">,"
+			 << IndentLevel(--l)
+			 << std::endl;
+
+		  return os;
+		}
+
+	private:
+		value_type		m_data[Size];
+	};
+
+	template <class T, int R, int C>
+	inline FixedMatrix<T,R,C> operator+(FixedMatrix<T,R,C> a, const FixedMatrix<T,R,C> & b)
+	{
+		return a += b;
+	}
+
+	template <class T, int R, int C>
+	inline FixedMatrix<T,R,C> operator-(FixedMatrix<T,R,C> a, const FixedMatrix<T,R,C> & b)
+	{
+		return a -= b;
+	}
+
+	template <class T, int R, int C>
+	inline FixedMatrix<T,R,C> operator-(FixedMatrix<T,R,C> a)
+	{
+		return a *= -1;
+	}
+
+	template <class T, int R, int C>
+	inline FixedMatrix<T,R,C> operator*(FixedMatrix<T,R,C> a, typename FixedMatrix<T,R,C>::value_type alpha)
+	{
+		return a *= alpha;
+	}
+
+	template <class T, int R, int C>
+	inline FixedMatrix<T,R,C> operator*(typename FixedMatrix<T,R,C>::value_type alpha, FixedMatrix<T,R,C> a)
+	{
+		return a *= alpha;
+	}
+
+	template <class T, int R, int C>
+	inline FixedMatrix<T,R,C> operator/(FixedMatrix<T,R,C> a, typename FixedMatrix<T,R,C>::value_type alpha)
+	{
+		return a /= alpha;
+	}
+
+	// A*B among fixed sizes, on the host
+	template <class T, int R, int K, int C>
+	inline FixedMatrix<T,R,C> operator*(const FixedMatrix<T,R,K> & A, const FixedMatrix<T,K,C> & B)
+	{
+		FixedMatrix<T,R,C> P;
+		impl::Unroll<R*C>::run([&](int i) {
+			T p = 0;
+			impl::Unroll<K>::run([&](int k) { p += A(i % R, k)*B(k, i / R); });
+			P.data()[i] = p;
+		});
+		return P;
+	}
+
+	// F*M
+	template <class T, int R, int C, class X>
+	inline XprMatrix<XprFixedProduct<T, R, C, typename impl::MatrixOperand<X>::expr_type, FixedTimesDense> >
+	operator*(const FixedMatrix<T,R,C> & F, const X & M)
+	{
+		static_assert(R <= impl::FixedDeviceMaxSize && C <= impl::FixedDeviceMaxSize,
+			"products with a dense matrix are instantiated up to FixedDeviceMaxSize");
+
+		typedef typename impl::MatrixOperand<X>::expr_type					expr_type;
+		typedef XprFixedProduct<T, R, C, expr_type, FixedTimesDense>		expr_node;
+
+		return XprMatrix<expr_node>(expr_node(F, impl::MatrixOperand<X>::as_expr(M)));
+	}
+
+	// M*F
+	template <class X, class T, int R, int C>
+	inline XprMatrix<XprFixedProduct<T, R, C, typename impl::MatrixOperand<X>::expr_type, DenseTimesFixed> >
+	operator*(const X & M, const FixedMatrix<T,R,C> & F)
+	{
+		static_assert(R <= impl::FixedDeviceMaxSize && C <= impl::FixedDeviceMaxSize,
+			"products with a dense matrix are instantiated up to FixedDeviceMaxSize");
+
+		typedef typename impl::MatrixOperand<X>::expr_type					expr_type;
+		typedef XprFixedProduct<T, R, C, expr_type, DenseTimesFixed>		expr_node;
+
+		return XprMatrix<expr_node>(expr_node(F, impl::MatrixOperand<X>::as_expr(M)));
+	}
+
+	namespace impl
+	{
+		// Dest = F*M, M*F
+		template <typename T, int R, int C, typename E, int Side, typename Dest,typename Assign>
+		void eval(Dest& dest,
+			const XprFixedProduct<T,R,C,XprMatrix<E>,Side> & expr,
+			const Assign& assign_fn)
+		{
+			check_size(dest,expr.rows(),expr.cols());
+
+			typename XprMatrix<E>::result_type M = expr.dense().eval();
+
+			if (XprFixedProduct<T,R,C,XprMatrix<E>,Side>::fixed_left)
+				impl::fixed_mm_left<T,R,C>(expr.fixed().data(),M.cols(),M.data(),M.rows(),dest.data(),dest.rows());
+			else
+				impl::fixed_mm_right<T,R,C>(M.rows(),M.data(),M.rows(),expr.fixed().data(),dest.data(),dest.rows());
+		}
+	}
+}
+
+#endif
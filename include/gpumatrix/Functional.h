@@ -25,6 +25,7 @@
 #define TVMET_FUNCTIONAL_H
 
 #include <gpumatrix/TypePromotion.h>
+#include <gpumatrix/Half.h>
 
 namespace gpumatrix {
 
@@ -0,0 +1,306 @@
+#ifndef GPUMATRIX_HALF_H
+#define GPUMATRIX_HALF_H
+
+#include <algorithm>
+#include <cstring>
+#include <cstddef>
+#include <cmath>
+#include <limits>
+
+#include <gpumatrix/NumericTraits.h>
+#include <gpumatrix/TypePromotion.h>
+
+#if defined(__CUDACC__)
+#  include <cuda_fp16.h>
+#  define GPUMATRIX_HOST_DEVICE __host__ __device__
+#else
+#  define GPUMATRIX_HOST_DEVICE
+#endif
+
+#if defined(__F16C__) || (defined(__AVX512BF16__) && defined(__AVX512VL__))
+#  include <immintrin.h>
+#endif
+
+
+namespace gpumatrix
+{
+	namespace impl
+	{
+		GPUMATRIX_HOST_DEVICE inline unsigned int float_as_bits(float f)
+		{
+#if defined(__CUDA_ARCH__)
+			return __float_as_uint(f);
+#else
+			unsigned int u;
+			std::memcpy(&u,&f,sizeof(u));
+			return u;
+#endif
+		}
+
+		GPUMATRIX_HOST_DEVICE inline float bits_as_float(unsigned int u)
+		{
+#if defined(__CUDA_ARCH__)
+			return __uint_as_float(u);
+#else
+			float f;
+			std::memcpy(&f,&u,sizeof(f));
+			return f;
+#endif
+		}
+
+		/** IEEE binary16 encoding of f, rounded to nearest even. */
+		GPUMATRIX_HOST_DEVICE inline unsigned short float_to_half_bits(float f)
+		{
+#if defined(__CUDA_ARCH__)
+			return __half_as_ushort(__float2half_rn(f));
+#elif defined(__F16C__)
+			return _cvtss_sh(f, 0);
+#else
+			unsigned int x = float_as_bits(f);
+			unsigned int sign = (x >> 16) & 0x8000u;
+			unsigned int u = x & 0x7fffffffu;
+
+			// 65536.0f and up is out of range, everything from the largest
+			// finite half up to there rounds into the exponent below
+			if (u >= 0x47800000u)
+				return sign | (u > 0x7f800000u ? 0x7e00u : 0x7c00u);
+
+			if (u < 0x38800000u)
+			{
+				// subnormal or zero: let the fp adder do the rounding
+				const unsigned int magic = 0x3f000000u;
+				return sign | (float_as_bits(bits_as_float(u) + bits_as_float(magic)) - magic);
+			}
+
+			unsigned int odd = (u >> 13) & 1u;
+			u += 0xc8000fffu + odd;
+			return sign | (u >> 13);
+#endif
+		}
+
+		GPUMATRIX_HOST_DEVICE inline float half_bits_to_float(unsigned short h)
+		{
+#if defined(__CUDA_ARCH__)
+			return __half2float(__ushort_as_half(h));
+#elif defined(__F16C__)
+			return _cvtsh_ss(h);
+#else
+			const unsigned int shifted_exp = 0x7c00u << 13;
+			unsigned int o = (h & 0x7fffu) << 13;
+			unsigned int exp = o & shifted_exp;
+
+			o += (127 - 15) << 23;
+			if (exp == shifted_exp)
+				o += (128 - 16) << 23;
+			else if (exp == 0)
+				o = float_as_bits(bits_as_float(o + (1u << 23)) - bits_as_float(113u << 23));
+
+			return bits_as_float(o | ((h & 0x8000u) << 16));
+#endif
+		}
+
+		/** bfloat16 encoding of f (the upper half of the float), rounded to nearest even.
+		The AVX-512 BF16 instruction flushes float subnormals to zero, which
+		is below bfloat16 resolution for anything but denormal inputs. */
+		GPUMATRIX_HOST_DEVICE inline unsigned short float_to_bfloat16_bits(float f)
+		{
+#if !defined(__CUDA_ARCH__) && defined(__AVX512BF16__) && defined(__AVX512VL__)
+			__m128bh r = _mm_cvtneps_pbh(_mm_set_ss(f));
+			return (unsigned short)_mm_extract_epi16((__m128i)r, 0);
+#else
+			unsigned int x = float_as_bits(f);
+
+			if ((x & 0x7fffffffu) > 0x7f800000u)
+				return (unsigned short)((x >> 16) | 0x40u);
+
+			return (unsigned short)((x + 0x7fffu + ((x >> 16) & 1u)) >> 16);
+#endif
+		}
+
+		GPUMATRIX_HOST_DEVICE inline float bfloat16_bits_to_float(unsigned short b)
+		{
+			return bits_as_float((unsigned int)b << 16);
+		}
+	}
+
+
+	/**
+	* \class half Half.h "gpumatrix/Half.h"
+	* \brief IEEE 754 binary16 storage type.
+	*
+	* Only the storage is 16 bit. Every operation converts to float, computes
+	* in float and rounds the result back on store, on the host as well as
+	* inside the device kernels.
+	*/
+	struct half
+	{
+		unsigned short bits;
+
+		GPUMATRIX_HOST_DEVICE half() {}
+
+		GPUMATRIX_HOST_DEVICE half(float f):bits(impl::float_to_half_bits(f)) {}
+
+		GPUMATRIX_HOST_DEVICE operator float() const { return impl::half_bits_to_float(bits); }
+
+		GPUMATRIX_HOST_DEVICE half & operator+=(float rhs) { return *this = half(float(*this) + rhs); }
+		GPUMATRIX_HOST_DEVICE half & operator-=(float rhs) { return *this = half(float(*this) - rhs); }
+		GPUMATRIX_HOST_DEVICE half & operator*=(float rhs) { return *this = half(float(*this) * rhs); }
+		GPUMATRIX_HOST_DEVICE half & operator/=(float rhs) { return *this = half(float(*this) / rhs); }
+	};
+
+
+	/**
+	* \class bfloat16 Half.h "gpumatrix/Half.h"
+	* \brief Brain floating point storage type, float with a 7 bit mantissa.
+	*
+	* Same range as float, so it is the safer choice for values that would
+	* overflow half. Computation happens in float as for half.
+	*/
+	struct bfloat16
+	{
+		unsigned short bits;
+
+		GPUMATRIX_HOST_DEVICE bfloat16() {}
+
+		GPUMATRIX_HOST_DEVICE bfloat16(float f):bits(impl::float_to_bfloat16_bits(f)) {}
+
+		GPUMATRIX_HOST_DEVICE operator float() const { return impl::bfloat16_bits_to_float(bits); }
+
+		GPUMATRIX_HOST_DEVICE bfloat16 & operator+=(float rhs) { return *this = bfloat16(float(*this) + rhs); }
+		GPUMATRIX_HOST_DEVICE bfloat16 & operator-=(float rhs) { return *this = bfloat16(float(*this) - rhs); }
+		GPUMATRIX_HOST_DEVICE bfloat16 & operator*=(float rhs) { return *this = bfloat16(float(*this) * rhs); }
+		GPUMATRIX_HOST_DEVICE bfloat16 & operator/=(float rhs) { return *this = bfloat16(float(*this) / rhs); }
+	};
+
+
+	namespace impl
+	{
+		/** Host side bulk conversion, used when uploading to or downloading
+		from a 16 bit matrix. */
+		template <typename T, typename S> inline void convert(T * odata, const S * idata, std::size_t size)
+		{
+			for (std::size_t i = 0; i < size; ++i)
+				odata[i] = T(float(idata[i]));
+		}
+
+		template <> inline void convert<half,float>(half * odata, const float * idata, std::size_t size)
+		{
+			std::size_t i = 0;
+#if defined(__F16C__)
+			for (; i + 8 <= size; i += 8)
+				_mm_storeu_si128((__m128i *)(odata + i), _mm256_cvtps_ph(_mm256_loadu_ps(idata + i), 0));
+#endif
+			for (; i < size; ++i)
+				odata[i] = half(idata[i]);
+		}
+
+		template <> inline void convert<float,half>(float * odata, const half * idata, std::size_t size)
+		{
+			std::size_t i = 0;
+#if defined(__F16C__)
+			for (; i + 8 <= size; i += 8)
+				_mm256_storeu_ps(odata + i, _mm256_cvtph_ps(_mm_loadu_si128((const __m128i *)(idata + i))));
+#endif
+			for (; i < size; ++i)
+				odata[i] = idata[i];
+		}
+
+		template <> inline void convert<bfloat16,float>(bfloat16 * odata, const float * idata, std::size_t size)
+		{
+			std::size_t i = 0;
+#if defined(__AVX512BF16__) && defined(__AVX512VL__)
+			for (; i + 16 <= size; i += 16)
+				_mm256_storeu_si256((__m256i *)(odata + i), (__m256i)_mm512_cvtneps_pbh(_mm512_loadu_ps(idata + i)));
+#endif
+			for (; i < size; ++i)
+				odata[i] = bfloat16(idata[i]);
+		}
+
+		template <> inline void convert<float,bfloat16>(float * odata, const bfloat16 * idata, std::size_t size)
+		{
+			for (std::size_t i = 0; i < size; ++i)
+				odata[i] = idata[i];
+		}
+	}
+
+
+	/*
+	* PrecisionTraits rank the 16 bit types below float, so mixing them with
+	* float or double promotes to the wider type. half against bfloat16 has
+	* no lossless common 16 bit type and goes to float.
+	*/
+	template<> struct PrecisionTraits<half> { enum { rank = 650, known = 1 }; };
+	template<> struct PrecisionTraits<bfloat16> { enum { rank = 640, known = 1 }; };
+
+	template<> class PromoteTraits<half,bfloat16> { public: typedef float value_type; };
+	template<> class PromoteTraits<bfloat16,half> { public: typedef float value_type; };
+
+
+#define GPUMATRIX_16BIT_NUMERIC_TRAITS(T)					\
+	template<>												\
+	struct NumericTraits<T> {								\
+	  typedef T 					value_type;			\
+	  typedef float 				base_type;			\
+	  typedef float 				sum_type;			\
+	  typedef float 				diff_type;			\
+	  typedef float 				float_type;			\
+	  typedef float 				signed_type;		\
+															\
+	  typedef NumericTraits<value_type>		traits_type;	\
+	  typedef value_type				argument_type;		\
+															\
+	  static inline											\
+	  base_type real(argument_type x) { return x; }			\
+															\
+	  static inline											\
+	  base_type imag(argument_type) { return 0; }			\
+															\
+	  static inline											\
+	  value_type conj(argument_type x) { return x; }		\
+															\
+	  static inline											\
+	  base_type abs(argument_type x) { return std::abs(float(x)); }	\
+															\
+	  static inline											\
+	  value_type sqrt(argument_type x) { return std::sqrt(float(x)); }	\
+															\
+	  static inline											\
+	  base_type norm_1(argument_type x) { return traits_type::abs(x); }	\
+															\
+	  static inline											\
+	  base_type norm_2(argument_type x) { return traits_type::abs(x); }	\
+															\
+	  static inline											\
+	  base_type norm_inf(argument_type x) { return traits_type::abs(x); }	\
+															\
+	  static inline											\
+	  bool equals(argument_type lhs, argument_type rhs) {	\
+	    static base_type sqrt_epsilon(						\
+	      NumericTraits<base_type>::sqrt(					\
+	        std::numeric_limits<base_type>::epsilon()));	\
+															\
+	    return traits_type::norm_inf(float(lhs) - float(rhs)) < sqrt_epsilon *	\
+	      std::max(std::max(traits_type::norm_inf(lhs),	\
+				traits_type::norm_inf(rhs)),				\
+		       std::numeric_limits<base_type>::min());		\
+	  }														\
+															\
+	  enum { is_complex = false };							\
+															\
+	  enum {												\
+	    ops_plus = 1,										\
+	    ops_muls = 1										\
+	  };													\
+	};
+
+	GPUMATRIX_16BIT_NUMERIC_TRAITS(half)
+	GPUMATRIX_16BIT_NUMERIC_TRAITS(bfloat16)
+
+#undef GPUMATRIX_16BIT_NUMERIC_TRAITS
+
+	/** \class NumericTraits<half> Half.h "gpumatrix/Half.h" */
+	/** \class NumericTraits<bfloat16> Half.h "gpumatrix/Half.h" */
+}
+
+
+#endif
@@ -0,0 +1,102 @@
+#ifndef GPUMATRIX_KERNEL_MATRIX_H
+#define GPUMATRIX_KERNEL_MATRIX_H
+
+#include <stdexcept>
+
+#include <gpumatrix/Matrix.h>
+#include <gpumatrix/Vector.h>
+
+namespace gpumatrix
+{
+	enum KernelType
+	{
+		LinearKernel = 0,		/**< x^T y */
+		PolynomialKernel = 1,	/**< (gamma x^T y + coef0)^degree */
+		RbfKernel = 2			/**< exp(-gamma |x - y|^2) */
+	};
+
+	/**
+	* \class Kernel KernelMatrix.h "gpumatrix/KernelMatrix.h"
+	* \brief The kernel function k(x,y) of kernelMatrix().
+	*/
+	template <class T>
+	struct Kernel
+	{
+		KernelType	type;
+		T			gamma;
+		T			coef0;
+		int			degree;
+
+		static Kernel Linear()
+		{
+			Kernel k = { LinearKernel, T(1), T(0), 1 };
+			return k;
+		}
+
+		static Kernel Polynomial(T gamma, T coef0, int degree)
+		{
+			if (degree < 0)
+				throw std::runtime_error("Negative Degree for Polynomial Kernel");
+
+			Kernel k = { PolynomialKernel, gamma, coef0, degree };
+			return k;
+		}
+
+		static Kernel Rbf(T gamma)
+		{
+			Kernel k = { RbfKernel, gamma, T(0), 1 };
+			return k;
+		}
+	};
+
+	/** K(i,j) = k(X.col(i), Y.col(j)), the samples being the columns of X
+	and Y. K is computed as X^T*Y by impl::gemm, by impl::syrk when X and Y
+	are the same matrix, and the squared norms and the kernel function are
+	then applied to it in place, so K is the only m x n matrix allocated. */
+	template <class T>
+	Matrix<T> kernelMatrix(const Matrix<T> & X, const Matrix<T> & Y, const Kernel<T> & kernel)
+	{
+		if (X.rows() != Y.rows())
+			throw std::runtime_error("Dimension not Match for Kernel Matrix");
+
+		int d = X.rows(), m = X.cols(), n = Y.cols();
+		bool same = X.data() == Y.data() && m == n;
+
+		Matrix<T> K(m,n);
+		if (m == 0 || n == 0)
+			return K;
+
+		if (same)
+		{
+			impl::syrk('L','T',m,d,T(1),X.data(),d,T(0),K.data(),m);
+			impl::symmetrize('L',m,K.data(),m);
+		}
+		else
+			impl::gemm('T','N',m,n,d,T(1),X.data(),d,Y.data(),d,T(0),K.data(),m);
+
+		if (kernel.type == RbfKernel)
+		{
+			Vector<T> xnorm(m), ynorm(same ? 0 : n);
+			impl::column_squared_norms(d,m,X.data(),d,xnorm.data());
+			if (!same)
+				impl::column_squared_norms(d,n,Y.data(),d,ynorm.data());
+
+			impl::kernel_epilogue(int(kernel.type),m,n,kernel.gamma,kernel.coef0,kernel.degree,
+				xnorm.data(),same ? xnorm.data() : ynorm.data(),K.data(),m);
+		}
+		else
+			impl::kernel_epilogue(int(kernel.type),m,n,kernel.gamma,kernel.coef0,kernel.degree,
+				(const T *)0,(const T *)0,K.data(),m);
+
+		return K;
+	}
+
+	/** The Gram matrix of the columns of X under k. */
+	template <class T>
+	Matrix<T> kernelMatrix(const Matrix<T> & X, const Kernel<T> & kernel)
+	{
+		return kernelMatrix(X,X,kernel);
+	}
+}
+
+#endif
@@ -265,6 +265,16 @@ namespace gpumatrix {
 			return XprArray<ConstReference,D>(this->const_ref());
 		}
 
+		RowWiseView<XprArray<ConstReference,D>,true> rowwise() const
+		{
+			return RowWiseView<XprArray<ConstReference,D>,true>(this->as_expr());
+		}
+
+		ColWiseView<XprArray<ConstReference,D>,true> colwise() const
+		{
+			return ColWiseView<XprArray<ConstReference,D>,true>(this->as_expr());
+		}
+
 	private:
 		///** Wrapper for meta assign. */
 		//template<class Dest, class Src, class Assign>
@@ -426,7 +436,7 @@ namespace gpumatrix {
 		  XprUnOp<
 			Fcnl_exp<value_type>,
 			XprArray<ArrayConstReference<value_type,D>,D>
-		  >,D>  exp()
+		  >,D>  exp() const
 		{
 			typedef  XprUnOp<Fcnl_exp<value_type>,XprArray<ArrayConstReference<value_type,D>,D>> op_type;
 			return 	XprArray< op_type,D>(op_type(this->as_expr()));
@@ -436,7 +446,7 @@ namespace gpumatrix {
 		  XprUnOp<
 			Fcnl_log<value_type>,
 			XprArray<ArrayConstReference<value_type,D>,D>
-		  >,D>  log()
+		  >,D>  log() const
 		{
 			typedef  XprUnOp<Fcnl_log<value_type>,XprArray<ArrayConstReference<value_type,D>,D>> op_type;
 			return 	XprArray< op_type,D>(op_type(this->as_expr()));
@@ -446,7 +456,7 @@ namespace gpumatrix {
 		  XprUnOp<
 			Fcnl_logistic<value_type>,
 			XprArray<ArrayConstReference<value_type,D>,D>
-		  >,D>  logistic()
+		  >,D>  logistic() const
 		{
 			typedef XprUnOp<Fcnl_logistic<value_type>,XprArray<ArrayConstReference<value_type,D>,D>> op_type;
 			return 	XprArray< op_type,D>(op_type(this->as_expr()));
@@ -454,7 +464,7 @@ namespace gpumatrix {
 
 		void setZero()
 		{
-			cudaMemset(m_data, 0,size()*sizeof(value_type));
+			impl::zero(m_data, size());
 		}
 
 
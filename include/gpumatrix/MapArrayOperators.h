@@ -213,6 +213,138 @@ TVMET_DECLARE_MACRO(div, /, long double)
 #undef TVMET_DECLARE_MACRO
 
 
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ * Matrix compare and logical operators, the result is a
+ * bool mask
+ *+++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+
+/*
+ * operator(Map<Array<T1,D>>, Map<Array<T2,D>>)
+ * operator(Map<Array<T1,D>>, Array<T2,D>)
+ * operator(Array<T1,D>, Map<Array<T2,D>>)
+ * operator(XprArray<E,D>, Map<Array<T,D>>)
+ * operator(Map<Array<T,D>>, XprArray<E,D>)
+ * Note: operations are per se element wise
+ */
+#define TVMET_DECLARE_MACRO(NAME, OP)						\
+template<class T1, class T2, int D>		\
+XprArray<									\
+  XprBinOp<									\
+    Fcnl_##NAME<T1, T2>,							\
+    XprArray<ArrayConstReference<T1,D>,D>,					\
+    XprArray<ArrayConstReference<T2,D>,D>					\
+  >	,D							\
+>										\
+operator OP (const Map<Array<T1,D>>& lhs,					\
+	     const Map<Array<T2,D>>& rhs) TVMET_CXX_ALWAYS_INLINE;	\
+template<class T1, class T2, int D>		\
+XprArray<									\
+  XprBinOp<									\
+    Fcnl_##NAME<T1, T2>,							\
+    XprArray<ArrayConstReference<T1,D>,D>,					\
+    XprArray<ArrayConstReference<T2,D>,D>					\
+  >	,D							\
+>										\
+operator OP (const Map<Array<T1,D>>& lhs,					\
+	     const Array<T2,D>& rhs) TVMET_CXX_ALWAYS_INLINE;	\
+template<class T1, class T2, int D>		\
+XprArray<									\
+  XprBinOp<									\
+    Fcnl_##NAME<T1, T2>,							\
+    XprArray<ArrayConstReference<T1,D>,D>,					\
+    XprArray<ArrayConstReference<T2,D>,D>					\
+  >	,D							\
+>										\
+operator OP (const Array<T1,D>& lhs,					\
+	     const Map<Array<T2,D>>& rhs) TVMET_CXX_ALWAYS_INLINE;	\
+										\
+template<class E, class T, int D>			\
+XprArray<									\
+  XprBinOp<									\
+    Fcnl_##NAME<typename E::value_type, T>,					\
+    XprArray<E,D>,							\
+    XprArray<ArrayConstReference<T,D>,D>						\
+  >	,D										\
+>										\
+operator OP (const XprArray<E,D>& lhs, 				\
+	     const Map<Array<T,D>>& rhs) TVMET_CXX_ALWAYS_INLINE;		\
+										\
+template<class T, class E, int D>			\
+XprArray<									\
+  XprBinOp<									\
+    Fcnl_##NAME<T, typename E::value_type>,					\
+    XprArray<ArrayConstReference<T,D>,D>,					\
+    XprArray<E,D>							\
+  >	,D										\
+>										\
+operator OP (const Map<Array<T,D>>& lhs, 					\
+	     const XprArray<E,D>& rhs) TVMET_CXX_ALWAYS_INLINE;
+
+TVMET_DECLARE_MACRO(greater, >)
+TVMET_DECLARE_MACRO(less, <)
+TVMET_DECLARE_MACRO(greater_eq, >=)
+TVMET_DECLARE_MACRO(less_eq, <=)
+TVMET_DECLARE_MACRO(eq, ==)
+TVMET_DECLARE_MACRO(not_eq, !=)
+TVMET_DECLARE_MACRO(and, &&)
+TVMET_DECLARE_MACRO(or, ||)
+
+#undef TVMET_DECLARE_MACRO
+
+
+/*
+ * operator(Map<Array<T,D>>, POD)
+ * operator(POD, Map<Array<T,D>>)
+ * Note: operations are per se element wise
+ */
+#define TVMET_DECLARE_MACRO(NAME, OP, TP)				\
+template<class T, int D>			\
+XprArray<								\
+  XprBinOp<								\
+    Fcnl_##NAME<T, TP >,						\
+    XprArray<ArrayConstReference<T,D>,D>,				\
+    XprLiteral<TP >							\
+  >		,D											\
+>									\
+operator OP (const Map<Array<T,D>>& lhs, 				\
+	     TP rhs) TVMET_CXX_ALWAYS_INLINE;				\
+									\
+template<class T, int D>			\
+XprArray<								\
+  XprBinOp<								\
+    Fcnl_##NAME< TP, T>,						\
+    XprLiteral< TP >,							\
+    XprArray<ArrayConstReference<T,D>,D>					\
+  >		,D				\
+>									\
+operator OP (TP lhs, 							\
+	     const Map<Array<T,D>>& rhs) TVMET_CXX_ALWAYS_INLINE;
+
+TVMET_DECLARE_MACRO(greater, >, int)
+TVMET_DECLARE_MACRO(less, <, int)
+TVMET_DECLARE_MACRO(greater_eq, >=, int)
+TVMET_DECLARE_MACRO(less_eq, <=, int)
+TVMET_DECLARE_MACRO(eq, ==, int)
+TVMET_DECLARE_MACRO(not_eq, !=, int)
+
+TVMET_DECLARE_MACRO(greater, >, float)
+TVMET_DECLARE_MACRO(less, <, float)
+TVMET_DECLARE_MACRO(greater_eq, >=, float)
+TVMET_DECLARE_MACRO(less_eq, <=, float)
+TVMET_DECLARE_MACRO(eq, ==, float)
+TVMET_DECLARE_MACRO(not_eq, !=, float)
+
+TVMET_DECLARE_MACRO(greater, >, double)
+TVMET_DECLARE_MACRO(less, <, double)
+TVMET_DECLARE_MACRO(greater_eq, >=, double)
+TVMET_DECLARE_MACRO(less_eq, <=, double)
+TVMET_DECLARE_MACRO(eq, ==, double)
+TVMET_DECLARE_MACRO(not_eq, !=, double)
+
+#undef TVMET_DECLARE_MACRO
+
+
 #if defined(TVMET_HAVE_COMPLEX)
 /*
  * operator(Array<T,D>, complex<T>)
@@ -472,6 +604,189 @@ TVMET_IMPLEMENT_MACRO(div, /, long double)
 #undef TVMET_IMPLEMENT_MACRO
 
 
+/*++++++++++++++++++++++++++++++++++++++++++++++++++++++++
+ * Matrix compare and logical operators, the result is a
+ * bool mask
+ *+++++++++++++++++++++++++++++++++++++++++++++++++++++++*/
+
+
+/*
+ * operator(Map<Array<T1,D>>, Map<Array<T2,D>>)
+ * operator(Map<Array<T1,D>>, Array<T2,D>)
+ * operator(Array<T1,D>, Map<Array<T2,D>>)
+ * operator(XprArray<E,D>, Map<Array<T,D>>)
+ * operator(Map<Array<T,D>>, XprArray<E,D>)
+ * Note: operations are per se element wise
+ */
+#define TVMET_IMPLEMENT_MACRO(NAME, OP)						      \
+template<class T1, class T2, int D>		      \
+inline										      \
+XprArray<									      \
+  XprBinOp<									      \
+    Fcnl_##NAME<T1, T2>,							      \
+    XprArray<ArrayConstReference<T1,D>,D>,					      \
+    XprArray<ArrayConstReference<T2,D>,D>					      \
+  >		,D								      \
+>										      \
+operator OP (const Map<Array<T1,D>> & lhs,	const Map<Array<T2,D>> & rhs) {  \
+  typedef XprBinOp <									\
+    Fcnl_##NAME<T1, T2>,								\
+    XprArray<ArrayConstReference<T1,D>,D>,						\
+    XprArray<ArrayConstReference<T2,D>,D>						\
+  >							expr_type;			\
+  return XprArray<expr_type,D>(expr_type(lhs.as_expr(), rhs.as_expr()));	\
+}										      \
+template<class T1, class T2, int D>		      \
+inline										      \
+XprArray<									      \
+  XprBinOp<									      \
+    Fcnl_##NAME<T1, T2>,							      \
+    XprArray<ArrayConstReference<T1,D>,D>,					      \
+    XprArray<ArrayConstReference<T2,D>,D>					      \
+  >		,D								      \
+>										      \
+operator OP (const Map<Array<T1,D>> & lhs,	const Array<T2,D>& rhs) {  \
+  typedef XprBinOp <									\
+    Fcnl_##NAME<T1, T2>,								\
+    XprArray<ArrayConstReference<T1,D>,D>,						\
+    XprArray<ArrayConstReference<T2,D>,D>						\
+  >							expr_type;			\
+  return XprArray<expr_type,D>(expr_type(lhs.as_expr(), rhs.as_expr()));	\
+}										      \
+template<class T1, class T2, int D>		      \
+inline										      \
+XprArray<									      \
+  XprBinOp<									      \
+    Fcnl_##NAME<T1, T2>,							      \
+    XprArray<ArrayConstReference<T1,D>,D>,					      \
+    XprArray<ArrayConstReference<T2,D>,D>					      \
+  >		,D								      \
+>										      \
+operator OP (const Array<T1,D>& lhs,	const Map<Array<T2,D>> & rhs) {  \
+  typedef XprBinOp <									\
+    Fcnl_##NAME<T1, T2>,								\
+    XprArray<ArrayConstReference<T1,D>,D>,						\
+    XprArray<ArrayConstReference<T2,D>,D>						\
+  >							expr_type;			\
+  return XprArray<expr_type,D>(expr_type(lhs.as_expr(), rhs.as_expr()));	\
+}										      \
+										      \
+template<class E, class T, int D>			      \
+inline										      \
+XprArray<									      \
+  XprBinOp<									      \
+    Fcnl_##NAME<typename E::value_type, T>,					      \
+    XprArray<E,D>,							      \
+    XprArray<ArrayConstReference<T,D>,D>						      \
+  >	,D									      \
+>										      \
+operator OP (const XprArray<E,D>& lhs, const Map<Array<T,D>> & rhs) { \
+  typedef XprBinOp<									\
+    Fcnl_##NAME<typename E::value_type, T>,						\
+    XprArray<E,D>,								\
+    XprArray<ArrayConstReference<T,D>,D>							\
+  > 							 expr_type;			\
+  return XprArray<expr_type,D>(expr_type(lhs, rhs.as_expr()));		\
+}										      \
+										      \
+template<class T, class E, int D>			      \
+inline										      \
+XprArray<									      \
+  XprBinOp<									      \
+    Fcnl_##NAME<T, typename E::value_type>,					      \
+    XprArray<ArrayConstReference<T,D>,D>,					      \
+    XprArray<E,D>							      \
+  >		,D								      \
+>										      \
+operator OP (const Map<Array<T,D>>& lhs, const XprArray<E,D>& rhs) { \
+  typedef XprBinOp<									\
+    Fcnl_##NAME<T, typename E::value_type>,						\
+    XprArray<ArrayConstReference<T,D>,D>,						\
+    XprArray<E,D>								\
+  >	 						 expr_type;			\
+  return XprArray<expr_type,D>(expr_type(lhs.as_expr(), rhs));		\
+}
+
+TVMET_IMPLEMENT_MACRO(greater, >)
+TVMET_IMPLEMENT_MACRO(less, <)
+TVMET_IMPLEMENT_MACRO(greater_eq, >=)
+TVMET_IMPLEMENT_MACRO(less_eq, <=)
+TVMET_IMPLEMENT_MACRO(eq, ==)
+TVMET_IMPLEMENT_MACRO(not_eq, !=)
+TVMET_IMPLEMENT_MACRO(and, &&)
+TVMET_IMPLEMENT_MACRO(or, ||)
+
+#undef TVMET_IMPLEMENT_MACRO
+
+
+/*
+ * operator(Map<Array<T,D>>, POD)
+ * operator(POD, Map<Array<T,D>>)
+ * Note: operations are per se element wise
+ */
+#define TVMET_IMPLEMENT_MACRO(NAME, OP, TP)			\
+template<class T, int D>		\
+inline								\
+XprArray<							\
+  XprBinOp<							\
+    Fcnl_##NAME<T, TP >,					\
+    XprArray<ArrayConstReference<T,D>,D>,			\
+    XprLiteral<TP >						\
+  >	,D								\
+>								\
+operator OP (const Map<Array<T,D>>& lhs, TP rhs) {	\
+  typedef XprBinOp<						\
+    Fcnl_##NAME<T, TP >,					\
+    XprArray<ArrayConstReference<T,D>,D>,			\
+    XprLiteral<TP >						\
+  >							expr_type;	\
+  return XprArray<expr_type,D>(					\
+    expr_type(lhs.as_expr(), XprLiteral< TP >(rhs)));		\
+}								\
+								\
+template<class T, int D>		\
+inline								\
+XprArray<							\
+  XprBinOp<							\
+    Fcnl_##NAME< TP, T>,					\
+    XprLiteral< TP >,						\
+    XprArray<ArrayConstReference<T,D>,D>				\
+  >		,D							\
+>								\
+operator OP (TP lhs, const Map<Array<T,D>>& rhs) {	\
+  typedef XprBinOp<						\
+    Fcnl_##NAME< TP, T>,					\
+    XprLiteral< TP >,						\
+    XprArray<ArrayConstReference<T,D>,D>				\
+  >							expr_type;	\
+  return XprArray<expr_type,D>(					\
+    expr_type(XprLiteral< TP >(lhs), rhs.as_expr()));		\
+}
+
+TVMET_IMPLEMENT_MACRO(greater, >, int)
+TVMET_IMPLEMENT_MACRO(less, <, int)
+TVMET_IMPLEMENT_MACRO(greater_eq, >=, int)
+TVMET_IMPLEMENT_MACRO(less_eq, <=, int)
+TVMET_IMPLEMENT_MACRO(eq, ==, int)
+TVMET_IMPLEMENT_MACRO(not_eq, !=, int)
+
+TVMET_IMPLEMENT_MACRO(greater, >, float)
+TVMET_IMPLEMENT_MACRO(less, <, float)
+TVMET_IMPLEMENT_MACRO(greater_eq, >=, float)
+TVMET_IMPLEMENT_MACRO(less_eq, <=, float)
+TVMET_IMPLEMENT_MACRO(eq, ==, float)
+TVMET_IMPLEMENT_MACRO(not_eq, !=, float)
+
+TVMET_IMPLEMENT_MACRO(greater, >, double)
+TVMET_IMPLEMENT_MACRO(less, <, double)
+TVMET_IMPLEMENT_MACRO(greater_eq, >=, double)
+TVMET_IMPLEMENT_MACRO(less_eq, <=, double)
+TVMET_IMPLEMENT_MACRO(eq, ==, double)
+TVMET_IMPLEMENT_MACRO(not_eq, !=, double)
+
+#undef TVMET_IMPLEMENT_MACRO
+
+
 #if defined(TVMET_HAVE_COMPLEX)
 /*
  * operator(Array<T,D>, complex<T>)
@@ -213,12 +213,12 @@ namespace gpumatrix {
 		//  }
 
 
-		operator Eigen::Matrix<T,Eigen::Dynamic,Eigen::Dynamic> ()
+		operator Eigen::Matrix<T,Eigen::Dynamic,Eigen::Dynamic> () const
 		{
 
 			Eigen::Matrix<T,Eigen::Dynamic,Eigen::Dynamic> M(Rows,Cols);
 
-			cublasGetVector (Rows*Cols, sizeof(value_type), m_data,1, M.data(), 1);
+			impl::get(M.data(), m_data, Rows*Cols);
 
 			return M;
 		}
@@ -264,6 +264,16 @@ namespace gpumatrix {
 			return XprMatrix<ConstReference>(this->const_ref());
 		}
 
+		RowWiseView<XprMatrix<ConstReference>,true> rowwise() const
+		{
+			return RowWiseView<XprMatrix<ConstReference>,true>(this->as_expr());
+		}
+
+		ColWiseView<XprMatrix<ConstReference>,true> colwise() const
+		{
+			return ColWiseView<XprMatrix<ConstReference>,true>(this->as_expr());
+		}
+
 	private:
 		///** Wrapper for meta assign. */
 		//template<class Dest, class Src, class Assign>
@@ -388,7 +398,7 @@ namespace gpumatrix {
 
 	void setZero()
 	{
-		cudaMemset(m_data, 0,size()*sizeof(value_type));
+		impl::zero(m_data, size());
 	}
 
 	NoAliasProxy<Map<Matrix<T>>> noalias()
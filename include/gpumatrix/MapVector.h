@@ -304,19 +304,19 @@ namespace gpumatrix {
 			return *this;
 		}
 
-		operator Eigen::Matrix<T,Eigen::Dynamic,1> ()
+		operator Eigen::Matrix<T,Eigen::Dynamic,1> () const
 		{
 
 			Eigen::Matrix<T,Eigen::Dynamic,1> M(Size);
 
-			cublasGetVector (Size, sizeof(value_type), m_data,1, M.data(), 1);
+			impl::get(M.data(), m_data, Size);
 
 			return M;
 		}
 
 		void setZero()
 		{
-			cudaMemset(m_data, 0,size()*sizeof(value_type));
+			impl::zero(m_data, size());
 		}
 
 		NoAliasProxy<Map<Vector<T>>> noalias()
@@ -0,0 +1,85 @@
+#ifndef GPUMATRIX_MAPPED_FILE_H
+#define GPUMATRIX_MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace gpumatrix
+{
+	namespace impl
+	{
+		/**
+		* \class MappedFile MappedFile.h "gpumatrix/MappedFile.h"
+		* \brief A whole file mapped read only. An empty file maps to no data.
+		*/
+		class MappedFile
+		{
+			MappedFile(const MappedFile&);
+			MappedFile& operator=(const MappedFile&);
+
+		public:
+			explicit MappedFile(const std::string & path)
+				: m_data(0), m_size(0)
+			{
+				int fd = ::open(path.c_str(),O_RDONLY);
+				if (fd < 0)
+					throw std::runtime_error("Cannot Open " + path);
+
+				struct stat st;
+				if (::fstat(fd,&st) != 0)
+				{
+					::close(fd);
+					throw std::runtime_error("Cannot Open " + path);
+				}
+
+				m_size = st.st_size;
+
+				if (m_size > 0)
+				{
+					void * data = ::mmap(0,m_size,PROT_READ,MAP_SHARED,fd,0);
+					if (data == MAP_FAILED)
+					{
+						::close(fd);
+						throw std::runtime_error("Cannot Map " + path);
+					}
+					m_data = (const char *)data;
+				}
+
+				::close(fd);
+			}
+
+			~MappedFile()
+			{
+				if (m_data)
+					::munmap((void *)m_data,m_size);
+			}
+
+			const char * data() const { return m_data; }
+
+			std::size_t size() const { return m_size; }
+
+			/** madvise over the whole pages inside [p, p+bytes). */
+			void advise(const void * p, std::size_t bytes, int advice) const
+			{
+				std::size_t page = (std::size_t)::sysconf(_SC_PAGESIZE);
+				std::size_t begin = ((std::size_t)p + page - 1)/page*page;
+				std::size_t end = ((std::size_t)p + bytes)/page*page;
+
+				if (end > begin)
+					::madvise((void *)begin,end - begin,advice);
+			}
+
+		private:
+			const char *				m_data;
+			std::size_t					m_size;
+		};
+	}
+}
+
+#endif
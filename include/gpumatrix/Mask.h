@@ -0,0 +1,183 @@
+#ifndef GPUMATRIX_MASK_H
+#define GPUMATRIX_MASK_H
+
+#include <gpumatrix/xpr/Select.h>
+
+namespace gpumatrix
+{
+	/**
+	* A boolean mask, the result of comparing arrays. One byte per element,
+	* stored column major like every other array.
+	*/
+	typedef Array<bool,2>	Mask;
+
+	namespace impl
+	{
+		/** Array, Map<Array> and XprArray seen as an array expression, for
+		functions that take any of them. Anything else has no members. */
+		template<class A> struct ArrayOperand { };
+
+		template<class T, int D> struct ArrayOperand<Array<T,D> >
+		{
+			typedef T									value_type;
+			typedef XprArray<ArrayConstReference<T,D>,D>	expr_type;
+			enum { dim = D };
+
+			static expr_type as_expr(const Array<T,D> & a) { return a.as_expr(); }
+		};
+
+		template<class T, int D> struct ArrayOperand<Map<Array<T,D> > >
+		{
+			typedef T									value_type;
+			typedef XprArray<ArrayConstReference<T,D>,D>	expr_type;
+			enum { dim = D };
+
+			static expr_type as_expr(const Map<Array<T,D> > & a) { return a.as_expr(); }
+		};
+
+		template<class E, int D> struct ArrayOperand<XprArray<E,D> >
+		{
+			typedef typename E::value_type				value_type;
+			typedef XprArray<E,D>						expr_type;
+			enum { dim = D };
+
+			static const expr_type & as_expr(const XprArray<E,D> & a) { return a; }
+		};
+	}
+
+
+	/**
+	* \fn select(const M& mask, const A& a, const B& b)
+	* \brief Element wise mask ? a : b. Either branch may be a scalar,
+	* e.g. select(A.array() > 0, A.array(), 0) is a ReLU.
+	*/
+	template<class M, class A, class B>
+	inline
+	XprArray<
+		XprSelect<
+			typename impl::ArrayOperand<M>::expr_type,
+			typename impl::ArrayOperand<A>::expr_type,
+			typename impl::ArrayOperand<B>::expr_type
+		>, impl::ArrayOperand<M>::dim
+	>
+	select(const M & mask, const A & a, const B & b)
+	{
+		typedef XprSelect<
+			typename impl::ArrayOperand<M>::expr_type,
+			typename impl::ArrayOperand<A>::expr_type,
+			typename impl::ArrayOperand<B>::expr_type
+		> expr_type;
+		return XprArray<expr_type,impl::ArrayOperand<M>::dim>(
+			expr_type(impl::ArrayOperand<M>::as_expr(mask), impl::ArrayOperand<A>::as_expr(a), impl::ArrayOperand<B>::as_expr(b)));
+	}
+
+	template<class M, class A>
+	inline
+	XprArray<
+		XprSelect<
+			typename impl::ArrayOperand<M>::expr_type,
+			typename impl::ArrayOperand<A>::expr_type,
+			XprLiteral<typename impl::ArrayOperand<A>::value_type>
+		>, impl::ArrayOperand<M>::dim
+	>
+	select(const M & mask, const A & a, typename impl::ArrayOperand<A>::value_type b)
+	{
+		typedef typename impl::ArrayOperand<A>::value_type value_type;
+		typedef XprSelect<
+			typename impl::ArrayOperand<M>::expr_type,
+			typename impl::ArrayOperand<A>::expr_type,
+			XprLiteral<value_type>
+		> expr_type;
+		return XprArray<expr_type,impl::ArrayOperand<M>::dim>(
+			expr_type(impl::ArrayOperand<M>::as_expr(mask), impl::ArrayOperand<A>::as_expr(a), XprLiteral<value_type>(b)));
+	}
+
+	template<class M, class B>
+	inline
+	XprArray<
+		XprSelect<
+			typename impl::ArrayOperand<M>::expr_type,
+			XprLiteral<typename impl::ArrayOperand<B>::value_type>,
+			typename impl::ArrayOperand<B>::expr_type
+		>, impl::ArrayOperand<M>::dim
+	>
+	select(const M & mask, typename impl::ArrayOperand<B>::value_type a, const B & b)
+	{
+		typedef typename impl::ArrayOperand<B>::value_type value_type;
+		typedef XprSelect<
+			typename impl::ArrayOperand<M>::expr_type,
+			XprLiteral<value_type>,
+			typename impl::ArrayOperand<B>::expr_type
+		> expr_type;
+		return XprArray<expr_type,impl::ArrayOperand<M>::dim>(
+			expr_type(impl::ArrayOperand<M>::as_expr(mask), XprLiteral<value_type>(a), impl::ArrayOperand<B>::as_expr(b)));
+	}
+
+
+	/**
+	* \fn count(const M& mask)
+	* \brief Number of true entries of a mask.
+	*/
+	template<class M>
+	inline
+	std::size_t
+	count(const M & mask)
+	{
+		typename impl::ArrayOperand<M>::expr_type::result_type K = impl::ArrayOperand<M>::as_expr(mask).eval();
+
+		return impl::count(K.data(),K.size());
+	}
+
+
+	/**
+	* \fn masked_sum(const A& a, const M& mask)
+	* \brief Sum of the entries of a where mask is true. Entries outside the
+	* mask are skipped, not multiplied by zero, so NaN there is harmless.
+	*/
+	template<class A, class M>
+	inline
+	typename impl::ArrayOperand<A>::value_type
+	masked_sum(const A & a, const M & mask)
+	{
+		typename impl::ArrayOperand<A>::expr_type::result_type V = impl::ArrayOperand<A>::as_expr(a).eval();
+		typename impl::ArrayOperand<M>::expr_type::result_type K = impl::ArrayOperand<M>::as_expr(mask).eval();
+
+		check_dim(V,K);
+
+		return impl::masked_sum(V.data(),K.data(),V.size());
+	}
+
+
+	/*
+	* operator!(Mask)
+	* Note: per se element wise
+	*/
+	template<int D>
+	inline
+	XprArray<XprUnOp<Fcnl_not<bool>, XprArray<ArrayConstReference<bool,D>,D> >,D>
+	operator!(const Array<bool,D> & mask)
+	{
+		typedef XprUnOp<Fcnl_not<bool>, XprArray<ArrayConstReference<bool,D>,D> > expr_type;
+		return XprArray<expr_type,D>(expr_type(mask.as_expr()));
+	}
+
+	template<int D>
+	inline
+	XprArray<XprUnOp<Fcnl_not<bool>, XprArray<ArrayConstReference<bool,D>,D> >,D>
+	operator!(const Map<Array<bool,D> > & mask)
+	{
+		typedef XprUnOp<Fcnl_not<bool>, XprArray<ArrayConstReference<bool,D>,D> > expr_type;
+		return XprArray<expr_type,D>(expr_type(mask.as_expr()));
+	}
+
+	template<class E, int D>
+	inline
+	XprArray<XprUnOp<Fcnl_not<bool>, XprArray<E,D> >,D>
+	operator!(const XprArray<E,D> & mask)
+	{
+		typedef XprUnOp<Fcnl_not<bool>, XprArray<E,D> > expr_type;
+		return XprArray<expr_type,D>(expr_type(mask));
+	}
+}
+
+#endif
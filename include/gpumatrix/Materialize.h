@@ -0,0 +1,429 @@
+#ifndef GPUMATRIX_MATERIALIZE_H
+#define GPUMATRIX_MATERIALIZE_H
+
+#include <cstddef>
+#include <atomic>
+#include <mutex>
+#include <ostream>
+#include <typeinfo>
+
+/*
+* Where an expression allocates. Every kernel in impl/EvalImpl.h reads
+* plain device memory, so each operand that is not a matrix, vector or
+* array of its own is evaluated into a temporary first, and an assignment
+* without noalias() (and every compound assignment) evaluates the whole
+* right hand side into one more before copying it over. Elementwise right
+* hand sides are the exception: they are evaluated in place, see do_assign.
+*
+* set_materialize_log() prints each of these temporaries as it is made,
+* with its size, the reason and the print_xpr() tree of what it holds.
+* materialize_stats() counts them whether or not a log is set.
+*
+* temporaries<E>() is the same count at compile time, and xpr_cost() adds
+* the FLOPs and device bytes of every kernel the assignment launches:
+*
+*	static_assert(temporaries<decltype(A*B + C)>(true) == 1, "");
+*	std::cout << xpr_cost(A.transpose()*x) << std::endl;
+*/
+
+namespace gpumatrix
+{
+	template <class T> class Matrix;
+	template <class T> class Vector;
+	template <class T, int D> class Array;
+	template <class T> class MatrixConstReference;
+	template <class T> class VectorConstReference;
+	template <class T, int D> class ArrayConstReference;
+	template <class E> class XprMatrix;
+	template <class E> class XprVector;
+	template <class E, int D> class XprArray;
+	template <class T> class XprLiteral;
+	template <typename BinOp, typename E1, typename E2> class XprBinOp;
+	template <typename UnOp, typename E> class XprUnOp;
+	template <typename E1, typename E2> class XprMMProduct;
+	template <typename E1, typename E2> class XprMMtProduct;
+	template <typename E1, typename E2> class XprMtMProduct;
+	template <typename E1, typename E2> class XprMtMtProduct;
+	template <typename E1, typename E2> class XprMVProduct;
+	template <typename E1, typename E2> class XprMtVProduct;
+	template <typename E> class XprMatrixTranspose;
+	template <typename E> class RowWiseSum;
+	template <typename E> class ColWiseSum;
+	template <typename M, typename E1, typename E2> class XprSelect;
+	template <typename BinOp, typename E, typename V, int Dir> class XprBroadcast;
+	template <typename T, typename E, int Side> class XprSparseProduct;
+	template <typename T, int R, int C, typename E, int Side> class XprFixedProduct;
+
+	struct MaterializeStats
+	{
+		std::size_t count;		/**< temporaries made */
+		std::size_t bytes;		/**< device memory they took */
+	};
+
+	namespace impl
+	{
+		struct MaterializeState
+		{
+			MaterializeState() : log(0), count(0), bytes(0) { }
+
+			std::mutex lock;
+			std::ostream * log;
+			std::atomic<std::size_t> count;
+			std::atomic<std::size_t> bytes;
+		};
+
+		inline MaterializeState & materialize_state()
+		{
+			static MaterializeState state;
+			return state;
+		}
+
+		inline const char * & materialize_reason()
+		{
+			static thread_local const char * reason = 0;
+			return reason;
+		}
+
+		/** Names the next temporary made on this thread. */
+		class MaterializeReason
+		{
+			MaterializeReason(const MaterializeReason&);
+			MaterializeReason& operator=(const MaterializeReason&);
+
+		public:
+			explicit MaterializeReason(const char * reason) : m_saved(materialize_reason())
+			{
+				materialize_reason() = reason;
+			}
+
+			~MaterializeReason()
+			{
+				materialize_reason() = m_saved;
+			}
+
+		private:
+			const char *	m_saved;
+		};
+
+		/** The reason set for this temporary; the ones made for its operands have none. */
+		inline const char * take_materialize_reason()
+		{
+			const char * reason = materialize_reason();
+			materialize_reason() = 0;
+			return reason ? reason : "operand of a kernel";
+		}
+
+		template <class E>
+		void materialized(const E & expr, std::size_t elements, std::size_t bytes, const char * reason)
+		{
+			MaterializeState & state = materialize_state();
+			state.count += 1;
+			state.bytes += bytes;
+
+			if (state.log == 0)
+				return;
+
+			std::lock_guard<std::mutex> guard(state.lock);
+			if (state.log)
+			{
+				*state.log << "materialize " << elements << " x " << typeid(typename E::value_type).name()
+					<< " (" << bytes << " bytes), " << reason << ":" << std::endl;
+				expr.print_xpr(*state.log, 1);
+			}
+		}
+
+		/** Temporaries made by evaluating E as the operand of a kernel. */
+		template <class E> struct XprOperandTemporaries;
+
+		/** Temporaries made for the operands of the kernel evaluating E. */
+		template <class E> struct XprNodeTemporaries
+		{
+			static constexpr int value = 0;
+		};
+
+		template <class E> struct XprOperandTemporaries
+		{
+			static constexpr int value = 1 + XprNodeTemporaries<E>::value;
+		};
+
+		template <class T> struct XprOperandTemporaries<Matrix<T> > { static constexpr int value = 0; };
+		template <class T> struct XprOperandTemporaries<Vector<T> > { static constexpr int value = 0; };
+		template <class T, int D> struct XprOperandTemporaries<Array<T,D> > { static constexpr int value = 0; };
+		template <class T> struct XprOperandTemporaries<MatrixConstReference<T> > { static constexpr int value = 0; };
+		template <class T> struct XprOperandTemporaries<VectorConstReference<T> > { static constexpr int value = 0; };
+		template <class T, int D> struct XprOperandTemporaries<ArrayConstReference<T,D> > { static constexpr int value = 0; };
+		template <class T> struct XprOperandTemporaries<XprLiteral<T> > { static constexpr int value = 0; };
+
+		// the wrappers evaluate their expression in place
+		template <class E> struct XprOperandTemporaries<XprMatrix<E> > { static constexpr int value = XprOperandTemporaries<E>::value; };
+		template <class E> struct XprOperandTemporaries<XprVector<E> > { static constexpr int value = XprOperandTemporaries<E>::value; };
+		template <class E, int D> struct XprOperandTemporaries<XprArray<E,D> > { static constexpr int value = XprOperandTemporaries<E>::value; };
+		template <class E> struct XprNodeTemporaries<XprMatrix<E> > { static constexpr int value = XprNodeTemporaries<E>::value; };
+		template <class E> struct XprNodeTemporaries<XprVector<E> > { static constexpr int value = XprNodeTemporaries<E>::value; };
+		template <class E, int D> struct XprNodeTemporaries<XprArray<E,D> > { static constexpr int value = XprNodeTemporaries<E>::value; };
+
+		template <class E1, class E2> struct XprBinaryTemporaries
+		{
+			static constexpr int value = XprOperandTemporaries<E1>::value + XprOperandTemporaries<E2>::value;
+		};
+
+		template <class Op, class E1, class E2> struct XprNodeTemporaries<XprBinOp<Op,E1,E2> > : XprBinaryTemporaries<E1,E2> { };
+		template <class E1, class E2> struct XprNodeTemporaries<XprMMProduct<E1,E2> > : XprBinaryTemporaries<E1,E2> { };
+		template <class E1, class E2> struct XprNodeTemporaries<XprMMtProduct<E1,E2> > : XprBinaryTemporaries<E1,E2> { };
+		template <class E1, class E2> struct XprNodeTemporaries<XprMtMProduct<E1,E2> > : XprBinaryTemporaries<E1,E2> { };
+		template <class E1, class E2> struct XprNodeTemporaries<XprMtMtProduct<E1,E2> > : XprBinaryTemporaries<E1,E2> { };
+		template <class E1, class E2> struct XprNodeTemporaries<XprMVProduct<E1,E2> > : XprBinaryTemporaries<E1,E2> { };
+		template <class E1, class E2> struct XprNodeTemporaries<XprMtVProduct<E1,E2> > : XprBinaryTemporaries<E1,E2> { };
+		template <class Op, class E, class V, int Dir> struct XprNodeTemporaries<XprBroadcast<Op,E,V,Dir> > : XprBinaryTemporaries<E,V> { };
+		template <class T, class E, int Side> struct XprNodeTemporaries<XprSparseProduct<T,E,Side> > : XprOperandTemporaries<E> { };
+		template <class T, int R, int C, class E, int Side> struct XprNodeTemporaries<XprFixedProduct<T,R,C,E,Side> > : XprOperandTemporaries<E> { };
+
+		template <class Op, class E> struct XprNodeTemporaries<XprUnOp<Op,E> > : XprOperandTemporaries<E> { };
+		template <class E> struct XprNodeTemporaries<XprMatrixTranspose<E> > : XprOperandTemporaries<E> { };
+		template <class E> struct XprNodeTemporaries<RowWiseSum<E> > : XprOperandTemporaries<E> { };
+		template <class E> struct XprNodeTemporaries<ColWiseSum<E> > : XprOperandTemporaries<E> { };
+
+		template <class M, class E1, class E2> struct XprNodeTemporaries<XprSelect<M,E1,E2> >
+		{
+			static constexpr int value = XprOperandTemporaries<M>::value + XprBinaryTemporaries<E1,E2>::value;
+		};
+
+		/** Nodes whose kernel writes entry i from entry i of each operand, so
+		dest = E runs straight into dest even when dest is an operand (see
+		do_assign in impl/AssignImpl.h). Products and transposes are not. */
+		template <class E> struct XprElementwise { enum { value = 0 }; };
+
+		template <class E> struct XprElementwise<XprMatrix<E> > : XprElementwise<E> { };
+		template <class E> struct XprElementwise<XprVector<E> > : XprElementwise<E> { };
+		template <class E, int D> struct XprElementwise<XprArray<E,D> > : XprElementwise<E> { };
+
+		template <class Op, class E1, class E2> struct XprElementwise<XprBinOp<Op,E1,E2> > { enum { value = 1 }; };
+		template <class Op, class E> struct XprElementwise<XprUnOp<Op,E> > { enum { value = 1 }; };
+		template <class M, class E1, class E2> struct XprElementwise<XprSelect<M,E1,E2> > { enum { value = 1 }; };
+		template <class Op, class E, class V, int Dir> struct XprElementwise<XprBroadcast<Op,E,V,Dir> > { enum { value = 1 }; };
+	}
+
+	/** Every temporary made from now on is printed to os, 0 stops it. */
+	inline void set_materialize_log(std::ostream * os)
+	{
+		std::lock_guard<std::mutex> guard(impl::materialize_state().lock);
+		impl::materialize_state().log = os;
+	}
+
+	inline MaterializeStats materialize_stats()
+	{
+		MaterializeStats stats = { impl::materialize_state().count, impl::materialize_state().bytes };
+		return stats;
+	}
+
+	inline void reset_materialize_stats()
+	{
+		impl::materialize_state().count = 0;
+		impl::materialize_state().bytes = 0;
+	}
+
+	/** Temporaries made by dest = E, or by dest.noalias() = E. dest += E counts as dest = E.
+	An elementwise E goes straight into dest either way, unless dest partly overlaps an operand. */
+	template <class E>
+	constexpr int temporaries(bool noalias = false)
+	{
+		return noalias || impl::XprElementwise<E>::value ? int(impl::XprNodeTemporaries<E>::value) : int(impl::XprOperandTemporaries<E>::value);
+	}
+
+	/** What an assignment launches, its temporaries included. */
+	struct XprCost
+	{
+		int temporaries;
+		double flops;
+		double bytes;			/**< device memory read and written */
+	};
+
+	inline std::ostream & operator<<(std::ostream & os, const XprCost & cost)
+	{
+		return os << cost.temporaries << " temporaries, " << cost.flops << " flops, " << cost.bytes << " bytes";
+	}
+
+	namespace impl
+	{
+		template <class E> std::size_t xpr_elements(const E & expr) { return expr.size(); }
+		template <class T> std::size_t xpr_elements(const XprLiteral<T> &) { return 0; }
+
+		template <class E> struct XprCostOf;
+
+		template <class E> void xpr_operand_cost(const E & expr, XprCost & cost)
+		{
+			if (XprOperandTemporaries<E>::value > XprNodeTemporaries<E>::value)
+				cost.temporaries++;
+			XprCostOf<E>::node(expr, cost);
+		}
+
+		template <class E> void xpr_kernel_cost(const E & expr, XprCost & cost, double flops, double reads)
+		{
+			cost.flops += flops;
+			cost.bytes += (reads + expr.size())*sizeof(typename E::value_type);
+		}
+
+		// an expression without a rule here is taken as one elementwise pass
+		template <class E> struct XprCostOf
+		{
+			static void node(const E & expr, XprCost & cost) { xpr_kernel_cost(expr, cost, expr.size(), expr.size()); }
+		};
+
+		template <class T> struct XprCostOf<Matrix<T> > { static void node(const Matrix<T> &, XprCost &) { } };
+		template <class T> struct XprCostOf<Vector<T> > { static void node(const Vector<T> &, XprCost &) { } };
+		template <class T, int D> struct XprCostOf<Array<T,D> > { static void node(const Array<T,D> &, XprCost &) { } };
+		template <class T> struct XprCostOf<MatrixConstReference<T> > { static void node(const MatrixConstReference<T> &, XprCost &) { } };
+		template <class T> struct XprCostOf<VectorConstReference<T> > { static void node(const VectorConstReference<T> &, XprCost &) { } };
+		template <class T, int D> struct XprCostOf<ArrayConstReference<T,D> > { static void node(const ArrayConstReference<T,D> &, XprCost &) { } };
+		template <class T> struct XprCostOf<XprLiteral<T> > { static void node(const XprLiteral<T> &, XprCost &) { } };
+
+		template <class E> struct XprCostOf<XprMatrix<E> >
+		{
+			static void node(const XprMatrix<E> & expr, XprCost & cost) { XprCostOf<E>::node(expr.expr(), cost); }
+		};
+
+		template <class E> struct XprCostOf<XprVector<E> >
+		{
+			static void node(const XprVector<E> & expr, XprCost & cost) { XprCostOf<E>::node(expr.expr(), cost); }
+		};
+
+		template <class E, int D> struct XprCostOf<XprArray<E,D> >
+		{
+			static void node(const XprArray<E,D> & expr, XprCost & cost) { XprCostOf<E>::node(expr.expr(), cost); }
+		};
+
+		template <class Op, class E1, class E2> struct XprCostOf<XprBinOp<Op,E1,E2> >
+		{
+			static void node(const XprBinOp<Op,E1,E2> & expr, XprCost & cost)
+			{
+				xpr_operand_cost(expr.lhs(), cost);
+				xpr_operand_cost(expr.rhs(), cost);
+				xpr_kernel_cost(expr, cost, expr.size(), double(xpr_elements(expr.lhs())) + xpr_elements(expr.rhs()));
+			}
+		};
+
+		template <class Op, class E> struct XprCostOf<XprUnOp<Op,E> >
+		{
+			static void node(const XprUnOp<Op,E> & expr, XprCost & cost)
+			{
+				xpr_operand_cost(expr.expr(), cost);
+				xpr_kernel_cost(expr, cost, expr.size(), expr.expr().size());
+			}
+		};
+
+		template <class E> struct XprCostOf<XprMatrixTranspose<E> >
+		{
+			static void node(const XprMatrixTranspose<E> & expr, XprCost & cost)
+			{
+				xpr_operand_cost(expr.expr(), cost);
+				xpr_kernel_cost(expr, cost, 0, expr.expr().size());
+			}
+		};
+
+		template <class E> struct XprCostOf<RowWiseSum<E> >
+		{
+			static void node(const RowWiseSum<E> & expr, XprCost & cost)
+			{
+				xpr_operand_cost(expr.expr(), cost);
+				xpr_kernel_cost(expr, cost, expr.expr().size(), expr.expr().size());
+			}
+		};
+
+		template <class E> struct XprCostOf<ColWiseSum<E> >
+		{
+			static void node(const ColWiseSum<E> & expr, XprCost & cost)
+			{
+				xpr_operand_cost(expr.expr(), cost);
+				xpr_kernel_cost(expr, cost, expr.expr().size(), expr.expr().size());
+			}
+		};
+
+		template <class M, class E1, class E2> struct XprCostOf<XprSelect<M,E1,E2> >
+		{
+			static void node(const XprSelect<M,E1,E2> & expr, XprCost & cost)
+			{
+				xpr_operand_cost(expr.mask(), cost);
+				xpr_operand_cost(expr.lhs(), cost);
+				xpr_operand_cost(expr.rhs(), cost);
+				xpr_kernel_cost(expr, cost, 0, double(xpr_elements(expr.lhs())) + xpr_elements(expr.rhs()));
+				cost.bytes += expr.mask().size()*sizeof(bool);
+			}
+		};
+
+		template <class Op, class E, class V, int Dir> struct XprCostOf<XprBroadcast<Op,E,V,Dir> >
+		{
+			static void node(const XprBroadcast<Op,E,V,Dir> & expr, XprCost & cost)
+			{
+				xpr_operand_cost(expr.expr(), cost);
+				xpr_operand_cost(expr.vector(), cost);
+				xpr_kernel_cost(expr, cost, expr.size(), double(expr.expr().size()) + expr.vector().size());
+			}
+		};
+
+		// csrmm and csrmv: every stored entry meets each dense row or column once
+		template <class T, class E, int Side> struct XprCostOf<XprSparseProduct<T,E,Side> >
+		{
+			static void node(const XprSparseProduct<T,E,Side> & expr, XprCost & cost)
+			{
+				double nnz = expr.sparse().nonZeros();
+				double passes = XprSparseProduct<T,E,Side>::sparse_left ? expr.cols() : expr.rows();
+
+				xpr_operand_cost(expr.dense(), cost);
+				xpr_kernel_cost(expr, cost, 2.0*nnz*passes, nnz + expr.dense().size());
+				cost.bytes += (nnz + expr.sparse().outerSize() + 1)*sizeof(int);
+			}
+		};
+
+		// one pass over the dense factor, the fixed factor is a kernel argument
+		template <class T, int R, int C, class E, int Side> struct XprCostOf<XprFixedProduct<T,R,C,E,Side> >
+		{
+			static void node(const XprFixedProduct<T,R,C,E,Side> & expr, XprCost & cost)
+			{
+				double inner = XprFixedProduct<T,R,C,E,Side>::fixed_left ? C : R;
+
+				xpr_operand_cost(expr.dense(), cost);
+				xpr_kernel_cost(expr, cost, 2.0*inner*expr.size(), double(expr.dense().size()));
+			}
+		};
+
+		// gemm and gemv on the stored operands, k is the inner dimension
+		#define GPUMATRIX_XPR_PRODUCT_COST(PRODUCT, INNER)								\
+		template <class E1, class E2> struct XprCostOf<PRODUCT<E1,E2> >					\
+		{																				\
+			static void node(const PRODUCT<E1,E2> & expr, XprCost & cost)				\
+			{																			\
+				xpr_operand_cost(expr.lhs(), cost);										\
+				xpr_operand_cost(expr.rhs(), cost);										\
+				xpr_kernel_cost(expr, cost, 2.0*expr.size()*expr.lhs().INNER(),			\
+					double(expr.lhs().size()) + expr.rhs().size());						\
+			}																			\
+		};
+
+		GPUMATRIX_XPR_PRODUCT_COST(XprMMProduct, cols)
+		GPUMATRIX_XPR_PRODUCT_COST(XprMMtProduct, cols)
+		GPUMATRIX_XPR_PRODUCT_COST(XprMtMProduct, rows)
+		GPUMATRIX_XPR_PRODUCT_COST(XprMtMtProduct, rows)
+		GPUMATRIX_XPR_PRODUCT_COST(XprMVProduct, cols)
+		GPUMATRIX_XPR_PRODUCT_COST(XprMtVProduct, rows)
+		#undef GPUMATRIX_XPR_PRODUCT_COST
+	}
+
+	/** The kernels, temporaries and copy of dest = expr, or of dest.noalias() = expr. */
+	template <class E>
+	XprCost xpr_cost(const E & expr, bool noalias = false)
+	{
+		XprCost cost = { 0, 0, 0 };
+
+		if (noalias || impl::XprElementwise<E>::value)
+			impl::XprCostOf<E>::node(expr, cost);
+		else
+		{
+			impl::xpr_operand_cost(expr, cost);
+			cost.bytes += 2.0*expr.size()*sizeof(typename E::value_type);
+		}
+
+		return cost;
+	}
+}
+
+#endif
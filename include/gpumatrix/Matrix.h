@@ -38,8 +38,10 @@
 #include <gpumatrix/xpr/ColWiseView.h>
 #include <gpumatrix/NoAliasProxy.h>
 #include <gpumatrix/MapArray.h>
+#include <gpumatrix/Random.h>
 
 #include <gpumatrix/impl/Interface.h>
+#include <gpumatrix/SharedStorage.h>
 
 
 namespace gpumatrix {
@@ -49,6 +51,8 @@ namespace gpumatrix {
 	template<class T/**/> class Matrix;
 	template<class T, int D> class Array;
 	template<class E> class Map;
+	template<class T> class LLT;
+	template<class T> class HouseholderQR;
 
 	
 	template<class T,
@@ -224,16 +228,16 @@ namespace gpumatrix {
 
 	public: // STL  interface
 		/** STL iterator interface. */
-		iterator begin() { return m_data; }
+		iterator begin() { return data(); }
 
 		/** STL iterator interface. */
-		iterator end() { return m_data + Rows*Cols;; }
+		iterator end() { return data() + Rows*Cols;; }
 
 		/** STL const_iterator interface. */
-		const_iterator begin() const { return m_data; }
+		const_iterator begin() const { return m_storage.data(); }
 
 		/** STL const_iterator interface. */
-		const_iterator end() const { return m_data + Rows*Cols;; }
+		const_iterator end() const { return m_storage.data() + Rows*Cols;; }
 
 		/** STL reverse iterator interface reverse begin. */
 		reverse_iterator rbegin() { return reverse_iterator( end() ); }
@@ -260,7 +264,7 @@ namespace gpumatrix {
 		/** STL vector empty() - returns allways false. */
 		bool empty() 
 		{ 
-			if (m_data == 0)
+			if (m_storage.data() == 0)
 				return true; 
 			else 
 				return false;
@@ -278,52 +282,52 @@ namespace gpumatrix {
 			return NoAliasProxy<Matrix<T>>(*this);
 		}
 
-		Map<Array<T,2>> array() const
+		Map<Array<T,2>> array()
 		{
-			return Map<Array<T,2>>(m_data,Rows,Cols);
+			return Map<Array<T,2>>(m_storage.unique(),Rows,Cols);
 		}
 
-	public:
-		/** Default Destructor */
-		~Matrix() {
-			impl::free(m_data);
+		/** A read-only view; the buffer is not copied when it is shared. */
+		XprArray<ArrayConstReference<T,2>,2> array() const
+		{
+			return XprArray<ArrayConstReference<T,2>,2>(ArrayConstReference<T,2>(m_storage.data(),Rows,Cols));
 		}
 
+	public:
 		/** Default Constructor. The allocated memory region isn't cleared. If you want
 		a clean use the constructor argument zero. */
-		explicit Matrix():m_data(0),Rows(0),Cols(0)
+		explicit Matrix():Rows(0),Cols(0)
 		{ 
 		}
 
 		explicit Matrix(std::size_t nRows, std::size_t nCols):Rows(nRows),Cols(nCols)
 		{
-			m_data = impl::alloc<value_type>(Rows*Cols);
+			m_storage.reset(Rows*Cols);
 		}
 
-		/** Copy Constructor, not explicit! */
-		Matrix(const Matrix& rhs):Rows(rhs.rows()),Cols(rhs.cols())
+		/** Copy Constructor, not explicit! The copy shares the buffer of rhs
+		until either of them is written, see SharedStorage.h. */
+		Matrix(const Matrix& rhs):Rows(rhs.rows()),Cols(rhs.cols()),m_storage(rhs.m_storage)
 		{
-			if (this != &rhs)
-			{
-				if (rhs.data() == 0)
-				{
-					m_data = 0;
-					return;
-				}
-				m_data = impl::alloc<value_type>(Rows*Cols);
-				impl::copy(m_data,rhs.data(),rhs.size());
-			}
-			//		*this = XprMatrix<ConstReference>(rhs.as_expr());
 		}
 
 
 		Matrix(const Eigen::Matrix<value_type,Eigen::Dynamic,Eigen::Dynamic> & EigenMat):Rows(EigenMat.rows()),Cols(EigenMat.cols())
 		{
-			m_data = impl::alloc<value_type>(Rows*Cols);
-			impl::set(m_data,EigenMat.data(),Rows*Cols);
+			m_storage.reset(Rows*Cols);
+			impl::set(data(),EigenMat.data(),Rows*Cols);
 
 		}
 
+		/** Construct from an Eigen matrix of another element type, e.g. a
+		MatrixXf into a Matrix<half>. The conversion is done on the host. */
+		template<typename S>
+		explicit Matrix(const Eigen::Matrix<S,Eigen::Dynamic,Eigen::Dynamic> & EigenMat):Rows(EigenMat.rows()),Cols(EigenMat.cols())
+		{
+			m_storage.reset(Rows*Cols);
+			impl::set(data(),EigenMat.data(),Rows*Cols);
+		}
+
 
 		/**
 		* Constructor with STL iterator interface. The data will be copied into the matrix
@@ -368,7 +372,7 @@ namespace gpumatrix {
 		template<class E>
 		Matrix(const XprMatrix<E>& e):Rows(e.rows()),Cols(e.cols())
 		{
-			m_data = impl::alloc<value_type>(Rows*Cols);
+			m_storage.reset(Rows*Cols);
 
 			(*this).noalias() = e;
 		}
@@ -376,7 +380,7 @@ namespace gpumatrix {
 		template<class E>
 		Matrix(const XprArray<E,2>& e):Rows(e.rows()),Cols(e.cols())
 		{
-			m_data = impl::alloc<value_type>(Rows*Cols);
+			m_storage.reset(Rows*Cols);
 
 			(*this).noalias() = e;
 		}
@@ -386,14 +390,14 @@ namespace gpumatrix {
 		{
 			resize(rows,cols);
 
-			impl::zero(m_data,size());
+			impl::zero(m_storage.overwrite(),size());
 		}
 		operator Eigen::Matrix<value_type,Eigen::Dynamic,Eigen::Dynamic> () const
 		{
 
 			Eigen::Matrix<value_type,Eigen::Dynamic,Eigen::Dynamic> M(Rows,Cols);
 
-			impl::get(M.data(),m_data,size());
+			impl::get(M.data(),m_storage.data(),size());
 			return M;
 		}
 
@@ -404,11 +408,9 @@ namespace gpumatrix {
 
 				return;
 
-			impl::free(m_data);
-
 			Rows = r; Cols = c;
 
-			m_data = impl::alloc<value_type>(Rows*Cols);
+			m_storage.reset(Rows*Cols);
 
 		}
 		///** assign a value_type on array, this can be used for a single value
@@ -419,8 +421,9 @@ namespace gpumatrix {
 
 
 	public: // access operators
-		value_type* _tvmet_restrict data() { return m_data; }
-		const value_type* _tvmet_restrict data() const { return m_data; }
+		/** The buffer for writing, copied first if other objects share it. */
+		value_type* _tvmet_restrict data() { return m_storage.unique(); }
+		const value_type* _tvmet_restrict data() const { return m_storage.data(); }
 
 	public: // index access operators
 		//value_type& _tvmet_restrict operator()(std::size_t i, std::size_t j) {
@@ -458,27 +461,57 @@ namespace gpumatrix {
 		}
 
 		
-		Map<Vector<value_type>> col(unsigned int i ) const
+		// The views of a const matrix are expressions over the shared buffer
+		// and can't be written; the others take it for this matrix alone
+		// first, so that writes through them don't reach the other holders.
+		Map<Vector<value_type>> col(unsigned int i )
 		{
-			return Map<Vector<value_type>>(m_data+i*Rows,Rows);
+			return Map<Vector<value_type>>(m_storage.unique()+i*Rows,Rows);
 		}
 
-		RowWiseView<XprMatrix<ConstReference>> rowwise() const
+		XprVector<VectorConstReference<value_type>> col(unsigned int i ) const
 		{
-			return RowWiseView<XprMatrix<ConstReference>>(this->as_expr());
+			return XprVector<VectorConstReference<value_type>>(VectorConstReference<value_type>(m_storage.data()+i*Rows,Rows));
 		}
 
-		ColWiseView<XprMatrix<ConstReference>> colwise() const
+		RowWiseView<XprMatrix<ConstReference>,true> rowwise()
 		{
-			return ColWiseView<XprMatrix<ConstReference>>(this->as_expr());
+			// op= on the view updates this matrix in place
+			m_storage.unique();
+			return RowWiseView<XprMatrix<ConstReference>,true>(this->as_expr());
 		}
 
-		Map<Matrix<value_type>> block(int row_start_ind, int col_start_ind, size_t row_num, size_t col_num) const
+		RowWiseView<XprMatrix<ConstReference>,false> rowwise() const
+		{
+			return RowWiseView<XprMatrix<ConstReference>,false>(this->as_expr());
+		}
+
+		ColWiseView<XprMatrix<ConstReference>,true> colwise()
+		{
+			// op= on the view updates this matrix in place
+			m_storage.unique();
+			return ColWiseView<XprMatrix<ConstReference>,true>(this->as_expr());
+		}
+
+		ColWiseView<XprMatrix<ConstReference>,false> colwise() const
+		{
+			return ColWiseView<XprMatrix<ConstReference>,false>(this->as_expr());
+		}
+
+		Map<Matrix<value_type>> block(int row_start_ind, int col_start_ind, size_t row_num, size_t col_num)
+		{
+			if (row_start_ind != 0 || rows() != row_num)
+				throw runtime_error("Only full column blocks are supported now!");
+
+			return Map<Matrix<value_type>>(m_storage.unique()+col_start_ind*rows(),rows(),col_num);
+		}
+
+		XprMatrix<ConstReference> block(int row_start_ind, int col_start_ind, size_t row_num, size_t col_num) const
 		{
 			if (row_start_ind != 0 || rows() != row_num)
 				throw runtime_error("Only full column blocks are supported now!");
 
-			return Map<Matrix<value_type>>(m_data+col_start_ind*rows(),rows(),col_num);
+			return XprMatrix<ConstReference>(ConstReference(m_storage.data()+col_start_ind*rows(),rows(),col_num));
 		}
 
 
@@ -511,8 +544,10 @@ namespace gpumatrix {
 		generated. */
 		Matrix& operator=(const Matrix & rhs) {
 			
-			/*cudaMemcpy(m_data, rhs.m_data*Cols*sizeof(value_type), cudaMemcpyDeviceToDevice);*/
-			rhs.assign_to(*this, Fcnl_assign<value_type, value_type>());
+			// see SharedStorage::assign: views of this matrix stay valid
+			// when it holds a buffer of the right size alone
+			m_storage.assign(rhs.m_storage);
+			Rows = rhs.rows(); Cols = rhs.cols();
 			return *this;
 		}
 
@@ -559,7 +594,7 @@ namespace gpumatrix {
 		{
 			
 			resize(EigenMat.rows(),EigenMat.cols());
-			impl::set(m_data,EigenMat.data(),Rows*Cols);
+			impl::set(m_storage.overwrite(),EigenMat.data(),Rows*Cols);
 
 			return *this;
 		}
@@ -593,16 +628,51 @@ namespace gpumatrix {
 			expr_type(this->as_expr()));
 	}
 
+	/** Cholesky factorisation of this symmetric positive definite matrix,
+	see gpumatrix/Cholesky.h. */
+	LLT<value_type> llt() const
+	{
+		return LLT<value_type>(*this);
+	}
+
+	/** Householder QR of this matrix, see gpumatrix/QR.h. */
+	HouseholderQR<value_type> qr() const
+	{
+		return HouseholderQR<value_type>(*this);
+	}
+
 	value_type squaredNorm() const
 	{
 		return 	impl::squaredNorm(*this);
 	}
+
+	value_type squaredNorm(AccumulationPolicy policy) const
+	{
+		return 	impl::squaredNorm(*this,policy);
+	}
+
 	value_type sum() const
 	{
 		//return ((Eigen::MatrixXd)*this).sum();
 		return impl::sum(*this);
 	}
 
+	value_type sum(AccumulationPolicy policy) const
+	{
+		return impl::sum(*this,policy);
+	}
+
+
+	/** Element type conversion on the device, e.g. between float and half. */
+	template <typename T2>
+	Matrix<T2> cast() const
+	{
+		Matrix<T2> result(Rows,Cols);
+
+		impl::array_convert(result.data(),m_storage.data(),size());
+
+		return result;
+	}
 
 	value_type minCoeff() const
 	{
@@ -628,6 +698,43 @@ namespace gpumatrix {
 			return zero_mat;
 		}
 
+		/** Uniform in [-1,1), as Eigen's Random(). Drawn on the device from
+		the process-wide Philox stream, see set_random_seed(). */
+		static Matrix<value_type> Random(size_t rows, size_t cols)
+		{
+			return Uniform(rows,cols,-1,1);
+		}
+
+		/** Uniform in [low,high). */
+		static Matrix<value_type> Uniform(size_t rows, size_t cols, value_type low, value_type high)
+		{
+			Matrix<value_type> rand_mat(rows,cols);
+
+			impl::fill_uniform(rand_mat.data(),rand_mat.size(),low,high);
+
+			return rand_mat;
+		}
+
+		/** Gaussian with the given mean and standard deviation. */
+		static Matrix<value_type> Normal(size_t rows, size_t cols, value_type mean = 0, value_type stddev = 1)
+		{
+			Matrix<value_type> rand_mat(rows,cols);
+
+			impl::fill_normal(rand_mat.data(),rand_mat.size(),mean,stddev);
+
+			return rand_mat;
+		}
+
+		/** 1 with probability p, 0 otherwise. */
+		static Matrix<value_type> Bernoulli(size_t rows, size_t cols, value_type p)
+		{
+			Matrix<value_type> rand_mat(rows,cols);
+
+			impl::fill_bernoulli(rand_mat.data(),rand_mat.size(),p);
+
+			return rand_mat;
+		}
+
 
 	public: // math operators with scalars
 		// NOTE: this meaning is clear - element wise ops even if not in ns element_wise
@@ -758,9 +865,9 @@ namespace gpumatrix {
 		//std::ostream& print_on(std::ostream& os) const;
 
 	private:
-		/** The data of matrix self. */
+		/** The data of matrix self, see SharedStorage.h. */
 
-		value_type*						m_data;
+		impl::SharedStorage<value_type>	m_storage;
 
 	};
 
@@ -0,0 +1,264 @@
+#ifndef GPUMATRIX_MATRIX_BATCH_H
+#define GPUMATRIX_MATRIX_BATCH_H
+
+#include <stdexcept>
+#include <vector>
+
+#include <gpumatrix/Matrix.h>
+#include <gpumatrix/Vector.h>
+#include <gpumatrix/FixedMatrix.h>
+
+namespace gpumatrix
+{
+	/**
+	* \class MatrixBatch MatrixBatch.h "gpumatrix/MatrixBatch.h"
+	* \brief n independent R x C matrices on the device in structure of
+	* arrays layout.
+	*
+	* Entry (i,j) of every instance is contiguous: the batch is held as the
+	* n x R*C matrix planes(), whose column i + j*R is entry (i,j) of
+	* instance 0 to n-1. Elementwise operations are then operations on
+	* planes(), and products and inverses run one thread per instance with
+	* coalesced loads, see impl/backend/BatchInterface.h.
+	*/
+	template <class T, int R, int C>
+	class MatrixBatch
+	{
+		static_assert(R > 0 && C > 0, "MatrixBatch needs positive dimensions");
+
+	public:
+		typedef T		value_type;
+
+		/** Dimensions of each instance. */
+		enum {
+			Rows = R,			/**< Number of rows. */
+			Cols = C,			/**< Number of cols. */
+			Size = R * C		/**< Entries per instance. */
+		};
+
+	public:
+		MatrixBatch() { }
+
+		/** n instances, not cleared. */
+		explicit MatrixBatch(std::size_t n) : m_planes(n,Size) { }
+
+		/** The batch whose planes() are the n x R*C matrix planes. */
+		explicit MatrixBatch(const Matrix<value_type> & planes) : m_planes(planes)
+		{
+			if (planes.cols() != Size)
+				throw std::runtime_error("Dimension not Match for Matrix Batch");
+		}
+
+		/** Upload the instances, transposed to SoA on the host. */
+		MatrixBatch(const std::vector<FixedMatrix<value_type,R,C> > & instances) : m_planes(instances.size(),Size)
+		{
+			std::size_t n = instances.size();
+			std::vector<value_type> h_planes(n*Size);
+
+			for (std::size_t b = 0; b < n; b++)
+				for (int e = 0; e < Size; e++)
+					h_planes[e*n + b] = instances[b].data()[e];
+
+			impl::set(m_planes.data(),h_planes.data(),h_planes.size());
+		}
+
+		operator std::vector<FixedMatrix<value_type,R,C> > () const
+		{
+			std::size_t n = batchSize();
+			std::vector<value_type> h_planes(n*Size);
+			impl::get(h_planes.data(),m_planes.data(),h_planes.size());
+
+			std::vector<FixedMatrix<value_type,R,C> > instances(n);
+			for (std::size_t b = 0; b < n; b++)
+				for (int e = 0; e < Size; e++)
+					instances[b].data()[e] = h_planes[e*n + b];
+
+			return instances;
+		}
+
+		static MatrixBatch Zero(std::size_t n)
+		{
+			MatrixBatch batch(n);
+			impl::zero(batch.m_planes.data(),batch.m_planes.size());
+			return batch;
+		}
+
+	public:
+		static std::size_t rows() { return R; }
+		static std::size_t cols() { return C; }
+
+		/** The number of instances. */
+		std::size_t batchSize() const { return m_planes.rows(); }
+
+		Matrix<value_type> & planes() { return m_planes; }
+		const Matrix<value_type> & planes() const { return m_planes; }
+
+		/** Entry (i,j) of every instance. */
+		Map<Vector<value_type> > element(std::size_t i, std::size_t j)
+		{
+			TVMET_RT_CONDITION((i < R) && (j < C), "MatrixBatch Bounce Violation")
+			return m_planes.col(i + j*R);
+		}
+
+		XprVector<VectorConstReference<value_type> > element(std::size_t i, std::size_t j) const
+		{
+			TVMET_RT_CONDITION((i < R) && (j < C), "MatrixBatch Bounce Violation")
+			return m_planes.col(i + j*R);
+		}
+
+		/** Instance b, gathered on the device and copied to the host. */
+		FixedMatrix<value_type,R,C> instance(std::size_t b) const
+		{
+			TVMET_RT_CONDITION(b < batchSize(), "MatrixBatch Bounce Violation")
+
+			Vector<value_type> packed(Size);
+			impl::copy2d(packed.data(),1,m_planes.data() + b,batchSize(),1,Size);
+
+			FixedMatrix<value_type,R,C> m;
+			impl::get(m.data(),packed.data(),Size);
+			return m;
+		}
+
+		void setInstance(std::size_t b, const FixedMatrix<value_type,R,C> & m)
+		{
+			TVMET_RT_CONDITION(b < batchSize(), "MatrixBatch Bounce Violation")
+
+			Vector<value_type> packed(Size);
+			impl::set(packed.data(),m.data(),Size);
+			impl::copy2d(m_planes.data() + b,batchSize(),packed.data(),1,1,Size);
+		}
+
+	public:
+		/** Each instance transposed; this only permutes the planes. */
+		MatrixBatch<value_type,C,R> transpose() const
+		{
+			std::size_t n = batchSize();
+			MatrixBatch<value_type,C,R> t(n);
+
+			for (int j = 0; j < C; j++)
+				for (int i = 0; i < R; i++)
+					impl::copy(t.planes().data() + (j + i*C)*n,m_planes.data() + (i + j*R)*n,n);
+
+			return t;
+		}
+
+		/** Each instance inverted. */
+		MatrixBatch inverse() const
+		{
+			static_assert(R == C && R <= impl::FixedDeviceMaxSize, "inverse is instantiated for square instances up to FixedDeviceMaxSize");
+
+			std::size_t n = batchSize();
+			MatrixBatch inv(n);
+			impl::batch_inverse<value_type,R>(n,m_planes.data(),n,inv.m_planes.data(),n,(value_type *)0);
+			return inv;
+		}
+
+		/** The determinant of each instance. */
+		Vector<value_type> determinant() const
+		{
+			static_assert(R == C && R <= impl::FixedDeviceMaxSize, "determinant is instantiated for square instances up to FixedDeviceMaxSize");
+
+			std::size_t n = batchSize();
+			Vector<value_type> det(n);
+			impl::batch_inverse<value_type,R>(n,m_planes.data(),n,(value_type *)0,n,det.data());
+			return det;
+		}
+
+	public: // math operators
+		MatrixBatch& operator+=(const MatrixBatch & m) TVMET_CXX_ALWAYS_INLINE
+		{
+			m_planes += m.m_planes;
+			return *this;
+		}
+
+		MatrixBatch& operator-=(const MatrixBatch & m) TVMET_CXX_ALWAYS_INLINE
+		{
+			m_planes -= m.m_planes;
+			return *this;
+		}
+
+		template <typename POD>
+		MatrixBatch& operator*=(POD alpha) TVMET_CXX_ALWAYS_INLINE
+		{
+			m_planes *= alpha;
+			return *this;
+		}
+
+	private:
+		Matrix<value_type>		m_planes;
+	};
+
+	template <class T, int R, int C>
+	inline MatrixBatch<T,R,C> operator+(const MatrixBatch<T,R,C> & a, const MatrixBatch<T,R,C> & b)
+	{
+		MatrixBatch<T,R,C> r(a.batchSize());
+		r.planes() = a.planes() + b.planes();
+		return r;
+	}
+
+	template <class T, int R, int C>
+	inline MatrixBatch<T,R,C> operator-(const MatrixBatch<T,R,C> & a, const MatrixBatch<T,R,C> & b)
+	{
+		MatrixBatch<T,R,C> r(a.batchSize());
+		r.planes() = a.planes() - b.planes();
+		return r;
+	}
+
+	template <class T, int R, int C>
+	inline MatrixBatch<T,R,C> operator*(const MatrixBatch<T,R,C> & a, typename MatrixBatch<T,R,C>::value_type alpha)
+	{
+		MatrixBatch<T,R,C> r(a.batchSize());
+		r.planes() = alpha*a.planes();
+		return r;
+	}
+
+	template <class T, int R, int C>
+	inline MatrixBatch<T,R,C> operator*(typename MatrixBatch<T,R,C>::value_type alpha, const MatrixBatch<T,R,C> & a)
+	{
+		return a*alpha;
+	}
+
+	// A_b*B_b
+	template <class T, int R, int K, int C>
+	inline MatrixBatch<T,R,C> operator*(const MatrixBatch<T,R,K> & A, const MatrixBatch<T,K,C> & B)
+	{
+		static_assert(R <= impl::FixedDeviceMaxSize && K <= impl::FixedDeviceMaxSize && C <= impl::FixedDeviceMaxSize,
+			"batch products are instantiated up to FixedDeviceMaxSize");
+
+		if (A.batchSize() != B.batchSize())
+			throw std::runtime_error("Batch Size not Match for Matrix Batch Multiplication");
+
+		std::size_t n = A.batchSize();
+		MatrixBatch<T,R,C> P(n);
+		impl::batch_mm<T,R,K,C>(n,A.planes().data(),n,1,B.planes().data(),n,1,P.planes().data(),n);
+		return P;
+	}
+
+	// A_b*F, F the same for every instance and passed to the kernel by value
+	template <class T, int R, int K, int C>
+	inline MatrixBatch<T,R,C> operator*(const MatrixBatch<T,R,K> & A, const FixedMatrix<T,K,C> & F)
+	{
+		static_assert(R <= impl::FixedDeviceMaxSize && K <= impl::FixedDeviceMaxSize && C <= impl::FixedDeviceMaxSize,
+			"batch products are instantiated up to FixedDeviceMaxSize");
+
+		std::size_t n = A.batchSize();
+		MatrixBatch<T,R,C> P(n);
+		impl::batch_mm_fixed_right<T,R,K,C>(n,A.planes().data(),n,F.data(),P.planes().data(),n);
+		return P;
+	}
+
+	// F*B_b, F the same for every instance and passed to the kernel by value
+	template <class T, int R, int K, int C>
+	inline MatrixBatch<T,R,C> operator*(const FixedMatrix<T,R,K> & F, const MatrixBatch<T,K,C> & B)
+	{
+		static_assert(R <= impl::FixedDeviceMaxSize && K <= impl::FixedDeviceMaxSize && C <= impl::FixedDeviceMaxSize,
+			"batch products are instantiated up to FixedDeviceMaxSize");
+
+		std::size_t n = B.batchSize();
+		MatrixBatch<T,R,C> P(n);
+		impl::batch_mm_fixed_left<T,R,K,C>(n,F.data(),B.planes().data(),n,P.planes().data(),n);
+		return P;
+	}
+}
+
+#endif
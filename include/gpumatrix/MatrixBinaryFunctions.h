@@ -40,8 +40,8 @@ template<class T1, class T2>	\
 XprMatrix<								\
   XprBinOp<								\
     Fcnl_##NAME<T1, T2>,						\
-    MatrixConstReference<T1>,				\
-    MatrixConstReference<T2>				\
+    XprMatrix<MatrixConstReference<T1> >,				\
+    XprMatrix<MatrixConstReference<T2> >				\
   >							\
 >									\
 NAME(const Matrix<T1>& lhs, 				\
@@ -51,8 +51,8 @@ template<class E, class T>		\
 XprMatrix<								\
   XprBinOp<								\
     Fcnl_##NAME<typename E::value_type, T>,				\
-    MatrixConstReference<T>,				\
-    XprMatrix<E>						\
+    XprMatrix<E>,						\
+    XprMatrix<MatrixConstReference<T> >				\
   >							\
 >									\
 NAME(const XprMatrix<E>& lhs, 				\
@@ -62,7 +62,7 @@ template<class E, class T>		\
 XprMatrix<								\
   XprBinOp<								\
     Fcnl_##NAME<T, typename E::value_type>,				\
-    MatrixConstReference<T>,				\
+    XprMatrix<MatrixConstReference<T> >,				\
     XprMatrix<E>						\
   >							\
 >									\
@@ -91,7 +91,7 @@ template<class T>			\
 XprMatrix<								\
   XprBinOp<								\
     Fcnl_##NAME<T, TP >,						\
-    MatrixConstReference<T>,				\
+    XprMatrix<MatrixConstReference<T> >,				\
     XprLiteral< TP >							\
   >							\
 >									\
@@ -144,6 +144,108 @@ TVMET_DECLARE_MACRO(pow, long double)
 #undef TVMET_DECLARE_MACRO
 
 
+/*
+ * binary_function(POD, Matrix<T>)
+ */
+#define TVMET_DECLARE_MACRO(NAME, TP)					\
+template<class T>			\
+XprMatrix<								\
+  XprBinOp<								\
+    Fcnl_##NAME<TP, T >,						\
+    XprLiteral< TP >,							\
+    XprMatrix<MatrixConstReference<T> >				\
+  >							\
+>									\
+NAME(TP lhs, const Matrix<T>& rhs) TVMET_CXX_ALWAYS_INLINE;
+
+TVMET_DECLARE_MACRO(atan2, int)
+TVMET_DECLARE_MACRO(fmod, int)
+TVMET_DECLARE_MACRO(hypot, int)
+TVMET_DECLARE_MACRO(pow, int)
+
+TVMET_DECLARE_MACRO(atan2, float)
+TVMET_DECLARE_MACRO(fmod, float)
+TVMET_DECLARE_MACRO(hypot, float)
+TVMET_DECLARE_MACRO(pow, float)
+
+TVMET_DECLARE_MACRO(atan2, double)
+TVMET_DECLARE_MACRO(fmod, double)
+TVMET_DECLARE_MACRO(hypot, double)
+TVMET_DECLARE_MACRO(pow, double)
+
+#undef TVMET_DECLARE_MACRO
+
+
+/*
+ * cwiseMin/cwiseMax(Matrix<T1>, Matrix<T2>)
+ * cwiseMin/cwiseMax(XprMatrix<E>, Matrix<T>)
+ * cwiseMin/cwiseMax(Matrix<T>, XprMatrix<E>)
+ * cwiseMin/cwiseMax(Matrix<T>, T)
+ * cwiseMin/cwiseMax(T, Matrix<T>)
+ * Note: per se element wise, the scalar takes the element type
+ */
+#define TVMET_DECLARE_MACRO(NAME, FCNL)					\
+template<class T1, class T2>	\
+XprMatrix<								\
+  XprBinOp<								\
+    Fcnl_##FCNL<T1, T2>,						\
+    XprMatrix<MatrixConstReference<T1> >,				\
+    XprMatrix<MatrixConstReference<T2> >				\
+  >							\
+>									\
+NAME(const Matrix<T1>& lhs, 				\
+     const Matrix<T2>& rhs) TVMET_CXX_ALWAYS_INLINE;	\
+									\
+template<class E, class T>		\
+XprMatrix<								\
+  XprBinOp<								\
+    Fcnl_##FCNL<typename E::value_type, T>,				\
+    XprMatrix<E>,						\
+    XprMatrix<MatrixConstReference<T> >				\
+  >							\
+>									\
+NAME(const XprMatrix<E>& lhs, 				\
+     const Matrix<T>& rhs) TVMET_CXX_ALWAYS_INLINE;		\
+									\
+template<class E, class T>		\
+XprMatrix<								\
+  XprBinOp<								\
+    Fcnl_##FCNL<T, typename E::value_type>,				\
+    XprMatrix<MatrixConstReference<T> >,				\
+    XprMatrix<E>						\
+  >							\
+>									\
+NAME(const Matrix<T>& lhs, 					\
+     const XprMatrix<E>& rhs) TVMET_CXX_ALWAYS_INLINE;		\
+									\
+template<class T>			\
+XprMatrix<								\
+  XprBinOp<								\
+    Fcnl_##FCNL<T, T>,							\
+    XprMatrix<MatrixConstReference<T> >,				\
+    XprLiteral<T>							\
+  >							\
+>									\
+NAME(const Matrix<T>& lhs, 					\
+     typename Matrix<T>::value_type rhs) TVMET_CXX_ALWAYS_INLINE;	\
+									\
+template<class T>			\
+XprMatrix<								\
+  XprBinOp<								\
+    Fcnl_##FCNL<T, T>,							\
+    XprLiteral<T>,							\
+    XprMatrix<MatrixConstReference<T> >				\
+  >							\
+>									\
+NAME(typename Matrix<T>::value_type lhs, 				\
+     const Matrix<T>& rhs) TVMET_CXX_ALWAYS_INLINE;
+
+TVMET_DECLARE_MACRO(cwiseMin, min)
+TVMET_DECLARE_MACRO(cwiseMax, max)
+
+#undef TVMET_DECLARE_MACRO
+
+
 /*
  * complex math
  */
@@ -153,7 +255,7 @@ template<class T>
 XprMatrix<
   XprBinOp<
     Fcnl_pow<T, std::complex<T> >,
-    MatrixConstReference<T>,
+    XprMatrix<MatrixConstReference<T> >,
     XprLiteral< std::complex<T> >
   >
 >
@@ -165,7 +267,7 @@ template<class T>
 XprMatrix<
   XprBinOp<
     Fcnl_pow< std::complex<T>, std::complex<T> >,
-    MatrixConstReference<std::complex<T>>,
+    XprMatrix<MatrixConstReference<std::complex<T> > >,
     XprLiteral< std::complex<T> >
   >
 >
@@ -181,7 +283,7 @@ template<class T>
 XprMatrix<
   XprBinOp<
     Fcnl_pow<std::complex<T>, T>,
-    MatrixConstReference<std::complex<T>>,
+    XprMatrix<MatrixConstReference<std::complex<T> > >,
     XprLiteral<T>
   >
 >
@@ -197,7 +299,7 @@ template<class T>
 XprMatrix<
   XprBinOp<
     Fcnl_pow<std::complex<T>, int>,
-    MatrixConstReference<std::complex<T>>,
+    XprMatrix<MatrixConstReference<std::complex<T> > >,
     XprLiteral<int>
   >
 >
@@ -209,7 +311,7 @@ template<class T>
 XprMatrix<
   XprBinOp<
     Fcnl_polar<T, T>,
-    MatrixConstReference<T>,
+    XprMatrix<MatrixConstReference<T> >,
     XprLiteral<T>
   >
 >
@@ -239,15 +341,15 @@ inline										\
 XprMatrix<									\
   XprBinOp<									\
     Fcnl_##NAME<T1, T2>,							\
-    MatrixConstReference<T1>,					\
-    MatrixConstReference<T2>					\
+    XprMatrix<MatrixConstReference<T1> >,					\
+    XprMatrix<MatrixConstReference<T2> >					\
   >								\
 >										\
 NAME(const Matrix<T1>& lhs, const Matrix<T2>& rhs) {	\
   typedef XprBinOp <								\
     Fcnl_##NAME<T1, T2>,							\
-    MatrixConstReference<T1>,					\
-    MatrixConstReference<T2>					\
+    XprMatrix<MatrixConstReference<T1> >,					\
+    XprMatrix<MatrixConstReference<T2> >					\
   >							expr_type;		\
   return XprMatrix<expr_type>(					\
     expr_type(lhs.as_expr(), rhs.as_expr()));				\
@@ -258,15 +360,15 @@ inline										\
 XprMatrix<									\
   XprBinOp<									\
     Fcnl_##NAME<typename E::value_type, T>,					\
-    MatrixConstReference<T>,					\
-    XprMatrix<E>							\
+    XprMatrix<E>,							\
+    XprMatrix<MatrixConstReference<T> >						\
   >								\
 >										\
 NAME(const XprMatrix<E>& lhs, const Matrix<T>& rhs) {	\
   typedef XprBinOp<								\
     Fcnl_##NAME<typename E::value_type, T>,					\
     XprMatrix<E>,							\
-    MatrixConstReference<T>						\
+    XprMatrix<MatrixConstReference<T> >						\
   > 							 expr_type;		\
   return XprMatrix<expr_type>(					\
     expr_type(lhs, rhs.as_expr()));						\
@@ -277,14 +379,14 @@ inline										\
 XprMatrix<									\
   XprBinOp<									\
     Fcnl_##NAME<T, typename E::value_type>,					\
-    MatrixConstReference<T>,					\
+    XprMatrix<MatrixConstReference<T> >,					\
     XprMatrix<E>							\
   >								\
 >										\
 NAME(const Matrix<T>& lhs, const XprMatrix<E>& rhs) {	\
   typedef XprBinOp<								\
     Fcnl_##NAME<T, typename E::value_type>,					\
-    MatrixConstReference<T>,					\
+    XprMatrix<MatrixConstReference<T> >,					\
     XprMatrix<E>							\
   > 						 	expr_type;		\
   return XprMatrix<expr_type>(					\
@@ -313,14 +415,14 @@ inline									\
 XprMatrix<								\
   XprBinOp<								\
     Fcnl_##NAME<T, TP >,						\
-    MatrixConstReference<T>,				\
+    XprMatrix<MatrixConstReference<T> >,				\
     XprLiteral< TP >							\
   >							\
 >									\
 NAME(const Matrix<T>& lhs, TP rhs) {			\
   typedef XprBinOp<							\
     Fcnl_##NAME<T, TP >,						\
-    MatrixConstReference<T>,				\
+    XprMatrix<MatrixConstReference<T> >,				\
     XprLiteral< TP >							\
   >							expr_type;	\
   return XprMatrix<expr_type>(				\
@@ -374,6 +476,156 @@ TVMET_IMPLEMENT_MACRO(pow, long double)
 #undef TVMET_IMPLEMENT_MACRO
 
 
+/*
+ * binary_function(POD, Matrix<T>)
+ */
+#define TVMET_IMPLEMENT_MACRO(NAME, TP)					\
+template<class T>			\
+inline									\
+XprMatrix<								\
+  XprBinOp<								\
+    Fcnl_##NAME<TP, T >,						\
+    XprLiteral< TP >,							\
+    XprMatrix<MatrixConstReference<T> >				\
+  >							\
+>									\
+NAME(TP lhs, const Matrix<T>& rhs) {			\
+  typedef XprBinOp<							\
+    Fcnl_##NAME<TP, T >,						\
+    XprLiteral< TP >,							\
+    XprMatrix<MatrixConstReference<T> >				\
+  >							expr_type;	\
+  return XprMatrix<expr_type>(				\
+    expr_type(XprLiteral< TP >(lhs), rhs.as_expr()));			\
+}
+
+TVMET_IMPLEMENT_MACRO(atan2, int)
+TVMET_IMPLEMENT_MACRO(fmod, int)
+TVMET_IMPLEMENT_MACRO(hypot, int)
+TVMET_IMPLEMENT_MACRO(pow, int)
+
+TVMET_IMPLEMENT_MACRO(atan2, float)
+TVMET_IMPLEMENT_MACRO(fmod, float)
+TVMET_IMPLEMENT_MACRO(hypot, float)
+TVMET_IMPLEMENT_MACRO(pow, float)
+
+TVMET_IMPLEMENT_MACRO(atan2, double)
+TVMET_IMPLEMENT_MACRO(fmod, double)
+TVMET_IMPLEMENT_MACRO(hypot, double)
+TVMET_IMPLEMENT_MACRO(pow, double)
+
+#undef TVMET_IMPLEMENT_MACRO
+
+
+/*
+ * cwiseMin/cwiseMax(Matrix<T1>, Matrix<T2>)
+ * cwiseMin/cwiseMax(XprMatrix<E>, Matrix<T>)
+ * cwiseMin/cwiseMax(Matrix<T>, XprMatrix<E>)
+ * cwiseMin/cwiseMax(Matrix<T>, T)
+ * cwiseMin/cwiseMax(T, Matrix<T>)
+ */
+#define TVMET_IMPLEMENT_MACRO(NAME, FCNL)				\
+template<class T1, class T2>		\
+inline									\
+XprMatrix<								\
+  XprBinOp<								\
+    Fcnl_##FCNL<T1, T2>,						\
+    XprMatrix<MatrixConstReference<T1> >,				\
+    XprMatrix<MatrixConstReference<T2> >				\
+  >							\
+>									\
+NAME(const Matrix<T1>& lhs, const Matrix<T2>& rhs) {	\
+  typedef XprBinOp<							\
+    Fcnl_##FCNL<T1, T2>,						\
+    XprMatrix<MatrixConstReference<T1> >,				\
+    XprMatrix<MatrixConstReference<T2> >				\
+  >							expr_type;	\
+  return XprMatrix<expr_type>(				\
+    expr_type(lhs.as_expr(), rhs.as_expr()));				\
+}									\
+									\
+template<class E, class T>		\
+inline									\
+XprMatrix<								\
+  XprBinOp<								\
+    Fcnl_##FCNL<typename E::value_type, T>,				\
+    XprMatrix<E>,						\
+    XprMatrix<MatrixConstReference<T> >				\
+  >							\
+>									\
+NAME(const XprMatrix<E>& lhs, const Matrix<T>& rhs) {	\
+  typedef XprBinOp<							\
+    Fcnl_##FCNL<typename E::value_type, T>,				\
+    XprMatrix<E>,						\
+    XprMatrix<MatrixConstReference<T> >				\
+  >							expr_type;	\
+  return XprMatrix<expr_type>(				\
+    expr_type(lhs, rhs.as_expr()));					\
+}									\
+									\
+template<class E, class T>		\
+inline									\
+XprMatrix<								\
+  XprBinOp<								\
+    Fcnl_##FCNL<T, typename E::value_type>,				\
+    XprMatrix<MatrixConstReference<T> >,				\
+    XprMatrix<E>						\
+  >							\
+>									\
+NAME(const Matrix<T>& lhs, const XprMatrix<E>& rhs) {	\
+  typedef XprBinOp<							\
+    Fcnl_##FCNL<T, typename E::value_type>,				\
+    XprMatrix<MatrixConstReference<T> >,				\
+    XprMatrix<E>						\
+  >							expr_type;	\
+  return XprMatrix<expr_type>(				\
+    expr_type(lhs.as_expr(), rhs));					\
+}									\
+									\
+template<class T>			\
+inline									\
+XprMatrix<								\
+  XprBinOp<								\
+    Fcnl_##FCNL<T, T>,							\
+    XprMatrix<MatrixConstReference<T> >,				\
+    XprLiteral<T>							\
+  >							\
+>									\
+NAME(const Matrix<T>& lhs, typename Matrix<T>::value_type rhs) {	\
+  typedef XprBinOp<							\
+    Fcnl_##FCNL<T, T>,							\
+    XprMatrix<MatrixConstReference<T> >,				\
+    XprLiteral<T>							\
+  >							expr_type;	\
+  return XprMatrix<expr_type>(				\
+    expr_type(lhs.as_expr(), XprLiteral<T>(rhs)));			\
+}									\
+									\
+template<class T>			\
+inline									\
+XprMatrix<								\
+  XprBinOp<								\
+    Fcnl_##FCNL<T, T>,							\
+    XprLiteral<T>,							\
+    XprMatrix<MatrixConstReference<T> >				\
+  >							\
+>									\
+NAME(typename Matrix<T>::value_type lhs, const Matrix<T>& rhs) {	\
+  typedef XprBinOp<							\
+    Fcnl_##FCNL<T, T>,							\
+    XprLiteral<T>,							\
+    XprMatrix<MatrixConstReference<T> >				\
+  >							expr_type;	\
+  return XprMatrix<expr_type>(				\
+    expr_type(XprLiteral<T>(lhs), rhs.as_expr()));			\
+}
+
+TVMET_IMPLEMENT_MACRO(cwiseMin, min)
+TVMET_IMPLEMENT_MACRO(cwiseMax, max)
+
+#undef TVMET_IMPLEMENT_MACRO
+
+
 /*
  * complex math
  */
@@ -388,14 +640,14 @@ inline
 XprMatrix<
   XprBinOp<
     Fcnl_pow<T, std::complex<T> >,
-    MatrixConstReference<T>,
+    XprMatrix<MatrixConstReference<T> >,
     XprLiteral< std::complex<T> >
   >
 >
 pow(const Matrix<T>& lhs, const std::complex<T>& rhs) {
   typedef XprBinOp<
     Fcnl_pow<T, std::complex<T> >,
-    MatrixConstReference<T>,
+    XprMatrix<MatrixConstReference<T> >,
     XprLiteral< std::complex<T> >
   >							expr_type;
   return XprMatrix<expr_type>(
@@ -412,14 +664,14 @@ inline
 XprMatrix<
   XprBinOp<
     Fcnl_pow< std::complex<T>, std::complex<T> >,
-    MatrixConstReference<std::complex<T>>,
+    XprMatrix<MatrixConstReference<std::complex<T> > >,
     XprLiteral< std::complex<T> >
   >
 >
 pow(const Matrix<std::complex<T>>& lhs, const std::complex<T>& rhs) {
   typedef XprBinOp<
     Fcnl_pow< std::complex<T>, std::complex<T> >,
-    MatrixConstReference<std::complex<T>>,
+    XprMatrix<MatrixConstReference<std::complex<T> > >,
     XprLiteral< std::complex<T> >
   >							expr_type;
   return XprMatrix<expr_type>(
@@ -436,14 +688,14 @@ inline
 XprMatrix<
   XprBinOp<
     Fcnl_pow<std::complex<T>, T>,
-    MatrixConstReference<std::complex<T>>,
+    XprMatrix<MatrixConstReference<std::complex<T> > >,
     XprLiteral<T>
   >
 >
 pow(const Matrix<std::complex<T>>& lhs, const T& rhs) {
   typedef XprBinOp<
     Fcnl_pow<std::complex<T>, T>,
-    MatrixConstReference<std::complex<T>>,
+    XprMatrix<MatrixConstReference<std::complex<T> > >,
     XprLiteral<T>
   >							expr_type;
   return XprMatrix<expr_type>(
@@ -460,14 +712,14 @@ inline
 XprMatrix<
   XprBinOp<
     Fcnl_pow<std::complex<T>, int>,
-    MatrixConstReference<std::complex<T>>,
+    XprMatrix<MatrixConstReference<std::complex<T> > >,
     XprLiteral<int>
   >
 >
 pow(const Matrix<std::complex<T>>& lhs, int rhs) {
   typedef XprBinOp<
     Fcnl_pow<std::complex<T>, int>,
-    MatrixConstReference<std::complex<T>>,
+    XprMatrix<MatrixConstReference<std::complex<T> > >,
     XprLiteral<int>
   >							expr_type;
   return XprMatrix<expr_type>(
@@ -484,14 +736,14 @@ inline
 XprMatrix<
   XprBinOp<
     Fcnl_polar<T, T>,
-    MatrixConstReference<T>,
+    XprMatrix<MatrixConstReference<T> >,
     XprLiteral<T>
   >
 >
 polar(const Matrix<T>& lhs, const T& rhs) {
   typedef XprBinOp<
     Fcnl_polar<T, T>,
-    MatrixConstReference<T>,
+    XprMatrix<MatrixConstReference<T> >,
     XprLiteral<T>
   >							expr_type;
   return XprMatrix<expr_type>(
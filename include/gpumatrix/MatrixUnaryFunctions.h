@@ -40,7 +40,7 @@ inline								\
 XprMatrix<							\
   XprUnOp<							\
     Fcnl_##NAME<T>,						\
-    MatrixConstReference<T>				\
+    XprMatrix<MatrixConstReference<T> >				\
   >							\
 >								\
 NAME(const Matrix<T>& rhs) TVMET_CXX_ALWAYS_INLINE;
@@ -100,7 +100,7 @@ inline										\
 XprMatrix<									\
   XprUnOp<									\
     Fcnl_##NAME< std::complex<T> >,						\
-    MatrixConstReference<std::complex<T>>				\
+    XprMatrix<MatrixConstReference<std::complex<T> > >				\
   >									\
 >										\
 NAME(const Matrix<std::complex<T>>& rhs) TVMET_CXX_ALWAYS_INLINE;
@@ -130,13 +130,13 @@ inline									\
 XprMatrix<								\
   XprUnOp<								\
     Fcnl_##NAME<T>,							\
-    MatrixConstReference<T>					\
+    XprMatrix<MatrixConstReference<T> >					\
   >							\
 >									\
 NAME(const Matrix<T>& rhs) {				\
   typedef XprUnOp<							\
     Fcnl_##NAME<T>,							\
-    MatrixConstReference<T>					\
+    XprMatrix<MatrixConstReference<T> >					\
   > 							expr_type;	\
   return XprMatrix<expr_type>(expr_type(rhs.as_expr()));	\
 }
@@ -196,13 +196,13 @@ inline									\
 XprMatrix<								\
   XprUnOp<								\
     Fcnl_##NAME< std::complex<T> >,					\
-    MatrixConstReference<std::complex<T>>			\
+    XprMatrix<MatrixConstReference<std::complex<T> > >			\
   >							\
 >									\
 NAME(const Matrix<std::complex<T>>& rhs) {			\
   typedef XprUnOp<							\
     Fcnl_##NAME< std::complex<T> >,					\
-    MatrixConstReference<std::complex<T>>			\
+    XprMatrix<MatrixConstReference<std::complex<T> > >			\
   > 							expr_type;	\
   return XprMatrix<expr_type>(expr_type(rhs.as_expr()));	\
 }
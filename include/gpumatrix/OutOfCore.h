@@ -0,0 +1,301 @@
+#ifndef GPUMATRIX_OUT_OF_CORE_H
+#define GPUMATRIX_OUT_OF_CORE_H
+
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <Eigen/Core>
+
+#include <gpumatrix/impl/backend/LaunchInterface.h>
+#include <gpumatrix/impl/backend/OutOfCoreInterface.h>
+
+/*
+* Products too large for the device. C = A*B is cut into tiles of
+* rows x cols, and the depth into panels, so each step needs a rows x
+* depth tile of A and a depth x cols tile of B on the device next to the
+* C tile it accumulates into. Two slots of A and B tiles let the next
+* step upload while the current one multiplies; a C tile goes back to the
+* host once its last panel is in. The operands stay on the host, in
+* memory or memory mapped (see StorageFile::map), and are only read a
+* tile at a time.
+*/
+
+namespace gpumatrix
+{
+	/**
+	* \class OutOfCorePlan OutOfCore.h "gpumatrix/OutOfCore.h"
+	* \brief Tile sizes of an out of core product.
+	*/
+	struct OutOfCorePlan
+	{
+		std::size_t rows;		/**< Rows of the C and A tiles. */
+		std::size_t cols;		/**< Columns of the C and B tiles. */
+		std::size_t depth;		/**< Columns of A tiles, rows of B tiles. */
+
+		/** Entries held on the device: one C tile and two slots of A and B tiles. */
+		std::size_t footprint() const { return rows*cols + 2*(rows*depth + depth*cols); }
+	};
+
+	/** The largest tiles of an m x k times k x n product whose footprint
+	fits in bytes. The depth is that of square tiles filling the budget,
+	the C tile is then as large and as square as the rest allows, clipped
+	to the product and grown along n when m is short. */
+	template <class T>
+	OutOfCorePlan out_of_core_plan(std::size_t m, std::size_t n, std::size_t k, std::size_t bytes)
+	{
+		std::size_t budget = bytes/sizeof(T);
+		if (budget < 5)
+			throw std::runtime_error("Device Memory too Small for Out Of Core Product");
+
+		m = m ? m : 1;
+		n = n ? n : 1;
+		k = k ? k : 1;
+
+		// square tiles of side t take 5 t^2
+		std::size_t t = (std::size_t)std::sqrt(double(budget/5));
+		while ((t + 1)*(t + 1)*5 <= budget)
+			t++;
+		while (t*t*5 > budget)
+			t--;
+
+		OutOfCorePlan plan;
+		plan.depth = k < t ? k : t;
+
+		// square C tile of side w next to depth d takes w^2 + 4 w d
+		std::size_t d = plan.depth;
+		std::size_t w = (std::size_t)(std::sqrt(4.0*d*d + double(budget)) - 2.0*d);
+		while ((w + 1)*(w + 1 + 4*d) <= budget)
+			w++;
+		while (w*(w + 4*d) > budget)
+			w--;
+		plan.rows = m < w ? m : w;
+
+		std::size_t c = (budget - 2*plan.rows*d)/(plan.rows + 2*d);
+		plan.cols = n < c ? n : c;
+
+		// impl::gemm takes int dimensions
+		if (plan.rows > impl::Index32Max) plan.rows = impl::Index32Max;
+		if (plan.cols > impl::Index32Max) plan.cols = impl::Index32Max;
+		if (plan.depth > impl::Index32Max) plan.depth = impl::Index32Max;
+
+		return plan;
+	}
+
+	namespace impl
+	{
+		/** C = A*B, m x k times k x n, all column major on the host, through
+		the device dev. dev has load(), multiply() and store() as in
+		OutOfCoreInterface.h and tiles of plan. Steps run over the C tiles,
+		and over the panels of the depth within each tile; the step after the
+		current one is loaded before the current one is multiplied. */
+		template <class T, class Device>
+		void out_of_core_gemm(Device & dev, const OutOfCorePlan & plan, std::size_t m, std::size_t n, std::size_t k,
+			const T * A, std::size_t lda, const T * B, std::size_t ldb, T * C, std::size_t ldc)
+		{
+			if (m == 0 || n == 0)
+				return;
+
+			if (k == 0)
+			{
+				for (std::size_t j = 0; j < n; j++)
+					std::memset(C + j*ldc,0,m*sizeof(T));
+				return;
+			}
+
+			std::size_t mt = (m + plan.rows - 1)/plan.rows;
+			std::size_t nt = (n + plan.cols - 1)/plan.cols;
+			std::size_t kt = (k + plan.depth - 1)/plan.depth;
+			std::size_t steps = mt*nt*kt;
+
+			struct Step
+			{
+				std::size_t i, j, p, rows, cols, depth;
+			};
+
+			Step step[2];
+			std::size_t tile_rows = plan.rows, tile_cols = plan.cols, tile_depth = plan.depth;
+
+			// the tiles of step s, held in slot s%2
+			auto locate = [&](std::size_t s) {
+				Step & t = step[s%2];
+				std::size_t tile = s/kt;
+				t.i = (tile%mt)*tile_rows;
+				t.j = (tile/mt)*tile_cols;
+				t.p = (s%kt)*tile_depth;
+				t.rows = m - t.i < tile_rows ? m - t.i : tile_rows;
+				t.cols = n - t.j < tile_cols ? n - t.j : tile_cols;
+				t.depth = k - t.p < tile_depth ? k - t.p : tile_depth;
+				dev.load(int(s%2),A + t.i + t.p*lda,lda,B + t.p + t.j*ldb,ldb,t.rows,t.cols,t.depth);
+			};
+
+			locate(0);
+			for (std::size_t s = 0; s < steps; s++)
+			{
+				if (s + 1 < steps)
+					locate(s + 1);
+
+				const Step & t = step[s%2];
+				dev.multiply(int(s%2),t.rows,t.cols,t.depth,t.p != 0);
+
+				if (t.p + t.depth == k)
+					dev.store(C + t.i + t.j*ldc,ldc,t.rows,t.cols);
+			}
+		}
+
+		/** The device side of out_of_core_gemm on the GPU. */
+		template <class T>
+		class OutOfCoreDevice
+		{
+			OutOfCoreDevice(const OutOfCoreDevice&);
+			OutOfCoreDevice& operator=(const OutOfCoreDevice&);
+
+		public:
+			explicit OutOfCoreDevice(const OutOfCorePlan & plan)
+				: m_state(ooc_begin<T>(plan.rows,plan.cols,plan.depth)) { }
+
+			~OutOfCoreDevice()
+			{
+				if (m_state == 0)
+					return;
+				try { ooc_end<T>(m_state); } catch (...) { }
+			}
+
+			void load(int slot, const T * A, std::size_t lda, const T * B, std::size_t ldb,
+				std::size_t rows, std::size_t cols, std::size_t depth)
+			{
+				ooc_load<T>(m_state,slot,A,lda,B,ldb,rows,cols,depth);
+			}
+
+			void multiply(int slot, std::size_t rows, std::size_t cols, std::size_t depth, bool accumulate)
+			{
+				ooc_multiply<T>(m_state,slot,rows,cols,depth,accumulate);
+			}
+
+			void store(T * C, std::size_t ldc, std::size_t rows, std::size_t cols)
+			{
+				ooc_store<T>(m_state,C,ldc,rows,cols);
+			}
+
+			/** Release the tiles, reporting errors of the pending work. */
+			void end()
+			{
+				void * state = m_state;
+				m_state = 0;
+				ooc_end<T>(state);
+			}
+
+		private:
+			void *		m_state;
+		};
+
+		/** A stand in for the device of out_of_core_gemm: host buffers
+		allocated as the GPU would, refused beyond capacity bytes, and a
+		reference gemm. It keeps the calls in log(), 'L' for load, 'M' for
+		multiply and 'S' for store, and the bytes loaded. */
+		template <class T>
+		class HostOutOfCoreDevice
+		{
+		public:
+			HostOutOfCoreDevice(const OutOfCorePlan & plan, std::size_t capacity) : m_loaded(0)
+			{
+				if (plan.footprint()*sizeof(T) > capacity)
+					throw std::runtime_error("Out Of Core Tiles Exceed Device Memory");
+
+				m_C.resize(plan.rows*plan.cols);
+				for (int s = 0; s < 2; s++)
+				{
+					m_A[s].resize(plan.rows*plan.depth);
+					m_B[s].resize(plan.depth*plan.cols);
+				}
+			}
+
+			void load(int slot, const T * A, std::size_t lda, const T * B, std::size_t ldb,
+				std::size_t rows, std::size_t cols, std::size_t depth)
+			{
+				for (std::size_t j = 0; j < depth; j++)
+					std::memcpy(&m_A[slot][j*rows],A + j*lda,rows*sizeof(T));
+				for (std::size_t j = 0; j < cols; j++)
+					std::memcpy(&m_B[slot][j*depth],B + j*ldb,depth*sizeof(T));
+
+				m_loaded += (rows*depth + depth*cols)*sizeof(T);
+				m_log += 'L';
+			}
+
+			void multiply(int slot, std::size_t rows, std::size_t cols, std::size_t depth, bool accumulate)
+			{
+				for (std::size_t j = 0; j < cols; j++)
+					for (std::size_t i = 0; i < rows; i++)
+					{
+						T c = accumulate ? m_C[i + j*rows] : T(0);
+						for (std::size_t p = 0; p < depth; p++)
+							c += m_A[slot][i + p*rows]*m_B[slot][p + j*depth];
+						m_C[i + j*rows] = c;
+					}
+
+				m_log += 'M';
+			}
+
+			void store(T * C, std::size_t ldc, std::size_t rows, std::size_t cols)
+			{
+				for (std::size_t j = 0; j < cols; j++)
+					std::memcpy(C + j*ldc,&m_C[j*rows],rows*sizeof(T));
+
+				m_log += 'S';
+			}
+
+			const std::string & log() const { return m_log; }
+
+			std::size_t loadedBytes() const { return m_loaded; }
+
+		private:
+			std::vector<T>		m_C;
+			std::vector<T>		m_A[2];
+			std::vector<T>		m_B[2];
+			std::string			m_log;
+			std::size_t			m_loaded;
+		};
+	}
+
+	/** C = A*B for host operands, A and B in memory or memory mapped, in
+	tiles that fit bytes of device memory; 0 takes three quarters of what is
+	free. All three must be column major with unit inner stride, C is
+	resized to the product, and only C is ever whole in host memory. */
+	template <class DA, class DB, class DC>
+	void outOfCoreProduct(const Eigen::MatrixBase<DA> & A, const Eigen::MatrixBase<DB> & B, const Eigen::MatrixBase<DC> & C_, std::size_t bytes = 0)
+	{
+		typedef typename DC::Scalar T;
+
+		static_assert(!(DA::Flags & Eigen::RowMajorBit) && !(DB::Flags & Eigen::RowMajorBit) && !(DC::Flags & Eigen::RowMajorBit),
+			"outOfCoreProduct takes column major operands");
+		static_assert((DA::Flags & Eigen::DirectAccessBit) && (DB::Flags & Eigen::DirectAccessBit) && (DC::Flags & Eigen::DirectAccessBit),
+			"outOfCoreProduct takes operands in memory");
+
+		Eigen::MatrixBase<DC> & C = const_cast<Eigen::MatrixBase<DC> &>(C_);
+
+		if (A.cols() != B.rows())
+			throw std::runtime_error("Dimension not Match for Out Of Core Product");
+
+		std::size_t m = A.rows(), n = B.cols(), k = A.cols();
+		if ((std::size_t)C.rows() != m || (std::size_t)C.cols() != n)
+			C.derived().resize(m,n);
+
+		if (A.innerStride() != 1 || B.innerStride() != 1 || C.innerStride() != 1)
+			throw std::runtime_error("Out Of Core Product Needs Unit Inner Stride");
+
+		if (bytes == 0)
+			bytes = impl::device_free_bytes()/4*3;
+
+		OutOfCorePlan plan = out_of_core_plan<T>(m,n,k,bytes);
+
+		impl::OutOfCoreDevice<T> dev(plan);
+		impl::out_of_core_gemm<T>(dev,plan,m,n,k,A.derived().data(),A.outerStride(),
+			B.derived().data(),B.outerStride(),C.derived().data(),C.outerStride());
+		dev.end();
+	}
+}
+
+#endif
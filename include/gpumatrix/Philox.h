@@ -0,0 +1,81 @@
+#ifndef GPUMATRIX_PHILOX_H
+#define GPUMATRIX_PHILOX_H
+
+#if !defined(GPUMATRIX_HOST_DEVICE)
+#  if defined(__CUDACC__)
+#    define GPUMATRIX_HOST_DEVICE __host__ __device__
+#  else
+#    define GPUMATRIX_HOST_DEVICE
+#  endif
+#endif
+
+
+namespace gpumatrix
+{
+	namespace impl
+	{
+		/**
+		* \class Philox4x32 Philox.h "gpumatrix/Philox.h"
+		* \brief Philox4x32-10 counter based generator (Salmon et al., SC'11).
+		*
+		* The output is a pure function of (key, counter), so element i of a
+		* random matrix can be produced by any thread in any order and the
+		* result does not depend on the launch configuration.
+		*/
+		struct Philox4x32
+		{
+			unsigned int v[4];
+
+			GPUMATRIX_HOST_DEVICE static unsigned int mulhilo(unsigned int a, unsigned int b, unsigned int & hi)
+			{
+				unsigned long long p = (unsigned long long)a * b;
+				hi = (unsigned int)(p >> 32);
+				return (unsigned int)p;
+			}
+
+			GPUMATRIX_HOST_DEVICE Philox4x32(unsigned long long counter, unsigned long long key)
+			{
+				v[0] = (unsigned int)counter;
+				v[1] = (unsigned int)(counter >> 32);
+				v[2] = 0;
+				v[3] = 0;
+
+				unsigned int k0 = (unsigned int)key;
+				unsigned int k1 = (unsigned int)(key >> 32);
+
+				for (int r = 0; r < 10; ++r)
+				{
+					unsigned int hi0, hi1;
+					unsigned int lo0 = mulhilo(0xD2511F53u, v[0], hi0);
+					unsigned int lo1 = mulhilo(0xCD9E8D57u, v[2], hi1);
+
+					v[0] = hi1 ^ v[1] ^ k0;
+					v[1] = lo1;
+					v[2] = hi0 ^ v[3] ^ k1;
+					v[3] = lo0;
+
+					k0 += 0x9E3779B9u;
+					k1 += 0xBB67AE85u;
+				}
+			}
+		};
+
+		/** Values drawn from one Philox block: 32 bits per float, 64 per double. */
+		template <typename T> struct PhiloxValuesPerBlock { enum { value = 4 }; };
+		template <> struct PhiloxValuesPerBlock<double> { enum { value = 2 }; };
+
+		/** [0,1) with 24 bits. */
+		GPUMATRIX_HOST_DEVICE inline float philox_unit_float(unsigned int x)
+		{
+			return (x >> 8) * (1.0f / 16777216.0f);
+		}
+
+		/** [0,1) with 53 bits. */
+		GPUMATRIX_HOST_DEVICE inline double philox_unit_double(unsigned int lo, unsigned int hi)
+		{
+			return ((hi >> 5) * 67108864.0 + (lo >> 6)) * (1.0 / 9007199254740992.0);
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,157 @@
+#ifndef GPUMATRIX_QR_H
+#define GPUMATRIX_QR_H
+
+#include <stdexcept>
+
+#include <gpumatrix/Matrix.h>
+#include <gpumatrix/Vector.h>
+
+namespace gpumatrix
+{
+	/**
+	* \class HouseholderQR QR.h "gpumatrix/QR.h"
+	* \brief A = Q*R by blocked Householder reflections, as
+	* Eigen::HouseholderQR; solve() is the least squares solution of an
+	* m x n system with m >= n and full column rank.
+	*
+	* impl::geqrf gathers each panel of reflectors into compact WY form,
+	* so the trailing updates and the application of Q^T in solve() run
+	* through impl::gemm.
+	*/
+	template <class T>
+	class HouseholderQR
+	{
+	public:
+		typedef T		value_type;
+
+		HouseholderQR() { }
+
+		explicit HouseholderQR(const Matrix<T> & A)
+		{
+			compute(A);
+		}
+
+		HouseholderQR & compute(const Matrix<T> & A)
+		{
+			m_qr = A;
+			m_hCoeffs.resize(A.rows() < A.cols() ? A.rows() : A.cols());
+			impl::geqrf(m_qr.rows(),m_qr.cols(),m_qr.data(),m_qr.rows(),m_hCoeffs.data());
+
+			return *this;
+		}
+
+		/** R on and above the diagonal, the Householder vectors below it. */
+		const Matrix<T> & matrixQR() const { return m_qr; }
+
+		/** The scalars of the Householder reflectors. */
+		const Vector<T> & hCoeffs() const { return m_hCoeffs; }
+
+		/** X minimising the norm of A*X - B, column by column. */
+		Matrix<T> solve(const Matrix<T> & B) const
+		{
+			check_solve(B.rows());
+
+			int m = m_qr.rows(), n = m_qr.cols();
+			Matrix<T> C(B);
+			impl::ormqr('T',m,C.cols(),n,m_qr.data(),m,m_hCoeffs.data(),C.data(),m);
+			impl::trsm('L','U','N','N',n,C.cols(),T(1),m_qr.data(),m,C.data(),m);
+
+			Matrix<T> X(n,C.cols());
+			impl::copy2d(X.data(),n,C.data(),m,n,C.cols());
+			return X;
+		}
+
+		template <class E>
+		Matrix<T> solve(const XprMatrix<E> & B) const
+		{
+			return solve(Matrix<T>(B));
+		}
+
+		/** x minimising the norm of A*x - b. */
+		Vector<T> solve(const Vector<T> & b) const
+		{
+			check_solve(b.size());
+
+			int m = m_qr.rows(), n = m_qr.cols();
+			Vector<T> c(b);
+			impl::ormqr('T',m,1,n,m_qr.data(),m,m_hCoeffs.data(),c.data(),m);
+			impl::trsv('U','N','N',n,m_qr.data(),m,c.data(),1);
+
+			Vector<T> x(n);
+			impl::copy(x.data(),c.data(),n);
+			return x;
+		}
+
+		template <class E>
+		Vector<T> solve(const XprVector<E> & b) const
+		{
+			return solve(Vector<T>(b));
+		}
+
+	private:
+		void check_solve(std::size_t rows) const
+		{
+			if (m_qr.rows() < m_qr.cols())
+				throw std::runtime_error("Least Squares needs Rows >= Cols");
+			if (rows != m_qr.rows())
+				throw std::runtime_error("Dimension not Match for QR Solve");
+		}
+
+	private:
+		Matrix<T>					m_qr;
+		Vector<T>					m_hCoeffs;
+	};
+
+	/** R (n x n, upper triangular) of the m x n, m >= n, A = Q*R by tall
+	skinny QR: row blocks of block_rows rows (0 for 65536) are factored on
+	their own, then the stacked R factors. Q is not formed. */
+	template <class T>
+	Matrix<T> tsqr(const Matrix<T> & A, std::size_t block_rows = 0)
+	{
+		if (A.rows() < A.cols())
+			throw std::runtime_error("Least Squares needs Rows >= Cols");
+
+		int n = A.cols();
+		Matrix<T> R(n,n);
+		impl::tsqr(A.rows(),n,A.data(),A.rows(),0,(const T *)0,A.rows(),R.data(),n,(T *)0,n,
+			block_rows ? (int)block_rows : 65536);
+		return R;
+	}
+
+	/** X minimising the norm of A*X - B by tall skinny QR; Q^T*B is
+	accumulated block by block, so Q is never formed. */
+	template <class T>
+	Matrix<T> tsqr_solve(const Matrix<T> & A, const Matrix<T> & B, std::size_t block_rows = 0)
+	{
+		if (A.rows() < A.cols())
+			throw std::runtime_error("Least Squares needs Rows >= Cols");
+		if (B.rows() != A.rows())
+			throw std::runtime_error("Dimension not Match for QR Solve");
+
+		int n = A.cols(), nrhs = B.cols();
+		Matrix<T> R(n,n), X(n,nrhs);
+		impl::tsqr(A.rows(),n,A.data(),A.rows(),nrhs,B.data(),B.rows(),R.data(),n,X.data(),n,
+			block_rows ? (int)block_rows : 65536);
+		impl::trsm('L','U','N','N',n,nrhs,T(1),R.data(),n,X.data(),n);
+		return X;
+	}
+
+	template <class T>
+	Vector<T> tsqr_solve(const Matrix<T> & A, const Vector<T> & b, std::size_t block_rows = 0)
+	{
+		if (A.rows() < A.cols())
+			throw std::runtime_error("Least Squares needs Rows >= Cols");
+		if (b.size() != A.rows())
+			throw std::runtime_error("Dimension not Match for QR Solve");
+
+		int n = A.cols();
+		Matrix<T> R(n,n);
+		Vector<T> x(n);
+		impl::tsqr(A.rows(),n,A.data(),A.rows(),1,b.data(),b.size(),R.data(),n,x.data(),n,
+			block_rows ? (int)block_rows : 65536);
+		impl::trsv('U','N','N',n,R.data(),n,x.data(),1);
+		return x;
+	}
+}
+
+#endif
@@ -0,0 +1,70 @@
+#ifndef GPUMATRIX_RANDOM_H
+#define GPUMATRIX_RANDOM_H
+
+#include <atomic>
+#include <cstddef>
+
+#include <gpumatrix/impl/backend/RandomInterface.h>
+
+namespace gpumatrix
+{
+	/**
+	* Position in the process-wide Philox stream. Every random matrix takes
+	* the next unused counter range, so re-seeding and repeating the same
+	* sequence of calls gives bit-identical matrices. The range is reserved
+	* atomically: threads drawing at the same time get disjoint ranges, in
+	* an order that depends on scheduling.
+	*/
+	struct RandomState
+	{
+		std::atomic<unsigned long long> seed;
+		std::atomic<unsigned long long> offset;
+	};
+
+	inline RandomState & default_random_state()
+	{
+		static RandomState state = { {0}, {0} };
+		return state;
+	}
+
+	inline void set_random_seed(unsigned long long seed)
+	{
+		default_random_state().seed = seed;
+		default_random_state().offset = 0;
+	}
+
+	namespace impl
+	{
+		/** Reserve the Philox blocks for size values of type T and return the first one. */
+		template <typename T>
+		unsigned long long next_random_offset(std::size_t size)
+		{
+			const std::size_t K = PhiloxValuesPerBlock<T>::value;
+
+			return default_random_state().offset.fetch_add((size + K - 1)/K);
+		}
+
+		template <typename T>
+		void fill_uniform(T * data, std::size_t size, T low, T high)
+		{
+			unsigned long long offset = next_random_offset<T>(size);
+			impl::random_uniform(data,size,low,high,default_random_state().seed,offset);
+		}
+
+		template <typename T>
+		void fill_normal(T * data, std::size_t size, T mean, T stddev)
+		{
+			unsigned long long offset = next_random_offset<T>(size);
+			impl::random_normal(data,size,mean,stddev,default_random_state().seed,offset);
+		}
+
+		template <typename T>
+		void fill_bernoulli(T * data, std::size_t size, T p)
+		{
+			unsigned long long offset = next_random_offset<T>(size);
+			impl::random_bernoulli(data,size,p,default_random_state().seed,offset);
+		}
+	}
+}
+
+#endif
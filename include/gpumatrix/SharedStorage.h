@@ -0,0 +1,156 @@
+#ifndef GPUMATRIX_SHARED_STORAGE_H
+#define GPUMATRIX_SHARED_STORAGE_H
+
+#include <atomic>
+#include <cstddef>
+
+#include <gpumatrix/Context.h>
+#include <gpumatrix/impl/backend/MemoryInterface.h>
+
+/*
+* Device buffer of Matrix, Vector and Array, shared by copies.
+*
+* Copying an object takes a reference to its buffer, so objects pass,
+* return and sit in containers by value without a device copy. The first
+* write through a shared buffer copies it (copy on write): unique() is the
+* only way to a writable pointer, and the other holders keep the old
+* buffer. Assignment keeps a buffer the destination holds alone when it
+* has the right size, so views taken of it stay valid; it shares only a
+* buffer the destination lacks, must resize or already shares.
+*
+* The count is atomic, so copies may be dropped by any thread; a thread
+* that drops a copy another thread still holds calls synchronize() first
+* if it queued work reading it, as for any object handed between threads
+* (see Context.h).
+*/
+
+namespace gpumatrix
+{
+	namespace impl
+	{
+		template <typename T>
+		class SharedStorage
+		{
+			struct Block
+			{
+				explicit Block(std::size_t n) : data(impl::alloc<T>(n)), size(n), refs(1) { }
+
+				T *							data;
+				std::size_t					size;
+				std::atomic<long>			refs;
+			};
+
+		public:
+			SharedStorage() : m_block(0) { }
+
+			SharedStorage(const SharedStorage & rhs) : m_block(rhs.m_block)
+			{
+				if (m_block)
+					m_block->refs.fetch_add(1,std::memory_order_relaxed);
+			}
+
+			SharedStorage & operator=(const SharedStorage & rhs)
+			{
+				if (m_block != rhs.m_block)
+				{
+					SharedStorage copy(rhs);
+					swap(copy);
+				}
+				return *this;
+			}
+
+			~SharedStorage() { release(); }
+
+			void swap(SharedStorage & rhs)
+			{
+				Block * block = m_block;
+				m_block = rhs.m_block;
+				rhs.m_block = block;
+			}
+
+			/** The contents of rhs: copied into this buffer when it is of the
+			same size and held by no one else, shared otherwise. */
+			void assign(const SharedStorage & rhs)
+			{
+				if (m_block == rhs.m_block)
+					return;
+
+				if (m_block && rhs.m_block && m_block->size == rhs.m_block->size
+					&& m_block->refs.load(std::memory_order_acquire) == 1)
+					impl::copy(m_block->data,(const T *)rhs.m_block->data,m_block->size);
+				else
+					*this = rhs;
+			}
+
+			/** A new buffer of size elements, not cleared; the old one is let go. */
+			void reset(std::size_t size)
+			{
+				Block * block = new Block(size);
+				release();
+				m_block = block;
+			}
+
+			/** Let go of the buffer. */
+			void clear() { release(); }
+
+			/** The buffer for reading, null without one. */
+			const T * data() const { return m_block ? m_block->data : 0; }
+
+			/** The buffer for writing, copied first when it is shared. */
+			T * unique()
+			{
+				if (m_block && m_block->refs.load(std::memory_order_acquire) != 1)
+					detach();
+				return m_block ? m_block->data : 0;
+			}
+
+			/** The buffer for writing in full: a shared one is replaced by a new
+			buffer of the same size rather than copied. */
+			T * overwrite()
+			{
+				if (m_block && m_block->refs.load(std::memory_order_acquire) != 1)
+					reset(m_block->size);
+				return m_block ? m_block->data : 0;
+			}
+
+			bool shared() const { return m_block && m_block->refs.load(std::memory_order_acquire) != 1; }
+
+		private:
+			void detach()
+			{
+				Block * block = new Block(m_block->size);
+				try
+				{
+					impl::copy(block->data,(const T *)m_block->data,m_block->size);
+
+					// another thread may write the old buffer as soon as it is
+					// let go, so the copy must be done reading it by then
+					gpumatrix::synchronize();
+				}
+				catch (...)
+				{
+					impl::free(block->data);
+					delete block;
+					throw;
+				}
+				release();
+				m_block = block;
+			}
+
+			void release()
+			{
+				if (m_block && m_block->refs.fetch_sub(1,std::memory_order_acq_rel) == 1)
+				{
+					impl::free(m_block->data);
+					delete m_block;
+				}
+				m_block = 0;
+			}
+
+		private:
+			Block *			m_block;
+		};
+	}
+}
+
+#endif
@@ -0,0 +1,321 @@
+#ifndef GPUMATRIX_SPARSE_MATRIX_H
+#define GPUMATRIX_SPARSE_MATRIX_H
+
+#include <cstddef>
+#include <vector>
+#include <stdexcept>
+
+#include <Eigen/Sparse>
+
+#include <gpumatrix/Matrix.h>
+#include <gpumatrix/Vector.h>
+#include <gpumatrix/xpr/SparseProduct.h>
+
+namespace gpumatrix
+{
+	/** Which dimension a SparseMatrix compresses. */
+	enum SparseFormat
+	{
+		SparseCSR,	/**< compressed rows: outer index per row, column indices */
+		SparseCSC	/**< compressed columns: outer index per column, row indices */
+	};
+
+	template <class T> class SparseMatrixTranspose;
+
+	/**
+	* \class SparseMatrix SparseMatrix.h "gpumatrix/SparseMatrix.h"
+	* \brief A compressed sparse matrix on the device, CSR or CSC.
+	*
+	* Only the compressed arrays are transferred: outerSize()+1 offsets,
+	* nonZeros() inner indices and nonZeros() values. S*M, S.transpose()*M,
+	* M*S, M*S.transpose() and S*v are matrix and vector expressions
+	* evaluated by the kernels of impl/backend/SparseInterface.h.
+	*/
+	template <class T>
+	class SparseMatrix
+	{
+	public:
+		typedef T		value_type;
+
+		SparseMatrix()
+			: m_rows(0), m_cols(0), m_nnz(0), m_format(SparseCSR), m_outer(0), m_inner(0), m_values(0)
+		{
+		}
+
+		/** From compressed host arrays; outer has outer size + 1 entries, outer[0] == 0. */
+		SparseMatrix(std::size_t rows, std::size_t cols, SparseFormat format, const int * outer, const int * inner, const T * values)
+			: m_rows(0), m_cols(0), m_nnz(0), m_format(SparseCSR), m_outer(0), m_inner(0), m_values(0)
+		{
+			upload(rows,cols,format,outer,inner,values);
+		}
+
+		/** Row major Eigen matrices become CSR, column major ones CSC. */
+		template <int Options>
+		SparseMatrix(const Eigen::SparseMatrix<T,Options,int> & S)
+			: m_rows(0), m_cols(0), m_nnz(0), m_format(SparseCSR), m_outer(0), m_inner(0), m_values(0)
+		{
+			SparseFormat format = (Options & Eigen::RowMajor) ? SparseCSR : SparseCSC;
+
+			if (S.isCompressed())
+				upload(S.rows(),S.cols(),format,S.outerIndexPtr(),S.innerIndexPtr(),S.valuePtr());
+			else
+			{
+				Eigen::SparseMatrix<T,Options,int> C(S);
+				C.makeCompressed();
+				upload(C.rows(),C.cols(),format,C.outerIndexPtr(),C.innerIndexPtr(),C.valuePtr());
+			}
+		}
+
+		SparseMatrix(const SparseMatrix & rhs)
+			: m_rows(0), m_cols(0), m_nnz(0), m_format(SparseCSR), m_outer(0), m_inner(0), m_values(0)
+		{
+			*this = rhs;
+		}
+
+		SparseMatrix & operator=(const SparseMatrix & rhs)
+		{
+			if (this == &rhs)
+				return *this;
+
+			resize(rhs.m_rows,rhs.m_cols,rhs.m_format,rhs.m_nnz);
+			impl::copy(m_outer,rhs.m_outer,outerSize() + 1);
+			if (m_nnz > 0)
+			{
+				impl::copy(m_inner,rhs.m_inner,m_nnz);
+				impl::copy(m_values,rhs.m_values,m_nnz);
+			}
+			return *this;
+		}
+
+		~SparseMatrix()
+		{
+			release();
+		}
+
+		std::size_t rows() const { return m_rows; }
+
+		std::size_t cols() const { return m_cols; }
+
+		std::size_t nonZeros() const { return m_nnz; }
+
+		SparseFormat format() const { return m_format; }
+
+		/** Rows for CSR, columns for CSC. */
+		std::size_t outerSize() const { return m_format == SparseCSR ? m_rows : m_cols; }
+
+		std::size_t innerSize() const { return m_format == SparseCSR ? m_cols : m_rows; }
+
+		const int * outerIndexPtr() const { return m_outer; }
+
+		const int * innerIndexPtr() const { return m_inner; }
+
+		const T * valuePtr() const { return m_values; }
+
+		T * valuePtr() { return m_values; }
+
+		SparseMatrixTranspose<T> transpose() const
+		{
+			return SparseMatrixTranspose<T>(*this);
+		}
+
+		template <int Options>
+		operator Eigen::SparseMatrix<T,Options,int> () const
+		{
+			std::vector<int> outer(outerSize() + 1), inner(m_nnz);
+			std::vector<T> values(m_nnz);
+
+			if (m_outer)
+				impl::get(outer.data(),m_outer,outer.size());
+			else
+				outer.assign(outer.size(),0);
+			if (m_nnz > 0)
+			{
+				impl::get(inner.data(),m_inner,m_nnz);
+				impl::get(values.data(),m_values,m_nnz);
+			}
+
+			typedef Eigen::Map<const Eigen::SparseMatrix<T,Eigen::RowMajor,int> > RowMap;
+			typedef Eigen::Map<const Eigen::SparseMatrix<T,Eigen::ColMajor,int> > ColMap;
+
+			Eigen::SparseMatrix<T,Options,int> S;
+			if (m_format == SparseCSR)
+				S = RowMap(m_rows,m_cols,m_nnz,outer.data(),inner.data(),values.data());
+			else
+				S = ColMap(m_rows,m_cols,m_nnz,outer.data(),inner.data(),values.data());
+			return S;
+		}
+
+	private:
+		void upload(std::size_t rows, std::size_t cols, SparseFormat format, const int * outer, const int * inner, const T * values)
+		{
+			std::size_t outer_size = format == SparseCSR ? rows : cols;
+			std::size_t nnz = outer[outer_size] - outer[0];
+
+			if (outer[0] != 0)
+				throw std::runtime_error("Sparse Outer Index donot Start at Zero");
+
+			resize(rows,cols,format,nnz);
+			impl::set(m_outer,outer,outer_size + 1);
+			if (nnz > 0)
+			{
+				impl::set(m_inner,inner,nnz);
+				impl::set(m_values,values,nnz);
+			}
+		}
+
+		void resize(std::size_t rows, std::size_t cols, SparseFormat format, std::size_t nnz)
+		{
+			release();
+
+			m_rows = rows;
+			m_cols = cols;
+			m_format = format;
+			m_nnz = nnz;
+
+			m_outer = impl::alloc<int>(outerSize() + 1);
+			if (nnz > 0)
+			{
+				m_inner = impl::alloc<int>(nnz);
+				m_values = impl::alloc<T>(nnz);
+			}
+		}
+
+		void release()
+		{
+			if (m_outer)
+				impl::free(m_outer);
+			if (m_inner)
+				impl::free(m_inner);
+			if (m_values)
+				impl::free(m_values);
+
+			m_outer = m_inner = 0;
+			m_values = 0;
+			m_rows = m_cols = m_nnz = 0;
+		}
+
+	private:
+		std::size_t				m_rows;
+		std::size_t				m_cols;
+		std::size_t				m_nnz;
+		SparseFormat			m_format;
+		int *					m_outer;
+		int *					m_inner;
+		T *						m_values;
+	};
+
+	/**
+	* \class SparseMatrixTranspose SparseMatrix.h "gpumatrix/SparseMatrix.h"
+	* \brief S.transpose() as a product factor; nothing is moved.
+	*/
+	template <class T>
+	class SparseMatrixTranspose
+	{
+	public:
+		explicit SparseMatrixTranspose(const SparseMatrix<T> & S) : m_sparse(S) { }
+
+		const SparseMatrix<T> & transpose() const { return m_sparse; }
+
+		std::size_t rows() const { return m_sparse.cols(); }
+
+		std::size_t cols() const { return m_sparse.rows(); }
+
+	private:
+		const SparseMatrix<T> &	m_sparse;
+	};
+
+	// S*M, S*v
+	template <class T, class X>
+	inline typename impl::SparseProduct<T, typename impl::SparseOperand<X>::expr_type, SparseTimesDense>::type
+	operator*(const SparseMatrix<T> & S, const X & M)
+	{
+		typedef typename impl::SparseOperand<X>::expr_type					expr_type;
+		typedef XprSparseProduct<T, expr_type, SparseTimesDense>			expr_node;
+		typedef typename impl::SparseProduct<T, expr_type, SparseTimesDense>::type	result_type;
+
+		return result_type(expr_node(S, impl::SparseOperand<X>::as_expr(M)));
+	}
+
+	// S.transpose()*M, S.transpose()*v
+	template <class T, class X>
+	inline typename impl::SparseProduct<T, typename impl::SparseOperand<X>::expr_type, SparseTransposeTimesDense>::type
+	operator*(const SparseMatrixTranspose<T> & St, const X & M)
+	{
+		typedef typename impl::SparseOperand<X>::expr_type					expr_type;
+		typedef XprSparseProduct<T, expr_type, SparseTransposeTimesDense>	expr_node;
+		typedef typename impl::SparseProduct<T, expr_type, SparseTransposeTimesDense>::type	result_type;
+
+		return result_type(expr_node(St.transpose(), impl::SparseOperand<X>::as_expr(M)));
+	}
+
+	// M*S
+	template <class X, class T>
+	inline typename impl::SparseProduct<T, typename impl::MatrixOperand<X>::expr_type, DenseTimesSparse>::type
+	operator*(const X & M, const SparseMatrix<T> & S)
+	{
+		typedef typename impl::MatrixOperand<X>::expr_type					expr_type;
+		typedef XprSparseProduct<T, expr_type, DenseTimesSparse>			expr_node;
+		typedef typename impl::SparseProduct<T, expr_type, DenseTimesSparse>::type	result_type;
+
+		return result_type(expr_node(S, impl::MatrixOperand<X>::as_expr(M)));
+	}
+
+	// M*S.transpose()
+	template <class X, class T>
+	inline typename impl::SparseProduct<T, typename impl::MatrixOperand<X>::expr_type, DenseTimesSparseTranspose>::type
+	operator*(const X & M, const SparseMatrixTranspose<T> & St)
+	{
+		typedef typename impl::MatrixOperand<X>::expr_type					expr_type;
+		typedef XprSparseProduct<T, expr_type, DenseTimesSparseTranspose>	expr_node;
+		typedef typename impl::SparseProduct<T, expr_type, DenseTimesSparseTranspose>::type	result_type;
+
+		return result_type(expr_node(St.transpose(), impl::MatrixOperand<X>::as_expr(M)));
+	}
+
+	namespace impl
+	{
+		// CSC storage of S is the CSR storage of S^T, which flips the transpose
+		template <typename T, int Side>
+		char sparse_trans(const SparseMatrix<T> & S)
+		{
+			bool transposed = Side == SparseTransposeTimesDense || Side == DenseTimesSparseTranspose;
+			return transposed != (S.format() == SparseCSC) ? 'T' : 'N';
+		}
+
+		// Dest = S*M, S.transpose()*M, M*S, M*S.transpose()
+		template <typename T, typename E, int Side, typename Dest,typename Assign> 
+		void eval(Dest& dest, 
+			const XprSparseProduct<T,XprMatrix<E>,Side> & expr, 
+			const Assign& assign_fn)
+		{
+			check_size(dest,expr.rows(),expr.cols());
+
+			typename XprMatrix<E>::result_type M = expr.dense().eval();
+			const SparseMatrix<T> & S = expr.sparse();
+
+			if (XprSparseProduct<T,XprMatrix<E>,Side>::sparse_left)
+				impl::csrmm(sparse_trans<T,Side>(S),expr.rows(),expr.cols(),M.rows(),S.nonZeros(),
+					S.outerIndexPtr(),S.innerIndexPtr(),S.valuePtr(),M.data(),dest.data());
+			else
+				impl::csrmm_right(sparse_trans<T,Side>(S),expr.rows(),expr.cols(),M.cols(),S.nonZeros(),
+					S.outerIndexPtr(),S.innerIndexPtr(),S.valuePtr(),M.data(),dest.data());
+		}
+
+		// Dest = S*v, S.transpose()*v
+		template <typename T, typename E, int Side, typename Dest,typename Assign> 
+		void eval(Dest& dest, 
+			const XprSparseProduct<T,XprVector<E>,Side> & expr, 
+			const Assign& assign_fn)
+		{
+			check_size(dest,expr.size());
+
+			typename XprVector<E>::result_type x = expr.dense().eval();
+			const SparseMatrix<T> & S = expr.sparse();
+
+			impl::csrmv(sparse_trans<T,Side>(S),expr.rows(),x.size(),S.nonZeros(),
+				S.outerIndexPtr(),S.innerIndexPtr(),S.valuePtr(),x.data(),dest.data());
+		}
+	}
+}
+
+#endif
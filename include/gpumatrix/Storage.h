@@ -0,0 +1,419 @@
+#ifndef GPUMATRIX_STORAGE_H
+#define GPUMATRIX_STORAGE_H
+
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+#include <stdexcept>
+
+#include <Eigen/Core>
+
+#include <gpumatrix/Matrix.h>
+#include <gpumatrix/Vector.h>
+#include <gpumatrix/Array.h>
+#include <gpumatrix/Half.h>
+#include <gpumatrix/MappedFile.h>
+
+/*
+* Binary container for many named tensors.
+*
+*   [StorageHeader][payload 0][payload 1]...[StorageRecord x count]
+*
+* Every payload starts on a multiple of the file alignment (a page by
+* default), column major, native byte order. The directory goes last so
+* the writer can stream each tensor out as it is given and only patch the
+* header on close.
+*/
+
+namespace gpumatrix
+{
+	enum StorageType
+	{
+		StorageDouble = 0,
+		StorageFloat = 1,
+		StorageHalf = 2,
+		StorageBFloat16 = 3
+	};
+
+	template <typename T> struct StorageTypeOf;
+	template <> struct StorageTypeOf<double> { enum { value = StorageDouble }; };
+	template <> struct StorageTypeOf<float> { enum { value = StorageFloat }; };
+	template <> struct StorageTypeOf<half> { enum { value = StorageHalf }; };
+	template <> struct StorageTypeOf<bfloat16> { enum { value = StorageBFloat16 }; };
+
+	inline std::size_t storage_type_size(unsigned int dtype)
+	{
+		switch (dtype)
+		{
+		case StorageDouble: return sizeof(double);
+		case StorageFloat: return sizeof(float);
+		case StorageHalf: return sizeof(half);
+		case StorageBFloat16: return sizeof(bfloat16);
+		}
+		throw std::runtime_error("Unknown Storage Type");
+	}
+
+	struct StorageHeader
+	{
+		char magic[8];
+		unsigned int version;
+		unsigned int alignment;
+		unsigned long long count;
+		unsigned long long directory;
+	};
+
+	struct StorageRecord
+	{
+		char name[88];
+		unsigned int dtype;
+		unsigned int rank;
+		unsigned long long rows;
+		unsigned long long cols;
+		unsigned long long offset;
+		unsigned long long bytes;
+
+		std::size_t size() const { return rows*cols; }
+	};
+
+	static const char STORAGE_MAGIC[8] = { 'G','P','U','M','A','T','\0','\1' };
+	static const unsigned int STORAGE_VERSION = 1;
+
+	namespace impl
+	{
+		/** Bytes moved per impl::set / impl::get when streaming a payload. */
+		inline std::size_t & storage_chunk_bytes()
+		{
+			static std::size_t bytes = 16 << 20;
+			return bytes;
+		}
+
+		template <typename T>
+		std::size_t storage_chunk_size()
+		{
+			std::size_t n = storage_chunk_bytes()/sizeof(T);
+			return n > 0 ? n : 1;
+		}
+	}
+
+	inline void set_storage_chunk_bytes(std::size_t bytes)
+	{
+		impl::storage_chunk_bytes() = bytes;
+	}
+
+
+	/**
+	* \class StorageWriter Storage.h "gpumatrix/Storage.h"
+	* \brief Writes named matrices, vectors and arrays into one file.
+	*
+	* Device data is pulled down chunk by chunk, so the host never holds more
+	* than one chunk of a tensor at a time.
+	*/
+	class StorageWriter
+	{
+		StorageWriter(const StorageWriter&);
+		StorageWriter& operator=(const StorageWriter&);
+
+	public:
+		explicit StorageWriter(const std::string & path, std::size_t alignment = 4096)
+			: m_file(std::fopen(path.c_str(),"wb")), m_alignment(alignment), m_position(0)
+		{
+			if (m_file == 0)
+				throw std::runtime_error("Cannot Open " + path);
+
+			if (alignment == 0 || (alignment & (alignment - 1)) != 0)
+			{
+				std::fclose(m_file);
+				throw std::runtime_error("Storage Alignment Must Be A Power Of Two");
+			}
+
+			StorageHeader header = StorageHeader();
+			write_bytes(&header,sizeof(header));
+			m_position = sizeof(header);
+		}
+
+		~StorageWriter()
+		{
+			if (m_file)
+			{
+				try { close(); } catch (...) { }
+			}
+		}
+
+		template <typename T>
+		void write(const std::string & name, const Matrix<T> & m)
+		{
+			write_device(name,m.data(),2,m.rows(),m.cols());
+		}
+
+		template <typename T>
+		void write(const std::string & name, const Vector<T> & v)
+		{
+			write_device(name,v.data(),1,v.size(),1);
+		}
+
+		template <typename T, int D>
+		void write(const std::string & name, const Array<T,D> & a)
+		{
+			write_device(name,a.data(),D,a.rows(),a.cols());
+		}
+
+		/** Host data, column major. */
+		template <typename T>
+		void write(const std::string & name, const T * data, std::size_t rows, std::size_t cols)
+		{
+			StorageRecord & record = begin_record<T>(name,cols == 1 ? 1 : 2,rows,cols);
+			write_bytes(data,record.bytes);
+			m_position += record.bytes;
+		}
+
+		/** Write the directory and the final header. Further writes are errors. */
+		void close()
+		{
+			if (m_file == 0)
+				return;
+
+			pad_to(m_alignment);
+
+			StorageHeader header;
+			std::memcpy(header.magic,STORAGE_MAGIC,sizeof(header.magic));
+			header.version = STORAGE_VERSION;
+			header.alignment = (unsigned int)m_alignment;
+			header.count = m_records.size();
+			header.directory = m_position;
+
+			if (!m_records.empty())
+				write_bytes(&m_records[0],m_records.size()*sizeof(StorageRecord));
+
+			bool ok = std::fseek(m_file,0,SEEK_SET) == 0 && std::fwrite(&header,sizeof(header),1,m_file) == 1;
+			ok = std::fclose(m_file) == 0 && ok;
+			m_file = 0;
+
+			if (!ok)
+				throw std::runtime_error("Storage Write Failed");
+		}
+
+	private:
+		template <typename T>
+		void write_device(const std::string & name, const T * data, unsigned int rank, std::size_t rows, std::size_t cols)
+		{
+			StorageRecord & record = begin_record<T>(name,rank,rows,cols);
+
+			std::size_t size = record.size();
+			std::size_t chunk = impl::storage_chunk_size<T>();
+			std::vector<T> buffer(size < chunk ? size : chunk);
+
+			for (std::size_t i = 0; i < size; i += chunk)
+			{
+				std::size_t n = size - i < chunk ? size - i : chunk;
+				impl::get(&buffer[0],data + i,n);
+				write_bytes(&buffer[0],n*sizeof(T));
+			}
+
+			m_position += record.bytes;
+		}
+
+		template <typename T>
+		StorageRecord & begin_record(const std::string & name, unsigned int rank, std::size_t rows, std::size_t cols)
+		{
+			if (m_file == 0)
+				throw std::runtime_error("Storage Already Closed");
+
+			if (name.empty() || name.size() >= sizeof(((StorageRecord*)0)->name))
+				throw std::runtime_error("Invalid Storage Name " + name);
+
+			for (std::size_t i = 0; i < m_records.size(); ++i)
+				if (name == m_records[i].name)
+					throw std::runtime_error("Duplicate Storage Name " + name);
+
+			pad_to(m_alignment);
+
+			StorageRecord record = StorageRecord();
+			std::strncpy(record.name,name.c_str(),sizeof(record.name) - 1);
+			record.dtype = StorageTypeOf<T>::value;
+			record.rank = rank;
+			record.rows = rows;
+			record.cols = cols;
+			record.offset = m_position;
+			record.bytes = rows*cols*sizeof(T);
+
+			m_records.push_back(record);
+			return m_records.back();
+		}
+
+		void pad_to(std::size_t alignment)
+		{
+			static const char zeros[64] = { 0 };
+
+			std::size_t pad = (alignment - m_position % alignment) % alignment;
+			m_position += pad;
+
+			for (; pad > 0; pad -= pad < sizeof(zeros) ? pad : sizeof(zeros))
+				write_bytes(zeros,pad < sizeof(zeros) ? pad : sizeof(zeros));
+		}
+
+		void write_bytes(const void * data, std::size_t bytes)
+		{
+			if (bytes > 0 && std::fwrite(data,1,bytes,m_file) != bytes)
+				throw std::runtime_error("Storage Write Failed");
+		}
+
+	private:
+		std::FILE *						m_file;
+		std::size_t						m_alignment;
+		unsigned long long				m_position;
+		std::vector<StorageRecord>		m_records;
+	};
+
+
+	/**
+	* \class StorageFile Storage.h "gpumatrix/Storage.h"
+	* \brief Read only, memory mapped view of a file made by StorageWriter.
+	*
+	* Host access through data() and map() is zero copy: it points straight
+	* into the mapping and pages come in on demand. load() streams a payload
+	* into a device buffer a chunk at a time and releases the pages behind
+	* it, so a file larger than host memory still loads.
+	*/
+	class StorageFile
+	{
+		StorageFile(const StorageFile&);
+		StorageFile& operator=(const StorageFile&);
+
+	public:
+		explicit StorageFile(const std::string & path)
+			: m_file(path), m_header(0), m_records(0)
+		{
+			const char * base = m_file.data();
+			std::size_t length = m_file.size();
+
+			m_header = (const StorageHeader *)base;
+
+			if (length < sizeof(StorageHeader) || std::memcmp(m_header->magic,STORAGE_MAGIC,sizeof(STORAGE_MAGIC)) != 0
+				|| m_header->version != STORAGE_VERSION || m_header->directory > length
+				|| m_header->count > (length - m_header->directory)/sizeof(StorageRecord))
+				throw std::runtime_error("Not A Storage File " + path);
+
+			m_records = (const StorageRecord *)(base + m_header->directory);
+
+			for (std::size_t i = 0; i < size(); ++i)
+			{
+				const StorageRecord & r = m_records[i];
+				if (r.name[sizeof(r.name) - 1] != '\0' || r.dtype > StorageBFloat16 || r.offset > length
+					|| r.bytes > length - r.offset || r.bytes != r.size()*storage_type_size(r.dtype))
+					throw std::runtime_error("Corrupt Storage File " + path);
+			}
+		}
+
+		/** Number of tensors. */
+		std::size_t size() const { return m_header->count; }
+
+		std::size_t alignment() const { return m_header->alignment; }
+
+		const StorageRecord & record(std::size_t i) const { return m_records[i]; }
+
+		bool contains(const std::string & name) const { return lookup(name) != 0; }
+
+		const StorageRecord & find(const std::string & name) const
+		{
+			const StorageRecord * r = lookup(name);
+			if (r == 0)
+				throw std::runtime_error("No Tensor Named " + name);
+			return *r;
+		}
+
+		/** The payload in place. T must be the stored type. */
+		template <typename T>
+		const T * data(const std::string & name) const
+		{
+			const StorageRecord & r = find(name);
+			if (r.dtype != (unsigned int)StorageTypeOf<T>::value)
+				throw std::runtime_error("Storage Type donot Match");
+			return (const T *)(m_file.data() + r.offset);
+		}
+
+		/** Zero copy host matrix over the payload. Valid while the file is open. */
+		template <typename T>
+		Eigen::Map<const Eigen::Matrix<T,Eigen::Dynamic,Eigen::Dynamic> > map(const std::string & name) const
+		{
+			const StorageRecord & r = find(name);
+			return Eigen::Map<const Eigen::Matrix<T,Eigen::Dynamic,Eigen::Dynamic> >(data<T>(name),r.rows,r.cols);
+		}
+
+		template <typename T>
+		void load(const std::string & name, Matrix<T> & m) const
+		{
+			const StorageRecord & r = find(name);
+			m.resize(r.rows,r.cols);
+			stream(r,m.data());
+		}
+
+		template <typename T>
+		void load(const std::string & name, Vector<T> & v) const
+		{
+			const StorageRecord & r = find(name);
+			if (r.cols != 1)
+				throw std::runtime_error("Dimensionality donot Match");
+			v.resize(r.rows);
+			stream(r,v.data());
+		}
+
+		template <typename T, int D>
+		void load(const std::string & name, Array<T,D> & a) const
+		{
+			const StorageRecord & r = find(name);
+			if (D == 1 && r.cols != 1)
+				throw std::runtime_error("Dimensionality donot Match");
+			a.resize(r.rows,r.cols);
+			stream(r,a.data());
+		}
+
+	private:
+		const StorageRecord * lookup(const std::string & name) const
+		{
+			for (std::size_t i = 0; i < size(); ++i)
+				if (name == m_records[i].name)
+					return &m_records[i];
+			return 0;
+		}
+
+		// Stored type S, device type T. A mismatch converts on the host per
+		// chunk through the converting impl::set.
+		template <typename T>
+		void stream(const StorageRecord & r, T * device) const
+		{
+			switch (r.dtype)
+			{
+			case StorageDouble: stream_as<T,double>(r,device); break;
+			case StorageFloat: stream_as<T,float>(r,device); break;
+			case StorageHalf: stream_as<T,half>(r,device); break;
+			case StorageBFloat16: stream_as<T,bfloat16>(r,device); break;
+			}
+		}
+
+		template <typename T, typename S>
+		void stream_as(const StorageRecord & r, T * device) const
+		{
+			const S * host = (const S *)(m_file.data() + r.offset);
+			std::size_t size = r.size();
+			std::size_t chunk = impl::storage_chunk_size<S>();
+
+			m_file.advise(host,r.bytes,MADV_SEQUENTIAL);
+
+			for (std::size_t i = 0; i < size; i += chunk)
+			{
+				std::size_t n = size - i < chunk ? size - i : chunk;
+				impl::set(device + i,host + i,n);
+				m_file.advise(host + i,n*sizeof(S),MADV_DONTNEED);
+			}
+		}
+
+	private:
+		impl::MappedFile				m_file;
+		const StorageHeader *			m_header;
+		const StorageRecord *			m_records;
+	};
+}
+
+#endif
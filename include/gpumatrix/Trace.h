@@ -0,0 +1,300 @@
+#ifndef GPUMATRIX_TRACE_H
+#define GPUMATRIX_TRACE_H
+
+#include <cstddef>
+#include <string>
+#include <ostream>
+#include <fstream>
+#include <stdexcept>
+
+/*
+* Scoped trace events around the backend entry points, exported in the
+* Chrome trace event format (chrome://tracing, ui.perfetto.dev).
+*
+* Built only with GPUMATRIX_TRACE defined, for the library and the code
+* using it alike; otherwise GPUMATRIX_TRACE_SCOPE and GPUMATRIX_TRACE_EXPR
+* expand to nothing and the functions below are empty. When built in,
+* set_tracing() turns recording on and off at run time.
+*
+* Each thread appends to its own ring buffer of trace_capacity() events,
+* the oldest being overwritten, so recording takes no lock. Export and
+* clear lock only the list of buffers and expect the traced threads to be
+* quiet. Kernel launches are asynchronous: an event covers the launch
+* unless set_trace_sync(true) makes every scope wait for the device.
+*/
+
+#if defined(GPUMATRIX_TRACE)
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <typeinfo>
+#include <vector>
+#include <cxxabi.h>
+#include <cuda_runtime.h>
+
+namespace gpumatrix
+{
+	struct TraceEvent
+	{
+		const char * name;		/**< backend entry point */
+		const char * expr;		/**< mangled type of the expression being assigned, or 0 */
+		long long m, n, k;		/**< shape, 0 where unused */
+		double bytes;			/**< device memory read and written */
+		double flops;
+		long long begin, end;	/**< steady clock, ns */
+	};
+
+	namespace impl
+	{
+		struct TraceBuffer
+		{
+			std::vector<TraceEvent> ring;
+			std::size_t next, count;
+			unsigned int tid;
+		};
+
+		struct TraceState
+		{
+			TraceState() : enabled(false), sync(false), capacity(1 << 16), threads(0) { }
+
+			std::atomic<bool> enabled;
+			std::atomic<bool> sync;
+			std::size_t capacity;
+			unsigned int threads;
+			std::mutex lock;
+			std::vector<std::shared_ptr<TraceBuffer> > buffers;
+		};
+
+		inline TraceState & trace_state()
+		{
+			static TraceState state;
+			return state;
+		}
+
+		/** This thread's buffer, registered on first use and kept after the thread exits. */
+		inline TraceBuffer & trace_buffer()
+		{
+			static thread_local TraceBuffer * buffer = 0;
+
+			if (buffer == 0)
+			{
+				TraceState & state = trace_state();
+				std::shared_ptr<TraceBuffer> b(new TraceBuffer());
+
+				std::lock_guard<std::mutex> guard(state.lock);
+				b->ring.resize(state.capacity);
+				b->next = b->count = 0;
+				b->tid = ++state.threads;
+				state.buffers.push_back(b);
+				buffer = b.get();
+			}
+
+			return *buffer;
+		}
+
+		/** The outermost expression being assigned on this thread. */
+		inline const char * & trace_expr()
+		{
+			static thread_local const char * expr = 0;
+			return expr;
+		}
+
+		inline long long trace_clock()
+		{
+			return std::chrono::duration_cast<std::chrono::nanoseconds>(
+				std::chrono::steady_clock::now().time_since_epoch()).count();
+		}
+
+		class TraceScope
+		{
+			TraceScope(const TraceScope&);
+			TraceScope& operator=(const TraceScope&);
+
+		public:
+			TraceScope(const char * name, long long m, long long n, long long k, double bytes, double flops)
+				: m_active(trace_state().enabled.load(std::memory_order_relaxed))
+			{
+				if (m_active)
+				{
+					TraceEvent e = { name, trace_expr(), m, n, k, bytes, flops, trace_clock(), 0 };
+					m_event = e;
+				}
+			}
+
+			~TraceScope()
+			{
+				if (!m_active)
+					return;
+
+				// the calling thread's stream only, as synchronize() does; not
+				// synchronize() itself, which is traced and throws
+				if (trace_state().sync.load(std::memory_order_relaxed))
+					cudaStreamSynchronize(cudaStreamPerThread);
+
+				m_event.end = trace_clock();
+
+				TraceBuffer & b = trace_buffer();
+				if (b.ring.empty())
+					return;
+
+				b.ring[b.next] = m_event;
+				b.next = (b.next + 1) % b.ring.size();
+				b.count += b.count < b.ring.size();
+			}
+
+		private:
+			bool			m_active;
+			TraceEvent		m_event;
+		};
+
+		class TraceExprScope
+		{
+			TraceExprScope(const TraceExprScope&);
+			TraceExprScope& operator=(const TraceExprScope&);
+
+		public:
+			explicit TraceExprScope(const char * type) : m_owner(trace_expr() == 0)
+			{
+				if (m_owner)
+					trace_expr() = type;
+			}
+
+			~TraceExprScope()
+			{
+				if (m_owner)
+					trace_expr() = 0;
+			}
+
+		private:
+			bool			m_owner;
+		};
+
+		inline std::string trace_demangle(const char * name)
+		{
+			int status = 0;
+			char * s = abi::__cxa_demangle(name,0,0,&status);
+			std::string result = status == 0 && s ? s : name;
+			std::free(s);
+			return result;
+		}
+
+		inline std::string trace_quote(const std::string & s)
+		{
+			std::string q = "\"";
+			for (std::size_t i = 0; i < s.size(); ++i)
+			{
+				if (s[i] == '"' || s[i] == '\\')
+					q += '\\';
+				q += s[i];
+			}
+			return q + "\"";
+		}
+	}
+
+	inline void set_tracing(bool on) { impl::trace_state().enabled = on; }
+
+	inline bool tracing() { return impl::trace_state().enabled; }
+
+	/** Wait for the device at the end of every traced scope. */
+	inline void set_trace_sync(bool on) { impl::trace_state().sync = on; }
+
+	/** Ring size per thread, applied to every buffer by clear_trace(). */
+	inline void set_trace_capacity(std::size_t events)
+	{
+		std::lock_guard<std::mutex> guard(impl::trace_state().lock);
+		impl::trace_state().capacity = events;
+	}
+
+	inline void clear_trace()
+	{
+		impl::TraceState & state = impl::trace_state();
+		std::lock_guard<std::mutex> guard(state.lock);
+
+		for (std::size_t i = 0; i < state.buffers.size(); ++i)
+		{
+			state.buffers[i]->ring.assign(state.capacity,TraceEvent());
+			state.buffers[i]->next = state.buffers[i]->count = 0;
+		}
+	}
+
+	/** Every recorded event, oldest first per thread, as complete ("X") events. */
+	inline void write_chrome_trace(std::ostream & os)
+	{
+		impl::TraceState & state = impl::trace_state();
+		std::lock_guard<std::mutex> guard(state.lock);
+
+		long long origin = 0;
+		for (std::size_t i = 0; i < state.buffers.size(); ++i)
+		{
+			const impl::TraceBuffer & b = *state.buffers[i];
+			for (std::size_t j = 0; j < b.count; ++j)
+			{
+				long long t = b.ring[(b.next + b.ring.size() - b.count + j) % b.ring.size()].begin;
+				origin = origin == 0 || t < origin ? t : origin;
+			}
+		}
+
+		os << "{\"displayTimeUnit\":\"ns\",\"traceEvents\":[";
+
+		bool first = true;
+		for (std::size_t i = 0; i < state.buffers.size(); ++i)
+		{
+			const impl::TraceBuffer & b = *state.buffers[i];
+			for (std::size_t j = 0; j < b.count; ++j)
+			{
+				const TraceEvent & e = b.ring[(b.next + b.ring.size() - b.count + j) % b.ring.size()];
+
+				os << (first ? "\n" : ",\n") << "{\"name\":" << impl::trace_quote(e.name)
+					<< ",\"cat\":\"gpumatrix\",\"ph\":\"X\",\"pid\":1,\"tid\":" << b.tid
+					<< ",\"ts\":" << (e.begin - origin)*1e-3 << ",\"dur\":" << (e.end - e.begin)*1e-3
+					<< ",\"args\":{\"m\":" << e.m << ",\"n\":" << e.n << ",\"k\":" << e.k
+					<< ",\"bytes\":" << e.bytes << ",\"flops\":" << e.flops;
+				if (e.expr)
+					os << ",\"expr\":" << impl::trace_quote(impl::trace_demangle(e.expr));
+				os << "}}";
+				first = false;
+			}
+		}
+
+		os << "\n]}\n";
+	}
+}
+
+#define GPUMATRIX_TRACE_SCOPE(NAME, M, N, K, BYTES, FLOPS) \
+	::gpumatrix::impl::TraceScope gpumatrix_trace_scope_(NAME, (long long)(M), (long long)(N), (long long)(K), double(BYTES), double(FLOPS))
+
+#define GPUMATRIX_TRACE_EXPR(E) \
+	::gpumatrix::impl::TraceExprScope gpumatrix_trace_expr_(typeid(E).name())
+
+#else
+
+namespace gpumatrix
+{
+	inline void set_tracing(bool) { }
+	inline bool tracing() { return false; }
+	inline void set_trace_sync(bool) { }
+	inline void set_trace_capacity(std::size_t) { }
+	inline void clear_trace() { }
+	inline void write_chrome_trace(std::ostream & os) { os << "{\"traceEvents\":[]}\n"; }
+}
+
+#define GPUMATRIX_TRACE_SCOPE(NAME, M, N, K, BYTES, FLOPS) ((void)0)
+#define GPUMATRIX_TRACE_EXPR(E) ((void)0)
+
+#endif
+
+namespace gpumatrix
+{
+	inline void write_chrome_trace(const std::string & path)
+	{
+		std::ofstream os(path.c_str());
+		write_chrome_trace(os);
+		if (!os)
+			throw std::runtime_error("Cannot Write " + path);
+	}
+}
+
+#endif
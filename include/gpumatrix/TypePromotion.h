@@ -222,6 +222,25 @@ class PromoteTraits {
 };
 
 
+/**
+ * \class OperandTraits TypePromotion.h "gpumatrix/TypePromotion.h"
+ * \brief Common element type of two array operands of a compare or a
+ *        select: the shared type when they agree, so that two masks stay
+ *        bool, else the PromoteTraits type.
+ */
+template<class T1, class T2>
+class OperandTraits {
+ public:
+  typedef typename PromoteTraits<T1,T2>::value_type value_type;
+};
+
+template<class T>
+class OperandTraits<T,T> {
+ public:
+  typedef T value_type;
+};
+
+
 } // namespace gpumatrix
 
 #endif // TVMET_TYPE_PROMOTION_H
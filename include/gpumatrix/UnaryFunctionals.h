@@ -27,6 +27,8 @@
 #include <iostream>
 
 #include <gpumatrix/GpuMatrixBase.h>
+#include <gpumatrix/Half.h>				// GPUMATRIX_HOST_DEVICE
+#include <gpumatrix/FastMath.h>
 
 namespace gpumatrix {
 
@@ -38,7 +40,7 @@ template <class T>							\
 struct Fcnl_##NAME : public UnaryFunctional {				\
   typedef T						value_type;	\
 									\
-  static inline 							\
+  GPUMATRIX_HOST_DEVICE static inline					\
   value_type apply_on(value_type rhs) {					\
     return OP rhs;							\
   }									\
@@ -77,9 +79,13 @@ TVMET_IMPLEMENT_MACRO(not, !)
 template <class T>							\
 struct Fcnl_##NAME : public UnaryFunctional {				\
   typedef T						value_type;	\
-  									\
-   									\
- static 								\
+									\
+  GPUMATRIX_HOST_DEVICE static inline					\
+  value_type apply_on(value_type rhs) {					\
+    return TVMET_GLOBAL_SCOPE(NAME)(rhs);				\
+  }									\
+									\
+ static									\
  void print_xpr(std::ostream& os, std::size_t l=0) {			\
     os << IndentLevel(l) << "Fcnl_" << #NAME << "<T="			\
        << typeid(value_type).name() << ">,"				\
@@ -87,7 +93,6 @@ struct Fcnl_##NAME : public UnaryFunctional {				\
   }									\
 };
 
-TVMET_IMPLEMENT_MACRO(abs)	// specialized later, see below
 TVMET_IMPLEMENT_MACRO(ceil)
 TVMET_IMPLEMENT_MACRO(floor)
 TVMET_IMPLEMENT_MACRO(sin)
@@ -103,13 +108,56 @@ TVMET_IMPLEMENT_MACRO(exp)
 TVMET_IMPLEMENT_MACRO(log)
 TVMET_IMPLEMENT_MACRO(log10)
 TVMET_IMPLEMENT_MACRO(sqrt)
+#undef TVMET_IMPLEMENT_MACRO
 
-TVMET_IMPLEMENT_MACRO(sqnorm)
-TVMET_IMPLEMENT_MACRO(arrayinv)
-TVMET_IMPLEMENT_MACRO(logistic)
+
+/** \class Fcnl_abs		UnaryFunctionals.h "gpumatrix/UnaryFunctionals.h" */
+/** \class Fcnl_arrayinv	UnaryFunctionals.h "gpumatrix/UnaryFunctionals.h" */
+/** \class Fcnl_logistic	UnaryFunctionals.h "gpumatrix/UnaryFunctionals.h" */
+/** \class Fcnl_softplus	UnaryFunctionals.h "gpumatrix/UnaryFunctionals.h" */
+#define TVMET_IMPLEMENT_MACRO(NAME, EXPR)				\
+template <class T>							\
+struct Fcnl_##NAME : public UnaryFunctional {				\
+  typedef T						value_type;	\
+									\
+  GPUMATRIX_HOST_DEVICE static inline					\
+  value_type apply_on(value_type rhs) {					\
+    return EXPR;							\
+  }									\
+									\
+ static									\
+ void print_xpr(std::ostream& os, std::size_t l=0) {			\
+    os << IndentLevel(l) << "Fcnl_" << #NAME << "<T="			\
+       << typeid(value_type).name() << ">,"				\
+       << std::endl;							\
+  }									\
+};
+
+TVMET_IMPLEMENT_MACRO(abs, TVMET_GLOBAL_SCOPE(fabs)(rhs))	// see also labs/fabs below
+TVMET_IMPLEMENT_MACRO(arrayinv, 1/rhs)
+TVMET_IMPLEMENT_MACRO(logistic, 1/(1 + TVMET_GLOBAL_SCOPE(exp)(-rhs)))
+TVMET_IMPLEMENT_MACRO(softplus, rhs > 0 ? rhs + TVMET_GLOBAL_SCOPE(log1p)(TVMET_GLOBAL_SCOPE(exp)(-rhs))
+				       : TVMET_GLOBAL_SCOPE(log1p)(TVMET_GLOBAL_SCOPE(exp)(rhs)))
 #undef TVMET_IMPLEMENT_MACRO
 
 
+/**
+ * \class Fcnl_sqnorm	UnaryFunctionals.h "gpumatrix/UnaryFunctionals.h"
+ * \brief Tag for the squared norm reduction, it has no element wise form.
+ */
+template <class T>
+struct Fcnl_sqnorm : public UnaryFunctional {
+  typedef T						value_type;
+
+  static
+  void print_xpr(std::ostream& os, std::size_t l=0) {
+    os << IndentLevel(l) << "Fcnl_sqnorm<T="
+       << typeid(value_type).name() << ">,"
+       << std::endl;
+  }
+};
+
+
 /** \class Fcnl_cbrt		UnaryFunctionals.h "gpumatrix/UnaryFunctionals.h" */
 /** \class Fcnl_rint		UnaryFunctionals.h "gpumatrix/UnaryFunctionals.h" */
 #define TVMET_IMPLEMENT_MACRO(NAME)					\
@@ -117,7 +165,7 @@ template <class T>							\
 struct Fcnl_##NAME : public UnaryFunctional {				\
   typedef T						value_type;	\
 									\
-  static inline								\
+  GPUMATRIX_HOST_DEVICE static inline					\
   value_type apply_on(value_type rhs) {					\
     return TVMET_GLOBAL_SCOPE(NAME)(rhs);				\
   }									\
@@ -155,7 +203,7 @@ template <class T>							\
 struct Fcnl_##NAME : public UnaryFunctional {				\
   typedef T						value_type;	\
 									\
-  static inline 							\
+  GPUMATRIX_HOST_DEVICE static inline					\
   value_type apply_on(value_type rhs) {					\
     return TVMET_GLOBAL_SCOPE(NAME)(rhs);				\
   }									\
@@ -186,6 +234,93 @@ TVMET_IMPLEMENT_MACRO(lgamma)
 #endif // defined(TVMET_HAVE_IEEE_MATH)
 
 
+/*
+ * The element wise functionals the backend has kernels for, as X(NAME) for
+ * Fcnl_NAME. The kernels are compiled into the library for every floating
+ * point storage type, and GPUMATRIX_UNARY_FUNCTIONS also generates the free
+ * function NAME(array) for Array, Map<Array> and array expressions. A new
+ * functional with a GPUMATRIX_HOST_DEVICE apply_on therefore only has to be
+ * added to GPUMATRIX_UNARY_FUNCTIONS to be usable on arrays.
+ */
+#if defined(TVMET_HAVE_IEEE_MATH)
+#define GPUMATRIX_IEEE_UNARY_FUNCTIONALS(X)				\
+  X(asinh) X(acosh) X(atanh) X(expm1) X(log1p) X(erf) X(erfc)		\
+  X(j0) X(j1) X(y0) X(y1) X(lgamma)
+#else
+#define GPUMATRIX_IEEE_UNARY_FUNCTIONALS(X)
+#endif
+
+#define GPUMATRIX_UNARY_FUNCTIONS(X)					\
+  X(abs) X(ceil) X(floor) X(rint) X(cbrt)				\
+  X(sin) X(cos) X(tan) X(sinh) X(cosh) X(tanh)				\
+  X(asin) X(acos) X(atan) X(exp) X(log) X(log10) X(sqrt)		\
+  X(logistic) X(softplus)						\
+  GPUMATRIX_IEEE_UNARY_FUNCTIONALS(X)
+
+// neg and arrayinv are reached through operator- and inverse() instead
+#define GPUMATRIX_UNARY_FUNCTIONALS(X)					\
+  X(neg) X(arrayinv) GPUMATRIX_UNARY_FUNCTIONS(X)
+
+
+/**
+ * \class Fcnl_fast_exp	UnaryFunctionals.h "gpumatrix/UnaryFunctionals.h"
+ * \brief Polynomial form of Fcnl_exp, see FastMath.h. The same holds for
+ *        log, tanh, logistic, softplus and erf.
+ */
+#define TVMET_IMPLEMENT_MACRO(NAME)					\
+template <class T>							\
+struct Fcnl_fast_##NAME : public UnaryFunctional {			\
+  typedef T						value_type;	\
+  typedef typename impl::FastMathType<T>::type		math_type;	\
+									\
+  GPUMATRIX_HOST_DEVICE static inline					\
+  value_type apply_on(value_type rhs) {					\
+    return impl::fast_##NAME(math_type(rhs));				\
+  }									\
+									\
+ static									\
+ void print_xpr(std::ostream& os, std::size_t l=0) {			\
+    os << IndentLevel(l) << "Fcnl_fast_" << #NAME << "<T="		\
+       << typeid(value_type).name() << ">,"				\
+       << std::endl;							\
+  }									\
+};									\
+									\
+template <class T>							\
+struct FastFunctional< Fcnl_##NAME<T> > {				\
+  typedef Fcnl_fast_##NAME<T>				type;		\
+};
+
+/**
+ * \class FastFunctional	UnaryFunctionals.h "gpumatrix/UnaryFunctionals.h"
+ * \brief The functional the kernels run in MathFast mode, the functional
+ *        itself when it has no polynomial form.
+ */
+template <class Fcnl>
+struct FastFunctional {
+  typedef Fcnl						type;
+};
+
+TVMET_IMPLEMENT_MACRO(exp)
+TVMET_IMPLEMENT_MACRO(log)
+TVMET_IMPLEMENT_MACRO(tanh)
+TVMET_IMPLEMENT_MACRO(logistic)
+TVMET_IMPLEMENT_MACRO(softplus)
+#if defined(TVMET_HAVE_IEEE_MATH)
+TVMET_IMPLEMENT_MACRO(erf)
+#endif
+
+#undef TVMET_IMPLEMENT_MACRO
+
+#if defined(TVMET_HAVE_IEEE_MATH)
+#define GPUMATRIX_FAST_UNARY_FUNCTIONALS(X)				\
+  X(fast_exp) X(fast_log) X(fast_tanh) X(fast_logistic) X(fast_softplus) X(fast_erf)
+#else
+#define GPUMATRIX_FAST_UNARY_FUNCTIONALS(X)				\
+  X(fast_exp) X(fast_log) X(fast_tanh) X(fast_logistic) X(fast_softplus)
+#endif
+
+
 /** \class Fcnl_abs<long int>		UnaryFunctionals.h "gpumatrix/UnaryFunctionals.h" */
 /** \class Fcnl_abs<long long int>	UnaryFunctionals.h "gpumatrix/UnaryFunctionals.h" */
 /** \class Fcnl_abs<float>		UnaryFunctionals.h "gpumatrix/UnaryFunctionals.h" */
@@ -36,6 +36,7 @@
 #include <gpumatrix/NoAliasProxy.h>
 
 #include <gpumatrix/impl/Interface.h>
+#include <gpumatrix/SharedStorage.h>
 
 namespace gpumatrix {
 
@@ -91,7 +92,7 @@ namespace gpumatrix {
 		value_type operator()(std::size_t i) const {
 			TVMET_RT_CONDITION(i < Size, "VectorConstReference Bounce Violation")
 				value_type val;
-			cublasGetVector (1, sizeof(value_type), m_data + i,1, &val, 1);
+			impl::get(&val, m_data + i, 1);
 			return val;
 		}
 
@@ -186,16 +187,16 @@ namespace gpumatrix {
 
 	public: // STL  interface
 		/** STL iterator interface. */
-		iterator begin() { return m_data; }
+		iterator begin() { return data(); }
 
 		/** STL iterator interface. */
-		iterator end() { return m_data + Size; }
+		iterator end() { return data() + Size; }
 
 		/** STL const_iterator interface. */
-		const_iterator begin() const { return m_data; }
+		const_iterator begin() const { return m_storage.data(); }
 
 		/** STL const_iterator interface. */
-		const_iterator end() const { return m_data + Size; }
+		const_iterator end() const { return m_storage.data() + Size; }
 
 		/** STL reverse iterator interface reverse begin. */
 		reverse_iterator rbegin() { return reverse_iterator( end() ); }
@@ -214,19 +215,19 @@ namespace gpumatrix {
 		}
 
 		/** STL vector front element. */
-		value_type front() { return m_data[0]; }
+		value_type front() { return m_storage.data()[0]; }
 
 		/** STL vector const front element. */
-		const_reference front() const { return m_data[0]; }
+		const_reference front() const { return m_storage.data()[0]; }
 
 		/** STL vector back element. */
-		value_type back() { return m_data[Size-1]; }
+		value_type back() { return m_storage.data()[Size-1]; }
 
 		/** STL vector const back element. */
-		const_reference back() const { return m_data[Size-1]; }
+		const_reference back() const { return m_storage.data()[Size-1]; }
 
 		/** STL vector empty() - returns allways false. */
-		bool empty() { if (m_data == 0) return true; else return false; }
+		bool empty() { if (m_storage.data() == 0) return true; else return false; }
 
 		/** The size of the vector. */
 		std::size_t size() const { return Size; }
@@ -235,46 +236,29 @@ namespace gpumatrix {
 		std::size_t max_size() { return Size; }
 
 	public:
-		/** Default Destructor */
-		~Vector() {
-			impl::free(m_data);
-		}
-
 		/** Default Constructor. The allocated memory region isn't cleared. If you want
 		a clean use the constructor argument zero. */
-		explicit Vector():m_data(0),Size(0)
+		explicit Vector():Size(0)
 		{
 		}
 
 				/** Default Constructor. The allocated memory region isn't cleared. If you want
 		a clean use the constructor argument zero. */
-		explicit Vector(std::size_t size):m_data(0),Size(0)
+		explicit Vector(std::size_t size):Size(0)
 		{
 			resize(size);
 		}
 
-		/** Copy Constructor, not explicit! */
-		Vector(const Vector& rhs):m_data(0),Size(0)
+		/** Copy Constructor, not explicit! The copy shares the buffer of rhs
+		until either of them is written, see SharedStorage.h. */
+		Vector(const Vector& rhs):Size(rhs.size()),m_storage(rhs.m_storage)
 		{
-			if (this != &rhs)
-			{
-				if (rhs.data() == 0)
-				{
-					m_data = 0;
-					return;
-				}
-
-				resize(rhs.size());
-				impl::copy(m_data,rhs.data(),size());
-//				cudaMemcpy(m_data, rhs.m_data, Size*sizeof(value_type), cudaMemcpyDeviceToDevice);
-			}
-			//*this = XprVector<ConstReference>(rhs.as_expr());
 		}
 
-		Vector(const Eigen::Matrix<value_type,Eigen::Dynamic,1> & EigenVec):m_data(0),Size(0)
+		Vector(const Eigen::Matrix<value_type,Eigen::Dynamic,1> & EigenVec):Size(0)
 		{
 			resize(EigenVec.size());
-			impl::set(m_data,EigenVec.data(),size());
+			impl::set(data(),EigenVec.data(),size());
 //			cublasSetVector(Size,sizeof(value_type),EigenVec.data(),1,m_data,1);
 		}
 
@@ -423,7 +407,7 @@ namespace gpumatrix {
 
 		/** Construct a vector by expression. */
 		template <class E>
-		Vector(const XprVector<E>& e):m_data(0),Size(0)
+		Vector(const XprVector<E>& e):Size(0)
 		{
 			resize(e.size());
 
@@ -446,11 +430,9 @@ namespace gpumatrix {
 
 				return;
 
-			impl::free(m_data);
-
 			Size = size;
 
-			m_data = impl::alloc<value_type>(Size);
+			m_storage.reset(Size);
 
 
 		}
@@ -507,8 +489,9 @@ namespace gpumatrix {
 		}
 
 	public: // access operators
-		value_type* _tvmet_restrict data() { return m_data; }
-		const value_type* _tvmet_restrict data() const { return m_data; }
+		/** The buffer for writing, copied first if other objects share it. */
+		value_type* _tvmet_restrict data() { return m_storage.unique(); }
+		const value_type* _tvmet_restrict data() const { return m_storage.data(); }
 
 	public: // index access operators
 		//value_type& _tvmet_restrict operator()(std::size_t i) {
@@ -550,7 +533,7 @@ namespace gpumatrix {
 
 		Map<Array<T,1>> array()
 		{
-			return Map<Array<T,1>>(m_data,Size);
+			return Map<Array<T,1>>(data(),Size);
 		}
 
 
@@ -580,8 +563,9 @@ namespace gpumatrix {
 		/** assign a given Vector element wise to this vector.
 		The operator=(const Vector&) is compiler generated. */
 		Vector& operator = (const Vector & rhs) {
-			//resize(rhs.size());
-			rhs.assign_to(*this, Fcnl_assign<value_type, value_type>());
+			// see SharedStorage::assign
+			m_storage.assign(rhs.m_storage);
+			Size = rhs.size();
 			return *this;
 		}
 
@@ -606,7 +590,7 @@ namespace gpumatrix {
 
 			Eigen::Matrix<value_type,Eigen::Dynamic,1> M(Size);
 
-			impl::get(M.data(),m_data,Size);
+			impl::get(M.data(),m_storage.data(),Size);
 			return M;
 		}
 
@@ -614,7 +598,7 @@ namespace gpumatrix {
 		{
 			resize(s);
 
-			impl::zero(m_data,size());
+			impl::zero(m_storage.overwrite(),size());
 		}
 
 		value_type squaredNorm() const
@@ -622,16 +606,31 @@ namespace gpumatrix {
 			return 	impl::squaredNorm(*this);
 		}
 
+		value_type squaredNorm(AccumulationPolicy policy) const
+		{
+			return 	impl::squaredNorm(*this,policy);
+		}
+
 		value_type sum() const
 		{
 			return 	impl::sum(*this);
 		}
 
+		value_type sum(AccumulationPolicy policy) const
+		{
+			return 	impl::sum(*this,policy);
+		}
+
 		value_type dot(const Vector<value_type> & other) const
 		{
 			return impl::dot(*this, other);
 		}
 
+		value_type dot(const Vector<value_type> & other, AccumulationPolicy policy) const
+		{
+			return impl::dot(*this, other, policy);
+		}
+
 
 	private:
 		//template<class Obj, std::size_t LEN> friend class CommaInitializer;
@@ -678,7 +677,7 @@ namespace gpumatrix {
 		/** The data of vector self. */
 
 
-		value_type*	m_data;
+		impl::SharedStorage<value_type>	m_storage;
 
 	};
 
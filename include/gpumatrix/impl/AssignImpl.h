@@ -4,6 +4,9 @@
 
 #include<gpumatrix/impl/backend/Interface.h>
 #include<gpumatrix/impl/EvalInterface.h>
+#include<gpumatrix/impl/CompoundAssignInterface.h>
+#include<gpumatrix/Trace.h>
+#include<gpumatrix/Materialize.h>
 
 namespace gpumatrix
 {
@@ -34,6 +37,15 @@ namespace gpumatrix
 			impl::copy<T>(dest.data(),m.data(), m.size());
 		}
 
+		// Matrix = Matrix, as Matrix::operator=: an evaluated expression is
+		// copied into a buffer dest holds alone at the right size, so views
+		// of dest stay valid, and moves in without a copy otherwise
+		template <typename T,typename Assign> 
+		void do_assign(Matrix<T>& dest, const Matrix<T> & m, const Assign& assign_fn)
+		{
+			dest = m;
+		}
+
 		// Map<Matrix>  = Matrix
 		template <typename T,typename Assign> 
 		void do_assign(Map<Matrix<T>>& dest, const Matrix<T> & m, const Assign& assign_fn)
@@ -68,6 +80,13 @@ namespace gpumatrix
 			impl::copy<T>(dest.data(),m.data(), m.size());
 		}
 
+		// Vector = Vector, as Matrix = Matrix
+		template <typename T,typename Assign> 
+		void do_assign(Vector<T>& dest, const Vector<T> & m, const Assign& assign_fn)
+		{
+			dest = m;
+		}
+
 		// Map<Vector> = Vector
 		template <typename T, typename Assign> 
 		void do_assign(Map<Vector<T>>& dest, const Vector<T> & m, const Assign& assign_fn)
@@ -103,6 +122,13 @@ namespace gpumatrix
 			impl::copy<T>(dest.data(),m.data(), m.size());
 		}
 
+		// Array = Array, as Matrix = Matrix
+		template <typename T,int D,typename Assign> 
+		void do_assign(Array<T,D>& dest, const Array<T,D> & m, const Assign& assign_fn)
+		{
+			dest = m;
+		}
+
 		// Map<Vector>  = Array
 		template <typename T, typename Assign> 
 		void do_assign(Map<Vector<T>>& dest, const Array<T,1> & m, const Assign& assign_fn)
@@ -162,9 +188,169 @@ namespace gpumatrix
 		}
 
 
+		// Where an operand of an elementwise kernel lies against dest. Only
+		// matrices, vectors and arrays count: an operand that is an expression
+		// is evaluated into a temporary before dest is written, which is safe
+		// only while dest keeps its buffer (see in_place).
+		enum XprAlias { AliasNone = 0, AliasSame = 1, AliasPartial = 2 };
+
+		inline XprAlias alias_of(const void * dest, std::size_t dest_bytes, const void * data, std::size_t bytes)
+		{
+			const char * d = (const char *)dest;
+			const char * p = (const char *)data;
+			if (dest_bytes == 0 || bytes == 0 || p + bytes <= d || d + dest_bytes <= p)
+				return AliasNone;
+			return p == d && bytes == dest_bytes ? AliasSame : AliasPartial;
+		}
+
+		template <class E> struct XprOperandAlias
+		{
+			static XprAlias of(const void *, std::size_t, const E &) { return AliasNone; }
+		};
+
+		template <class T> struct XprOperandAlias<MatrixConstReference<T> >
+		{
+			static XprAlias of(const void * dest, std::size_t bytes, const MatrixConstReference<T> & m) { return alias_of(dest,bytes,m.data(),m.size()*sizeof(T)); }
+		};
+
+		template <class T> struct XprOperandAlias<VectorConstReference<T> >
+		{
+			static XprAlias of(const void * dest, std::size_t bytes, const VectorConstReference<T> & m) { return alias_of(dest,bytes,m.data(),m.size()*sizeof(T)); }
+		};
+
+		template <class T, int D> struct XprOperandAlias<ArrayConstReference<T,D> >
+		{
+			static XprAlias of(const void * dest, std::size_t bytes, const ArrayConstReference<T,D> & m) { return alias_of(dest,bytes,m.data(),m.size()*sizeof(T)); }
+		};
+
+		template <class E> struct XprOperandAlias<XprMatrix<E> >
+		{
+			static XprAlias of(const void * dest, std::size_t bytes, const XprMatrix<E> & m) { return XprOperandAlias<E>::of(dest,bytes,m.expr()); }
+		};
+
+		template <class E> struct XprOperandAlias<XprVector<E> >
+		{
+			static XprAlias of(const void * dest, std::size_t bytes, const XprVector<E> & m) { return XprOperandAlias<E>::of(dest,bytes,m.expr()); }
+		};
+
+		template <class E, int D> struct XprOperandAlias<XprArray<E,D> >
+		{
+			static XprAlias of(const void * dest, std::size_t bytes, const XprArray<E,D> & m) { return XprOperandAlias<E>::of(dest,bytes,m.expr()); }
+		};
+
+		template <class E1, class E2>
+		XprAlias operand_alias(const void * dest, std::size_t bytes, const E1 & lhs, const E2 & rhs)
+		{
+			XprAlias a = XprOperandAlias<E1>::of(dest,bytes,lhs);
+			XprAlias b = XprOperandAlias<E2>::of(dest,bytes,rhs);
+			return a > b ? a : b;
+		}
+
+		// The worst of the operands of an elementwise node; any other node
+		// reads entries it has not written yet and always takes a temporary
+		template <class E> struct XprNodeAlias
+		{
+			static XprAlias of(const void *, std::size_t, const E &) { return AliasPartial; }
+		};
+
+		template <class Op, class E1, class E2> struct XprNodeAlias<XprBinOp<Op,E1,E2> >
+		{
+			static XprAlias of(const void * dest, std::size_t bytes, const XprBinOp<Op,E1,E2> & expr) { return operand_alias(dest,bytes,expr.lhs(),expr.rhs()); }
+		};
+
+		template <class Op, class E> struct XprNodeAlias<XprUnOp<Op,E> >
+		{
+			static XprAlias of(const void * dest, std::size_t bytes, const XprUnOp<Op,E> & expr) { return XprOperandAlias<E>::of(dest,bytes,expr.expr()); }
+		};
+
+		template <class M, class E1, class E2> struct XprNodeAlias<XprSelect<M,E1,E2> >
+		{
+			static XprAlias of(const void * dest, std::size_t bytes, const XprSelect<M,E1,E2> & expr)
+			{
+				XprAlias a = XprOperandAlias<M>::of(dest,bytes,expr.mask());
+				XprAlias b = operand_alias(dest,bytes,expr.lhs(),expr.rhs());
+				return a > b ? a : b;
+			}
+		};
+
+		template <class Op, class E, class V, int Dir> struct XprNodeAlias<XprBroadcast<Op,E,V,Dir> >
+		{
+			static XprAlias of(const void * dest, std::size_t bytes, const XprBroadcast<Op,E,V,Dir> & expr) { return operand_alias(dest,bytes,expr.expr(),expr.vector()); }
+		};
+
+		// dest = expr evaluated straight into dest. check_size runs before
+		// any operand is evaluated, and a resize frees the buffer an operand
+		// nested in expr may still read, so dest must be empty or have the
+		// shape of expr already. It is then safe when no operand overlaps
+		// dest, or when one is dest itself.
+		template <typename E,typename Dest>
+		bool in_place(const Dest & dest, const E & expr)
+		{
+			if (dest.size() != 0 && (dest.rows() != expr.rows() || dest.cols() != expr.cols()))
+				return false;
+
+			XprAlias alias = XprNodeAlias<E>::of(dest.data(),dest.size()*sizeof(typename Dest::value_type),expr);
+			return alias != AliasPartial;
+		}
+
+		// dest = dest op x as the compound dest op= x, a literal x going to
+		// the scalar kernel
+		template <typename POD,typename Dest,typename Func>
+		void assign_compound(Dest& dest, const XprLiteral<POD> & x, const Func& fn)
+		{
+			impl::do_scalar_compound_assign(dest,x.eval(),fn);
+		}
+
+		template <typename E,typename Dest,typename Func>
+		void assign_compound(Dest& dest, const E & x, const Func& fn)
+		{
+			typename E::result_type X = x.eval();
+			impl::do_compound_assign(dest,X,fn);
+		}
+
+		template <typename E,typename Dest,typename Assign>
+		void assign_in_place(Dest& dest, const E & expr, const Assign& assign_fn)
+		{
+			impl::eval(dest,expr,assign_fn);
+		}
+
+		// Dest = Dest op x, and Dest = x op Dest when op commutes
+#define GPUMATRIX_IMPLEMENT_ASSIGN_IN_PLACE(NAME, COMMUTES)								\
+		template <typename T1,typename T2,typename E1,typename E2,typename Dest,typename Assign>	\
+		void assign_in_place(Dest& dest, const XprBinOp<Fcnl_##NAME<T1,T2>,E1,E2> & expr, const Assign& assign_fn)	\
+		{																				\
+			typedef typename Dest::value_type T;										\
+			const Dest & d = dest;														\
+			std::size_t bytes = d.size()*sizeof(T);										\
+																						\
+			if (XprOperandAlias<E1>::of(d.data(),bytes,expr.lhs()) == AliasSame)		\
+				impl::assign_compound(dest,expr.rhs(),Fcnl_##NAME##_eq<T,T>());			\
+			else if (COMMUTES && XprOperandAlias<E2>::of(d.data(),bytes,expr.rhs()) == AliasSame)	\
+				impl::assign_compound(dest,expr.lhs(),Fcnl_##NAME##_eq<T,T>());			\
+			else																		\
+				impl::eval(dest,expr,assign_fn);										\
+		}
+
+		GPUMATRIX_IMPLEMENT_ASSIGN_IN_PLACE(add, true)
+		GPUMATRIX_IMPLEMENT_ASSIGN_IN_PLACE(sub, false)
+		GPUMATRIX_IMPLEMENT_ASSIGN_IN_PLACE(mul, true)
+		GPUMATRIX_IMPLEMENT_ASSIGN_IN_PLACE(div, false)
+
+#undef GPUMATRIX_IMPLEMENT_ASSIGN_IN_PLACE
+
 		template <typename E,typename Dest,typename Assign> 
 		void do_assign(Dest& dest, const E & expr, const Assign& assign_fn)
 		{
+			GPUMATRIX_TRACE_EXPR(E);
+
+			// A = f(A), A = A op B: each kernel reads entry i before writing it
+			if (impl::in_place(dest,expr))
+			{
+				impl::assign_in_place(dest,expr,assign_fn);
+				return;
+			}
+
+			MaterializeReason reason("assignment without noalias()");
 			typename XprResultType<E>:: result_type  result = expr.eval();
 			impl::do_assign(dest,result,assign_fn);
 		}
@@ -172,8 +358,29 @@ namespace gpumatrix
 		template <typename E,typename Dest,typename Assign> 
 		void do_assign(NoAliasProxy<Dest> & dest, const E & expr, const Assign& assign_fn)
 		{
+			GPUMATRIX_TRACE_EXPR(E);
 			impl::eval(dest.lord(),expr,assign_fn);
 		}
+
+		// NoAlias = a view of a matrix, vector or array, e.g. the column of
+		// a const matrix: a copy as without noalias()
+		template <typename T,typename Dest,typename Assign> 
+		void do_assign(NoAliasProxy<Dest> & dest, const MatrixConstReference<T> & m, const Assign& assign_fn)
+		{
+			impl::do_assign(dest.lord(),m,assign_fn);
+		}
+
+		template <typename T,typename Dest,typename Assign> 
+		void do_assign(NoAliasProxy<Dest> & dest, const VectorConstReference<T> & m, const Assign& assign_fn)
+		{
+			impl::do_assign(dest.lord(),m,assign_fn);
+		}
+
+		template <typename T,int D,typename Dest,typename Assign> 
+		void do_assign(NoAliasProxy<Dest> & dest, const ArrayConstReference<T,D> & m, const Assign& assign_fn)
+		{
+			impl::do_assign(dest.lord(),m,assign_fn);
+		}
 	}
 
 }
@@ -86,6 +86,16 @@ namespace gpumatrix
 		template <typename E,typename Dest,typename Assign> 
 		void do_assign(NoAliasProxy<Dest> & dest, const E & expr, const Assign& assign_fn);
 
+		// NoAlias = Matrix, Vector, Array
+		template <typename T,typename Dest,typename Assign> 
+		void do_assign(NoAliasProxy<Dest> & dest, const MatrixConstReference<T> & m, const Assign& assign_fn);
+
+		template <typename T,typename Dest,typename Assign> 
+		void do_assign(NoAliasProxy<Dest> & dest, const VectorConstReference<T> & m, const Assign& assign_fn);
+
+		template <typename T,int D,typename Dest,typename Assign> 
+		void do_assign(NoAliasProxy<Dest> & dest, const ArrayConstReference<T,D> & m, const Assign& assign_fn);
+
 		
 		template <typename E,typename Dest,typename Func> 
 		void do_compound_assign(Dest & dest, const E & expr, const Func& fn);
@@ -3,6 +3,8 @@
 
 #include <gpumatrix/impl/CompoundAssignInterface.h>
 #include <gpumatrix/impl/backend/Interface.h>
+#include <gpumatrix/Trace.h>
+#include <gpumatrix/Materialize.h>
 
 namespace gpumatrix
 {
@@ -105,6 +107,8 @@ namespace gpumatrix
 		template <typename E,typename Dest,typename Func> 
 		void do_compound_assign(Dest& dest, const E & expr, const Func& fn)
 		{
+			GPUMATRIX_TRACE_EXPR(E);
+			MaterializeReason reason("compound assignment");
 			typename XprResultType<E>:: result_type  result = expr.eval();
 			do_compound_assign(dest,result,fn);
 		}
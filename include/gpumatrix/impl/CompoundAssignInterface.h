@@ -13,7 +13,7 @@ namespace gpumatrix
 	template <class C> class Map;
 	template <class C> class NoAliasProxy;
 
-	namespace backend
+	namespace impl
 	{
 		// Dest op= value
 		template <typename POD,typename Dest,typename Func> 
@@ -4,6 +4,9 @@
 
 #include <gpumatrix/impl/EvalInterface.h>
 #include <gpumatrix/impl/Interface.h>
+#include <gpumatrix/Materialize.h>
+
+#include <type_traits>
 
 
 namespace gpumatrix
@@ -13,13 +16,13 @@ namespace gpumatrix
 	{
 		
 		template <class Dest> 
-		void check_size(Dest & dest, int size)
+		void check_size(Dest & dest, std::size_t size)
 		{
 			dest.resize(size);
 		}
 
 		template <class Dest> 
-		void check_size(Map<Dest> & dest, int size)
+		void check_size(Map<Dest> & dest, std::size_t size)
 		{
 			if (dest.size() != size)
 				throw runtime_error("Dimensionality donot Match");
@@ -63,10 +66,15 @@ namespace gpumatrix
 		template <typename E> 
 		typename XprResultType<E>:: result_type eval(const E & expr) 
 		{
-			typename XprResultType<E>::result_type result;
+			typedef typename XprResultType<E>::result_type result_type;
+
+			const char * reason = impl::take_materialize_reason();
+			result_type result;
 
 			impl::eval(result,expr,Fcnl_assign<typename E::value_type,typename E::value_type>());
 
+			impl::materialized(expr,result.size(),result.size()*sizeof(typename result_type::value_type),reason);
+
 			return result;
 			/*if (expr.lhs().cols() != expr.rhs().rows())
 				throw runtime_error("Dimension not Match for Matrix Multiplication");
@@ -98,6 +106,13 @@ namespace gpumatrix
 			impl::transpose<typename E::value_type> (dest.data(),A.data(),A.rows(),A.cols());
 		}
 
+		// True when both product operands evaluated to the same matrix
+		template <typename L, typename R>
+		bool same_operand(const L & lhs, const R & rhs)
+		{
+			return lhs.data() == rhs.data() && lhs.rows() == rhs.rows() && lhs.cols() == rhs.cols();
+		}
+
 		// Dest = M1*M2
 		template <typename E1, typename E2,typename Dest,typename Assign> 
 		void eval(Dest& dest, const XprMMProduct<E1,E2> & prod, const Assign& assign_fn)
@@ -122,6 +137,14 @@ namespace gpumatrix
 
 			typedef typename XprMtMProduct<E1,E2>::value_type value_type;
 
+			// A.transpose()*A is symmetric: compute the lower triangle and mirror it
+			if (same_operand(A,B))
+			{
+				impl::syrk<value_type> ('L', 'T', A.cols(), A.rows(), 1, A.data(), A.rows(), 0, dest.data(), dest.rows());
+				impl::symmetrize<value_type> ('L', dest.rows(), dest.data(), dest.rows());
+				return;
+			}
+
 			impl::gemm<value_type> ('T', 'N', A.cols(), B.cols(), A.rows(), 1, A.data(),
 				A.rows(), B.data(), B.rows(), 0, dest.data(), dest.rows());
 		}
@@ -136,6 +159,14 @@ namespace gpumatrix
 
 			typedef typename XprMMtProduct<E1,E2>::value_type value_type;
 
+			// A*A.transpose() likewise
+			if (same_operand(A,B))
+			{
+				impl::syrk<value_type> ('L', 'N', A.rows(), A.cols(), 1, A.data(), A.rows(), 0, dest.data(), dest.rows());
+				impl::symmetrize<value_type> ('L', dest.rows(), dest.data(), dest.rows());
+				return;
+			}
+
 			impl::gemm<value_type> ('N', 'T', A.rows(), B.rows(), A.cols(), 1, A.data(),
 				A.rows(), B.data(), B.rows(), 0, dest.data(), dest.rows());
 		}
@@ -661,6 +692,272 @@ namespace gpumatrix
 		} 
 
 
+		// An array operand of a compare or select evaluated in the promoted
+		// element type T; one of another type is converted on the device.
+		template <typename T, typename E, int D, bool Same = std::is_same<T,typename E::value_type>::value>
+		struct PromotedOperand
+		{
+			typedef typename XprArray<E,D>::result_type type;
+
+			static type eval(const XprArray<E,D> & x) { return x.eval(); }
+		};
+
+		template <typename T, typename E, int D>
+		struct PromotedOperand<T,E,D,false>
+		{
+			typedef Array<T,D> type;
+
+			static type eval(const XprArray<E,D> & x)
+			{
+				typename XprArray<E,D>::result_type A = x.eval();
+				Array<T,D> result(A.rows(),A.cols());
+				impl::array_convert(result.data(),A.data(),A.size());
+				return result;
+			}
+		};
+
+		// Mask = A op B, Mask = A op alpha, Mask = alpha op A
+		// The backend only compares array against scalar, so the literal
+		// on the left is handled with the mirrored comparison. Operands of
+		// two element types are compared in the promoted one.
+#define GPUMATRIX_IMPLEMENT_COMPARE_EVAL(NAME, MIRRORED)				\
+		template < int D, typename E1, typename E2,typename Dest,typename Assign> \
+		void eval(Dest& dest, 											\
+			const XprBinOp<												\
+					Fcnl_##NAME<typename E1::value_type,typename E2::value_type>,	\
+					XprArray<E1,D>,										\
+					XprArray<E2,D>										\
+			> & expr, 													\
+			const Assign& assign_fn)									\
+		{																\
+			typedef typename OperandTraits<typename E1::value_type,typename E2::value_type>::value_type T;	\
+			check_size(dest,expr.rows(),expr.cols());					\
+																		\
+			typename PromotedOperand<T,E1,D>::type A = PromotedOperand<T,E1,D>::eval(expr.lhs());	\
+			typename PromotedOperand<T,E2,D>::type B = PromotedOperand<T,E2,D>::eval(expr.rhs());	\
+																		\
+			impl::array_compare(dest.data(),A.data(),B.data(),dest.size(),Fcnl_##NAME<T,T>());	\
+		}																\
+																		\
+		template < int D, typename POD,typename E, typename Dest,typename Assign> \
+		void eval(Dest& dest, 											\
+			const XprBinOp<												\
+					Fcnl_##NAME<typename E::value_type,POD>,			\
+					XprArray<E,D>,										\
+					XprLiteral< POD >									\
+			> & expr, 													\
+			const Assign& assign_fn)									\
+		{																\
+			typedef typename E::value_type T;							\
+			check_size(dest,expr.rows(),expr.cols());					\
+																		\
+			T alpha = (T)expr.rhs().eval();								\
+			typename XprArray<E,D>::result_type A = expr.lhs().eval();	\
+																		\
+			impl::array_scalar_compare(dest.data(),A.data(),alpha,dest.size(),Fcnl_##NAME<T,T>());	\
+		}																\
+																		\
+		template < int D, typename POD,typename E, typename Dest,typename Assign> \
+		void eval(Dest& dest, 											\
+			const XprBinOp<												\
+					Fcnl_##NAME<POD,typename E::value_type>,			\
+					XprLiteral< POD >,									\
+					XprArray<E,D>										\
+			> & expr, 													\
+			const Assign& assign_fn)									\
+		{																\
+			typedef typename E::value_type T;							\
+			check_size(dest,expr.rows(),expr.cols());					\
+																		\
+			T alpha = (T)expr.lhs().eval();								\
+			typename XprArray<E,D>::result_type A = expr.rhs().eval();	\
+																		\
+			impl::array_scalar_compare(dest.data(),A.data(),alpha,dest.size(),Fcnl_##MIRRORED<T,T>());	\
+		}
+
+		GPUMATRIX_IMPLEMENT_COMPARE_EVAL(greater, less)
+		GPUMATRIX_IMPLEMENT_COMPARE_EVAL(less, greater)
+		GPUMATRIX_IMPLEMENT_COMPARE_EVAL(greater_eq, less_eq)
+		GPUMATRIX_IMPLEMENT_COMPARE_EVAL(less_eq, greater_eq)
+		GPUMATRIX_IMPLEMENT_COMPARE_EVAL(eq, eq)
+		GPUMATRIX_IMPLEMENT_COMPARE_EVAL(not_eq, not_eq)
+		GPUMATRIX_IMPLEMENT_COMPARE_EVAL(and, and)
+		GPUMATRIX_IMPLEMENT_COMPARE_EVAL(or, or)
+
+#undef GPUMATRIX_IMPLEMENT_COMPARE_EVAL
+
+		// Dest = f(A, B), f(A, beta), f(alpha, B), one kernel pass
+#define GPUMATRIX_IMPLEMENT_BINARY_FUNCTION_EVAL(NAME)					\
+		template < int D, typename E1, typename E2,typename Dest,typename Assign>	\
+		void eval(Dest& dest, 						\
+			const XprBinOp<						\
+					Fcnl_##NAME<typename E1::value_type,typename E2::value_type>,	\
+					XprArray<E1,D>,					\
+					XprArray<E2,D>					\
+			> & expr, 							\
+			const Assign& assign_fn)					\
+		{								\
+			typedef typename E1::value_type T;				\
+			check_size(dest,expr.rows(),expr.cols());			\
+									\
+			typename XprArray<E1,D>::result_type A = expr.lhs().eval();	\
+			typename XprArray<E2,D>::result_type B = expr.rhs().eval();	\
+									\
+			impl::binary_array_op(dest.data(),A.data(),B.data(),dest.size(),Fcnl_##NAME<T,T>());	\
+		}								\
+									\
+		template < int D, typename POD,typename E, typename Dest,typename Assign>	\
+		void eval(Dest& dest, 						\
+			const XprBinOp<						\
+					Fcnl_##NAME<typename E::value_type,POD>,		\
+					XprArray<E,D>,					\
+					XprLiteral< POD >					\
+			> & expr, 							\
+			const Assign& assign_fn)					\
+		{								\
+			typedef typename E::value_type T;				\
+			check_size(dest,expr.rows(),expr.cols());			\
+									\
+			T beta = (T)expr.rhs().eval();				\
+			typename XprArray<E,D>::result_type A = expr.lhs().eval();	\
+									\
+			impl::binary_array_op(dest.data(),A.data(),beta,dest.size(),Fcnl_##NAME<T,T>());	\
+		}								\
+									\
+		template < int D, typename POD,typename E, typename Dest,typename Assign>	\
+		void eval(Dest& dest, 						\
+			const XprBinOp<						\
+					Fcnl_##NAME<POD,typename E::value_type>,		\
+					XprLiteral< POD >,					\
+					XprArray<E,D>					\
+			> & expr, 							\
+			const Assign& assign_fn)					\
+		{								\
+			typedef typename E::value_type T;				\
+			check_size(dest,expr.rows(),expr.cols());			\
+									\
+			T alpha = (T)expr.lhs().eval();				\
+			typename XprArray<E,D>::result_type B = expr.rhs().eval();	\
+									\
+			impl::binary_array_op(dest.data(),alpha,B.data(),dest.size(),Fcnl_##NAME<T,T>());	\
+		}								\
+									\
+		template < typename E1, typename E2,typename Dest,typename Assign>	\
+		void eval(Dest& dest, 						\
+			const XprBinOp<						\
+					Fcnl_##NAME<typename E1::value_type,typename E2::value_type>,	\
+					XprMatrix<E1>,					\
+					XprMatrix<E2>					\
+			> & expr, 							\
+			const Assign& assign_fn)					\
+		{								\
+			typedef typename E1::value_type T;				\
+			check_size(dest,expr.rows(),expr.cols());			\
+									\
+			typename XprMatrix<E1>::result_type A = expr.lhs().eval();	\
+			typename XprMatrix<E2>::result_type B = expr.rhs().eval();	\
+									\
+			impl::binary_array_op(dest.data(),A.data(),B.data(),dest.size(),Fcnl_##NAME<T,T>());	\
+		}								\
+									\
+		template < typename POD,typename E, typename Dest,typename Assign>	\
+		void eval(Dest& dest, 						\
+			const XprBinOp<						\
+					Fcnl_##NAME<typename E::value_type,POD>,		\
+					XprMatrix<E>,					\
+					XprLiteral< POD >					\
+			> & expr, 							\
+			const Assign& assign_fn)					\
+		{								\
+			typedef typename E::value_type T;				\
+			check_size(dest,expr.rows(),expr.cols());			\
+									\
+			T beta = (T)expr.rhs().eval();				\
+			typename XprMatrix<E>::result_type A = expr.lhs().eval();	\
+									\
+			impl::binary_array_op(dest.data(),A.data(),beta,dest.size(),Fcnl_##NAME<T,T>());	\
+		}								\
+									\
+		template < typename POD,typename E, typename Dest,typename Assign>	\
+		void eval(Dest& dest, 						\
+			const XprBinOp<						\
+					Fcnl_##NAME<POD,typename E::value_type>,		\
+					XprLiteral< POD >,					\
+					XprMatrix<E>					\
+			> & expr, 							\
+			const Assign& assign_fn)					\
+		{								\
+			typedef typename E::value_type T;				\
+			check_size(dest,expr.rows(),expr.cols());			\
+									\
+			T alpha = (T)expr.lhs().eval();				\
+			typename XprMatrix<E>::result_type B = expr.rhs().eval();	\
+									\
+			impl::binary_array_op(dest.data(),alpha,B.data(),dest.size(),Fcnl_##NAME<T,T>());	\
+		}
+
+		GPUMATRIX_BINARY_FUNCTIONALS(GPUMATRIX_IMPLEMENT_BINARY_FUNCTION_EVAL)
+
+#undef GPUMATRIX_IMPLEMENT_BINARY_FUNCTION_EVAL
+
+		// Dest = select(Mask, A, B)
+		template < int D, typename M, typename E1, typename E2,typename Dest,typename Assign> 
+		void eval(Dest& dest, 
+			const XprSelect<
+					XprArray<M,D>,
+					XprArray<E1,D>,
+					XprArray<E2,D>
+			> & expr, 
+			const Assign& assign_fn)
+		{
+			typedef typename Dest::value_type T;
+			check_size(dest,expr.rows(),expr.cols());
+
+			typename XprArray<M,D>::result_type K = expr.mask().eval();
+			typename PromotedOperand<T,E1,D>::type A = PromotedOperand<T,E1,D>::eval(expr.lhs());
+			typename PromotedOperand<T,E2,D>::type B = PromotedOperand<T,E2,D>::eval(expr.rhs());
+
+			impl::array_select(dest.data(),K.data(),A.data(),B.data(),dest.size());
+		}
+
+		// Dest = select(Mask, A, beta)
+		template < int D, typename M, typename E, typename POD,typename Dest,typename Assign> 
+		void eval(Dest& dest, 
+			const XprSelect<
+					XprArray<M,D>,
+					XprArray<E,D>,
+					XprLiteral< POD >
+			> & expr, 
+			const Assign& assign_fn)
+		{
+			check_size(dest,expr.rows(),expr.cols());
+
+			typename E::value_type beta = (typename E::value_type)expr.rhs().eval();
+			typename XprArray<M,D>::result_type K = expr.mask().eval();
+			typename XprArray<E,D>::result_type A = expr.lhs().eval();
+
+			impl::array_select(dest.data(),K.data(),A.data(),beta,dest.size());
+		}
+
+		// Dest = select(Mask, alpha, B)
+		template < int D, typename M, typename POD, typename E,typename Dest,typename Assign> 
+		void eval(Dest& dest, 
+			const XprSelect<
+					XprArray<M,D>,
+					XprLiteral< POD >,
+					XprArray<E,D>
+			> & expr, 
+			const Assign& assign_fn)
+		{
+			check_size(dest,expr.rows(),expr.cols());
+
+			typename E::value_type alpha = (typename E::value_type)expr.lhs().eval();
+			typename XprArray<M,D>::result_type K = expr.mask().eval();
+			typename XprArray<E,D>::result_type B = expr.rhs().eval();
+
+			impl::array_select(dest.data(),K.data(),alpha,B.data(),dest.size());
+		}
+
 		// Dest = M.rowwise().sum()
 		template <typename E, typename Dest,typename Assign> 
 		void eval(Dest& dest, 
@@ -689,6 +986,23 @@ namespace gpumatrix
 		
 		} 
 
+		// Dest = M.rowwise() op x, Dest = M.colwise() op x
+		template <typename BinOp, typename E, typename V, int Dir, typename Dest,typename Assign> 
+		void eval(Dest& dest, 
+			const XprBroadcast<BinOp,E,V,Dir> & expr, 
+			const Assign& assign_fn)
+		{
+			check_size(dest,expr.rows(),expr.cols());
+
+			typename E::result_type M = expr.expr().eval();
+			typename V::result_type x = expr.vector().eval();
+
+			if (Dir == BroadcastRowWise)
+				impl::rowwise_array_op(dest.data(),M.data(),M.rows(),M.cols(),x.data(),BinOp());
+			else
+				impl::colwise_array_op(dest.data(),M.data(),M.rows(),M.cols(),x.data(),BinOp());
+		} 
+
 		// Dest = - M
 		template <typename UnOP, typename E, typename Dest,typename Assign> 
 		void eval(Dest& dest, 
@@ -699,7 +1013,7 @@ namespace gpumatrix
 
 			typename XprMatrix<E>::result_type M = expr.expr().eval();
 
-			impl::unary_array_op( dest.data(), M.data(), M.size(),UnOP()) ;
+			impl::unary_array_op( dest.data(), M.data(), M.size(),UnOP(),math_mode()) ;
 		
 		} 
 
@@ -712,7 +1026,7 @@ namespace gpumatrix
 			check_size(dest,expr.rows(),expr.cols());
 			typename XprArray<E,D>::result_type M = expr.expr().eval();
 
-			unary_array_op( dest.data(), M.data(), M.size(),UnOP()) ;
+			impl::unary_array_op( dest.data(), M.data(), M.size(),UnOP(),math_mode()) ;
 		
 		} 
 
@@ -726,7 +1040,7 @@ namespace gpumatrix
 
 			typename XprVector<E>::result_type M = expr.expr().eval();
 
-			impl::unary_array_op( dest.data(), M.data(), M.size(),UnOP()) ;
+			impl::unary_array_op( dest.data(), M.data(), M.size(),UnOP(),math_mode()) ;
 		
 		} 
 
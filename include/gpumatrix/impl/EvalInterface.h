@@ -32,6 +32,10 @@ namespace gpumatrix
 
 	template<typename E>	class RowWiseSum;
 	template<typename E>	class ColWiseSum;
+	template<typename M, typename E1, typename E2>	class XprSelect;
+	template<typename BinOp, typename E, typename V, int Dir>	class XprBroadcast;
+	template<typename T, typename E, int Side>	class XprSparseProduct;
+	template<typename T, int R, int C, typename E, int Side>	class XprFixedProduct;
 
 	template <class E> class XprResultType;
 	template <class E> class XprMatrixTranspose;
@@ -315,6 +319,137 @@ namespace gpumatrix
 			const Assign& assign_fn);
 
 
+		// Mask = A op B, Mask = A op alpha, Mask = alpha op A
+#define GPUMATRIX_DECLARE_COMPARE_EVAL(NAME)							\
+		template < int D, typename E1, typename E2,typename Dest,typename Assign> \
+		void eval(Dest& dest, 											\
+			const XprBinOp<												\
+					Fcnl_##NAME<typename E1::value_type,typename E2::value_type>,	\
+					XprArray<E1,D>,										\
+					XprArray<E2,D>										\
+			> & expr, 													\
+			const Assign& assign_fn);									\
+																		\
+		template < int D, typename POD,typename E, typename Dest,typename Assign> \
+		void eval(Dest& dest, 											\
+			const XprBinOp<												\
+					Fcnl_##NAME<typename E::value_type,POD>,			\
+					XprArray<E,D>,										\
+					XprLiteral< POD >									\
+			> & expr, 													\
+			const Assign& assign_fn);									\
+																		\
+		template < int D, typename POD,typename E, typename Dest,typename Assign> \
+		void eval(Dest& dest, 											\
+			const XprBinOp<												\
+					Fcnl_##NAME<POD,typename E::value_type>,			\
+					XprLiteral< POD >,									\
+					XprArray<E,D>										\
+			> & expr, 													\
+			const Assign& assign_fn);
+
+		GPUMATRIX_DECLARE_COMPARE_EVAL(greater)
+		GPUMATRIX_DECLARE_COMPARE_EVAL(less)
+		GPUMATRIX_DECLARE_COMPARE_EVAL(greater_eq)
+		GPUMATRIX_DECLARE_COMPARE_EVAL(less_eq)
+		GPUMATRIX_DECLARE_COMPARE_EVAL(eq)
+		GPUMATRIX_DECLARE_COMPARE_EVAL(not_eq)
+		GPUMATRIX_DECLARE_COMPARE_EVAL(and)
+		GPUMATRIX_DECLARE_COMPARE_EVAL(or)
+
+#undef GPUMATRIX_DECLARE_COMPARE_EVAL
+
+		// Dest = f(A, B), f(A, beta), f(alpha, B) for the functionals in
+		// GPUMATRIX_BINARY_FUNCTIONALS, on arrays and matrices
+#define GPUMATRIX_DECLARE_BINARY_FUNCTION_EVAL(NAME)					\
+		template < int D, typename E1, typename E2,typename Dest,typename Assign>	\
+		void eval(Dest& dest, 						\
+			const XprBinOp<						\
+					Fcnl_##NAME<typename E1::value_type,typename E2::value_type>,	\
+					XprArray<E1,D>,					\
+					XprArray<E2,D>					\
+			> & expr, 							\
+			const Assign& assign_fn);					\
+									\
+		template < int D, typename POD,typename E, typename Dest,typename Assign>	\
+		void eval(Dest& dest, 						\
+			const XprBinOp<						\
+					Fcnl_##NAME<typename E::value_type,POD>,		\
+					XprArray<E,D>,					\
+					XprLiteral< POD >					\
+			> & expr, 							\
+			const Assign& assign_fn);					\
+									\
+		template < int D, typename POD,typename E, typename Dest,typename Assign>	\
+		void eval(Dest& dest, 						\
+			const XprBinOp<						\
+					Fcnl_##NAME<POD,typename E::value_type>,		\
+					XprLiteral< POD >,					\
+					XprArray<E,D>					\
+			> & expr, 							\
+			const Assign& assign_fn);					\
+									\
+		template < typename E1, typename E2,typename Dest,typename Assign>	\
+		void eval(Dest& dest, 						\
+			const XprBinOp<						\
+					Fcnl_##NAME<typename E1::value_type,typename E2::value_type>,	\
+					XprMatrix<E1>,					\
+					XprMatrix<E2>					\
+			> & expr, 							\
+			const Assign& assign_fn);					\
+									\
+		template < typename POD,typename E, typename Dest,typename Assign>	\
+		void eval(Dest& dest, 						\
+			const XprBinOp<						\
+					Fcnl_##NAME<typename E::value_type,POD>,		\
+					XprMatrix<E>,					\
+					XprLiteral< POD >					\
+			> & expr, 							\
+			const Assign& assign_fn);					\
+									\
+		template < typename POD,typename E, typename Dest,typename Assign>	\
+		void eval(Dest& dest, 						\
+			const XprBinOp<						\
+					Fcnl_##NAME<POD,typename E::value_type>,		\
+					XprLiteral< POD >,					\
+					XprMatrix<E>					\
+			> & expr, 							\
+			const Assign& assign_fn);
+
+		GPUMATRIX_BINARY_FUNCTIONALS(GPUMATRIX_DECLARE_BINARY_FUNCTION_EVAL)
+
+#undef GPUMATRIX_DECLARE_BINARY_FUNCTION_EVAL
+
+		// Dest = select(Mask, A, B)
+		template < int D, typename M, typename E1, typename E2,typename Dest,typename Assign> 
+		void eval(Dest& dest, 
+			const XprSelect<
+					XprArray<M,D>,
+					XprArray<E1,D>,
+					XprArray<E2,D>
+			> & expr, 
+			const Assign& assign_fn);
+
+		// Dest = select(Mask, A, beta)
+		template < int D, typename M, typename E, typename POD,typename Dest,typename Assign> 
+		void eval(Dest& dest, 
+			const XprSelect<
+					XprArray<M,D>,
+					XprArray<E,D>,
+					XprLiteral< POD >
+			> & expr, 
+			const Assign& assign_fn);
+
+		// Dest = select(Mask, alpha, B)
+		template < int D, typename M, typename POD, typename E,typename Dest,typename Assign> 
+		void eval(Dest& dest, 
+			const XprSelect<
+					XprArray<M,D>,
+					XprLiteral< POD >,
+					XprArray<E,D>
+			> & expr, 
+			const Assign& assign_fn);
+
 		// Dest = M.rowwise().sum()
 		template <typename E, typename Dest,typename Assign> 
 		void eval(Dest& dest, 
@@ -327,6 +462,30 @@ namespace gpumatrix
 			const ColWiseSum<E> & expr, 
 			const Assign& assign_fn);
 
+		// Dest = M.rowwise() op x, Dest = M.colwise() op x
+		template <typename BinOp, typename E, typename V, int Dir, typename Dest,typename Assign> 
+		void eval(Dest& dest, 
+			const XprBroadcast<BinOp,E,V,Dir> & expr, 
+			const Assign& assign_fn);
+
+		// Dest = S*M, S.transpose()*M, M*S, M*S.transpose()
+		template <typename T, typename E, int Side, typename Dest,typename Assign> 
+		void eval(Dest& dest, 
+			const XprSparseProduct<T,XprMatrix<E>,Side> & expr, 
+			const Assign& assign_fn);
+
+		// Dest = S*v, S.transpose()*v
+		template <typename T, typename E, int Side, typename Dest,typename Assign> 
+		void eval(Dest& dest, 
+			const XprSparseProduct<T,XprVector<E>,Side> & expr, 
+			const Assign& assign_fn);
+
+		// Dest = F*M, M*F
+		template <typename T, int R, int C, typename E, int Side, typename Dest,typename Assign> 
+		void eval(Dest& dest, 
+			const XprFixedProduct<T,R,C,XprMatrix<E>,Side> & expr, 
+			const Assign& assign_fn);
+
 		// Dest = - M
 		template <typename UnOP, typename E, typename Dest,typename Assign> 
 		void eval(Dest& dest, 
@@ -2,29 +2,142 @@
 #define FUNCTION_IMPL_H
 
 #include <gpumatrix/impl/backend/Interface.h>
+#include <gpumatrix/impl/FunctionInterface.h>
 
 
 
 namespace gpumatrix
 {
+	inline AccumulationPolicy & default_accumulation_policy()
+	{
+		static thread_local AccumulationPolicy policy = AccumulateNative;
+		return policy;
+	}
+
+	inline AccumulationPolicy accumulation_policy()
+	{
+		return default_accumulation_policy();
+	}
+
+	inline void set_accumulation_policy(AccumulationPolicy policy)
+	{
+		default_accumulation_policy() = policy;
+	}
+
+	inline MathMode & default_math_mode()
+	{
+		static thread_local MathMode mode = MathStrict;
+		return mode;
+	}
+
+	inline MathMode math_mode()
+	{
+		return default_math_mode();
+	}
+
+	inline void set_math_mode(MathMode mode)
+	{
+		default_math_mode() = mode;
+	}
 
 	namespace impl
 	{
+		template <class Fcnl>
+		void unary_array_op(typename Fcnl::value_type * odata, const typename Fcnl::value_type * idata, std::size_t size, const Fcnl & func, MathMode mode)
+		{
+			if (mode == MathFast)
+				impl::unary_array_op(odata,idata,size,typename FastFunctional<Fcnl>::type());
+			else
+				impl::unary_array_op(odata,idata,size,func);
+		}
+
+		// There is nothing wider than double on the device, so the policy
+		// only changes the float reductions below.
+		template <typename T>
+		T accumulate_sum(const T * data, std::size_t size, AccumulationPolicy policy)
+		{
+			return impl::sum(data,size);
+		}
+
+		inline float accumulate_sum(const float * data, std::size_t size, AccumulationPolicy policy)
+		{
+			if (policy == AccumulateWide)
+				return (float)impl::wide_sum(data,size);
+
+			return impl::sum(data,size);
+		}
+
+		// cuBLAS level 1 takes int lengths, so longer arrays are reduced in
+		// pieces of BlasChunk; anything shorter is a single call as before.
+		inline int blas_chunk(std::size_t size, std::size_t offset)
+		{
+			return (int)(size - offset < BlasChunk ? size - offset : BlasChunk);
+		}
+
+		template <typename T>
+		T accumulate_squared_norm(const T * data, std::size_t size, AccumulationPolicy policy)
+		{
+			T norm = impl::nrm2(blas_chunk(size,0),data,1);
+			T squared = norm*norm;
+
+			for (std::size_t i = BlasChunk; i < size; i += BlasChunk)
+			{
+				norm = impl::nrm2(blas_chunk(size,i),data + i,1);
+				squared += norm*norm;
+			}
+			return squared;
+		}
+
+		inline float accumulate_squared_norm(const float * data, std::size_t size, AccumulationPolicy policy)
+		{
+			if (policy == AccumulateWide)
+				return (float)impl::wide_squared_norm(data,size);
+
+			return accumulate_squared_norm<float>(data,size,policy);
+		}
+
+		template <typename T>
+		T accumulate_dot(const T * x, const T * y, std::size_t size, AccumulationPolicy policy)
+		{
+			T d = impl::dot(blas_chunk(size,0),x,1,y,1);
+
+			for (std::size_t i = BlasChunk; i < size; i += BlasChunk)
+				d += impl::dot(blas_chunk(size,i),x + i,1,y + i,1);
+			return d;
+		}
+
+		inline float accumulate_dot(const float * x, const float * y, std::size_t size, AccumulationPolicy policy)
+		{
+			if (policy == AccumulateWide)
+				return (float)impl::wide_dot(x,y,size);
+
+			return accumulate_dot<float>(x,y,size,policy);
+		}
+
 
 		template <typename E>
 		typename E::value_type squaredNorm(const E & m)
 		{
-			typename E::value_type norm =  impl::nrm2(m.size(),m.data(),1) ;
-			return norm*norm;
+			return impl::squaredNorm(m,accumulation_policy());
 		}
 
+		template <typename E>
+		typename E::value_type squaredNorm(const E & m, AccumulationPolicy policy)
+		{
+			return impl::accumulate_squared_norm(m.data(),m.size(),policy);
+		}
 
 
 		template <typename E>
 		typename E::value_type sum(const E & m)
 		{
-			return impl::sum(m.data(),m.size());
-			
+			return impl::sum(m,accumulation_policy());
+		}
+
+		template <typename E>
+		typename E::value_type sum(const E & m, AccumulationPolicy policy)
+		{
+			return impl::accumulate_sum(m.data(),m.size(),policy);
 		}
 
 		template <typename E>
@@ -44,10 +157,16 @@ namespace gpumatrix
 		template <typename E1, typename E2>
 		typename E1::value_type dot(const E1 & v1, const E2 & v2)
 		{
-			return impl::dot(v1.size(),v1.data(),1,v2.data(),1) ;
+			return impl::dot(v1,v2,accumulation_policy());
+		}
+
+		template <typename E1, typename E2>
+		typename E1::value_type dot(const E1 & v1, const E2 & v2, AccumulationPolicy policy)
+		{
+			return impl::accumulate_dot(v1.data(),v2.data(),v1.size(),policy);
 		}
 
 
 	}
 }
-#endif
\ No newline at end of file
+#endif
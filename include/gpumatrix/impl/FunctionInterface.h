@@ -3,13 +3,58 @@
 
 namespace gpumatrix
 {
+	/**
+	* Accumulator used by the reductions (sum, dot, squaredNorm) over
+	* single precision data. The storage type is never changed, only the
+	* running sum is widened to double.
+	*/
+	enum AccumulationPolicy
+	{
+		AccumulateNative,	/**< accumulate in the storage type, fastest */
+		AccumulateWide		/**< accumulate in double, rounded once at the end */
+	};
+
+	/**
+	* Policy used by the reductions this thread calls without an explicit
+	* policy. Like the execution context, it is kept per host thread.
+	*/
+	AccumulationPolicy accumulation_policy();
+
+	void set_accumulation_policy(AccumulationPolicy policy);
+
+	/**
+	* Implementation of exp, log, tanh, logistic, softplus and erf in the
+	* element wise kernels. The fast forms are the polynomials of
+	* FastMath.h with the error bounds listed there; they are used only
+	* after set_math_mode(MathFast), the default is MathStrict.
+	*/
+	enum MathMode
+	{
+		MathFast,		/**< polynomial forms, a few ulp */
+		MathStrict		/**< the device math library */
+	};
+
+	/** Mode used by the element wise kernels this thread launches. */
+	MathMode math_mode();
+
+	void set_math_mode(MathMode mode);
+
     namespace impl
     {
+		template <class Fcnl>
+		void unary_array_op(typename Fcnl::value_type * odata, const typename Fcnl::value_type * idata, std::size_t size, const Fcnl & func, MathMode mode);
+
 		template <typename E>
 		typename E::value_type squaredNorm(const E & m);
+
+		template <typename E>
+		typename E::value_type squaredNorm(const E & m, AccumulationPolicy policy);
 		
 		template <typename E>
 		typename E::value_type sum(const E & m);
+
+		template <typename E>
+		typename E::value_type sum(const E & m, AccumulationPolicy policy);
 		
 		template <typename E>
 		typename E::value_type min(const E & m);
@@ -19,9 +64,12 @@ namespace gpumatrix
 		
 		template <typename E1, typename E2>
 		typename E1::value_type dot(const E1 & v1, const E2 & v2);
+
+		template <typename E1, typename E2>
+		typename E1::value_type dot(const E1 & v1, const E2 & v2, AccumulationPolicy policy);
 		
     }
 }
 
 
-#endif
\ No newline at end of file
+#endif
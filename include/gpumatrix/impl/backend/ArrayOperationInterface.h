@@ -3,6 +3,7 @@
 
 
 #include <gpumatrix/Functional.h>
+#include <gpumatrix/impl/backend/LaunchInterface.h>
 
 namespace gpumatrix
 {
@@ -10,7 +11,7 @@ namespace gpumatrix
 	namespace impl
 	{
 	    #define DECLEAR_SCALAR_ARRAY_OP(OPNAME, TYPE) \
-	    void scalar_array_##OPNAME( TYPE *odata, TYPE  alpha, const TYPE *idata,  int size);
+	    void scalar_array_##OPNAME( TYPE *odata, TYPE  alpha, const TYPE *idata,  std::size_t size);
 
 
 	    DECLEAR_SCALAR_ARRAY_OP(add,float)
@@ -21,10 +22,18 @@ namespace gpumatrix
 	    DECLEAR_SCALAR_ARRAY_OP(mul,double)
 	    DECLEAR_SCALAR_ARRAY_OP(div,float)
 	    DECLEAR_SCALAR_ARRAY_OP(div,double)
+	    DECLEAR_SCALAR_ARRAY_OP(add,half)
+	    DECLEAR_SCALAR_ARRAY_OP(add,bfloat16)
+	    DECLEAR_SCALAR_ARRAY_OP(sub,half)
+	    DECLEAR_SCALAR_ARRAY_OP(sub,bfloat16)
+	    DECLEAR_SCALAR_ARRAY_OP(mul,half)
+	    DECLEAR_SCALAR_ARRAY_OP(mul,bfloat16)
+	    DECLEAR_SCALAR_ARRAY_OP(div,half)
+	    DECLEAR_SCALAR_ARRAY_OP(div,bfloat16)
 
 
 	    #define DECLEAR_ARRAY_ARRAY_OP(OPNAME, TYPE) \
-	    void array_##OPNAME( TYPE *odata, const TYPE  * idata1, const TYPE * idata2,  int size) ;
+	    void array_##OPNAME( TYPE *odata, const TYPE  * idata1, const TYPE * idata2,  std::size_t size) ;
 
 
 
@@ -36,11 +45,19 @@ namespace gpumatrix
 	    DECLEAR_ARRAY_ARRAY_OP(mul,double)
 	    DECLEAR_ARRAY_ARRAY_OP(div,float)
 	    DECLEAR_ARRAY_ARRAY_OP(div,double)
+	    DECLEAR_ARRAY_ARRAY_OP(add,half)
+	    DECLEAR_ARRAY_ARRAY_OP(add,bfloat16)
+	    DECLEAR_ARRAY_ARRAY_OP(sub,half)
+	    DECLEAR_ARRAY_ARRAY_OP(sub,bfloat16)
+	    DECLEAR_ARRAY_ARRAY_OP(mul,half)
+	    DECLEAR_ARRAY_ARRAY_OP(mul,bfloat16)
+	    DECLEAR_ARRAY_ARRAY_OP(div,half)
+	    DECLEAR_ARRAY_ARRAY_OP(div,bfloat16)
 	    DECLEAR_ARRAY_ARRAY_OP(cross_entropy,double)
 	    DECLEAR_ARRAY_ARRAY_OP(cross_entropy_diff,double)
 
 	    #define DELEAR_ARRAY_ARRAY_COMPOUND_OP(OPNAME, TYPE) \
-	    void array_compound_op( TYPE *odata, const TYPE  * idata, int size,const Fcnl_##OPNAME<TYPE,TYPE> & func);
+	    void array_compound_op( TYPE *odata, const TYPE  * idata, std::size_t size,const Fcnl_##OPNAME<TYPE,TYPE> & func);
 
 
 	    DELEAR_ARRAY_ARRAY_COMPOUND_OP(add_eq, double)
@@ -51,9 +68,17 @@ namespace gpumatrix
 	    DELEAR_ARRAY_ARRAY_COMPOUND_OP(mul_eq, float)
 	    DELEAR_ARRAY_ARRAY_COMPOUND_OP(div_eq, double)
 	    DELEAR_ARRAY_ARRAY_COMPOUND_OP(div_eq, float)
+	    DELEAR_ARRAY_ARRAY_COMPOUND_OP(add_eq, half)
+	    DELEAR_ARRAY_ARRAY_COMPOUND_OP(add_eq, bfloat16)
+	    DELEAR_ARRAY_ARRAY_COMPOUND_OP(sub_eq, half)
+	    DELEAR_ARRAY_ARRAY_COMPOUND_OP(sub_eq, bfloat16)
+	    DELEAR_ARRAY_ARRAY_COMPOUND_OP(mul_eq, half)
+	    DELEAR_ARRAY_ARRAY_COMPOUND_OP(mul_eq, bfloat16)
+	    DELEAR_ARRAY_ARRAY_COMPOUND_OP(div_eq, half)
+	    DELEAR_ARRAY_ARRAY_COMPOUND_OP(div_eq, bfloat16)
 
 	    #define DELEAR_SCALAR_ARRAY_COMPOUND_OP(OPNAME, TYPE) \
-	    void scalar_array_compound_op( TYPE *odata, TYPE  alpha,int size,const Fcnl_##OPNAME<TYPE,TYPE> & func) ;
+	    void scalar_array_compound_op( TYPE *odata, TYPE  alpha,std::size_t size,const Fcnl_##OPNAME<TYPE,TYPE> & func) ;
 
 	    DELEAR_SCALAR_ARRAY_COMPOUND_OP(add_eq, double)
 	    DELEAR_SCALAR_ARRAY_COMPOUND_OP(add_eq, float)
@@ -63,18 +88,105 @@ namespace gpumatrix
 	    DELEAR_SCALAR_ARRAY_COMPOUND_OP(mul_eq, float)
 	    DELEAR_SCALAR_ARRAY_COMPOUND_OP(div_eq, double)
 	    DELEAR_SCALAR_ARRAY_COMPOUND_OP(div_eq, float)
+	    DELEAR_SCALAR_ARRAY_COMPOUND_OP(add_eq, half)
+	    DELEAR_SCALAR_ARRAY_COMPOUND_OP(add_eq, bfloat16)
+	    DELEAR_SCALAR_ARRAY_COMPOUND_OP(sub_eq, half)
+	    DELEAR_SCALAR_ARRAY_COMPOUND_OP(sub_eq, bfloat16)
+	    DELEAR_SCALAR_ARRAY_COMPOUND_OP(mul_eq, half)
+	    DELEAR_SCALAR_ARRAY_COMPOUND_OP(mul_eq, bfloat16)
+	    DELEAR_SCALAR_ARRAY_COMPOUND_OP(div_eq, half)
+	    DELEAR_SCALAR_ARRAY_COMPOUND_OP(div_eq, bfloat16)
+
+	    // odata(i,j) = idata(i,j) op x[i] (colwise) or op x[j] (rowwise) on a
+	    // column major row x col matrix, for Fcnl_add/sub/mul/div
+	    template <class Fcnl>
+	    void colwise_array_op(typename Fcnl::value_type *odata, const typename Fcnl::value_type * idata, int row, int col, const typename Fcnl::value_type * x, const Fcnl & func);
+	    template <class Fcnl>
+	    void rowwise_array_op(typename Fcnl::value_type *odata, const typename Fcnl::value_type * idata, int row, int col, const typename Fcnl::value_type * x, const Fcnl & func);
 
 	    #define DELEAR_COLWISE_ARRAY_COMPOUND_OP(OPNAME, TYPE) \
 	    void colwise_array_compound_op( TYPE *odata, int row, int col, const TYPE * x ,const Fcnl_colwise_##OPNAME<TYPE,TYPE> & func) ;
 
-	    DELEAR_COLWISE_ARRAY_COMPOUND_OP(add_eq, double)
-	    DELEAR_COLWISE_ARRAY_COMPOUND_OP(add_eq, float)
-
 	    #define DELEAR_ROWWISE_ARRAY_COMPOUND_OP(OPNAME, TYPE) \
 	    void rowwise_array_compound_op( TYPE *odata, int row, int col, const TYPE * x ,const Fcnl_rowwise_##OPNAME<TYPE,TYPE> & func) ;
 
-	    DELEAR_ROWWISE_ARRAY_COMPOUND_OP(add_eq, double)
-	    DELEAR_ROWWISE_ARRAY_COMPOUND_OP(add_eq, float)
+	    #define DELEAR_BROADCAST_ARRAY_COMPOUND_OP(TYPE) \
+	    DELEAR_COLWISE_ARRAY_COMPOUND_OP(add_eq, TYPE) \
+	    DELEAR_COLWISE_ARRAY_COMPOUND_OP(sub_eq, TYPE) \
+	    DELEAR_COLWISE_ARRAY_COMPOUND_OP(mul_eq, TYPE) \
+	    DELEAR_COLWISE_ARRAY_COMPOUND_OP(div_eq, TYPE) \
+	    DELEAR_ROWWISE_ARRAY_COMPOUND_OP(add_eq, TYPE) \
+	    DELEAR_ROWWISE_ARRAY_COMPOUND_OP(sub_eq, TYPE) \
+	    DELEAR_ROWWISE_ARRAY_COMPOUND_OP(mul_eq, TYPE) \
+	    DELEAR_ROWWISE_ARRAY_COMPOUND_OP(div_eq, TYPE)
+
+	    DELEAR_BROADCAST_ARRAY_COMPOUND_OP(double)
+	    DELEAR_BROADCAST_ARRAY_COMPOUND_OP(float)
+	    DELEAR_BROADCAST_ARRAY_COMPOUND_OP(half)
+	    DELEAR_BROADCAST_ARRAY_COMPOUND_OP(bfloat16)
+
+	    // element type conversion on the device between any two of double,
+	    // float, half and bfloat16; 16 bit types go through float
+	    #define DECLEAR_ARRAY_CONVERT(TO, FROM) \
+	    void array_convert( TO *odata, const FROM * idata, std::size_t size);
+
+	    DECLEAR_ARRAY_CONVERT(float, double)
+	    DECLEAR_ARRAY_CONVERT(double, float)
+	    DECLEAR_ARRAY_CONVERT(half, float)
+	    DECLEAR_ARRAY_CONVERT(float, half)
+	    DECLEAR_ARRAY_CONVERT(bfloat16, float)
+	    DECLEAR_ARRAY_CONVERT(float, bfloat16)
+	    DECLEAR_ARRAY_CONVERT(half, double)
+	    DECLEAR_ARRAY_CONVERT(double, half)
+	    DECLEAR_ARRAY_CONVERT(bfloat16, double)
+	    DECLEAR_ARRAY_CONVERT(double, bfloat16)
+	    DECLEAR_ARRAY_CONVERT(half, bfloat16)
+	    DECLEAR_ARRAY_CONVERT(bfloat16, half)
+
+	    // element wise comparison into a bool mask, one byte per element
+	    #define DECLEAR_ARRAY_COMPARE(OPNAME, TYPE) \
+	    void array_compare( bool *odata, const TYPE * idata1, const TYPE * idata2, std::size_t size, const Fcnl_##OPNAME<TYPE,TYPE> & func); \
+	    void array_scalar_compare( bool *odata, const TYPE * idata, TYPE alpha, std::size_t size, const Fcnl_##OPNAME<TYPE,TYPE> & func);
+
+	    DECLEAR_ARRAY_COMPARE(greater, float)
+	    DECLEAR_ARRAY_COMPARE(greater, double)
+	    DECLEAR_ARRAY_COMPARE(less, float)
+	    DECLEAR_ARRAY_COMPARE(less, double)
+	    DECLEAR_ARRAY_COMPARE(greater_eq, float)
+	    DECLEAR_ARRAY_COMPARE(greater_eq, double)
+	    DECLEAR_ARRAY_COMPARE(less_eq, float)
+	    DECLEAR_ARRAY_COMPARE(less_eq, double)
+	    DECLEAR_ARRAY_COMPARE(eq, float)
+	    DECLEAR_ARRAY_COMPARE(eq, double)
+	    DECLEAR_ARRAY_COMPARE(not_eq, float)
+	    DECLEAR_ARRAY_COMPARE(not_eq, double)
+	    DECLEAR_ARRAY_COMPARE(greater, half)
+	    DECLEAR_ARRAY_COMPARE(greater, bfloat16)
+	    DECLEAR_ARRAY_COMPARE(less, half)
+	    DECLEAR_ARRAY_COMPARE(less, bfloat16)
+	    DECLEAR_ARRAY_COMPARE(greater_eq, half)
+	    DECLEAR_ARRAY_COMPARE(greater_eq, bfloat16)
+	    DECLEAR_ARRAY_COMPARE(less_eq, half)
+	    DECLEAR_ARRAY_COMPARE(less_eq, bfloat16)
+	    DECLEAR_ARRAY_COMPARE(eq, half)
+	    DECLEAR_ARRAY_COMPARE(eq, bfloat16)
+	    DECLEAR_ARRAY_COMPARE(not_eq, half)
+	    DECLEAR_ARRAY_COMPARE(not_eq, bfloat16)
+	    DECLEAR_ARRAY_COMPARE(eq, bool)
+	    DECLEAR_ARRAY_COMPARE(not_eq, bool)
+	    DECLEAR_ARRAY_COMPARE(and, bool)
+	    DECLEAR_ARRAY_COMPARE(or, bool)
+
+	    // odata = mask ? a : b, either branch may be a scalar
+	    #define DECLEAR_ARRAY_SELECT(TYPE) \
+	    void array_select( TYPE *odata, const bool * mask, const TYPE * idata1, const TYPE * idata2, std::size_t size); \
+	    void array_select( TYPE *odata, const bool * mask, const TYPE * idata1, TYPE beta, std::size_t size); \
+	    void array_select( TYPE *odata, const bool * mask, TYPE alpha, const TYPE * idata2, std::size_t size);
+
+	    DECLEAR_ARRAY_SELECT(float)
+	    DECLEAR_ARRAY_SELECT(double)
+	    DECLEAR_ARRAY_SELECT(half)
+	    DECLEAR_ARRAY_SELECT(bfloat16)
 
 
 
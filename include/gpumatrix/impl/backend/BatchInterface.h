@@ -0,0 +1,32 @@
+#ifndef BATCH_INTERFACE_H
+#define BATCH_INTERFACE_H
+
+#include <gpumatrix/impl/backend/LaunchInterface.h>
+
+namespace gpumatrix
+{
+	namespace impl
+	{
+		/* A batch stores entry e of instance b of X at X[e*ldx + b*incx]:
+		   incx is 1 for a batch in SoA layout and 0 for one instance
+		   broadcast to the whole batch */
+
+		/* C_b = A_b*B_b for the n instances of the R x K batch A and the K x C batch B */
+		template <typename T, int R, int K, int C> void batch_mm(std::size_t n, const T *A, std::size_t lda, int inca,
+			const T *B, std::size_t ldb, int incb, T *Cm, std::size_t ldc);
+
+		/* C_b = F*B_b and C_b = A_b*F with the R x K or K x C factor F held on
+		   the host; it goes to the kernel by value, with no device copy */
+		template <typename T, int R, int K, int C> void batch_mm_fixed_left(std::size_t n, const T *F,
+			const T *B, std::size_t ldb, T *Cm, std::size_t ldc);
+		template <typename T, int R, int K, int C> void batch_mm_fixed_right(std::size_t n, const T *A, std::size_t lda,
+			const T *F, T *Cm, std::size_t ldc);
+
+		/* Ainv_b = A_b^-1 and det_b = det(A_b) for the n instances of the D x D batch A,
+		   by the adjugate; a singular instance gives inf or nan. Ainv or det may be null */
+		template <typename T, int D> void batch_inverse(std::size_t n, const T *A, std::size_t lda, T *Ainv, std::size_t ldi, T *det);
+	}
+}
+
+
+#endif
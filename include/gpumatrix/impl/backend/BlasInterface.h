@@ -1,6 +1,8 @@
 #ifndef BACKEND_EVAL_INTERFACE_H
 #define BACKEND_EVAL_INTERFACE_H
 
+#include <gpumatrix/Half.h>
+
 namespace gpumatrix
 {
   
@@ -28,6 +30,22 @@ namespace gpumatrix
 		  template <typename T> void gemv (char trans, int m, int n, T alpha, const T *A, int lda, 
 			  const T *x, int incx, T beta, T *y, int incy);
 
+		  /* C = alpha * op(A) * op(A)^T + beta * C, only the triangle uplo of C is referenced */
+		  template <typename T> void syrk (char uplo, char trans, int n, int k, T alpha, const T *A, int lda, 
+			  T beta, T *C, int ldc);
+
+		  /* A = alpha * x * y^T + A */
+		  template <typename T> void ger (int m, int n, T alpha, const T *x, int incx, const T *y, int incy, 
+			  T *A, int lda);
+
+		  /* B = alpha * op(A)^-1 * B (side 'L') or alpha * B * op(A)^-1 (side 'R'), A triangular */
+		  template <typename T> void trsm (char side, char uplo, char transa, char diag, int m, int n, 
+			  T alpha, const T *A, int lda, T *B, int ldb);
+
+		  /* x = op(A)^-1 * x, A triangular */
+		  template <typename T> void trsv (char uplo, char trans, char diag, int n, const T *A, int lda, 
+			  T *x, int incx);
+
 		  /* res = norm(x) */
 		  template <typename T> T nrm2 (int n, const T *x, int incx);
 
@@ -43,6 +61,28 @@ namespace gpumatrix
 		  /* res = sum(x) */
 		  template <typename T> T dot(int n, const T *x, int incx, const T * y ,int incy);
 
+		  /* cuBLAS has no 16 bit routines, these are the tiled kernels of MatrixOperationImpl.cu */
+		  template<> void gemm<half>(char transa, char transb, int m, int n, int k, 
+			  half alpha, const half *A, int lda, const half *B, int ldb, half beta, half *C, int ldc);
+		  template<> void gemm<bfloat16>(char transa, char transb, int m, int n, int k, 
+			  bfloat16 alpha, const bfloat16 *A, int lda, const bfloat16 *B, int ldb, bfloat16 beta, bfloat16 *C, int ldc);
+
+		  template<> void gemv<half>(char trans, int m, int n, half alpha, const half *A, int lda, 
+			  const half *x, int incx, half beta, half *y, int incy);
+		  template<> void gemv<bfloat16>(char trans, int m, int n, bfloat16 alpha, const bfloat16 *A, int lda, 
+			  const bfloat16 *x, int incx, bfloat16 beta, bfloat16 *y, int incy);
+
+		  template<> void syrk<half>(char uplo, char trans, int n, int k, 
+			  half alpha, const half *A, int lda, half beta, half *C, int ldc);
+		  template<> void syrk<bfloat16>(char uplo, char trans, int n, int k, 
+			  bfloat16 alpha, const bfloat16 *A, int lda, bfloat16 beta, bfloat16 *C, int ldc);
+
+		  /* thrust reductions of FunctionImpl.cu, accumulating in float */
+		  template<> half nrm2<half>(int n, const half *x, int incx);
+		  template<> bfloat16 nrm2<bfloat16>(int n, const bfloat16 *x, int incx);
+		  template<> half dot<half>(int n, const half *x, int incx, const half * y, int incy);
+		  template<> bfloat16 dot<bfloat16>(int n, const bfloat16 *x, int incx, const bfloat16 * y, int incy);
+
 	    }
       
     
@@ -0,0 +1,22 @@
+#ifndef CONTEXT_INTERFACE_H
+#define CONTEXT_INTERFACE_H
+
+
+#include <cstddef>
+namespace gpumatrix
+{
+	namespace impl
+	{
+		/* bytes of device memory from the calling thread's allocator cache, 0 for no bytes */
+		void * context_alloc(std::size_t bytes);
+
+		/* back to the cache when this thread allocated data, to the device otherwise */
+		void context_free(void * data);
+
+		/* scratch of at least bytes owned by the calling thread, valid until its next workspace() */
+		void * workspace(std::size_t bytes);
+	}
+}
+
+
+#endif
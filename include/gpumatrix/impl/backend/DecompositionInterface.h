@@ -0,0 +1,35 @@
+#ifndef BACKEND_DECOMPOSITION_INTERFACE_H
+#define BACKEND_DECOMPOSITION_INTERFACE_H
+
+namespace gpumatrix
+{
+	namespace impl
+	{
+		/* A = L * L^T in place, n x n column major. Only the lower part is
+		read; the strictly upper part is set to zero. Returns 0, or k > 0 when
+		the leading minor of order k is not positive definite. */
+		template <typename T> int potrf(int n, T *A, int lda);
+
+		/* A = Q * R in place, m x n column major, by blocked Householder
+		reflections. R is left on and above the diagonal, the reflectors
+		below it with an implicit unit diagonal, and their scalars in the
+		min(m,n) entries of tau, as LAPACK geqrf. */
+		template <typename T> void geqrf(int m, int n, T *A, int lda, T *tau);
+
+		/* C = Q^T * C (trans 'T') or Q * C (trans 'N'), C m x n, Q the
+		product of the first k reflectors left in A and tau by geqrf. */
+		template <typename T> void ormqr(char trans, int m, int n, int k, const T *A, int lda, const T *tau, 
+			T *C, int ldc);
+
+		/* Tall skinny QR, m >= n: the upper triangular R (n x n) of A = Q * R,
+		and QtB, the first n rows of Q^T * B (B m x nrhs). Row blocks of
+		block_rows (at least 2n) rows are factored concurrently, one thread
+		block each, and their R factors stacked and factored again. A and B
+		are not modified and Q is not formed. */
+		template <typename T> void tsqr(int m, int n, const T *A, int lda, int nrhs, const T *B, int ldb, 
+			T *R, int ldr, T *QtB, int ldq, int block_rows);
+
+	}
+}
+
+#endif
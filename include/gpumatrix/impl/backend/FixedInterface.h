@@ -0,0 +1,21 @@
+#ifndef FIXED_INTERFACE_H
+#define FIXED_INTERFACE_H
+
+
+namespace gpumatrix
+{
+	namespace impl
+	{
+		/* the largest R and C the fixed size products are instantiated for */
+		enum { FixedDeviceMaxSize = 4 };
+
+		/* Y = F*X for the R x C matrix F held on the host and the C x n matrix X */
+		template <typename T, int R, int C> void fixed_mm_left(const T *F, int n, const T *X, int ldx, T *Y, int ldy);
+
+		/* Y = X*F for the m x R matrix X and the R x C matrix F held on the host */
+		template <typename T, int R, int C> void fixed_mm_right(int m, const T *X, int ldx, const T *F, T *Y, int ldy);
+	}
+}
+
+
+#endif
@@ -3,6 +3,7 @@
 
 
 #include <gpumatrix/Functional.h>
+#include <gpumatrix/impl/backend/LaunchInterface.h>
 
 namespace gpumatrix
 {
@@ -10,33 +11,54 @@ namespace gpumatrix
     {
 
 		    
-		    template<typename T> T sum(const T * data, int size);
+		    template<typename T> T sum(const T * data, std::size_t size);
 
-		    template<typename T> T max_element(const T * data, int size);
+		    template<typename T> T max_element(const T * data, std::size_t size);
 
-		    template<typename T> T min_element(const T * data, int size);
+		    template<typename T> T min_element(const T * data, std::size_t size);
+
+		    // float reductions with a double accumulator
+		    double wide_sum(const float * data, std::size_t size);
+
+		    double wide_squared_norm(const float * data, std::size_t size);
+
+		    double wide_dot(const float * x, const float * y, std::size_t size);
+
+		    // number of set entries of a mask
+		    std::size_t count(const bool * mask, std::size_t size);
+
+		    // sum over the entries where mask is set, the others are never
+		    // added so NaN/Inf outside the mask do not leak into the result
+		    template<typename T> T masked_sum(const T * data, const bool * mask, std::size_t size);
+
+		    // 16 bit storage accumulates in float
+		    template<> half sum<half>(const half * data, std::size_t size);
+		    template<> bfloat16 sum<bfloat16>(const bfloat16 * data, std::size_t size);
+		    template<> half masked_sum<half>(const half * data, const bool * mask, std::size_t size);
+		    template<> bfloat16 masked_sum<bfloat16>(const bfloat16 * data, const bool * mask, std::size_t size);
 		    
 		    
-		    #define DECLEAR_UNARY_ARRAY_FUNC(OPNAME, TYPE) \
-		    void unary_array_op( TYPE *odata, const TYPE  * idata, int size,const Fcnl_##OPNAME<TYPE> & func) ;
-
-		    DECLEAR_UNARY_ARRAY_FUNC(exp, double)
-		    DECLEAR_UNARY_ARRAY_FUNC(exp, float)
-		    DECLEAR_UNARY_ARRAY_FUNC(neg, double)
-		    DECLEAR_UNARY_ARRAY_FUNC(neg, float)
-		    DECLEAR_UNARY_ARRAY_FUNC(arrayinv, double)
-		    DECLEAR_UNARY_ARRAY_FUNC(arrayinv, float)
-		    DECLEAR_UNARY_ARRAY_FUNC(logistic, double)
-		    DECLEAR_UNARY_ARRAY_FUNC(logistic, float)
-		    DECLEAR_UNARY_ARRAY_FUNC(log, double)
-		    DECLEAR_UNARY_ARRAY_FUNC(log, float)
+		    // odata[i] = Fcnl::apply_on(idata[i]), for every functional in
+		    // GPUMATRIX_UNARY_FUNCTIONALS, GPUMATRIX_FAST_UNARY_FUNCTIONALS and
+		    // Fcnl_not<bool>
+		    template <class Fcnl>
+		    void unary_array_op(typename Fcnl::value_type *odata, const typename Fcnl::value_type * idata, std::size_t size, const Fcnl & func);
+
+		    // odata[i] = Fcnl::apply_on(a[i], b[i]), either side may be a scalar,
+		    // for every functional in GPUMATRIX_BINARY_FUNCTIONALS
+		    template <class Fcnl>
+		    void binary_array_op(typename Fcnl::value_type *odata, const typename Fcnl::value_type * idata1, const typename Fcnl::value_type * idata2, std::size_t size, const Fcnl & func);
+		    template <class Fcnl>
+		    void binary_array_op(typename Fcnl::value_type *odata, const typename Fcnl::value_type * idata1, typename Fcnl::value_type beta, std::size_t size, const Fcnl & func);
+		    template <class Fcnl>
+		    void binary_array_op(typename Fcnl::value_type *odata, typename Fcnl::value_type alpha, const typename Fcnl::value_type * idata2, std::size_t size, const Fcnl & func);
 		    
 		    
 		    template <typename T> void rowwise_sum(T * odata, const T * idata, int r, int c);
 		    template <typename T> void colwise_sum(T * odata, const T * idata, int r, int c);
 
 		    #define DECLEAR_BINARY_ARRAY_FUNC(OPNAME, TYPE) \
-		    void array_##OPNAME( TYPE *odata, const TYPE  * idata1, const TYPE * idata2,  int size) ;
+		    void array_##OPNAME( TYPE *odata, const TYPE  * idata1, const TYPE * idata2,  std::size_t size) ;
 
 		    DECLEAR_BINARY_ARRAY_FUNC(cross_entropy,double)
 		    DECLEAR_BINARY_ARRAY_FUNC(cross_entropy_diff,double)
@@ -44,5 +66,9 @@ namespace gpumatrix
     }
 }
 
+#if defined(__CUDACC__)
+#include <gpumatrix/impl/backend/cuda/UnaryArrayOpImpl.h>
+#include <gpumatrix/impl/backend/cuda/BinaryArrayOpImpl.h>
+#endif
 
 #endif
\ No newline at end of file
@@ -3,11 +3,20 @@
 
 
 
+#include <gpumatrix/impl/backend/LaunchInterface.h>
 #include <gpumatrix/impl/backend/ArrayOperationInterface.h>
 #include <gpumatrix/impl/backend/MatrixOperationInterface.h>
 #include <gpumatrix/impl/backend/BlasInterface.h>
 #include <gpumatrix/impl/backend/FunctionInterface.h>
 #include <gpumatrix/impl/backend/MemoryInterface.h>
+#include <gpumatrix/impl/backend/ContextInterface.h>
+#include <gpumatrix/impl/backend/RandomInterface.h>
+#include <gpumatrix/impl/backend/SparseInterface.h>
+#include <gpumatrix/impl/backend/DecompositionInterface.h>
+#include <gpumatrix/impl/backend/KernelMatrixInterface.h>
+#include <gpumatrix/impl/backend/FixedInterface.h>
+#include <gpumatrix/impl/backend/BatchInterface.h>
+#include <gpumatrix/impl/backend/OutOfCoreInterface.h>
 
 
 
@@ -0,0 +1,21 @@
+#ifndef KERNEL_MATRIX_INTERFACE_H
+#define KERNEL_MATRIX_INTERFACE_H
+
+
+namespace gpumatrix
+{
+	namespace impl
+	{
+		/* norms[j] = squared norm of column j of the d x n matrix X */
+		template <typename T> void column_squared_norms(int d, int n, const T *X, int ldx, T *norms);
+
+		/* K = k(K) in place, K holding the m x n matrix G = X^T*Y on entry:
+		   kernel 0 leaves G, 1 is (gamma*G + coef0)^degree and 2 is
+		   exp(-gamma*(xnorm_i + ynorm_j - 2*G)) */
+		template <typename T> void kernel_epilogue(int kernel, int m, int n, T gamma, T coef0, int degree,
+			const T *xnorm, const T *ynorm, T *K, int ldk);
+	}
+}
+
+
+#endif
@@ -0,0 +1,54 @@
+#ifndef BACKEND_LAUNCH_INTERFACE_H
+#define BACKEND_LAUNCH_INTERFACE_H
+
+#include <cstddef>
+
+namespace gpumatrix
+{
+	namespace impl
+	{
+		/* Launch geometry of the element wise kernels. Sizes are std::size_t
+		   throughout; a grid covers one element per thread up to
+		   ElementwiseMaxBlocks blocks, larger arrays keep that grid and every
+		   thread strides over it */
+		enum { ElementwiseThreads = 256 };
+
+		static const std::size_t ElementwiseMaxBlocks = std::size_t(1) << 20;
+
+		/* Sizes up to Index32Max index in 32 bit unsigned arithmetic: an index
+		   below it plus the largest grid stride can't wrap */
+		static const std::size_t Index32Max = 0x7fffffff;
+
+		/* cuBLAS level 1 takes int lengths, longer arrays go in chunks of this */
+		static const std::size_t BlasChunk = std::size_t(1) << 30;
+
+		/* Blocks of ElementwiseThreads for size elements; at least one, so an
+		   empty array is still a valid launch */
+		inline unsigned int elementwise_blocks(std::size_t size)
+		{
+			std::size_t blocks = (size + ElementwiseThreads - 1)/ElementwiseThreads;
+
+			if (blocks == 0)
+				return 1;
+			return (unsigned int)(blocks < ElementwiseMaxBlocks ? blocks : ElementwiseMaxBlocks);
+		}
+	}
+}
+
+#if defined(__CUDACC__)
+/* for (index over 0..size-1 handled by this thread) BODY, in 32 bit
+   arithmetic whenever size allows */
+#define GPUMATRIX_ELEMENTWISE_LOOP(index, size, BODY)																	\
+	if ((size) <= gpumatrix::impl::Index32Max)																			\
+	{																													\
+		for (unsigned int index = blockIdx.x * blockDim.x + threadIdx.x; index < (unsigned int)(size); index += blockDim.x * gridDim.x)	\
+		{ BODY }																										\
+	}																													\
+	else																												\
+	{																													\
+		for (std::size_t index = blockIdx.x * (std::size_t)blockDim.x + threadIdx.x; index < (size); index += (std::size_t)blockDim.x * gridDim.x)	\
+		{ BODY }																										\
+	}
+#endif
+
+#endif
@@ -8,6 +8,9 @@ namespace gpumatrix
 	{
 
 			template <typename T> void transpose( T *odata, const T *idata,  int r, int c) ;
+
+			/* copy the triangle uplo of the n x n matrix A onto the other one */
+			template <typename T> void symmetrize(char uplo, int n, T *A, int lda);
 		
 	}
 }
@@ -9,10 +9,7 @@ namespace gpumatrix
     {
 
 
-		  void alloc_notify();
-
-		  void free_notify();
-
+		  // allocations live in the calling thread's context, see ContextInterface.h
 		  int memory_check();
 
 		  template <typename T>
@@ -27,9 +24,17 @@ namespace gpumatrix
 		  template <typename T>
 		  void get(T * host_data, const T* device_data, std::size_t size);
 
+		  // upload with an element type conversion done on the host
+		  template <typename T, typename S>
+		  void set(T * device_data, const S* host_data, std::size_t size);
+
 		  template <typename T>
 		  void copy(T * device_dest, const T* device_source, std::size_t size);
 
+		  // rows x cols block between column major matrices of leading dimension ldd and lds
+		  template <typename T>
+		  void copy2d(T * device_dest, std::size_t ldd, const T* device_source, std::size_t lds, std::size_t rows, std::size_t cols);
+
 		  template <typename T>
 		  void zero(T * device_data, std::size_t size);
 	  
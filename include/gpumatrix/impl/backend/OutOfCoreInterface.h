@@ -0,0 +1,38 @@
+#ifndef OUT_OF_CORE_INTERFACE_H
+#define OUT_OF_CORE_INTERFACE_H
+
+
+#include <cstddef>
+
+namespace gpumatrix
+{
+	namespace impl
+	{
+		/* bytes of device memory free right now */
+		std::size_t device_free_bytes();
+
+		/* Device side of the out of core product, see gpumatrix/OutOfCore.h.
+		   ooc_begin allocates a tile_rows x tile_cols C tile and two slots of a
+		   tile_rows x tile_depth A tile and a tile_depth x tile_cols B tile, with
+		   pinned host staging for each slot. The state it returns goes to every
+		   other call and is released by ooc_end */
+		template <typename T> void * ooc_begin(std::size_t tile_rows, std::size_t tile_cols, std::size_t tile_depth);
+
+		/* queue the host tiles A (rows x depth) and B (depth x cols) into slot
+		   on the transfer stream, behind the multiply that last read slot;
+		   returns once they are staged */
+		template <typename T> void ooc_load(void * state, int slot, const T *A, std::size_t lda, const T *B, std::size_t ldb,
+			std::size_t rows, std::size_t cols, std::size_t depth);
+
+		/* C tile = A_slot*B_slot, or += when accumulate, queued behind the load of slot */
+		template <typename T> void ooc_multiply(void * state, int slot, std::size_t rows, std::size_t cols, std::size_t depth, bool accumulate);
+
+		/* copy the rows x cols C tile to the host, waiting for its multiplies */
+		template <typename T> void ooc_store(void * state, T *C, std::size_t ldc, std::size_t rows, std::size_t cols);
+
+		template <typename T> void ooc_end(void * state);
+	}
+}
+
+
+#endif
@@ -0,0 +1,25 @@
+#ifndef BACKEND_RANDOM_INTERFACE_H
+#define BACKEND_RANDOM_INTERFACE_H
+
+
+#include <gpumatrix/Philox.h>
+#include <gpumatrix/impl/backend/LaunchInterface.h>
+
+namespace gpumatrix
+{
+	namespace impl
+	{
+	    // Fill odata from the Philox stream (seed, offset). Element i comes from
+	    // block offset + i/PhiloxValuesPerBlock<TYPE>, whatever the launch size.
+	    #define DECLEAR_RANDOM_OP(TYPE) \
+	    void random_uniform( TYPE *odata, std::size_t size, TYPE low, TYPE high, unsigned long long seed, unsigned long long offset); \
+	    void random_normal( TYPE *odata, std::size_t size, TYPE mean, TYPE stddev, unsigned long long seed, unsigned long long offset); \
+	    void random_bernoulli( TYPE *odata, std::size_t size, TYPE p, unsigned long long seed, unsigned long long offset);
+
+	    DECLEAR_RANDOM_OP(float)
+	    DECLEAR_RANDOM_OP(double)
+
+	}
+}
+
+#endif
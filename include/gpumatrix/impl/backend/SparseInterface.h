@@ -0,0 +1,30 @@
+#ifndef BACKEND_SPARSE_INTERFACE_H
+#define BACKEND_SPARSE_INTERFACE_H
+
+namespace gpumatrix
+{
+	namespace impl
+	{
+		// A is held as compressed rows: outer[r] .. outer[r+1]-1 index inner
+		// (column) and values of row r. CSC storage of S is the compressed
+		// row storage of S^T, so both formats reach the same kernels.
+		// Dense operands are column major with leading dimension = rows.
+		//
+		// csrmm:       C(m x n) = op(A)*B, B is k x n, op(A) is m x k
+		// csrmm_right: C(m x n) = B*op(A), B is m x k, op(A) is k x n
+		// csrmv:       y(m) = op(A)*x, x has k entries
+		//
+		// trans 'N' reads A row by row into C; trans 'T' scatters every row
+		// of A with atomic adds, so its summation order is not fixed.
+		#define DECLEAR_SPARSE_OP(TYPE) \
+		void csrmm(char trans, int m, int n, int k, int nnz, const int * outer, const int * inner, const TYPE * values, const TYPE * B, TYPE * C); \
+		void csrmm_right(char trans, int m, int n, int k, int nnz, const int * outer, const int * inner, const TYPE * values, const TYPE * B, TYPE * C); \
+		void csrmv(char trans, int m, int k, int nnz, const int * outer, const int * inner, const TYPE * values, const TYPE * x, TYPE * y);
+
+		DECLEAR_SPARSE_OP(float)
+		DECLEAR_SPARSE_OP(double)
+
+	}
+}
+
+#endif
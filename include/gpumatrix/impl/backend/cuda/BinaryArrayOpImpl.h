@@ -0,0 +1,66 @@
+#ifndef GPU_BINARY_ARRAY_OP_H
+#define GPU_BINARY_ARRAY_OP_H
+
+// Kernels for the element wise binary functionals, either side may be a
+// scalar. Only visible to nvcc: the library instantiates them for
+// GPUMATRIX_BINARY_FUNCTIONALS.
+
+#include <gpumatrix/Functional.h>
+#include <gpumatrix/Trace.h>
+#include <gpumatrix/impl/backend/LaunchInterface.h>
+
+namespace gpumatrix
+{
+	namespace impl
+	{
+		template <class Fcnl>
+		__global__ void _binary_array_op(typename Fcnl::value_type *odata, const typename Fcnl::value_type * idata1, const typename Fcnl::value_type * idata2, std::size_t size)
+		{
+			GPUMATRIX_ELEMENTWISE_LOOP(index, size,
+				odata[index] = Fcnl::apply_on(idata1[index], idata2[index]);
+			)
+		}
+
+		template <class Fcnl>
+		__global__ void _binary_array_op(typename Fcnl::value_type *odata, const typename Fcnl::value_type * idata1, typename Fcnl::value_type beta, std::size_t size)
+		{
+			GPUMATRIX_ELEMENTWISE_LOOP(index, size,
+				odata[index] = Fcnl::apply_on(idata1[index], beta);
+			)
+		}
+
+		template <class Fcnl>
+		__global__ void _binary_array_op(typename Fcnl::value_type *odata, typename Fcnl::value_type alpha, const typename Fcnl::value_type * idata2, std::size_t size)
+		{
+			GPUMATRIX_ELEMENTWISE_LOOP(index, size,
+				odata[index] = Fcnl::apply_on(alpha, idata2[index]);
+			)
+		}
+
+		template <class Fcnl>
+		void binary_array_op(typename Fcnl::value_type *odata, const typename Fcnl::value_type * idata1, const typename Fcnl::value_type * idata2, std::size_t size, const Fcnl & func)
+		{
+			GPUMATRIX_TRACE_SCOPE("impl::binary_array_op",size,0,0,3.0*size*sizeof(typename Fcnl::value_type),size);
+			unsigned int numGrid = elementwise_blocks(size);
+			_binary_array_op<Fcnl><<<numGrid,ElementwiseThreads>>>(odata, idata1, idata2, size);
+		}
+
+		template <class Fcnl>
+		void binary_array_op(typename Fcnl::value_type *odata, const typename Fcnl::value_type * idata1, typename Fcnl::value_type beta, std::size_t size, const Fcnl & func)
+		{
+			GPUMATRIX_TRACE_SCOPE("impl::binary_array_op",size,0,0,2.0*size*sizeof(typename Fcnl::value_type),size);
+			unsigned int numGrid = elementwise_blocks(size);
+			_binary_array_op<Fcnl><<<numGrid,ElementwiseThreads>>>(odata, idata1, beta, size);
+		}
+
+		template <class Fcnl>
+		void binary_array_op(typename Fcnl::value_type *odata, typename Fcnl::value_type alpha, const typename Fcnl::value_type * idata2, std::size_t size, const Fcnl & func)
+		{
+			GPUMATRIX_TRACE_SCOPE("impl::binary_array_op",size,0,0,2.0*size*sizeof(typename Fcnl::value_type),size);
+			unsigned int numGrid = elementwise_blocks(size);
+			_binary_array_op<Fcnl><<<numGrid,ElementwiseThreads>>>(odata, alpha, idata2, size);
+		}
+	}
+}
+
+#endif
@@ -3,32 +3,33 @@
 
 
 #include <gpumatrix/impl/backend/MemoryInterface.h>
+#include <gpumatrix/impl/backend/ContextInterface.h>
 #include <cuda.h>
 #include <cublas.h>
+#include <cuda_runtime.h>
 #include <cstddef> 
+#include <vector>
+#include <gpumatrix/Half.h>
 #include <stdexcept>
+#include <gpumatrix/Trace.h>
 
 namespace gpumatrix
 {
 	namespace impl
 	{
-		void alloc_notify();
-
-		void free_notify();
-
 		int memory_check();
 
+		// Device memory comes from the calling thread's context and every
+		// transfer is queued on its stream, cudaStreamPerThread, so threads
+		// working on their own objects never wait on each other. Downloads
+		// and uploads from host memory wait for that stream only.
+
 		template <typename T>
 		T * alloc(std::size_t size)
 		{
-			T * data;
-			cublasStatus status = cublasAlloc (size, sizeof(T),(void **) &data);
-			if (status != CUBLAS_STATUS_SUCCESS)
-				throw std::runtime_error("GPU Memory Allocation Failed");
+			GPUMATRIX_TRACE_SCOPE("impl::alloc",size,0,0,0,0);
 
-			alloc_notify();
-
-			return data;
+			return (T *) context_alloc(size*sizeof(T));
 		}
 
 
@@ -38,33 +39,65 @@ namespace gpumatrix
 			if ( data == 0)
 				return;
 
-			cublasStatus status = cublasFree (data);
-			if (status != CUBLAS_STATUS_SUCCESS)
-				throw std::runtime_error("GPU Memory Free Failed");
+			GPUMATRIX_TRACE_SCOPE("impl::free",0,0,0,0,0);
 
-			free_notify();
+			context_free(data);
 		}
 
 		template <typename T>
 		void set(T * device_data, const T* host_data, std::size_t size)
 		{
-			cublasStatus status = cublasSetVector(size,sizeof(T),host_data,1,device_data,1);
-			if (status != CUBLAS_STATUS_SUCCESS)
+			GPUMATRIX_TRACE_SCOPE("impl::set",size,0,0,double(size)*sizeof(T),0);
+
+			cudaError_t cudaError = cudaMemcpyAsync(device_data, host_data, size*sizeof(T), cudaMemcpyHostToDevice, cudaStreamPerThread);
+			if (cudaError == cudaSuccess)
+				cudaError = cudaStreamSynchronize(cudaStreamPerThread);
+			if (cudaError != cudaSuccess)
 				throw std::runtime_error("GPU Memory SetVector Failed");
 		}
 
 		template <typename T>
 		void get(T * host_data, const T* device_data, std::size_t size)
 		{
-			cublasStatus status = cublasGetVector (size, sizeof(T), device_data,1, host_data, 1);
-			if (status != CUBLAS_STATUS_SUCCESS)
+			GPUMATRIX_TRACE_SCOPE("impl::get",size,0,0,double(size)*sizeof(T),0);
+
+			cudaError_t cudaError = cudaMemcpyAsync(host_data, device_data, size*sizeof(T), cudaMemcpyDeviceToHost, cudaStreamPerThread);
+			if (cudaError == cudaSuccess)
+				cudaError = cudaStreamSynchronize(cudaStreamPerThread);
+			if (cudaError != cudaSuccess)
 				throw std::runtime_error("GPU Memory GetVector Failed");
 		}
 
+		// Converting before the copy means only the narrow type crosses the bus,
+		// which is the point of storing weights as half or bfloat16.
+		template <typename T, typename S>
+		void set(T * device_data, const S* host_data, std::size_t size)
+		{
+			std::vector<T> buffer(size);
+			convert(buffer.data(), host_data, size);
+			set(device_data, (const T *)buffer.data(), size);
+		}
+
 		template <typename T>
 		void copy(T * device_dest, const T* device_source, std::size_t size)
 		{
-			cudaError_t cudaError = cudaMemcpy(device_dest, device_source,size*sizeof(T), cudaMemcpyDeviceToDevice);
+			GPUMATRIX_TRACE_SCOPE("impl::copy",size,0,0,2.0*size*sizeof(T),0);
+
+			cudaError_t cudaError = cudaMemcpyAsync(device_dest, device_source,size*sizeof(T), cudaMemcpyDeviceToDevice, cudaStreamPerThread);
+			
+			if (cudaError != cudaSuccess)
+				throw std::runtime_error(cudaGetErrorString(cudaError));
+		}
+
+		template <typename T>
+		void copy2d(T * device_dest, std::size_t ldd, const T* device_source, std::size_t lds, std::size_t rows, std::size_t cols)
+		{
+			GPUMATRIX_TRACE_SCOPE("impl::copy2d",rows,cols,0,2.0*rows*cols*sizeof(T),0);
+
+			if (rows == 0 || cols == 0)
+				return;
+
+			cudaError_t cudaError = cudaMemcpy2DAsync(device_dest, ldd*sizeof(T), device_source, lds*sizeof(T), rows*sizeof(T), cols, cudaMemcpyDeviceToDevice, cudaStreamPerThread);
 			
 			if (cudaError != cudaSuccess)
 				throw std::runtime_error(cudaGetErrorString(cudaError));
@@ -73,7 +106,9 @@ namespace gpumatrix
 		template <typename T>
 		void zero(T * device_data, std::size_t size)
 		{
-			cudaError_t cudaError = cudaMemset(device_data, 0,size*sizeof(T));
+			GPUMATRIX_TRACE_SCOPE("impl::zero",size,0,0,double(size)*sizeof(T),0);
+
+			cudaError_t cudaError = cudaMemsetAsync(device_data, 0,size*sizeof(T), cudaStreamPerThread);
 			
 			if (cudaError != cudaSuccess)
 				throw std::runtime_error(cudaGetErrorString(cudaError));
@@ -82,4 +117,4 @@ namespace gpumatrix
 	}
 }
 
-#endif
\ No newline at end of file
+#endif
\ No newline at end of file
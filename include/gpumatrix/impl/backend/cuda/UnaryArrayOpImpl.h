@@ -0,0 +1,34 @@
+#ifndef GPU_UNARY_ARRAY_OP_H
+#define GPU_UNARY_ARRAY_OP_H
+
+// Kernel for the element wise unary functionals. Only visible to nvcc: the
+// library instantiates it for GPUMATRIX_UNARY_FUNCTIONALS, a .cu file of the
+// user may instantiate it for any other functional with a device apply_on.
+
+#include <gpumatrix/Functional.h>
+#include <gpumatrix/Trace.h>
+#include <gpumatrix/impl/backend/LaunchInterface.h>
+
+namespace gpumatrix
+{
+	namespace impl
+	{
+		template <class Fcnl>
+		__global__ void _unary_array_op(typename Fcnl::value_type *odata, const typename Fcnl::value_type * idata, std::size_t size)
+		{
+			GPUMATRIX_ELEMENTWISE_LOOP(index, size,
+				odata[index] = Fcnl::apply_on(idata[index]);
+			)
+		}
+
+		template <class Fcnl>
+		void unary_array_op(typename Fcnl::value_type *odata, const typename Fcnl::value_type * idata, std::size_t size, const Fcnl & func)
+		{
+			GPUMATRIX_TRACE_SCOPE("impl::unary_array_op",size,0,0,2.0*size*sizeof(typename Fcnl::value_type),size);
+			unsigned int numGrid = elementwise_blocks(size);
+			_unary_array_op<Fcnl><<<numGrid,ElementwiseThreads>>>(odata, idata, size);
+		}
+	}
+}
+
+#endif
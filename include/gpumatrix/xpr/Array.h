@@ -37,8 +37,8 @@ namespace gpumatrix {
 	/* forwards */
 	template <class T,int D> class Array;
 	template <class T> class Matrix;
-	template <class E> class RowWiseView;
-	template <class E> class ColWiseView;
+	template <class E, bool Writable> class RowWiseView;
+	template <class E, bool Writable> class ColWiseView;
 	/**
 	* \class XprMatrix Matrix.h "gpumatrix/xpr/Matrix.h"
 	* \brief Represents the expression for vectors at any node in the parse tree.
@@ -131,14 +131,14 @@ namespace gpumatrix {
 		}
 
 		
-		RowWiseView<XprArray<E,D>> rowwise() const
+		RowWiseView<XprArray<E,D>,false> rowwise() const
 		{
-			return RowWiseView<XprArray<E,D>>(*this);
+			return RowWiseView<XprArray<E,D>,false>(*this);
 		}
 
-		ColWiseView<XprArray<E,D>> colwise() const
+		ColWiseView<XprArray<E,D>,false> colwise() const
 		{
-			return ColWiseView<XprArray<E,D>>(*this);
+			return ColWiseView<XprArray<E,D>,false>(*this);
 		}
 
 		///** Wrapper for meta assign. */
@@ -258,6 +258,7 @@ namespace gpumatrix {
 //
 #include <gpumatrix/xpr/ArrayFunctions.h>
 #include <gpumatrix/xpr/ArrayOperators.h>
+#include <gpumatrix/xpr/ArrayUnaryFunctions.h>
 
 
 
@@ -0,0 +1,64 @@
+#ifndef GPUMATRIX_XPR_ARRAY_UNARY_FUNCTIONS_H
+#define GPUMATRIX_XPR_ARRAY_UNARY_FUNCTIONS_H
+
+namespace gpumatrix {
+
+
+/*********************************************************
+ * PART I: DECLARATION
+ *********************************************************/
+
+/*
+ * unary_function(XprArray<E,D>)
+ */
+#define TVMET_DECLARE_MACRO(NAME)					\
+template<class E, int D>						\
+inline									\
+XprArray<								\
+  XprUnOp<								\
+    Fcnl_##NAME<typename E::value_type>,				\
+    XprArray<E,D>							\
+  >,D									\
+>									\
+NAME(const XprArray<E,D>& rhs) TVMET_CXX_ALWAYS_INLINE;
+
+GPUMATRIX_UNARY_FUNCTIONS(TVMET_DECLARE_MACRO)
+
+#undef TVMET_DECLARE_MACRO
+
+
+/*********************************************************
+ * PART II: IMPLEMENTATION
+ *********************************************************/
+
+
+#define TVMET_IMPLEMENT_MACRO(NAME)					\
+template<class E, int D>						\
+inline									\
+XprArray<								\
+  XprUnOp<								\
+    Fcnl_##NAME<typename E::value_type>,				\
+    XprArray<E,D>							\
+  >,D									\
+>									\
+NAME(const XprArray<E,D>& rhs) {					\
+  typedef XprUnOp<							\
+    Fcnl_##NAME<typename E::value_type>,				\
+    XprArray<E,D>							\
+  >							expr_type;	\
+  return XprArray<expr_type,D>(expr_type(rhs));			\
+}
+
+GPUMATRIX_UNARY_FUNCTIONS(TVMET_IMPLEMENT_MACRO)
+
+#undef TVMET_IMPLEMENT_MACRO
+
+
+} // namespace gpumatrix
+
+#endif // GPUMATRIX_XPR_ARRAY_UNARY_FUNCTIONS_H
+
+// Local Variables:
+// mode:C++
+// tab-width:8
+// End:
@@ -0,0 +1,132 @@
+#ifndef GPUMATRIX_XPR_BROADCAST_H
+#define GPUMATRIX_XPR_BROADCAST_H
+
+#include <gpumatrix/xpr/ResultType.h>
+
+namespace gpumatrix {
+
+	template<class T> class Vector;
+	template<class C> class Map;
+
+	/** Which way a vector is repeated over a matrix, see XprBroadcast. */
+	enum BroadcastDirection
+	{
+		BroadcastRowWise,	/**< x[j] against every row, x has cols() entries */
+		BroadcastColWise	/**< x[i] against every column, x has rows() entries */
+	};
+
+	namespace impl
+	{
+		/** Vector, Map<Vector> and XprVector seen as a vector expression.
+		Anything else has no members. */
+		template<class V> struct VectorOperand { };
+
+		template<class T> struct VectorOperand<Vector<T> >
+		{
+			typedef XprVector<VectorConstReference<T> >	expr_type;
+
+			static expr_type as_expr(const Vector<T> & v) { return v.as_expr(); }
+		};
+
+		template<class T> struct VectorOperand<Map<Vector<T> > >
+		{
+			typedef XprVector<VectorConstReference<T> >	expr_type;
+
+			static expr_type as_expr(const Map<Vector<T> > & v) { return v.as_expr(); }
+		};
+
+		template<class E> struct VectorOperand<XprVector<E> >
+		{
+			typedef XprVector<E>						expr_type;
+
+			static const expr_type & as_expr(const XprVector<E> & v) { return v; }
+		};
+
+		/** The wrapper a broadcast over E lives in: XprMatrix over a
+		matrix, XprArray over an array. */
+		template<class E, class X> struct BroadcastWrapper;
+
+		template<class E, class X> struct BroadcastWrapper<XprMatrix<E>, X>
+		{
+			typedef XprMatrix<X>						type;
+		};
+
+		template<class E, int D, class X> struct BroadcastWrapper<XprArray<E,D>, X>
+		{
+			typedef XprArray<X,D>						type;
+		};
+	}
+
+
+/**
+ * \class XprBroadcast Broadcast.h "gpumatrix/xpr/Broadcast.h"
+ * \brief M.rowwise() op x and M.colwise() op x for op one of + - * /.
+ *
+ * BinOp(M(i,j), x[j]) row wise, BinOp(M(i,j), x[i]) column wise. Shape is
+ * taken from the matrix.
+ */
+template<class BinOp, class E, class V, int Dir>
+class XprBroadcast
+  : public GpuMatrixBase< XprBroadcast<BinOp, E, V, Dir> >
+{
+  XprBroadcast();
+  XprBroadcast& operator=(const XprBroadcast&);
+
+public:
+  typedef typename E::value_type						value_type;
+  typedef typename XprResultType<XprBroadcast<BinOp,E,V,Dir>>::result_type result_type;
+
+public:
+  /** Constructor for the matrix and the repeated vector. */
+  explicit XprBroadcast(const E& expr, const V& vector)
+    : m_expr(expr), m_vector(vector)
+  {
+	  if (vector.size() != (Dir == BroadcastRowWise ? expr.cols() : expr.rows()))
+		  throw runtime_error("Dimensionality donot Match");
+  }
+
+  const E & expr() const { return m_expr; }
+
+  const V & vector() const { return m_vector; }
+
+  std::size_t rows() const
+  {
+	  return m_expr.rows();
+  }
+
+  std::size_t cols() const
+  {
+	  return m_expr.cols();
+  }
+
+  std::size_t size() const
+  {
+	  return m_expr.size();
+  }
+
+  result_type eval() const
+  {
+	  return impl::eval(*this);
+  }
+
+public: // debugging Xpr parse tree
+  void print_xpr(std::ostream& os, std::size_t l=0) const {
+    os << IndentLevel(l++)
+       << (Dir == BroadcastRowWise ? "XprBroadcast<RowWise," : "XprBroadcast<ColWise,")
+       << std::endl;
+    BinOp::print_xpr(os, l);
+    m_expr.print_xpr(os, l);
+    m_vector.print_xpr(os, l);
+    os << IndentLevel(--l)
+       << ">," << std::endl;
+  }
+
+private:
+  const E						m_expr;
+  const V						m_vector;
+};
+
+
+} // namespace gpumatrix
+
+#endif // GPUMATRIX_XPR_BROADCAST_H
@@ -2,6 +2,7 @@
 #define COLWISE_VIEW_H_
 
 #include <gpumatrix/xpr/ColWiseSum.h>
+#include <gpumatrix/xpr/Broadcast.h>
 #include <gpumatrix/impl/Interface.h>
 namespace gpumatrix {
 
@@ -15,9 +16,9 @@ namespace gpumatrix {
 	*        \f]
 	* \note The Rows2 has to be  equal to Cols1.
 	*/
-	template<class E>
+	template<class E, bool Writable>
 	class ColWiseView
-		: public GpuMatrixBase< ColWiseView<E> >
+		: public GpuMatrixBase< ColWiseView<E,Writable> >
 	{
 	private:
 		ColWiseView();
@@ -44,22 +45,39 @@ namespace gpumatrix {
 		//	return XprVector<ColWiseSum<E>>(ColWiseSum<E>(m_expr));
 		//}
 
-		typename E::result_type operator += (const Vector<value_type> & x)
-		{
-			typename E::result_type result = m_expr.eval();
-			impl::colwise_array_compound_op(const_cast<value_type *>(result.data()) , m_expr.rows(),m_expr.cols(), x.data(), Fcnl_colwise_add_eq<value_type,value_type>());
-			return result;
+		// M.colwise() op= x evaluates M and updates the result in place;
+		// only the views of a matrix that may be written offer it
+#define GPUMATRIX_COLWISE_OP(OP, FCNL)											\
+		template<class V>												\
+		typename E::result_type operator OP##= (const V & x)			\
+		{																\
+			static_assert(Writable, "op= needs the colwise view of a matrix that may be written");	\
+			typename impl::VectorOperand<V>::expr_type::result_type v = impl::VectorOperand<V>::as_expr(x).eval();	\
+			if (v.size() != m_expr.rows())								\
+				throw runtime_error("Dimensionality donot Match");		\
+			typename E::result_type result = m_expr.eval();				\
+			impl::colwise_array_compound_op(const_cast<value_type *>(result.data()) , m_expr.rows(),m_expr.cols(), v.data(), Fcnl_colwise_##FCNL##_eq<value_type,value_type>());	\
+			return result;												\
+		}																\
+																		\
+		template<class V>												\
+		typename impl::BroadcastWrapper<E, XprBroadcast<Fcnl_##FCNL<value_type,value_type>, E, typename impl::VectorOperand<V>::expr_type, BroadcastColWise> >::type	\
+		operator OP (const V & x) const									\
+		{																\
+			typedef XprBroadcast<Fcnl_##FCNL<value_type,value_type>, E, typename impl::VectorOperand<V>::expr_type, BroadcastColWise> expr_type;	\
+			typedef typename impl::BroadcastWrapper<E, expr_type>::type wrapper_type;	\
+			return wrapper_type(expr_type(m_expr, impl::VectorOperand<V>::as_expr(x)));	\
 		}
 
-		typename E::result_type operator += (const Map<Vector<value_type>> & x)
-		{
-			typename E::result_type result = m_expr.eval();
-			impl::colwise_array_compound_op(const_cast<value_type *>(result.data()) , m_expr.rows(),m_expr.cols(), x.data(), Fcnl_colwise_add_eq<value_type,value_type>());
-			return result;
-		}
+		GPUMATRIX_COLWISE_OP(+, add)
+		GPUMATRIX_COLWISE_OP(-, sub)
+		GPUMATRIX_COLWISE_OP(*, mul)
+		GPUMATRIX_COLWISE_OP(/, div)
+
+#undef GPUMATRIX_COLWISE_OP
 
 
-		XprVector<ColWiseSum<E>> sum()
+		XprVector<ColWiseSum<E>> sum() const
 		{
 			return XprVector<ColWiseSum<E>>(ColWiseSum<E>(m_expr));
 		}
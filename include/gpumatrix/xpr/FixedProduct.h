@@ -0,0 +1,89 @@
+#ifndef GPUMATRIX_XPR_FIXED_PRODUCT_H
+#define GPUMATRIX_XPR_FIXED_PRODUCT_H
+
+#include <gpumatrix/xpr/ResultType.h>
+#include <gpumatrix/xpr/SparseProduct.h>
+
+namespace gpumatrix {
+
+	template<class T, int R, int C> class FixedMatrix;
+
+	/** Which side the fixed size factor of an XprFixedProduct is on. */
+	enum FixedProductSide
+	{
+		FixedTimesDense,	/**< F*M */
+		DenseTimesFixed		/**< M*F */
+	};
+
+
+/**
+ * \class XprFixedProduct FixedProduct.h "gpumatrix/xpr/FixedProduct.h"
+ * \brief A FixedMatrix times a dense matrix expression E, the fixed
+ * factor on the side given by Side.
+ *
+ * The fixed factor is small and is held by value, so it may be a
+ * temporary; only the dense factor is evaluated.
+ */
+template<class T, int R, int C, class E, int Side>
+class XprFixedProduct
+  : public GpuMatrixBase< XprFixedProduct<T, R, C, E, Side> >
+{
+  XprFixedProduct();
+  XprFixedProduct& operator=(const XprFixedProduct&);
+
+public:
+  typedef T												value_type;
+  typedef typename XprResultType<XprFixedProduct<T,R,C,E,Side>>::result_type result_type;
+
+  enum { fixed_left = Side == FixedTimesDense };
+
+public:
+  /** Constructor for the fixed and the dense factor. */
+  explicit XprFixedProduct(const FixedMatrix<T,R,C>& fixed, const E& dense)
+    : m_fixed(fixed), m_dense(dense)
+  {
+	  if (fixed_left ? dense.rows() != C : dense.cols() != R)
+		  throw runtime_error("Dimension not Match for Fixed Matrix Multiplication");
+  }
+
+  const FixedMatrix<T,R,C> & fixed() const { return m_fixed; }
+
+  const E & dense() const { return m_dense; }
+
+  std::size_t rows() const { return fixed_left ? R : m_dense.rows(); }
+
+  std::size_t cols() const { return fixed_left ? m_dense.cols() : C; }
+
+  std::size_t size() const
+  {
+	  return rows()*cols();
+  }
+
+  result_type eval() const
+  {
+	  return impl::eval(*this);
+  }
+
+public: // debugging Xpr parse tree
+  void print_xpr(std::ostream& os, std::size_t l=0) const {
+    os << IndentLevel(l++)
+       << "XprFixedProduct<" << (fixed_left ? "F*D" : "D*F") << ","
+       << std::endl;
+    os << IndentLevel(l)
+       << "FixedMatrix<R=" << R << ", C=" << C << ">,\n";
+    m_dense.print_xpr(os, l);
+    os << IndentLevel(l)
+       << "R=" << rows() << ", C=" << cols() << ",\n";
+    os << IndentLevel(--l)
+       << ">," << std::endl;
+  }
+
+private:
+  const FixedMatrix<T,R,C>		m_fixed;
+  const E						m_dense;
+};
+
+
+} // namespace gpumatrix
+
+#endif // GPUMATRIX_XPR_FIXED_PRODUCT_H
@@ -41,6 +41,8 @@ namespace gpumatrix {
 
 	/* forwards */
 	template <class T/**/> class Matrix;
+	template <class E, bool Writable> class RowWiseView;
+	template <class E, bool Writable> class ColWiseView;
 
 	/**
 	* \class XprMatrix Matrix.h "gpumatrix/xpr/Matrix.h"
@@ -134,6 +136,16 @@ namespace gpumatrix {
 
 			return result;
 		}
+
+		RowWiseView<XprMatrix<E>,false> rowwise() const
+		{
+			return RowWiseView<XprMatrix<E>,false>(*this);
+		}
+
+		ColWiseView<XprMatrix<E>,false> colwise() const
+		{
+			return ColWiseView<XprMatrix<E>,false>(*this);
+		}
 		///** Wrapper for meta assign. */
 		//template<class Dest, class Src, class Assign>
 		//static inline
@@ -178,9 +190,9 @@ namespace gpumatrix {
 			return gpumatrix::impl::eval(m_expr);
 		}
 
-		operator Eigen::Matrix<value_type,Eigen::Dynamic,Eigen::Dynamic> ()
+		operator Eigen::Matrix<value_type,Eigen::Dynamic,Eigen::Dynamic> () const
 		{
-			return eval();
+			return Matrix<value_type>(*this);
 		}
 
 	public: // debugging Xpr parse tree
@@ -122,6 +122,84 @@ TVMET_DECLARE_MACRO(pow, long double)
 #undef TVMET_DECLARE_MACRO
 
 
+/*
+ * binary_function(POD, XprMatrix<E>)
+ */
+#define TVMET_DECLARE_MACRO(NAME, TP)			\
+template<class E>	\
+XprMatrix<						\
+  XprBinOp<						\
+    Fcnl_##NAME<TP, typename E::value_type>,		\
+    XprLiteral< TP >,					\
+    XprMatrix<E>				\
+  >					\
+>							\
+NAME(TP lhs, 		\
+     const XprMatrix<E>& rhs) TVMET_CXX_ALWAYS_INLINE;
+
+TVMET_DECLARE_MACRO(atan2, int)
+TVMET_DECLARE_MACRO(fmod, int)
+TVMET_DECLARE_MACRO(hypot, int)
+TVMET_DECLARE_MACRO(pow, int)
+
+TVMET_DECLARE_MACRO(atan2, float)
+TVMET_DECLARE_MACRO(fmod, float)
+TVMET_DECLARE_MACRO(hypot, float)
+TVMET_DECLARE_MACRO(pow, float)
+
+TVMET_DECLARE_MACRO(atan2, double)
+TVMET_DECLARE_MACRO(fmod, double)
+TVMET_DECLARE_MACRO(hypot, double)
+TVMET_DECLARE_MACRO(pow, double)
+
+#undef TVMET_DECLARE_MACRO
+
+
+/*
+ * cwiseMin/cwiseMax(XprMatrix<E1>, XprMatrix<E2>)
+ * cwiseMin/cwiseMax(XprMatrix<E>, E::value_type)
+ * cwiseMin/cwiseMax(E::value_type, XprMatrix<E>)
+ */
+#define TVMET_DECLARE_MACRO(NAME, FCNL)				\
+template<class E1,  class E2>	\
+XprMatrix<								\
+  XprBinOp<								\
+    Fcnl_##FCNL<typename E1::value_type, typename E2::value_type>,	\
+    XprMatrix<E1>,						\
+    XprMatrix<E2>						\
+  >								\
+>									\
+NAME(const XprMatrix<E1>& lhs, 				\
+     const XprMatrix<E2>& rhs) TVMET_CXX_ALWAYS_INLINE;		\
+									\
+template<class E>	\
+XprMatrix<						\
+  XprBinOp<						\
+    Fcnl_##FCNL<typename E::value_type, typename E::value_type>,	\
+    XprMatrix<E>,				\
+    XprLiteral<typename E::value_type>			\
+  >					\
+>							\
+NAME(const XprMatrix<E>& lhs, 		\
+     typename E::value_type rhs) TVMET_CXX_ALWAYS_INLINE;	\
+									\
+template<class E>	\
+XprMatrix<						\
+  XprBinOp<						\
+    Fcnl_##FCNL<typename E::value_type, typename E::value_type>,	\
+    XprLiteral<typename E::value_type>,			\
+    XprMatrix<E>				\
+  >					\
+>							\
+NAME(typename E::value_type lhs, 		\
+     const XprMatrix<E>& rhs) TVMET_CXX_ALWAYS_INLINE;
+
+TVMET_DECLARE_MACRO(cwiseMin, min)
+TVMET_DECLARE_MACRO(cwiseMax, max)
+
+#undef TVMET_DECLARE_MACRO
+
+
 #if defined(TVMET_HAVE_COMPLEX)
 /*
  * binary_function(XprMatrix<E>, std::complex<>)
@@ -264,6 +342,116 @@ TVMET_IMPLEMENT_MACRO(pow, long double)
 #undef TVMET_IMPLEMENT_MACRO
 
 
+/*
+ * binary_function(POD, XprMatrix<E>)
+ */
+#define TVMET_IMPLEMENT_MACRO(NAME, TP)					\
+template<class E>			\
+inline									\
+XprMatrix<								\
+  XprBinOp<								\
+    Fcnl_##NAME<TP, typename E::value_type>,				\
+    XprLiteral< TP >,							\
+    XprMatrix<E>						\
+  >								\
+>									\
+NAME(TP lhs, const XprMatrix<E>& rhs) {			\
+  typedef XprBinOp<							\
+    Fcnl_##NAME<TP, typename E::value_type>,				\
+    XprLiteral< TP >,							\
+    XprMatrix<E>						\
+  >							expr_type;	\
+  return XprMatrix<expr_type>(				\
+    expr_type(XprLiteral< TP >(lhs), rhs));				\
+}
+
+TVMET_IMPLEMENT_MACRO(atan2, int)
+TVMET_IMPLEMENT_MACRO(fmod, int)
+TVMET_IMPLEMENT_MACRO(hypot, int)
+TVMET_IMPLEMENT_MACRO(pow, int)
+
+TVMET_IMPLEMENT_MACRO(atan2, float)
+TVMET_IMPLEMENT_MACRO(fmod, float)
+TVMET_IMPLEMENT_MACRO(hypot, float)
+TVMET_IMPLEMENT_MACRO(pow, float)
+
+TVMET_IMPLEMENT_MACRO(atan2, double)
+TVMET_IMPLEMENT_MACRO(fmod, double)
+TVMET_IMPLEMENT_MACRO(hypot, double)
+TVMET_IMPLEMENT_MACRO(pow, double)
+
+#undef TVMET_IMPLEMENT_MACRO
+
+
+/*
+ * cwiseMin/cwiseMax(XprMatrix<E1>, XprMatrix<E2>)
+ * cwiseMin/cwiseMax(XprMatrix<E>, E::value_type)
+ * cwiseMin/cwiseMax(E::value_type, XprMatrix<E>)
+ */
+#define TVMET_IMPLEMENT_MACRO(NAME, FCNL)					\
+template<class E1,  class E2>			\
+inline											\
+XprMatrix<										\
+  XprBinOp<										\
+    Fcnl_##FCNL<typename E1::value_type, typename E2::value_type>,			\
+    XprMatrix<E1>,								\
+    XprMatrix<E2>								\
+  >									\
+>											\
+NAME(const XprMatrix<E1>& lhs, const XprMatrix<E2>& rhs) {	\
+  typedef XprBinOp<									\
+    Fcnl_##FCNL<typename E1::value_type, typename E2::value_type>,			\
+    XprMatrix<E1>,								\
+    XprMatrix<E2>								\
+  >		    					expr_type;			\
+  return XprMatrix<expr_type>(						\
+    expr_type(lhs, rhs));								\
+}											\
+											\
+template<class E>			\
+inline									\
+XprMatrix<								\
+  XprBinOp<								\
+    Fcnl_##FCNL<typename E::value_type, typename E::value_type>,		\
+    XprMatrix<E>,						\
+    XprLiteral<typename E::value_type>					\
+  >								\
+>									\
+NAME(const XprMatrix<E>& lhs, typename E::value_type rhs) {	\
+  typedef XprBinOp<							\
+    Fcnl_##FCNL<typename E::value_type, typename E::value_type>,		\
+    XprMatrix<E>,						\
+    XprLiteral<typename E::value_type>					\
+  >							expr_type;	\
+  return XprMatrix<expr_type>(				\
+    expr_type(lhs, XprLiteral<typename E::value_type>(rhs)));		\
+}									\
+									\
+template<class E>			\
+inline									\
+XprMatrix<								\
+  XprBinOp<								\
+    Fcnl_##FCNL<typename E::value_type, typename E::value_type>,		\
+    XprLiteral<typename E::value_type>,					\
+    XprMatrix<E>						\
+  >								\
+>									\
+NAME(typename E::value_type lhs, const XprMatrix<E>& rhs) {	\
+  typedef XprBinOp<							\
+    Fcnl_##FCNL<typename E::value_type, typename E::value_type>,		\
+    XprLiteral<typename E::value_type>,					\
+    XprMatrix<E>						\
+  >							expr_type;	\
+  return XprMatrix<expr_type>(				\
+    expr_type(XprLiteral<typename E::value_type>(lhs), rhs));		\
+}
+
+TVMET_IMPLEMENT_MACRO(cwiseMin, min)
+TVMET_IMPLEMENT_MACRO(cwiseMax, max)
+
+#undef TVMET_IMPLEMENT_MACRO
+
+
 #if defined(TVMET_HAVE_COMPLEX)
 /*
  * binary_function(XprMatrix<E>, std::complex<>)
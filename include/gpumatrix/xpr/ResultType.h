@@ -26,6 +26,10 @@ namespace gpumatrix
 
 	template<typename E>	class RowWiseSum;
 	template<typename E>	class ColWiseSum;
+	template<typename M, typename E1, typename E2>	class XprSelect;
+	template<typename BinOp, typename E, typename V, int Dir>	class XprBroadcast;
+	template<typename T, typename E, int Side>	class XprSparseProduct;
+	template<typename T, int R, int C, typename E, int Side>	class XprFixedProduct;
 
 	template <class E> class XprResultType;
 	template <class E> class XprMatrixTranspose;
@@ -163,6 +167,48 @@ namespace gpumatrix
 	public:
 		typedef Array<typename E::value_type,D> result_type; 
 	};
+
+	// comparisons and logical ops on arrays evaluate into a bool mask
+#define GPUMATRIX_MASK_RESULT_TYPE(NAME)										\
+	template< typename T1, typename T2, typename E1, typename E2, int D>	\
+	class XprResultType<XprBinOp<Fcnl_##NAME<T1,T2>, XprArray<E1,D>, XprArray<E2,D>>>	\
+	{																		\
+	public:																	\
+		typedef Array<bool,D> result_type;									\
+	};																		\
+																			\
+	template< typename T1, typename T2, typename POD, typename E, int D>	\
+	class XprResultType<XprBinOp<Fcnl_##NAME<T1,T2>, XprLiteral<POD>, XprArray<E,D>>>	\
+	{																		\
+	public:																	\
+		typedef Array<bool,D> result_type;									\
+	};																		\
+																			\
+	template< typename T1, typename T2, typename POD, typename E, int D>	\
+	class XprResultType<XprBinOp<Fcnl_##NAME<T1,T2>, XprArray<E,D>, XprLiteral<POD>>>	\
+	{																		\
+	public:																	\
+		typedef Array<bool,D> result_type;									\
+	};
+
+	GPUMATRIX_MASK_RESULT_TYPE(greater)
+	GPUMATRIX_MASK_RESULT_TYPE(less)
+	GPUMATRIX_MASK_RESULT_TYPE(greater_eq)
+	GPUMATRIX_MASK_RESULT_TYPE(less_eq)
+	GPUMATRIX_MASK_RESULT_TYPE(eq)
+	GPUMATRIX_MASK_RESULT_TYPE(not_eq)
+	GPUMATRIX_MASK_RESULT_TYPE(and)
+	GPUMATRIX_MASK_RESULT_TYPE(or)
+
+#undef GPUMATRIX_MASK_RESULT_TYPE
+
+	template<typename M, typename E1, typename E2, int D>
+	class XprResultType<XprSelect<XprArray<M,D>,E1,E2>>
+	{
+	public:
+		typedef Array<typename XprSelect<XprArray<M,D>,E1,E2>::value_type,D> result_type;
+	};
+
 	//template<typename E1, typename E2>
 	//class XprResultType<XprMMProduct<E1,E2>>
 	//{
@@ -226,6 +272,41 @@ namespace gpumatrix
 		typedef Vector<typename E::value_type> result_type;
 	};
 
+	template<typename BinOp, typename E, typename V, int Dir>
+	class XprResultType<XprBroadcast<BinOp,XprMatrix<E>,V,Dir>>
+	{
+	public:
+		typedef Matrix<typename E::value_type> result_type;
+	};
+
+	template<typename BinOp, typename E, int D, typename V, int Dir>
+	class XprResultType<XprBroadcast<BinOp,XprArray<E,D>,V,Dir>>
+	{
+	public:
+		typedef Array<typename E::value_type,D> result_type;
+	};
+
+	template<typename T, typename E, int Side>
+	class XprResultType<XprSparseProduct<T,XprMatrix<E>,Side>>
+	{
+	public:
+		typedef Matrix<T> result_type;
+	};
+
+	template<typename T, typename E, int Side>
+	class XprResultType<XprSparseProduct<T,XprVector<E>,Side>>
+	{
+	public:
+		typedef Vector<T> result_type;
+	};
+
+	template<typename T, int R, int C, typename E, int Side>
+	class XprResultType<XprFixedProduct<T,R,C,E,Side>>
+	{
+	public:
+		typedef Matrix<T> result_type;
+	};
+
 	template<typename E, int D >
 	class XprResultType<XprUnOp<Fcnl_exp<typename E::value_type>,XprArray<E,D> > >
 	{
@@ -251,4 +332,4 @@ namespace gpumatrix
 
 }
 
-#endif
\ No newline at end of file
+#endif
\ No newline at end of file
@@ -2,6 +2,7 @@
 #define ROWWISE_VIEW_H_
 
 #include <gpumatrix/xpr/RowWiseSum.h>
+#include <gpumatrix/xpr/Broadcast.h>
 #include <gpumatrix/impl/Interface.h>
 
 namespace gpumatrix {
@@ -16,9 +17,9 @@ namespace gpumatrix {
 	*        \f]
 	* \note The Rows2 has to be  equal to Cols1.
 	*/
-	template<class E>
+	template<class E, bool Writable>
 	class RowWiseView
-		: public GpuMatrixBase< RowWiseView<E> >
+		: public GpuMatrixBase< RowWiseView<E,Writable> >
 	{
 	private:
 		RowWiseView();
@@ -40,24 +41,41 @@ namespace gpumatrix {
 		//use_meta  = Rows1*Cols2 < TVMET_COMPLEXITY_MM_TRIGGER ? true : false
 		// };
 
-		XprVector<RowWiseSum<E>> sum()
+		XprVector<RowWiseSum<E>> sum() const
 		{
 			return XprVector<RowWiseSum<E>>(RowWiseSum<E>(m_expr));
 		}
 
-		typename E::result_type operator += (const Vector<value_type> & x)
-		{
-			typename E::result_type result = m_expr.eval();
-			impl::rowwise_array_compound_op(const_cast<value_type *>(result.data()) , m_expr.rows(),m_expr.cols(), x.data(), Fcnl_rowwise_add_eq<value_type,value_type>());
-			return result;
+		// M.rowwise() op= x evaluates M and updates the result in place;
+		// only the views of a matrix that may be written offer it
+#define GPUMATRIX_ROWWISE_OP(OP, FCNL)											\
+		template<class V>												\
+		typename E::result_type operator OP##= (const V & x)			\
+		{																\
+			static_assert(Writable, "op= needs the rowwise view of a matrix that may be written");	\
+			typename impl::VectorOperand<V>::expr_type::result_type v = impl::VectorOperand<V>::as_expr(x).eval();	\
+			if (v.size() != m_expr.cols())								\
+				throw runtime_error("Dimensionality donot Match");		\
+			typename E::result_type result = m_expr.eval();				\
+			impl::rowwise_array_compound_op(const_cast<value_type *>(result.data()) , m_expr.rows(),m_expr.cols(), v.data(), Fcnl_rowwise_##FCNL##_eq<value_type,value_type>());	\
+			return result;												\
+		}																\
+																		\
+		template<class V>												\
+		typename impl::BroadcastWrapper<E, XprBroadcast<Fcnl_##FCNL<value_type,value_type>, E, typename impl::VectorOperand<V>::expr_type, BroadcastRowWise> >::type	\
+		operator OP (const V & x) const									\
+		{																\
+			typedef XprBroadcast<Fcnl_##FCNL<value_type,value_type>, E, typename impl::VectorOperand<V>::expr_type, BroadcastRowWise> expr_type;	\
+			typedef typename impl::BroadcastWrapper<E, expr_type>::type wrapper_type;	\
+			return wrapper_type(expr_type(m_expr, impl::VectorOperand<V>::as_expr(x)));	\
 		}
 
-		typename E::result_type operator += (const Map<Vector<value_type>> & x)
-		{
-			typename E::result_type result = m_expr.eval();
-			impl::rowwise_array_compound_op(const_cast<value_type *>(result.data()) , m_expr.rows(),m_expr.cols(), x.data(), Fcnl_rowwise_add_eq<value_type,value_type>());
-			return result;
-		}
+		GPUMATRIX_ROWWISE_OP(+, add)
+		GPUMATRIX_ROWWISE_OP(-, sub)
+		GPUMATRIX_ROWWISE_OP(*, mul)
+		GPUMATRIX_ROWWISE_OP(/, div)
+
+#undef GPUMATRIX_ROWWISE_OP
 		
 	public:
 		/** Constructor. */
@@ -0,0 +1,104 @@
+#ifndef GPUMATRIX_XPR_SELECT_H
+#define GPUMATRIX_XPR_SELECT_H
+
+#include <gpumatrix/xpr/BinOperator.h>
+
+namespace gpumatrix {
+
+	namespace impl
+	{
+		/** value type of a select, taken from the array branch so that a
+		literal on the other side converts to it; two array branches
+		take their OperandTraits type. */
+		template<class E1, class E2> struct SelectTraits
+		{
+			typedef typename OperandTraits<typename E1::value_type, typename E2::value_type>::value_type value_type;
+		};
+
+		template<class E, class POD> struct SelectTraits<E, XprLiteral<POD> >
+		{
+			typedef typename E::value_type value_type;
+		};
+
+		template<class POD, class E> struct SelectTraits<XprLiteral<POD>, E>
+		{
+			typedef typename E::value_type value_type;
+		};
+	}
+
+
+/**
+ * \class XprSelect Select.h "gpumatrix/xpr/Select.h"
+ * \brief Element wise choice between two sub expressions by a bool mask,
+ *        mask(i,j) ? lhs(i,j) : rhs(i,j).
+ *
+ * Either branch may be an XprLiteral. Shape is taken from the mask.
+ */
+template<class M, class E1, class E2>
+class XprSelect
+  : public GpuMatrixBase< XprSelect<M, E1, E2> >
+{
+  XprSelect();
+  XprSelect& operator=(const XprSelect&);
+
+public:
+  typedef typename impl::SelectTraits<E1,E2>::value_type	value_type;
+  typedef typename XprResultType<XprSelect<M,E1,E2>>::result_type result_type;
+
+public:
+  /** Constructor for the mask and the two branches. */
+  explicit XprSelect(const M& mask, const E1& lhs, const E2& rhs)
+    : m_mask(mask), m_lhs(lhs), m_rhs(rhs)
+  {
+	  check_dim(mask,lhs);
+	  check_dim(mask,rhs);
+  }
+
+  const M & mask() const { return m_mask; }
+
+  const E1 & lhs() const { return m_lhs; }
+
+  const E2 & rhs() const { return m_rhs; }
+
+  std::size_t rows() const
+  {
+	  return m_mask.rows();
+  }
+
+  std::size_t cols() const
+  {
+	  return m_mask.cols();
+  }
+
+  std::size_t size() const
+  {
+	  return m_mask.size();
+  }
+
+  result_type eval() const
+  {
+	  return impl::eval(*this);
+  }
+
+public: // debugging Xpr parse tree
+  void print_xpr(std::ostream& os, std::size_t l=0) const {
+    os << IndentLevel(l++)
+       << "XprSelect<"
+       << std::endl;
+    m_mask.print_xpr(os, l);
+    m_lhs.print_xpr(os, l);
+    m_rhs.print_xpr(os, l);
+    os << IndentLevel(--l)
+       << ">," << std::endl;
+  }
+
+private:
+  const M						m_mask;
+  const E1						m_lhs;
+  const E2						m_rhs;
+};
+
+
+} // namespace gpumatrix
+
+#endif // GPUMATRIX_XPR_SELECT_H
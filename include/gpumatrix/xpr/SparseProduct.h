@@ -0,0 +1,171 @@
+#ifndef GPUMATRIX_XPR_SPARSE_PRODUCT_H
+#define GPUMATRIX_XPR_SPARSE_PRODUCT_H
+
+#include <gpumatrix/xpr/ResultType.h>
+#include <gpumatrix/xpr/Broadcast.h>
+
+namespace gpumatrix {
+
+	template<class T> class Matrix;
+	template<class T> class SparseMatrix;
+
+	/** Which side the sparse factor of an XprSparseProduct is on, and
+	whether it is transposed. */
+	enum SparseProductSide
+	{
+		SparseTimesDense,			/**< S*M, S*v */
+		SparseTransposeTimesDense,	/**< S.transpose()*M, S.transpose()*v */
+		DenseTimesSparse,			/**< M*S */
+		DenseTimesSparseTranspose	/**< M*S.transpose() */
+	};
+
+	namespace impl
+	{
+		/** Matrix, Map<Matrix> and XprMatrix seen as a matrix expression.
+		Anything else has no members. */
+		template<class M> struct MatrixOperand { };
+
+		template<class T> struct MatrixOperand<Matrix<T> >
+		{
+			typedef XprMatrix<MatrixConstReference<T> >	expr_type;
+
+			static expr_type as_expr(const Matrix<T> & m) { return m.as_expr(); }
+		};
+
+		template<class T> struct MatrixOperand<Map<Matrix<T> > >
+		{
+			typedef XprMatrix<MatrixConstReference<T> >	expr_type;
+
+			static expr_type as_expr(const Map<Matrix<T> > & m) { return m.as_expr(); }
+		};
+
+		template<class E> struct MatrixOperand<XprMatrix<E> >
+		{
+			typedef XprMatrix<E>						expr_type;
+
+			static const expr_type & as_expr(const XprMatrix<E> & m) { return m; }
+		};
+
+		/** The dense factor of a sparse product: a matrix or a vector expression. */
+		template<class X> struct SparseOperand { };
+
+		template<class T> struct SparseOperand<Matrix<T> > : MatrixOperand<Matrix<T> > { };
+		template<class T> struct SparseOperand<Map<Matrix<T> > > : MatrixOperand<Map<Matrix<T> > > { };
+		template<class E> struct SparseOperand<XprMatrix<E> > : MatrixOperand<XprMatrix<E> > { };
+		template<class T> struct SparseOperand<Vector<T> > : VectorOperand<Vector<T> > { };
+		template<class T> struct SparseOperand<Map<Vector<T> > > : VectorOperand<Map<Vector<T> > > { };
+		template<class E> struct SparseOperand<XprVector<E> > : VectorOperand<XprVector<E> > { };
+
+		/** The wrapped product node: XprMatrix over a matrix, XprVector over a vector. */
+		template<class T, class E, int Side> struct SparseProduct;
+
+		template<class T, class E, int Side> struct SparseProduct<T, XprMatrix<E>, Side>
+		{
+			typedef XprMatrix<XprSparseProduct<T, XprMatrix<E>, Side> >	type;
+		};
+
+		template<class T, class E, int Side> struct SparseProduct<T, XprVector<E>, Side>
+		{
+			typedef XprVector<XprSparseProduct<T, XprVector<E>, Side> >	type;
+		};
+	}
+
+
+/**
+ * \class XprSparseProduct SparseProduct.h "gpumatrix/xpr/SparseProduct.h"
+ * \brief A SparseMatrix times a dense matrix or vector expression E, the
+ * sparse factor on the side given by Side.
+ *
+ * Only the dense factor is evaluated; the sparse factor is used in place,
+ * so the SparseMatrix must outlive the expression.
+ */
+template<class T, class E, int Side>
+class XprSparseProduct
+  : public GpuMatrixBase< XprSparseProduct<T, E, Side> >
+{
+  XprSparseProduct();
+  XprSparseProduct& operator=(const XprSparseProduct&);
+
+public:
+  typedef T												value_type;
+  typedef typename XprResultType<XprSparseProduct<T,E,Side>>::result_type result_type;
+
+  enum { sparse_left = Side == SparseTimesDense || Side == SparseTransposeTimesDense };
+
+public:
+  /** Constructor for the sparse and the dense factor. */
+  explicit XprSparseProduct(const SparseMatrix<T>& sparse, const E& dense)
+    : m_sparse(sparse), m_dense(dense)
+  {
+	  bool match;
+	  switch (Side)
+	  {
+	  case SparseTimesDense:			match = dense.rows() == sparse.cols(); break;
+	  case SparseTransposeTimesDense:	match = dense.rows() == sparse.rows(); break;
+	  case DenseTimesSparse:			match = dense.cols() == sparse.rows(); break;
+	  default:							match = dense.cols() == sparse.cols(); break;
+	  }
+
+	  if (!match)
+		  throw runtime_error("Dimension not Match for Sparse Matrix Multiplication");
+  }
+
+  const SparseMatrix<T> & sparse() const { return m_sparse; }
+
+  const E & dense() const { return m_dense; }
+
+  std::size_t rows() const
+  {
+	  switch (Side)
+	  {
+	  case SparseTimesDense:			return m_sparse.rows();
+	  case SparseTransposeTimesDense:	return m_sparse.cols();
+	  default:							return m_dense.rows();
+	  }
+  }
+
+  std::size_t cols() const
+  {
+	  switch (Side)
+	  {
+	  case DenseTimesSparse:			return m_sparse.cols();
+	  case DenseTimesSparseTranspose:	return m_sparse.rows();
+	  default:							return m_dense.cols();
+	  }
+  }
+
+  std::size_t size() const
+  {
+	  return rows()*cols();
+  }
+
+  result_type eval() const
+  {
+	  return impl::eval(*this);
+  }
+
+public: // debugging Xpr parse tree
+  void print_xpr(std::ostream& os, std::size_t l=0) const {
+    static const char * side[] = { "S*D", "St*D", "D*S", "D*St" };
+    os << IndentLevel(l++)
+       << "XprSparseProduct<" << side[Side] << ","
+       << std::endl;
+    os << IndentLevel(l)
+       << "SparseMatrix<R=" << m_sparse.rows() << ", C=" << m_sparse.cols()
+       << ", NNZ=" << m_sparse.nonZeros() << ">,\n";
+    m_dense.print_xpr(os, l);
+    os << IndentLevel(l)
+       << "R=" << rows() << ", C=" << cols() << ",\n";
+    os << IndentLevel(--l)
+       << ">," << std::endl;
+  }
+
+private:
+  const SparseMatrix<T> &		m_sparse;
+  const E						m_dense;
+};
+
+
+} // namespace gpumatrix
+
+#endif // GPUMATRIX_XPR_SPARSE_PRODUCT_H
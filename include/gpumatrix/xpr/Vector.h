@@ -145,9 +145,9 @@ namespace gpumatrix {
 			return 	eval().squaredNorm();
 		}
 
-		operator Eigen::Matrix<value_type,Eigen::Dynamic,1> ()
+		operator Eigen::Matrix<value_type,Eigen::Dynamic,1> () const
 		{
-			return eval();
+			return Vector<value_type>(*this);
 		}
 
 
@@ -2,6 +2,7 @@
 
 
 #include <gpumatrix/impl/backend/ArrayOperationInterface.h>
+#include <gpumatrix/Trace.h>
 #include <cuda.h>
 #include <cublas.h>
 #include <cuda_runtime.h>
@@ -22,22 +23,20 @@ namespace gpumatrix
 
 #define SCALAR_ARRAY_OP(OPNAME, OP, TYPE) \
 	\
-	__global__ void _scalar_array_##OPNAME (TYPE *odata, const TYPE  alpha, const TYPE *idata,  int size) \
+	__global__ void _scalar_array_##OPNAME (TYPE *odata, const TYPE  alpha, const TYPE *idata,  std::size_t size) \
 			{																			\
 			\
-			unsigned int index = blockIdx.x * blockDim.x + threadIdx.x;				\
-			\
-			if(index < size )														\
-			{																		\
+			GPUMATRIX_ELEMENTWISE_LOOP(index, size, \
 			odata[index] = alpha OP idata[index]  ;								\
-		}																		\
+			) \
 		\
 		}																			\
 		\
-		void scalar_array_##OPNAME( TYPE *odata, const TYPE  alpha, const TYPE *idata,  int size)  \
+		void scalar_array_##OPNAME( TYPE *odata, const TYPE  alpha, const TYPE *idata,  std::size_t size)  \
 			{																						\
-			int numGrid = (size + 256 -1)/256;													\
-			_scalar_array_##OPNAME<<<numGrid,256>>>(odata, alpha, idata, size);						\
+			GPUMATRIX_TRACE_SCOPE("impl::scalar_array_" #OPNAME,size,0,0,2.0*size*sizeof(TYPE),size);		\
+			unsigned int numGrid = elementwise_blocks(size);													\
+			_scalar_array_##OPNAME<<<numGrid,ElementwiseThreads>>>(odata, alpha, idata, size);						\
 		}																				
 
 			SCALAR_ARRAY_OP(add,+,float)
@@ -48,25 +47,31 @@ namespace gpumatrix
 				SCALAR_ARRAY_OP(mul,*,double)
 				SCALAR_ARRAY_OP(div,/,float)
 				SCALAR_ARRAY_OP(div,/,double)
+				SCALAR_ARRAY_OP(add,+,half)
+				SCALAR_ARRAY_OP(add,+,bfloat16)
+				SCALAR_ARRAY_OP(sub,-,half)
+				SCALAR_ARRAY_OP(sub,-,bfloat16)
+				SCALAR_ARRAY_OP(mul,*,half)
+				SCALAR_ARRAY_OP(mul,*,bfloat16)
+				SCALAR_ARRAY_OP(div,/,half)
+				SCALAR_ARRAY_OP(div,/,bfloat16)
 
 #define ARRAY_ARRAY_OP(OPNAME, OP, TYPE) \
 	\
-	__global__ void _array_##OPNAME (TYPE *odata, const TYPE  * idata1, const TYPE * idata2,  int size) \
+	__global__ void _array_##OPNAME (TYPE *odata, const TYPE  * idata1, const TYPE * idata2,  std::size_t size) \
 			{																			\
 			\
-			unsigned int index = blockIdx.x * blockDim.x + threadIdx.x;				\
-			\
-			if(index < size )														\
-			{																		\
+			GPUMATRIX_ELEMENTWISE_LOOP(index, size, \
 			odata[index] = idata1[index] OP idata2[index]  ;								\
-			}																		\
+			) \
 			\
 			}																			\
 			\
-			void array_##OPNAME( TYPE *odata, const TYPE  * idata1, const TYPE * idata2,  int size)  \
+			void array_##OPNAME( TYPE *odata, const TYPE  * idata1, const TYPE * idata2,  std::size_t size)  \
 			{																						\
-			int numGrid = (size + 256 -1)/256;													\
-			_array_##OPNAME<<<numGrid,256>>>(odata, idata1, idata2, size);						\
+			GPUMATRIX_TRACE_SCOPE("impl::array_" #OPNAME,size,0,0,3.0*size*sizeof(TYPE),size);		\
+			unsigned int numGrid = elementwise_blocks(size);													\
+			_array_##OPNAME<<<numGrid,ElementwiseThreads>>>(odata, idata1, idata2, size);						\
 			}			
 
 
@@ -78,26 +83,32 @@ namespace gpumatrix
 			ARRAY_ARRAY_OP(mul,*,double)
 			ARRAY_ARRAY_OP(div,/,float)
 			ARRAY_ARRAY_OP(div,/,double)
+			ARRAY_ARRAY_OP(add,+,half)
+			ARRAY_ARRAY_OP(add,+,bfloat16)
+			ARRAY_ARRAY_OP(sub,-,half)
+			ARRAY_ARRAY_OP(sub,-,bfloat16)
+			ARRAY_ARRAY_OP(mul,*,half)
+			ARRAY_ARRAY_OP(mul,*,bfloat16)
+			ARRAY_ARRAY_OP(div,/,half)
+			ARRAY_ARRAY_OP(div,/,bfloat16)
 
 
 #define ARRAY_ARRAY_COMPOUND_OP(OPNAME, OP, TYPE) \
 	\
-	__global__ void _array_compound_op (TYPE *odata, const TYPE  * idata, int size, const Fcnl_##OPNAME<TYPE,TYPE> * func) \
+	__global__ void _array_compound_op (TYPE *odata, const TYPE  * idata, std::size_t size, const Fcnl_##OPNAME<TYPE,TYPE> * func) \
 			{																			\
 			\
-			unsigned int index = blockIdx.x * blockDim.x + threadIdx.x;				\
-			\
-			if(index < size )														\
-			{																		\
+			GPUMATRIX_ELEMENTWISE_LOOP(index, size, \
 			odata[index] OP idata[index];								\
-			}																		\
+			) \
 			\
 			}																			\
 			\
-			void array_compound_op( TYPE *odata, const TYPE  * idata, int size,const Fcnl_##OPNAME<TYPE,TYPE> & func)  \
+			void array_compound_op( TYPE *odata, const TYPE  * idata, std::size_t size,const Fcnl_##OPNAME<TYPE,TYPE> & func)  \
 			{																						\
-			int numGrid = (size + 256 -1)/256;													\
-			_array_compound_op<<<numGrid,256>>>(odata, idata,  size,&func);						\
+			GPUMATRIX_TRACE_SCOPE("impl::array_compound_op<" #OPNAME ">",size,0,0,3.0*size*sizeof(TYPE),size);		\
+			unsigned int numGrid = elementwise_blocks(size);													\
+			_array_compound_op<<<numGrid,ElementwiseThreads>>>(odata, idata,  size,&func);						\
 			}			
 
 				ARRAY_ARRAY_COMPOUND_OP(add_eq, +=, double)
@@ -108,26 +119,32 @@ namespace gpumatrix
 				ARRAY_ARRAY_COMPOUND_OP(mul_eq, *=, float)
 				ARRAY_ARRAY_COMPOUND_OP(div_eq, /=, double)
 				ARRAY_ARRAY_COMPOUND_OP(div_eq, /=, float)
+				ARRAY_ARRAY_COMPOUND_OP(add_eq, +=, half)
+				ARRAY_ARRAY_COMPOUND_OP(add_eq, +=, bfloat16)
+				ARRAY_ARRAY_COMPOUND_OP(sub_eq, -=, half)
+				ARRAY_ARRAY_COMPOUND_OP(sub_eq, -=, bfloat16)
+				ARRAY_ARRAY_COMPOUND_OP(mul_eq, *=, half)
+				ARRAY_ARRAY_COMPOUND_OP(mul_eq, *=, bfloat16)
+				ARRAY_ARRAY_COMPOUND_OP(div_eq, /=, half)
+				ARRAY_ARRAY_COMPOUND_OP(div_eq, /=, bfloat16)
 
 
 #define SCALAR_ARRAY_COMPOUND_OP(OPNAME, OP, TYPE) \
 	\
-	__global__ void _scalar_array_compound_op (TYPE *odata, TYPE  alpha, int size, const Fcnl_##OPNAME<TYPE,TYPE> * func) \
+	__global__ void _scalar_array_compound_op (TYPE *odata, TYPE  alpha, std::size_t size, const Fcnl_##OPNAME<TYPE,TYPE> * func) \
 			{																			\
 			\
-			unsigned int index = blockIdx.x * blockDim.x + threadIdx.x;				\
-			\
-			if(index < size )														\
-			{																		\
+			GPUMATRIX_ELEMENTWISE_LOOP(index, size, \
 			odata[index] OP alpha;								\
-			}																		\
+			) \
 			\
 			}																			\
 			\
-			void scalar_array_compound_op( TYPE *odata, TYPE  alpha,int size,const Fcnl_##OPNAME<TYPE,TYPE> & func)  \
+			void scalar_array_compound_op( TYPE *odata, TYPE  alpha,std::size_t size,const Fcnl_##OPNAME<TYPE,TYPE> & func)  \
 			{																						\
-			int numGrid = (size + 256 -1)/256;													\
-			_scalar_array_compound_op<<<numGrid,256>>>(odata, alpha, size,&func);						\
+			GPUMATRIX_TRACE_SCOPE("impl::scalar_array_compound_op<" #OPNAME ">",size,0,0,2.0*size*sizeof(TYPE),size);		\
+			unsigned int numGrid = elementwise_blocks(size);													\
+			_scalar_array_compound_op<<<numGrid,ElementwiseThreads>>>(odata, alpha, size,&func);						\
 			}			
 
 			SCALAR_ARRAY_COMPOUND_OP(add_eq, +=, double)
@@ -138,63 +155,270 @@ namespace gpumatrix
 			SCALAR_ARRAY_COMPOUND_OP(mul_eq, *=, float)
 			SCALAR_ARRAY_COMPOUND_OP(div_eq, /=, double)
 			SCALAR_ARRAY_COMPOUND_OP(div_eq, /=, float)
+			SCALAR_ARRAY_COMPOUND_OP(add_eq, +=, half)
+			SCALAR_ARRAY_COMPOUND_OP(add_eq, +=, bfloat16)
+			SCALAR_ARRAY_COMPOUND_OP(sub_eq, -=, half)
+			SCALAR_ARRAY_COMPOUND_OP(sub_eq, -=, bfloat16)
+			SCALAR_ARRAY_COMPOUND_OP(mul_eq, *=, half)
+			SCALAR_ARRAY_COMPOUND_OP(mul_eq, *=, bfloat16)
+			SCALAR_ARRAY_COMPOUND_OP(div_eq, /=, half)
+			SCALAR_ARRAY_COMPOUND_OP(div_eq, /=, bfloat16)
+
+
+			// Broadcast of a vector over a column major row x col matrix. A
+			// block covers a BROADCAST_TILE square tile with threadIdx.x running
+			// down a column, so every load and store of the matrix is coalesced.
+			// The BROADCAST_ROWS rows of threads stride over the tile columns.
+#define BROADCAST_TILE 32
+#define BROADCAST_ROWS 8
+
+			// odata(i,j) = idata(i,j) op x[j]: the x[j] of the tile are read
+			// into shared memory once and reused by all its rows
+			template <class Fcnl>
+			__global__ void _rowwise_array_op(typename Fcnl::value_type *odata, const typename Fcnl::value_type * idata, int row, int col, const typename Fcnl::value_type * x)
+			{
+				typedef typename Fcnl::value_type T;
+				__shared__ T xs[BROADCAST_TILE];
+
+				unsigned int i = blockIdx.x * BROADCAST_TILE + threadIdx.x;
+				unsigned int j0 = blockIdx.y * BROADCAST_TILE;
+
+				if (threadIdx.y == 0 && j0 + threadIdx.x < col)
+					xs[threadIdx.x] = x[j0 + threadIdx.x];
+
+				__syncthreads();
+
+				if (i < row)
+				{
+					for (unsigned int jj = threadIdx.y; jj < BROADCAST_TILE && j0 + jj < col; jj += BROADCAST_ROWS)
+					{
+						size_t k = (size_t)(j0 + jj) * row + i;
+						odata[k] = Fcnl::apply_on(idata[k], xs[jj]);
+					}
+				}
+			}
+
+			// odata(i,j) = idata(i,j) op x[i]: x[i] stays in a register for
+			// the columns of the tile
+			template <class Fcnl>
+			__global__ void _colwise_array_op(typename Fcnl::value_type *odata, const typename Fcnl::value_type * idata, int row, int col, const typename Fcnl::value_type * x)
+			{
+				typedef typename Fcnl::value_type T;
+
+				unsigned int i = blockIdx.x * BROADCAST_TILE + threadIdx.x;
+				unsigned int j0 = blockIdx.y * BROADCAST_TILE;
+
+				if (i < row)
+				{
+					T xi = x[i];
+
+					for (unsigned int jj = threadIdx.y; jj < BROADCAST_TILE && j0 + jj < col; jj += BROADCAST_ROWS)
+					{
+						size_t k = (size_t)(j0 + jj) * row + i;
+						odata[k] = Fcnl::apply_on(idata[k], xi);
+					}
+				}
+			}
+
+			template <class Fcnl>
+			void rowwise_array_op(typename Fcnl::value_type *odata, const typename Fcnl::value_type * idata, int row, int col, const typename Fcnl::value_type * x, const Fcnl & func)
+			{
+				dim3 dimBlock(BROADCAST_TILE, BROADCAST_ROWS, 1);
+				GPUMATRIX_TRACE_SCOPE("impl::rowwise_array_op",row,col,0,(2.0*row*col + col)*sizeof(typename Fcnl::value_type),double(row)*col);
+
+				dim3 dimGrid((row + BROADCAST_TILE - 1)/BROADCAST_TILE, (col + BROADCAST_TILE - 1)/BROADCAST_TILE, 1);
+
+				_rowwise_array_op<Fcnl><<<dimGrid,dimBlock>>>(odata, idata, row, col, x);
+			}
+
+			template <class Fcnl>
+			void colwise_array_op(typename Fcnl::value_type *odata, const typename Fcnl::value_type * idata, int row, int col, const typename Fcnl::value_type * x, const Fcnl & func)
+			{
+				dim3 dimBlock(BROADCAST_TILE, BROADCAST_ROWS, 1);
+				GPUMATRIX_TRACE_SCOPE("impl::colwise_array_op",row,col,0,(2.0*row*col + row)*sizeof(typename Fcnl::value_type),double(row)*col);
+
+				dim3 dimGrid((row + BROADCAST_TILE - 1)/BROADCAST_TILE, (col + BROADCAST_TILE - 1)/BROADCAST_TILE, 1);
+
+				_colwise_array_op<Fcnl><<<dimGrid,dimBlock>>>(odata, idata, row, col, x);
+			}
+
+			// the compound forms run the same kernels in place
+#define BROADCAST_ARRAY_OP(OPNAME, TYPE) \
+	template void rowwise_array_op< Fcnl_##OPNAME<TYPE,TYPE> >(TYPE *odata, const TYPE * idata, int row, int col, const TYPE * x, const Fcnl_##OPNAME<TYPE,TYPE> & func); \
+	template void colwise_array_op< Fcnl_##OPNAME<TYPE,TYPE> >(TYPE *odata, const TYPE * idata, int row, int col, const TYPE * x, const Fcnl_##OPNAME<TYPE,TYPE> & func); \
+	\
+	void rowwise_array_compound_op( TYPE *odata, int row, int col, const TYPE * x , const Fcnl_rowwise_##OPNAME##_eq<TYPE,TYPE> & func) \
+	{ \
+		rowwise_array_op(odata, odata, row, col, x, Fcnl_##OPNAME<TYPE,TYPE>()); \
+	} \
+	\
+	void colwise_array_compound_op( TYPE *odata, int row, int col, const TYPE * x , const Fcnl_colwise_##OPNAME##_eq<TYPE,TYPE> & func) \
+	{ \
+		colwise_array_op(odata, odata, row, col, x, Fcnl_##OPNAME<TYPE,TYPE>()); \
+	}
+
+#define BROADCAST_ARRAY_OP_ALL(TYPE) \
+	BROADCAST_ARRAY_OP(add, TYPE) \
+	BROADCAST_ARRAY_OP(sub, TYPE) \
+	BROADCAST_ARRAY_OP(mul, TYPE) \
+	BROADCAST_ARRAY_OP(div, TYPE)
 
+			BROADCAST_ARRAY_OP_ALL(double)
+			BROADCAST_ARRAY_OP_ALL(float)
+			BROADCAST_ARRAY_OP_ALL(half)
+			BROADCAST_ARRAY_OP_ALL(bfloat16)
 
-#define BLOCK_DIM 16
 
-#define ROWWISE_ARRAY_COMPOUND_OP(OPNAME, OP, TYPE) \
+#define ARRAY_CONVERT(TO, FROM) \
 	\
-	__global__ void _rowwise_array_compound_op (TYPE *odata, int row, int col, const TYPE * x , const Fcnl_rowwise_##OPNAME<TYPE,TYPE> * func) \
+	__global__ void _array_convert (TO *odata, const FROM * idata, std::size_t size) \
 			{																			\
 			\
-			unsigned int xIndex = blockIdx.x * BLOCK_DIM + threadIdx.x;				\
-			unsigned int yIndex = blockIdx.y * BLOCK_DIM + threadIdx.y;				\
-			if((xIndex < row) && (yIndex < col))							    	\
-			{																		\
-			odata[yIndex*row+xIndex] OP x[yIndex];								\
-			}																		\
+			GPUMATRIX_ELEMENTWISE_LOOP(index, size, \
+			odata[index] = TO(idata[index]);								\
+			) \
 			\
 			}																			\
 			\
+			void array_convert( TO *odata, const FROM * idata, std::size_t size)  \
+			{																						\
+			GPUMATRIX_TRACE_SCOPE("impl::array_convert",size,0,0,double(size)*(sizeof(TO) + sizeof(FROM)),0);		\
+			unsigned int numGrid = elementwise_blocks(size);													\
+			_array_convert<<<numGrid,ElementwiseThreads>>>(odata, idata, size);						\
+			}			
+
+			ARRAY_CONVERT(float, double)
+			ARRAY_CONVERT(double, float)
+			ARRAY_CONVERT(half, float)
+			ARRAY_CONVERT(float, half)
+			ARRAY_CONVERT(bfloat16, float)
+			ARRAY_CONVERT(float, bfloat16)
+			ARRAY_CONVERT(half, double)
+			ARRAY_CONVERT(double, half)
+			ARRAY_CONVERT(bfloat16, double)
+			ARRAY_CONVERT(double, bfloat16)
+			ARRAY_CONVERT(half, bfloat16)
+			ARRAY_CONVERT(bfloat16, half)
+
+
+#define ARRAY_COMPARE(OPNAME, OP, TYPE) \
+	\
+	__global__ void _array_compare (bool *odata, const TYPE * idata1, const TYPE * idata2, std::size_t size, const Fcnl_##OPNAME<TYPE,TYPE> * func) \
+			{																			\
 			\
-			void rowwise_array_compound_op( TYPE *odata, int row, int col, const TYPE * x , const Fcnl_rowwise_##OPNAME<TYPE,TYPE> & func)	\
-			{																															\
-			dim3 dimGrid(BLOCK_DIM,BLOCK_DIM,1);																					\
-			dim3 dimBlock(int(ceil(float(row)/BLOCK_DIM)),int(ceil(float(col)/BLOCK_DIM)));											\
+			GPUMATRIX_ELEMENTWISE_LOOP(index, size, \
+			odata[index] = idata1[index] OP idata2[index];								\
+			) \
 			\
-			_rowwise_array_compound_op<<<dimBlock,dimGrid>>>(odata, row, col, x, & func);											\
-			}																															\
-
-
-			ROWWISE_ARRAY_COMPOUND_OP(add_eq, +=, double)
-			ROWWISE_ARRAY_COMPOUND_OP(add_eq, +=, float)
-
-#define COLWISE_ARRAY_COMPOUND_OP(OPNAME, OP, TYPE) \
+			}																			\
+			\
+	__global__ void _array_scalar_compare (bool *odata, const TYPE * idata, TYPE alpha, std::size_t size, const Fcnl_##OPNAME<TYPE,TYPE> * func) \
+			{																			\
+			\
+			GPUMATRIX_ELEMENTWISE_LOOP(index, size, \
+			odata[index] = idata[index] OP alpha;								\
+			) \
+			\
+			}																			\
+			\
+			void array_compare( bool *odata, const TYPE * idata1, const TYPE * idata2, std::size_t size, const Fcnl_##OPNAME<TYPE,TYPE> & func)  \
+			{																						\
+			GPUMATRIX_TRACE_SCOPE("impl::array_compare<" #OPNAME ">",size,0,0,double(size)*(2*sizeof(TYPE) + sizeof(bool)),size);		\
+			unsigned int numGrid = elementwise_blocks(size);													\
+			_array_compare<<<numGrid,ElementwiseThreads>>>(odata, idata1, idata2, size, &func);						\
+			}																						\
+			\
+			void array_scalar_compare( bool *odata, const TYPE * idata, TYPE alpha, std::size_t size, const Fcnl_##OPNAME<TYPE,TYPE> & func)  \
+			{																						\
+			GPUMATRIX_TRACE_SCOPE("impl::array_scalar_compare<" #OPNAME ">",size,0,0,double(size)*(sizeof(TYPE) + sizeof(bool)),size);		\
+			unsigned int numGrid = elementwise_blocks(size);													\
+			_array_scalar_compare<<<numGrid,ElementwiseThreads>>>(odata, idata, alpha, size, &func);						\
+			}
+
+			ARRAY_COMPARE(greater, >, float)
+			ARRAY_COMPARE(greater, >, double)
+			ARRAY_COMPARE(less, <, float)
+			ARRAY_COMPARE(less, <, double)
+			ARRAY_COMPARE(greater_eq, >=, float)
+			ARRAY_COMPARE(greater_eq, >=, double)
+			ARRAY_COMPARE(less_eq, <=, float)
+			ARRAY_COMPARE(less_eq, <=, double)
+			ARRAY_COMPARE(eq, ==, float)
+			ARRAY_COMPARE(eq, ==, double)
+			ARRAY_COMPARE(not_eq, !=, float)
+			ARRAY_COMPARE(not_eq, !=, double)
+			ARRAY_COMPARE(greater, >, half)
+			ARRAY_COMPARE(greater, >, bfloat16)
+			ARRAY_COMPARE(less, <, half)
+			ARRAY_COMPARE(less, <, bfloat16)
+			ARRAY_COMPARE(greater_eq, >=, half)
+			ARRAY_COMPARE(greater_eq, >=, bfloat16)
+			ARRAY_COMPARE(less_eq, <=, half)
+			ARRAY_COMPARE(less_eq, <=, bfloat16)
+			ARRAY_COMPARE(eq, ==, half)
+			ARRAY_COMPARE(eq, ==, bfloat16)
+			ARRAY_COMPARE(not_eq, !=, half)
+			ARRAY_COMPARE(not_eq, !=, bfloat16)
+			ARRAY_COMPARE(eq, ==, bool)
+			ARRAY_COMPARE(not_eq, !=, bool)
+			ARRAY_COMPARE(and, &&, bool)
+			ARRAY_COMPARE(or, ||, bool)
+
+
+#define ARRAY_SELECT(TYPE) \
 	\
-	__global__ void _colwise_array_compound_op (TYPE *odata, int row, int col, const TYPE * x , const Fcnl_colwise_##OPNAME<TYPE,TYPE> * func) \
+	__global__ void _array_select (TYPE *odata, const bool * mask, const TYPE * idata1, const TYPE * idata2, std::size_t size) \
 			{																			\
 			\
-			unsigned int xIndex = blockIdx.x * BLOCK_DIM + threadIdx.x;				\
-			unsigned int yIndex = blockIdx.y * BLOCK_DIM + threadIdx.y;				\
-			if((xIndex < row) && (yIndex < col))							    	\
-			{																		\
-			odata[yIndex*row+xIndex] OP x[xIndex];								\
-			}																		\
+			GPUMATRIX_ELEMENTWISE_LOOP(index, size, \
+			odata[index] = mask[index] ? idata1[index] : idata2[index];								\
+			) \
 			\
 			}																			\
 			\
+	__global__ void _array_select (TYPE *odata, const bool * mask, const TYPE * idata1, TYPE beta, std::size_t size) \
+			{																			\
 			\
-			void colwise_array_compound_op( TYPE *odata, int row, int col, const TYPE * x , const Fcnl_colwise_##OPNAME<TYPE,TYPE> & func)	\
-			{																															\
-			dim3 dimGrid(BLOCK_DIM,BLOCK_DIM,1);																					\
-			dim3 dimBlock(int(ceil(float(row)/BLOCK_DIM)),int(ceil(float(col)/BLOCK_DIM)));											\
+			GPUMATRIX_ELEMENTWISE_LOOP(index, size, \
+			odata[index] = mask[index] ? idata1[index] : beta;								\
+			) \
 			\
-			_colwise_array_compound_op<<<dimBlock,dimGrid>>>(odata, row, col, x, & func);											\
-			}																															\
-
-
-			COLWISE_ARRAY_COMPOUND_OP(add_eq, +=, double)
-			COLWISE_ARRAY_COMPOUND_OP(add_eq, +=, float)
+			}																			\
+			\
+	__global__ void _array_select (TYPE *odata, const bool * mask, TYPE alpha, const TYPE * idata2, std::size_t size) \
+			{																			\
+			\
+			GPUMATRIX_ELEMENTWISE_LOOP(index, size, \
+			odata[index] = mask[index] ? alpha : idata2[index];								\
+			) \
+			\
+			}																			\
+			\
+			void array_select( TYPE *odata, const bool * mask, const TYPE * idata1, const TYPE * idata2, std::size_t size)  \
+			{																						\
+			GPUMATRIX_TRACE_SCOPE("impl::array_select",size,0,0,double(size)*(3*sizeof(TYPE) + sizeof(bool)),0);		\
+			unsigned int numGrid = elementwise_blocks(size);													\
+			_array_select<<<numGrid,ElementwiseThreads>>>(odata, mask, idata1, idata2, size);						\
+			}																						\
+			\
+			void array_select( TYPE *odata, const bool * mask, const TYPE * idata1, TYPE beta, std::size_t size)  \
+			{																						\
+			GPUMATRIX_TRACE_SCOPE("impl::array_select",size,0,0,double(size)*(2*sizeof(TYPE) + sizeof(bool)),0);		\
+			unsigned int numGrid = elementwise_blocks(size);													\
+			_array_select<<<numGrid,ElementwiseThreads>>>(odata, mask, idata1, beta, size);						\
+			}																						\
+			\
+			void array_select( TYPE *odata, const bool * mask, TYPE alpha, const TYPE * idata2, std::size_t size)  \
+			{																						\
+			GPUMATRIX_TRACE_SCOPE("impl::array_select",size,0,0,double(size)*(2*sizeof(TYPE) + sizeof(bool)),0);		\
+			unsigned int numGrid = elementwise_blocks(size);													\
+			_array_select<<<numGrid,ElementwiseThreads>>>(odata, mask, alpha, idata2, size);						\
+			}
+
+			ARRAY_SELECT(float)
+			ARRAY_SELECT(double)
+			ARRAY_SELECT(half)
+			ARRAY_SELECT(bfloat16)
 
 
 
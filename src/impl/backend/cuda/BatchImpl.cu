@@ -0,0 +1,265 @@
+#include <cuda.h>
+#include <cublas.h>
+#include <cuda_runtime.h>
+
+#include <gpumatrix/impl/backend/BatchInterface.h>
+#include <gpumatrix/Trace.h>
+
+#include "FixedFactor.cuh"
+
+namespace gpumatrix
+{
+	namespace impl
+	{
+		// One thread per instance throughout: a warp reads 32 consecutive
+		// instances of each entry, so every load and store is coalesced, and
+		// the instance itself is held in registers with the loops unrolled.
+		// The grid is elementwise_blocks(n) and strides over larger batches.
+
+		// instance b of C from a (R x K) and x (K x C) held in registers
+		template <typename T, int R, int K, int C>
+		__device__ void batch_mm_store(const T * a, const T * x, T * Cm, std::size_t ldc, std::size_t b)
+		{
+			#pragma unroll
+			for (int j = 0; j < C; j++)
+				#pragma unroll
+				for (int i = 0; i < R; i++)
+				{
+					T c = 0;
+					#pragma unroll
+					for (int k = 0; k < K; k++)
+						c += a[i + k*R]*x[k + j*K];
+					Cm[(i + j*R)*ldc + b] = c;
+				}
+		}
+
+		template <typename T, int R, int K, int C>
+		__global__ void _batch_mm(std::size_t n, const T * A, std::size_t lda, int inca, const T * B, std::size_t ldb, int incb, T * Cm, std::size_t ldc)
+		{
+			for (std::size_t b = blockIdx.x * (std::size_t)blockDim.x + threadIdx.x; b < n; b += (std::size_t)blockDim.x * gridDim.x)
+			{
+				T a[R*K], x[K*C];
+				#pragma unroll
+				for (int e = 0; e < R*K; e++)
+					a[e] = A[e*lda + b*inca];
+				#pragma unroll
+				for (int e = 0; e < K*C; e++)
+					x[e] = B[e*ldb + b*incb];
+
+				batch_mm_store<T,R,K,C>(a, x, Cm, ldc, b);
+			}
+		}
+
+		template <typename T, int R, int K, int C>
+		__global__ void _batch_mm_fixed_left(FixedFactor<T,R,K> F, std::size_t n, const T * B, std::size_t ldb, T * Cm, std::size_t ldc)
+		{
+			for (std::size_t b = blockIdx.x * (std::size_t)blockDim.x + threadIdx.x; b < n; b += (std::size_t)blockDim.x * gridDim.x)
+			{
+				T x[K*C];
+				#pragma unroll
+				for (int e = 0; e < K*C; e++)
+					x[e] = B[e*ldb + b];
+
+				batch_mm_store<T,R,K,C>(F.v, x, Cm, ldc, b);
+			}
+		}
+
+		template <typename T, int R, int K, int C>
+		__global__ void _batch_mm_fixed_right(std::size_t n, const T * A, std::size_t lda, FixedFactor<T,K,C> F, T * Cm, std::size_t ldc)
+		{
+			for (std::size_t b = blockIdx.x * (std::size_t)blockDim.x + threadIdx.x; b < n; b += (std::size_t)blockDim.x * gridDim.x)
+			{
+				T a[R*K];
+				#pragma unroll
+				for (int e = 0; e < R*K; e++)
+					a[e] = A[e*lda + b];
+
+				batch_mm_store<T,R,K,C>(a, F.v, Cm, ldc, b);
+			}
+		}
+
+		// r = adj(a) and the determinant, a and r column major D x D
+		template <typename T, int D> struct BatchAdjugate;
+
+		template <typename T> struct BatchAdjugate<T,1>
+		{
+			__device__ static T run(const T * a, T * r)
+			{
+				r[0] = 1;
+				return a[0];
+			}
+		};
+
+		template <typename T> struct BatchAdjugate<T,2>
+		{
+			__device__ static T run(const T * a, T * r)
+			{
+				r[0] = a[3]; r[2] = -a[2];
+				r[1] = -a[1]; r[3] = a[0];
+				return a[0]*a[3] - a[2]*a[1];
+			}
+		};
+
+		template <typename T> struct BatchAdjugate<T,3>
+		{
+			__device__ static T run(const T * a, T * r)
+			{
+				#define A3(i,j) a[(i) + (j)*3]
+				r[0] = A3(1,1)*A3(2,2) - A3(1,2)*A3(2,1);
+				r[3] = A3(0,2)*A3(2,1) - A3(0,1)*A3(2,2);
+				r[6] = A3(0,1)*A3(1,2) - A3(0,2)*A3(1,1);
+				r[1] = A3(1,2)*A3(2,0) - A3(1,0)*A3(2,2);
+				r[4] = A3(0,0)*A3(2,2) - A3(0,2)*A3(2,0);
+				r[7] = A3(0,2)*A3(1,0) - A3(0,0)*A3(1,2);
+				r[2] = A3(1,0)*A3(2,1) - A3(1,1)*A3(2,0);
+				r[5] = A3(0,1)*A3(2,0) - A3(0,0)*A3(2,1);
+				r[8] = A3(0,0)*A3(1,1) - A3(0,1)*A3(1,0);
+				T det = A3(0,0)*r[0] + A3(0,1)*r[1] + A3(0,2)*r[2];
+				#undef A3
+				return det;
+			}
+		};
+
+		// Laplace expansion along the first two rows: s are the 2x2 minors
+		// of rows 0,1 and c those of rows 2,3
+		template <typename T> struct BatchAdjugate<T,4>
+		{
+			__device__ static T run(const T * a, T * r)
+			{
+				#define A4(i,j) a[(i) + (j)*4]
+				#define R4(i,j) r[(i) + (j)*4]
+				T s0 = A4(0,0)*A4(1,1) - A4(1,0)*A4(0,1);
+				T s1 = A4(0,0)*A4(1,2) - A4(1,0)*A4(0,2);
+				T s2 = A4(0,0)*A4(1,3) - A4(1,0)*A4(0,3);
+				T s3 = A4(0,1)*A4(1,2) - A4(1,1)*A4(0,2);
+				T s4 = A4(0,1)*A4(1,3) - A4(1,1)*A4(0,3);
+				T s5 = A4(0,2)*A4(1,3) - A4(1,2)*A4(0,3);
+
+				T c5 = A4(2,2)*A4(3,3) - A4(3,2)*A4(2,3);
+				T c4 = A4(2,1)*A4(3,3) - A4(3,1)*A4(2,3);
+				T c3 = A4(2,1)*A4(3,2) - A4(3,1)*A4(2,2);
+				T c2 = A4(2,0)*A4(3,3) - A4(3,0)*A4(2,3);
+				T c1 = A4(2,0)*A4(3,2) - A4(3,0)*A4(2,2);
+				T c0 = A4(2,0)*A4(3,1) - A4(3,0)*A4(2,1);
+
+				R4(0,0) =  A4(1,1)*c5 - A4(1,2)*c4 + A4(1,3)*c3;
+				R4(0,1) = -A4(0,1)*c5 + A4(0,2)*c4 - A4(0,3)*c3;
+				R4(0,2) =  A4(3,1)*s5 - A4(3,2)*s4 + A4(3,3)*s3;
+				R4(0,3) = -A4(2,1)*s5 + A4(2,2)*s4 - A4(2,3)*s3;
+
+				R4(1,0) = -A4(1,0)*c5 + A4(1,2)*c2 - A4(1,3)*c1;
+				R4(1,1) =  A4(0,0)*c5 - A4(0,2)*c2 + A4(0,3)*c1;
+				R4(1,2) = -A4(3,0)*s5 + A4(3,2)*s2 - A4(3,3)*s1;
+				R4(1,3) =  A4(2,0)*s5 - A4(2,2)*s2 + A4(2,3)*s1;
+
+				R4(2,0) =  A4(1,0)*c4 - A4(1,1)*c2 + A4(1,3)*c0;
+				R4(2,1) = -A4(0,0)*c4 + A4(0,1)*c2 - A4(0,3)*c0;
+				R4(2,2) =  A4(3,0)*s4 - A4(3,1)*s2 + A4(3,3)*s0;
+				R4(2,3) = -A4(2,0)*s4 + A4(2,1)*s2 - A4(2,3)*s0;
+
+				R4(3,0) = -A4(1,0)*c3 + A4(1,1)*c1 - A4(1,2)*c0;
+				R4(3,1) =  A4(0,0)*c3 - A4(0,1)*c1 + A4(0,2)*c0;
+				R4(3,2) = -A4(3,0)*s3 + A4(3,1)*s1 - A4(3,2)*s0;
+				R4(3,3) =  A4(2,0)*s3 - A4(2,1)*s1 + A4(2,2)*s0;
+				#undef A4
+				#undef R4
+
+				return s0*c5 - s1*c4 + s2*c3 + s3*c2 - s4*c1 + s5*c0;
+			}
+		};
+
+		template <typename T, int D>
+		__global__ void _batch_inverse(std::size_t n, const T * A, std::size_t lda, T * Ainv, std::size_t ldi, T * det)
+		{
+			for (std::size_t b = blockIdx.x * (std::size_t)blockDim.x + threadIdx.x; b < n; b += (std::size_t)blockDim.x * gridDim.x)
+			{
+				T a[D*D], r[D*D];
+				#pragma unroll
+				for (int e = 0; e < D*D; e++)
+					a[e] = A[e*lda + b];
+
+				T d = BatchAdjugate<T,D>::run(a, r);
+
+				if (Ainv)
+				{
+					T s = T(1)/d;
+					#pragma unroll
+					for (int e = 0; e < D*D; e++)
+						Ainv[e*ldi + b] = r[e]*s;
+				}
+				if (det)
+					det[b] = d;
+			}
+		}
+
+		template <typename T, int R, int K, int C> void batch_mm(std::size_t n, const T *A, std::size_t lda, int inca,
+			const T *B, std::size_t ldb, int incb, T *Cm, std::size_t ldc)
+		{
+			GPUMATRIX_TRACE_SCOPE("impl::batch_mm",R,C,K,(double(R)*K + K*C + R*C)*n*sizeof(T),2.0*R*K*C*n);
+
+			if (n == 0)
+				return;
+
+			_batch_mm<T,R,K,C><<<elementwise_blocks(n),ElementwiseThreads>>>(n, A, lda, inca, B, ldb, incb, Cm, ldc);
+		}
+
+		template <typename T, int R, int K, int C> void batch_mm_fixed_left(std::size_t n, const T *F,
+			const T *B, std::size_t ldb, T *Cm, std::size_t ldc)
+		{
+			GPUMATRIX_TRACE_SCOPE("impl::batch_mm_fixed_left",R,C,K,(double(K)*C + R*C)*n*sizeof(T),2.0*R*K*C*n);
+
+			if (n == 0)
+				return;
+
+			_batch_mm_fixed_left<T,R,K,C><<<elementwise_blocks(n),ElementwiseThreads>>>(FixedFactor<T,R,K>::load(F), n, B, ldb, Cm, ldc);
+		}
+
+		template <typename T, int R, int K, int C> void batch_mm_fixed_right(std::size_t n, const T *A, std::size_t lda,
+			const T *F, T *Cm, std::size_t ldc)
+		{
+			GPUMATRIX_TRACE_SCOPE("impl::batch_mm_fixed_right",R,C,K,(double(R)*K + R*C)*n*sizeof(T),2.0*R*K*C*n);
+
+			if (n == 0)
+				return;
+
+			_batch_mm_fixed_right<T,R,K,C><<<elementwise_blocks(n),ElementwiseThreads>>>(n, A, lda, FixedFactor<T,K,C>::load(F), Cm, ldc);
+		}
+
+		template <typename T, int D> void batch_inverse(std::size_t n, const T *A, std::size_t lda, T *Ainv, std::size_t ldi, T *det)
+		{
+			GPUMATRIX_TRACE_SCOPE("impl::batch_inverse",D,D,n,(2.0*D*D + 1)*n*sizeof(T),3.0*D*D*D*n);
+
+			if (n == 0)
+				return;
+
+			_batch_inverse<T,D><<<elementwise_blocks(n),ElementwiseThreads>>>(n, A, lda, Ainv, ldi, det);
+		}
+
+		#define GPUMATRIX_BATCH_MM(T,R,K,C)																		\
+			template void batch_mm<T,R,K,C>(std::size_t n, const T *A, std::size_t lda, int inca,				\
+				const T *B, std::size_t ldb, int incb, T *Cm, std::size_t ldc);									\
+			template void batch_mm_fixed_left<T,R,K,C>(std::size_t n, const T *F,								\
+				const T *B, std::size_t ldb, T *Cm, std::size_t ldc);												\
+			template void batch_mm_fixed_right<T,R,K,C>(std::size_t n, const T *A, std::size_t lda,				\
+				const T *F, T *Cm, std::size_t ldc);
+
+		#define GPUMATRIX_BATCH_MM_COLS(T,R,K)															\
+			GPUMATRIX_BATCH_MM(T,R,K,1) GPUMATRIX_BATCH_MM(T,R,K,2) GPUMATRIX_BATCH_MM(T,R,K,3) GPUMATRIX_BATCH_MM(T,R,K,4)
+
+		#define GPUMATRIX_BATCH_MM_INNER(T,R)															\
+			GPUMATRIX_BATCH_MM_COLS(T,R,1) GPUMATRIX_BATCH_MM_COLS(T,R,2) GPUMATRIX_BATCH_MM_COLS(T,R,3) GPUMATRIX_BATCH_MM_COLS(T,R,4)
+
+		// every R x K times K x C up to FixedDeviceMaxSize
+		GPUMATRIX_BATCH_MM_INNER(float,1) GPUMATRIX_BATCH_MM_INNER(float,2) GPUMATRIX_BATCH_MM_INNER(float,3) GPUMATRIX_BATCH_MM_INNER(float,4)
+		GPUMATRIX_BATCH_MM_INNER(double,1) GPUMATRIX_BATCH_MM_INNER(double,2) GPUMATRIX_BATCH_MM_INNER(double,3) GPUMATRIX_BATCH_MM_INNER(double,4)
+
+		template void batch_inverse<float,1>(std::size_t n, const float *A, std::size_t lda, float *Ainv, std::size_t ldi, float *det);
+		template void batch_inverse<float,2>(std::size_t n, const float *A, std::size_t lda, float *Ainv, std::size_t ldi, float *det);
+		template void batch_inverse<float,3>(std::size_t n, const float *A, std::size_t lda, float *Ainv, std::size_t ldi, float *det);
+		template void batch_inverse<float,4>(std::size_t n, const float *A, std::size_t lda, float *Ainv, std::size_t ldi, float *det);
+		template void batch_inverse<double,1>(std::size_t n, const double *A, std::size_t lda, double *Ainv, std::size_t ldi, double *det);
+		template void batch_inverse<double,2>(std::size_t n, const double *A, std::size_t lda, double *Ainv, std::size_t ldi, double *det);
+		template void batch_inverse<double,3>(std::size_t n, const double *A, std::size_t lda, double *Ainv, std::size_t ldi, double *det);
+		template void batch_inverse<double,4>(std::size_t n, const double *A, std::size_t lda, double *Ainv, std::size_t ldi, double *det);
+	}
+}
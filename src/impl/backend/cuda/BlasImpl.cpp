@@ -1,9 +1,12 @@
 #include <gpumatrix/impl/backend/BlasInterface.h>
+#include <gpumatrix/Trace.h>
 
 #include <cuda.h>
-#include <cublas.h>
+#include <cublas_v2.h>
 #include <cuda_runtime.h>
 
+#include "ContextImpl.h"
+
 #include <cstdio>
 using namespace std;
 
@@ -12,12 +15,43 @@ namespace gpumatrix
   
 	namespace impl
 	{
+			// Every call goes through the calling thread's handle, bound to its
+			// stream, so independent threads never share cuBLAS state.
+
+			static cublasOperation_t blas_op(char trans)
+			{
+				return trans == 'T' || trans == 't' ? CUBLAS_OP_T : trans == 'C' || trans == 'c' ? CUBLAS_OP_C : CUBLAS_OP_N;
+			}
+
+			static cublasFillMode_t blas_fill(char uplo)
+			{
+				return uplo == 'U' || uplo == 'u' ? CUBLAS_FILL_MODE_UPPER : CUBLAS_FILL_MODE_LOWER;
+			}
+
+			static cublasSideMode_t blas_side(char side)
+			{
+				return side == 'R' || side == 'r' ? CUBLAS_SIDE_RIGHT : CUBLAS_SIDE_LEFT;
+			}
+
+			static cublasDiagType_t blas_diag(char diag)
+			{
+				return diag == 'U' || diag == 'u' ? CUBLAS_DIAG_UNIT : CUBLAS_DIAG_NON_UNIT;
+			}
+
+			static void blas_check(cublasStatus_t err)
+			{
+				if( CUBLAS_STATUS_SUCCESS != err) { 
+					fprintf(stderr, "Cublas error in file '%s' in line %i \n", __FILE__, __LINE__);
+					throw "Cublas error occured "; 
+				}
+			}
+
 
 			template<> void gemm<double>(char transa, char transb, int m, int n, int k, 
 				double alpha, const double *A, int lda, const double *B, int ldb, double beta, double *C, int ldc)
 			{
-				cublasDgemm(transa, transb, m, n, k,alpha, A, lda, B, ldb, beta,  C, ldc);
-				cublasStatus err  = cublasGetError();
+				GPUMATRIX_TRACE_SCOPE("impl::gemm<double>",m,n,k,(double(m)*k + double(k)*n + 2.0*m*n)*sizeof(double),2.0*m*n*k);
+				cublasStatus_t err = cublasDgemm(blas_handle(), blas_op(transa), blas_op(transb), m, n, k, &alpha, A, lda, B, ldb, &beta, C, ldc);
 
 				if( CUBLAS_STATUS_SUCCESS != err) { 
 					fprintf(stderr, "Cublas error in file '%s' in line %i \n", __FILE__, __LINE__);
@@ -28,8 +62,32 @@ namespace gpumatrix
 			template<> void gemm<float>(char transa, char transb, int m, int n, int k, 
 				float alpha, const float *A, int lda, const float *B, int ldb, float beta, float *C, int ldc)
 			{
-				cublasSgemm(transa, transb, m, n, k,alpha, A, lda, B, ldb, beta,  C, ldc);
-							cublasStatus err  = cublasGetError();
+				GPUMATRIX_TRACE_SCOPE("impl::gemm<float>",m,n,k,(double(m)*k + double(k)*n + 2.0*m*n)*sizeof(float),2.0*m*n*k);
+				cublasStatus_t err = cublasSgemm(blas_handle(), blas_op(transa), blas_op(transb), m, n, k, &alpha, A, lda, B, ldb, &beta, C, ldc);
+
+				if( CUBLAS_STATUS_SUCCESS != err) { 
+					fprintf(stderr, "Cublas error in file '%s' in line %i \n", __FILE__, __LINE__);
+					throw "Cublas error occured "; 
+				}
+			}
+
+			template<> void syrk<double>(char uplo, char trans, int n, int k, 
+				double alpha, const double *A, int lda, double beta, double *C, int ldc)
+			{
+				GPUMATRIX_TRACE_SCOPE("impl::syrk<double>",n,n,k,(double(n)*k + double(n)*(n+1))*sizeof(double),double(n)*(n+1)*k);
+				cublasStatus_t err = cublasDsyrk(blas_handle(), blas_fill(uplo), blas_op(trans), n, k, &alpha, A, lda, &beta, C, ldc);
+
+				if( CUBLAS_STATUS_SUCCESS != err) { 
+					fprintf(stderr, "Cublas error in file '%s' in line %i \n", __FILE__, __LINE__);
+					throw "Cublas error occured "; 
+				}
+			}
+
+			template<> void syrk<float>(char uplo, char trans, int n, int k, 
+				float alpha, const float *A, int lda, float beta, float *C, int ldc)
+			{
+				GPUMATRIX_TRACE_SCOPE("impl::syrk<float>",n,n,k,(double(n)*k + double(n)*(n+1))*sizeof(float),double(n)*(n+1)*k);
+				cublasStatus_t err = cublasSsyrk(blas_handle(), blas_fill(uplo), blas_op(trans), n, k, &alpha, A, lda, &beta, C, ldc);
 
 				if( CUBLAS_STATUS_SUCCESS != err) { 
 					fprintf(stderr, "Cublas error in file '%s' in line %i \n", __FILE__, __LINE__);
@@ -40,8 +98,8 @@ namespace gpumatrix
 
 			template<> void axpy<double>(int n, double alpha, const double *x, int incx, double *y, int incy)
 			{
-				cublasDaxpy (n, alpha, x, incx, y, incy);
-						cublasStatus err  = cublasGetError();
+				GPUMATRIX_TRACE_SCOPE("impl::axpy<double>",n,0,0,3.0*n*sizeof(double),2.0*n);
+				cublasStatus_t err = cublasDaxpy(blas_handle(), n, &alpha, x, incx, y, incy);
 
 				if( CUBLAS_STATUS_SUCCESS != err) { 
 					fprintf(stderr, "Cublas error in file '%s' in line %i \n", __FILE__, __LINE__);
@@ -51,8 +109,8 @@ namespace gpumatrix
 
 			template<> void axpy<float>(int n, float alpha, const float *x, int incx, float *y, int incy)
 			{
-				cublasSaxpy (n, alpha, x, incx, y, incy);
-						cublasStatus err  = cublasGetError();
+				GPUMATRIX_TRACE_SCOPE("impl::axpy<float>",n,0,0,3.0*n*sizeof(float),2.0*n);
+				cublasStatus_t err = cublasSaxpy(blas_handle(), n, &alpha, x, incx, y, incy);
 
 				if( CUBLAS_STATUS_SUCCESS != err) { 
 					fprintf(stderr, "Cublas error in file '%s' in line %i \n", __FILE__, __LINE__);
@@ -62,8 +120,8 @@ namespace gpumatrix
 
 			template<>  void scal<double > (int n, double alpha, double *x, int incx)
 			{
-				cublasDscal (n, alpha, x, incx);
-						cublasStatus err  = cublasGetError();
+				GPUMATRIX_TRACE_SCOPE("impl::scal<double>",n,0,0,2.0*n*sizeof(double),n);
+				cublasStatus_t err = cublasDscal(blas_handle(), n, &alpha, x, incx);
 
 				if( CUBLAS_STATUS_SUCCESS != err) { 
 					fprintf(stderr, "Cublas error in file '%s' in line %i \n", __FILE__, __LINE__);
@@ -73,8 +131,8 @@ namespace gpumatrix
 
 			template<>  void scal<float> (int n, float alpha, float *x, int incx)
 			{
-				cublasSscal (n, alpha, x, incx);
-							cublasStatus err  = cublasGetError();
+				GPUMATRIX_TRACE_SCOPE("impl::scal<float>",n,0,0,2.0*n*sizeof(float),n);
+				cublasStatus_t err = cublasSscal(blas_handle(), n, &alpha, x, incx);
 
 				if( CUBLAS_STATUS_SUCCESS != err) { 
 					fprintf(stderr, "Cublas error in file '%s' in line %i \n", __FILE__, __LINE__);
@@ -85,8 +143,8 @@ namespace gpumatrix
 			template <> void gemv<float> (char trans, int m, int n, float alpha, const float *A, int lda, 
 				const float *x,int incx, float beta, float *y, int incy)
 			{
-				cublasSgemv ( trans, m, n, alpha,A,lda, x, incx, beta, y, incy);
-							cublasStatus err  = cublasGetError();
+				GPUMATRIX_TRACE_SCOPE("impl::gemv<float>",m,n,0,(double(m)*n + m + n)*sizeof(float),2.0*m*n);
+				cublasStatus_t err = cublasSgemv(blas_handle(), blas_op(trans), m, n, &alpha, A, lda, x, incx, &beta, y, incy);
 
 				if( CUBLAS_STATUS_SUCCESS != err) { 
 					fprintf(stderr, "Cublas error in file '%s' in line %i \n", __FILE__, __LINE__);
@@ -98,8 +156,80 @@ namespace gpumatrix
 			template <> void gemv<double > (char trans, int m, int n, double alpha, const double *A, int lda, 
 				const double *x,int incx, double beta, double *y, int incy)
 			{
-				cublasDgemv ( trans, m, n, alpha,A,lda, x, incx, beta, y, incy);
-							cublasStatus err  = cublasGetError();
+				GPUMATRIX_TRACE_SCOPE("impl::gemv<double>",m,n,0,(double(m)*n + m + n)*sizeof(double),2.0*m*n);
+				cublasStatus_t err = cublasDgemv(blas_handle(), blas_op(trans), m, n, &alpha, A, lda, x, incx, &beta, y, incy);
+
+				if( CUBLAS_STATUS_SUCCESS != err) { 
+					fprintf(stderr, "Cublas error in file '%s' in line %i \n", __FILE__, __LINE__);
+					throw "Cublas error occured "; 
+				}
+			}
+
+			template <> void ger<float> (int m, int n, float alpha, const float *x, int incx, const float *y, int incy, 
+				float *A, int lda)
+			{
+				GPUMATRIX_TRACE_SCOPE("impl::ger<float>",m,n,0,(2.0*m*n + m + n)*sizeof(float),2.0*m*n);
+				cublasStatus_t err = cublasSger(blas_handle(), m, n, &alpha, x, incx, y, incy, A, lda);
+
+				if( CUBLAS_STATUS_SUCCESS != err) { 
+					fprintf(stderr, "Cublas error in file '%s' in line %i \n", __FILE__, __LINE__);
+					throw "Cublas error occured "; 
+				}
+			}
+
+			template <> void ger<double> (int m, int n, double alpha, const double *x, int incx, const double *y, int incy, 
+				double *A, int lda)
+			{
+				GPUMATRIX_TRACE_SCOPE("impl::ger<double>",m,n,0,(2.0*m*n + m + n)*sizeof(double),2.0*m*n);
+				cublasStatus_t err = cublasDger(blas_handle(), m, n, &alpha, x, incx, y, incy, A, lda);
+
+				if( CUBLAS_STATUS_SUCCESS != err) { 
+					fprintf(stderr, "Cublas error in file '%s' in line %i \n", __FILE__, __LINE__);
+					throw "Cublas error occured "; 
+				}
+			}
+
+			template <> void trsm<float> (char side, char uplo, char transa, char diag, int m, int n, 
+				float alpha, const float *A, int lda, float *B, int ldb)
+			{
+				GPUMATRIX_TRACE_SCOPE("impl::trsm<float>",m,n,0,((side == 'L' ? double(m)*m : double(n)*n)/2 + 2.0*m*n)*sizeof(float),(side == 'L' ? double(m) : double(n))*m*n);
+				cublasStatus_t err = cublasStrsm(blas_handle(), blas_side(side), blas_fill(uplo), blas_op(transa), blas_diag(diag), m, n, &alpha, A, lda, B, ldb);
+
+				if( CUBLAS_STATUS_SUCCESS != err) { 
+					fprintf(stderr, "Cublas error in file '%s' in line %i \n", __FILE__, __LINE__);
+					throw "Cublas error occured "; 
+				}
+			}
+
+			template <> void trsv<float> (char uplo, char trans, char diag, int n, const float *A, int lda, 
+				float *x, int incx)
+			{
+				GPUMATRIX_TRACE_SCOPE("impl::trsv<float>",n,0,0,(double(n)*n/2 + 2.0*n)*sizeof(float),double(n)*n);
+				cublasStatus_t err = cublasStrsv(blas_handle(), blas_fill(uplo), blas_op(trans), blas_diag(diag), n, A, lda, x, incx);
+
+				if( CUBLAS_STATUS_SUCCESS != err) { 
+					fprintf(stderr, "Cublas error in file '%s' in line %i \n", __FILE__, __LINE__);
+					throw "Cublas error occured "; 
+				}
+			}
+
+			template <> void trsm<double> (char side, char uplo, char transa, char diag, int m, int n, 
+				double alpha, const double *A, int lda, double *B, int ldb)
+			{
+				GPUMATRIX_TRACE_SCOPE("impl::trsm<double>",m,n,0,((side == 'L' ? double(m)*m : double(n)*n)/2 + 2.0*m*n)*sizeof(double),(side == 'L' ? double(m) : double(n))*m*n);
+				cublasStatus_t err = cublasDtrsm(blas_handle(), blas_side(side), blas_fill(uplo), blas_op(transa), blas_diag(diag), m, n, &alpha, A, lda, B, ldb);
+
+				if( CUBLAS_STATUS_SUCCESS != err) { 
+					fprintf(stderr, "Cublas error in file '%s' in line %i \n", __FILE__, __LINE__);
+					throw "Cublas error occured "; 
+				}
+			}
+
+			template <> void trsv<double> (char uplo, char trans, char diag, int n, const double *A, int lda, 
+				double *x, int incx)
+			{
+				GPUMATRIX_TRACE_SCOPE("impl::trsv<double>",n,0,0,(double(n)*n/2 + 2.0*n)*sizeof(double),double(n)*n);
+				cublasStatus_t err = cublasDtrsv(blas_handle(), blas_fill(uplo), blas_op(trans), blas_diag(diag), n, A, lda, x, incx);
 
 				if( CUBLAS_STATUS_SUCCESS != err) { 
 					fprintf(stderr, "Cublas error in file '%s' in line %i \n", __FILE__, __LINE__);
@@ -109,23 +239,35 @@ namespace gpumatrix
 
 			template <> double nrm2 <double> (int n, const double *x, int incx)
 			{
-				return cublasDnrm2(n, x, incx);
+				GPUMATRIX_TRACE_SCOPE("impl::nrm2<double>",n,0,0,double(n)*sizeof(double),2.0*n);
+				double result = 0;
+				blas_check(cublasDnrm2(blas_handle(), n, x, incx, &result));
+				return result;
 			}
 
 			template <> float nrm2 <float> (int n, const float *x, int incx)
 			{
-				return cublasSnrm2(n, x, incx);
+				GPUMATRIX_TRACE_SCOPE("impl::nrm2<float>",n,0,0,double(n)*sizeof(float),2.0*n);
+				float result = 0;
+				blas_check(cublasSnrm2(blas_handle(), n, x, incx, &result));
+				return result;
 			}
 
 
 			template <> double dot <double> (int n, const double *x, int incx, const double * y, int incy)
 			{
-				return cublasDdot(n, x, incx, y, incy);
+				GPUMATRIX_TRACE_SCOPE("impl::dot<double>",n,0,0,2.0*n*sizeof(double),2.0*n);
+				double result = 0;
+				blas_check(cublasDdot(blas_handle(), n, x, incx, y, incy, &result));
+				return result;
 			}
 
 			template <> float dot <float> (int n, const float *x, int incx, const float * y, int incy)
 			{
-				return cublasSdot(n, x, incx, y, incy);
+				GPUMATRIX_TRACE_SCOPE("impl::dot<float>",n,0,0,2.0*n*sizeof(float),2.0*n);
+				float result = 0;
+				blas_check(cublasSdot(blas_handle(), n, x, incx, y, incy, &result));
+				return result;
 			}
 
 			//template <> double cublas_asum <double> (int n, const double *x, int incx)
@@ -139,4 +281,4 @@ namespace gpumatrix
 			//}
 		
 	}
-}
\ No newline at end of file
+}
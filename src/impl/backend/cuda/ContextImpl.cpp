@@ -0,0 +1,309 @@
+#include <gpumatrix/Context.h>
+#include <gpumatrix/impl/backend/ContextInterface.h>
+#include <gpumatrix/impl/backend/MemoryInterface.h>
+#include <gpumatrix/Trace.h>
+
+#include <cuda.h>
+#include <cuda_runtime.h>
+
+#include "ContextImpl.h"
+
+#include <atomic>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace gpumatrix
+{
+	namespace impl
+	{
+		// Blocks are rounded to 512 bytes and kept by size once freed; a
+		// request takes the smallest cached block that fits, unless that is
+		// more than twice what was asked for.
+		static const std::size_t ContextBlockAlign = 512;
+
+		class ExecutionContext;
+
+		// The context owning each block, from its cudaMalloc to its cudaFree:
+		// it is only touched on those two and on a free by another thread,
+		// so a cache hit takes no lock.
+		struct BlockOwners
+		{
+			std::mutex										lock;
+			std::unordered_map<void *,ExecutionContext *>	owner;
+		};
+
+		static BlockOwners & block_owners()
+		{
+			static BlockOwners owners;
+			return owners;
+		}
+
+		class ExecutionContext
+		{
+			ExecutionContext(const ExecutionContext&);
+			ExecutionContext& operator=(const ExecutionContext&);
+
+		public:
+			ExecutionContext() : m_handle(0), m_live_bytes(0), m_cached_bytes(0), m_workspace(0), m_workspace_bytes(0), m_returned(0) { }
+
+			// Runs at thread exit, possibly after the runtime has gone at
+			// process exit, so errors are ignored. Blocks still live are
+			// disowned: whoever frees them later returns them to the device.
+			~ExecutionContext()
+			{
+				{
+					BlockOwners & owners = block_owners();
+					std::lock_guard<std::mutex> guard(owners.lock);
+					for (std::unordered_map<void *,std::size_t>::iterator it = m_live.begin(); it != m_live.end(); ++it)
+						owners.owner.erase(it->first);
+				}
+				drain();
+				release();
+				if (m_handle)
+					cublasDestroy(m_handle);
+			}
+
+			cublasHandle_t handle()
+			{
+				if (m_handle == 0)
+				{
+					if (cublasCreate(&m_handle) != CUBLAS_STATUS_SUCCESS)
+						throw std::runtime_error("Cublas Handle Creation Failed");
+					cublasSetStream(m_handle, cudaStreamPerThread);
+				}
+				return m_handle;
+			}
+
+			void * alloc(std::size_t bytes)
+			{
+				if (bytes == 0)
+					return 0;
+
+				bytes = (bytes + ContextBlockAlign - 1)/ContextBlockAlign*ContextBlockAlign;
+				drain();
+
+				void * data;
+				std::size_t size;
+
+				std::multimap<std::size_t,void *>::iterator it = m_free.lower_bound(bytes);
+				if (it != m_free.end() && it->first <= 2*bytes)
+				{
+					size = it->first;
+					data = it->second;
+					m_free.erase(it);
+					m_cached_bytes -= size;
+				}
+				else
+				{
+					size = bytes;
+					data = device_alloc(size);
+
+					BlockOwners & owners = block_owners();
+					std::lock_guard<std::mutex> guard(owners.lock);
+					owners.owner[data] = this;
+				}
+
+				m_live[data] = size;
+				m_live_bytes += size;
+				return data;
+			}
+
+			bool free(void * data)
+			{
+				std::unordered_map<void *,std::size_t>::iterator it = m_live.find(data);
+				if (it == m_live.end())
+					return false;
+
+				m_free.insert(std::make_pair(it->second,data));
+				m_cached_bytes += it->second;
+				m_live_bytes -= it->second;
+				m_live.erase(it);
+				return true;
+			}
+
+			// A block of this context freed by another thread, called with
+			// the owners' lock held so the context can't go meanwhile. It is
+			// pushed on a lock free list that the owner drains.
+			void give_back(void * data)
+			{
+				ReturnedBlock * r = new ReturnedBlock;
+				r->data = data;
+				r->next = m_returned.load(std::memory_order_relaxed);
+				while (!m_returned.compare_exchange_weak(r->next, r, std::memory_order_release, std::memory_order_relaxed))
+					;
+			}
+
+			void * workspace(std::size_t bytes)
+			{
+				if (bytes > m_workspace_bytes)
+				{
+					cudaFree(m_workspace);
+					m_workspace = 0;
+					m_workspace_bytes = 0;
+
+					m_workspace = device_alloc(bytes);
+					m_workspace_bytes = bytes;
+				}
+				return m_workspace;
+			}
+
+			void release()
+			{
+				drain();
+				release_blocks();
+
+				cudaFree(m_workspace);
+				m_workspace = 0;
+				m_workspace_bytes = 0;
+			}
+
+			std::size_t live_blocks() { drain(); return m_live.size(); }
+			std::size_t live_bytes() { drain(); return m_live_bytes; }
+			std::size_t cached_bytes() { drain(); return m_cached_bytes + m_workspace_bytes; }
+
+		private:
+			struct ReturnedBlock
+			{
+				void *			data;
+				ReturnedBlock *	next;
+			};
+
+			// take back the blocks other threads have freed
+			void drain()
+			{
+				ReturnedBlock * r = m_returned.exchange(0, std::memory_order_acquire);
+				while (r)
+				{
+					ReturnedBlock * next = r->next;
+					free(r->data);
+					delete r;
+					r = next;
+				}
+			}
+
+			void release_blocks()
+			{
+				if (m_free.empty())
+					return;
+
+				{
+					BlockOwners & owners = block_owners();
+					std::lock_guard<std::mutex> guard(owners.lock);
+					for (std::multimap<std::size_t,void *>::iterator it = m_free.begin(); it != m_free.end(); ++it)
+						owners.owner.erase(it->second);
+				}
+				for (std::multimap<std::size_t,void *>::iterator it = m_free.begin(); it != m_free.end(); ++it)
+					cudaFree(it->second);
+				m_free.clear();
+				m_cached_bytes = 0;
+			}
+
+			// A failed cudaMalloc is retried once with the cached blocks
+			// released; the workspace may be in use and is kept.
+			void * device_alloc(std::size_t bytes)
+			{
+				void * data = 0;
+				if (cudaMalloc(&data, bytes) != cudaSuccess)
+				{
+					cudaGetLastError();
+					release_blocks();
+					if (cudaMalloc(&data, bytes) != cudaSuccess)
+					{
+						cudaGetLastError();
+						throw std::runtime_error("GPU Memory Allocation Failed");
+					}
+				}
+				return data;
+			}
+
+			cublasHandle_t								m_handle;
+			std::unordered_map<void *,std::size_t>		m_live;
+			std::multimap<std::size_t,void *>			m_free;
+			std::size_t									m_live_bytes;
+			std::size_t									m_cached_bytes;
+			void *										m_workspace;
+			std::size_t									m_workspace_bytes;
+			std::atomic<ReturnedBlock *>				m_returned;
+		};
+
+		static ExecutionContext & context()
+		{
+			static thread_local ExecutionContext c;
+			return c;
+		}
+
+		cublasHandle_t blas_handle()
+		{
+			return context().handle();
+		}
+
+		void * context_alloc(std::size_t bytes)
+		{
+			return context().alloc(bytes);
+		}
+
+		// A block from another thread's context goes back to it once this
+		// thread's queue is done with it; one whose thread has exited goes
+		// back to the device.
+		void context_free(void * data)
+		{
+			if (context().free(data))
+				return;
+
+			cudaError_t cudaError = cudaStreamSynchronize(cudaStreamPerThread);
+			if (cudaError != cudaSuccess)
+				throw std::runtime_error(cudaGetErrorString(cudaError));
+
+			{
+				BlockOwners & owners = block_owners();
+				std::lock_guard<std::mutex> guard(owners.lock);
+				std::unordered_map<void *,ExecutionContext *>::iterator it = owners.owner.find(data);
+				if (it != owners.owner.end())
+				{
+					it->second->give_back(data);
+					return;
+				}
+			}
+
+			cudaError = cudaFree(data);
+			if (cudaError != cudaSuccess)
+				throw std::runtime_error("GPU Memory Free Failed");
+		}
+
+		void * workspace(std::size_t bytes)
+		{
+			return context().workspace(bytes);
+		}
+
+		int memory_check()
+		{
+			return int(context().live_blocks());
+		}
+	}
+
+	void synchronize()
+	{
+		GPUMATRIX_TRACE_SCOPE("synchronize",0,0,0,0,0);
+
+		cudaError_t cudaError = cudaStreamSynchronize(cudaStreamPerThread);
+		if (cudaError != cudaSuccess)
+			throw std::runtime_error(cudaGetErrorString(cudaError));
+	}
+
+	std::size_t allocated_bytes()
+	{
+		return impl::context().live_bytes();
+	}
+
+	std::size_t cached_bytes()
+	{
+		return impl::context().cached_bytes();
+	}
+
+	void release_cached_memory()
+	{
+		impl::context().release();
+	}
+}
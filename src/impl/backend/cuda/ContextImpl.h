@@ -0,0 +1,15 @@
+#ifndef CONTEXT_IMPL_H
+#define CONTEXT_IMPL_H
+
+#include <cublas_v2.h>
+
+namespace gpumatrix
+{
+	namespace impl
+	{
+		/* the calling thread's cuBLAS handle, its stream set to cudaStreamPerThread */
+		cublasHandle_t blas_handle();
+	}
+}
+
+#endif
@@ -0,0 +1,468 @@
+#include <cuda.h>
+#include <cublas.h>
+#include <cuda_runtime.h>
+
+#include <gpumatrix/impl/backend/DecompositionInterface.h>
+#include <gpumatrix/impl/backend/BlasInterface.h>
+#include <gpumatrix/impl/backend/cuda/MemoryImpl.h>
+#include <gpumatrix/Trace.h>
+
+#include <cmath>
+#include <vector>
+
+namespace gpumatrix
+{
+	namespace impl
+	{
+		// Diagonal blocks are factored by one thread block in shared memory;
+		// trailing updates are taken a column block at a time by gemm.
+		static const int CholeskyBlock = 64;
+		static const int CholeskyUpdateBlock = 256;
+
+		// Unblocked lower Cholesky of the n x n (n <= CholeskyBlock) block at A.
+		// The first failing pivot, offset + k + 1, goes to *info if still 0.
+		template <typename T>
+		__global__ void _potf2(int n, T * A, int lda, int offset, int * info)
+		{
+			__shared__ T a[CholeskyBlock][CholeskyBlock + 1];
+
+			for (int idx = threadIdx.x; idx < n*n; idx += blockDim.x)
+			{
+				int i = idx % n, j = idx / n;
+				a[i][j] = i >= j ? A[i + j*lda] : T(0);
+			}
+			__syncthreads();
+
+			for (int k = 0; k < n; ++k)
+			{
+				if (threadIdx.x == 0)
+				{
+					T d = a[k][k];
+					if (!(d > 0))
+						atomicCAS(info, 0, offset + k + 1);
+					a[k][k] = sqrt(d);
+				}
+				__syncthreads();
+
+				for (int i = k + 1 + threadIdx.x; i < n; i += blockDim.x)
+					a[i][k] /= a[k][k];
+				__syncthreads();
+
+				int r = n - k - 1;
+				for (int idx = threadIdx.x; idx < r*r; idx += blockDim.x)
+				{
+					int i = k + 1 + idx % r, j = k + 1 + idx / r;
+					if (j <= i)
+						a[i][j] -= a[i][k]*a[j][k];
+				}
+				__syncthreads();
+			}
+
+			for (int idx = threadIdx.x; idx < n*n; idx += blockDim.x)
+			{
+				int i = idx % n, j = idx / n;
+				A[i + j*lda] = i >= j ? a[i][j] : T(0);
+			}
+		}
+
+		template <typename T>
+		__global__ void _zero_upper(int n, T * A, int lda)
+		{
+			int i = blockIdx.x * blockDim.x + threadIdx.x;
+			for (int j = blockIdx.y; j < n; j += gridDim.y)
+				if (i < j)
+					A[i + (size_t)j*lda] = T(0);
+		}
+
+		// Right looking: factor the diagonal block, solve the panel below
+		// it, then take the panel's product off the lower trailing matrix.
+		template <typename T>
+		int potrf(int n, T * A, int lda)
+		{
+			GPUMATRIX_TRACE_SCOPE("impl::potrf",n,n,0,double(n)*n*sizeof(T),double(n)*n*n/3);
+
+			if (n == 0)
+				return 0;
+
+			int * d_info = (int *) workspace(sizeof(int));
+			zero(d_info,1);
+
+			for (int j = 0; j < n; j += CholeskyBlock)
+			{
+				int jb = n - j < CholeskyBlock ? n - j : CholeskyBlock;
+				T * Ajj = A + j + (size_t)j*lda;
+
+				_potf2<T><<<1,256>>>(jb, Ajj, lda, j, d_info);
+
+				int m2 = n - j - jb;
+				if (m2 == 0)
+					break;
+
+				T * A21 = Ajj + jb;
+				trsm<T>('R', 'L', 'T', 'N', m2, jb, T(1), Ajj, lda, A21, lda);
+
+				for (int i = 0; i < m2; i += CholeskyUpdateBlock)
+				{
+					int ib = m2 - i < CholeskyUpdateBlock ? m2 - i : CholeskyUpdateBlock;
+					gemm<T>('N', 'T', m2 - i, ib, jb, T(-1), A21 + i, lda, A21 + i, lda,
+						T(1), A21 + i + (size_t)(jb + i)*lda, lda);
+				}
+			}
+
+			int info = 0;
+			get(&info,d_info,1);
+
+			dim3 grid((n + 256 -1)/256, n < 65535 ? n : 65535);
+			_zero_upper<T><<<grid,256>>>(n, A, lda);
+
+			return info;
+		}
+
+		template int potrf<float>(int n, float * A, int lda);
+		template int potrf<double>(int n, double * A, int lda);
+
+		// Householder panels are QRBlock columns wide. Their reflectors are
+		// gathered into I - V*T*V^T (compact WY) so that the updates of the
+		// columns to the right, and of right hand sides, are three gemm.
+		static const int QRBlock = 32;
+
+		// The unit lower trapezoidal V of a panel: zero above the diagonal, one on it
+		template <typename T>
+		__global__ void _unit_lower(int cols, T * A, int lda)
+		{
+			int i = blockIdx.x * blockDim.x + threadIdx.x;
+			for (int j = blockIdx.y; j < cols; j += gridDim.y)
+				if (i <= j)
+					A[i + (size_t)j*lda] = i == j ? T(1) : T(0);
+		}
+
+		template <typename T>
+		__global__ void _zero_lower(int rows, int cols, T * A, int lda)
+		{
+			int i = blockIdx.x * blockDim.x + threadIdx.x;
+			for (int j = blockIdx.y; j < cols; j += gridDim.y)
+				if (i > j && i < rows)
+					A[i + (size_t)j*lda] = T(0);
+		}
+
+		static dim3 triangle_grid(int rows, int cols)
+		{
+			return dim3((rows + 256 -1)/256, cols < 65535 ? cols : 65535);
+		}
+
+		// Reflector H = I - tau*v*v^T with H*x = (beta, 0, ..., 0), as LAPACK
+		// larfg: x[0] becomes beta, x[1..len-1] the tail of v (v[0] = 1).
+		template <typename T>
+		T householder(int len, T * x)
+		{
+			T alpha;
+			get(&alpha,x,1);
+
+			T xnorm = len > 1 ? nrm2<T>(len - 1, x + 1, 1) : T(0);
+			if (xnorm == T(0))
+				return T(0);
+
+			T beta = alpha >= T(0) ? -std::hypot(alpha,xnorm) : std::hypot(alpha,xnorm);
+			scal<T>(len - 1, T(1)/(alpha - beta), x + 1, 1);
+			set(x,&beta,1);
+
+			return (beta - alpha)/beta;
+		}
+
+		// Unblocked QR of the len x jb panel at A, the scalars to the host array tau
+		template <typename T>
+		void geqr2(int len, int jb, T * A, int lda, T * tau, T * work)
+		{
+			for (int k = 0; k < jb; ++k)
+			{
+				T * akk = A + k + (size_t)k*lda;
+				tau[k] = householder(len - k, akk);
+
+				if (k + 1 < jb && tau[k] != T(0))
+				{
+					T beta, one = T(1);
+					get(&beta,akk,1);
+					set(akk,&one,1);
+					gemv<T>('T', len - k, jb - k - 1, T(1), akk + lda, lda, akk, 1, T(0), work, 1);
+					ger<T>(len - k, jb - k - 1, -tau[k], akk, 1, work, 1, akk + lda, lda);
+					set(akk,&beta,1);
+				}
+			}
+		}
+
+		// V (len x jb) and the upper triangular T (jb x jb) of the jb reflectors
+		// at A, as LAPACK larft, T built on the host from S = V^T*V.
+		template <typename T>
+		void larft(int len, int jb, const T * A, int lda, const T * tau, T * V, T * Td, T * S)
+		{
+			copy2d(V, len, A, lda, len, jb);
+			_unit_lower<T><<<triangle_grid(jb,jb),256>>>(jb, V, len);
+			gemm<T>('T', 'N', jb, jb, len, T(1), V, len, V, len, T(0), S, jb);
+
+			std::vector<T> s(jb*jb), t(jb*jb, T(0));
+			get(s.data(),S,s.size());
+
+			// T(0:i,i) = -tau(i) * T(0:i,0:i) * V(:,0:i)^T * v(i)
+			for (int i = 0; i < jb; ++i)
+			{
+				t[i + i*jb] = tau[i];
+				for (int r = 0; r < i; ++r)
+				{
+					T sum = T(0);
+					for (int q = r; q < i; ++q)
+						sum += t[r + q*jb]*s[q + i*jb];
+					t[r + i*jb] = -tau[i]*sum;
+				}
+			}
+
+			set(Td,t.data(),t.size());
+		}
+
+		// C = (I - V*T*V^T) * C for trans 'N', (I - V*T^T*V^T) * C for 'T'; C is len x n
+		template <typename T>
+		void larfb(char trans, int len, int n, int jb, const T * V, const T * Td, T * C, int ldc, T * W1, T * W2)
+		{
+			gemm<T>('T', 'N', jb, n, len, T(1), V, len, C, ldc, T(0), W1, jb);
+			gemm<T>(trans, 'N', jb, n, jb, T(1), Td, jb, W1, jb, T(0), W2, jb);
+			gemm<T>('N', 'N', len, n, jb, T(-1), V, len, W2, jb, T(1), C, ldc);
+		}
+
+		// V, T and S of a panel and the two products of larfb, carved from
+		// the thread's workspace; geqrf and ormqr call nothing else using it.
+		template <typename T>
+		T * qr_workspace(int m, int n, int nb)
+		{
+			return (T *) workspace(((size_t)m*nb + 2*nb*nb + 2*(size_t)nb*n)*sizeof(T));
+		}
+
+		template <typename T>
+		void geqrf(int m, int n, T * A, int lda, T * tau)
+		{
+			GPUMATRIX_TRACE_SCOPE("impl::geqrf",m,n,0,2.0*m*n*sizeof(T),2.0*m*n*n - 2.0*n*n*n/3);
+
+			int kmax = m < n ? m : n;
+			if (kmax == 0)
+				return;
+
+			int nb = kmax < QRBlock ? kmax : QRBlock;
+			T * V = qr_workspace<T>(m, n, nb);
+			T * Td = V + (size_t)m*nb;
+			T * S = Td + nb*nb;
+			T * W1 = S + nb*nb;
+			T * W2 = W1 + (size_t)nb*n;
+			std::vector<T> h_tau(kmax);
+
+			for (int j = 0; j < kmax; j += nb)
+			{
+				int jb = kmax - j < nb ? kmax - j : nb;
+				int len = m - j;
+				T * Ajj = A + j + (size_t)j*lda;
+
+				geqr2(len, jb, Ajj, lda, &h_tau[j], W1);
+
+				int n2 = n - j - jb;
+				if (n2 > 0)
+				{
+					larft(len, jb, Ajj, lda, &h_tau[j], V, Td, S);
+					larfb('T', len, n2, jb, V, Td, Ajj + (size_t)jb*lda, lda, W1, W2);
+				}
+			}
+
+			set(tau,h_tau.data(),kmax);
+		}
+
+		template <typename T>
+		void ormqr(char trans, int m, int n, int k, const T * A, int lda, const T * tau, T * C, int ldc)
+		{
+			GPUMATRIX_TRACE_SCOPE("impl::ormqr",m,n,k,(double(m)*k + 2.0*m*n)*sizeof(T),4.0*m*n*k);
+
+			if (k == 0 || n == 0)
+				return;
+
+			int nb = k < QRBlock ? k : QRBlock;
+			T * V = qr_workspace<T>(m, n, nb);
+			T * Td = V + (size_t)m*nb;
+			T * S = Td + nb*nb;
+			T * W1 = S + nb*nb;
+			T * W2 = W1 + (size_t)nb*n;
+			std::vector<T> h_tau(k);
+			get(h_tau.data(),tau,k);
+
+			// Q = H(0)...H(k-1): Q^T takes the panels first to last, Q last to first
+			int blocks = (k + nb - 1)/nb;
+			for (int b = 0; b < blocks; ++b)
+			{
+				int j = (trans == 'T' ? b : blocks - 1 - b)*nb;
+				int jb = k - j < nb ? k - j : nb;
+				int len = m - j;
+
+				larft(len, jb, A + j + (size_t)j*lda, lda, &h_tau[j], V, Td, S);
+				larfb(trans, len, n, jb, V, Td, C + j, ldc, W1, W2);
+			}
+		}
+
+		// TSQR leaves are factored together, one thread block per leaf, by
+		// unblocked Householder QR in place on the leaf's rows of W; the R
+		// factors and the first n rows of Q^T*WB go to S and SB.
+		static const int LeafThreads = 256;
+
+		// the sum of v over the block; every thread gets it
+		template <typename T>
+		__device__ T leaf_sum(T v, T * red)
+		{
+			red[threadIdx.x] = v;
+			__syncthreads();
+			for (int s = LeafThreads/2; s > 0; s >>= 1)
+			{
+				if (threadIdx.x < s)
+					red[threadIdx.x] += red[threadIdx.x + s];
+				__syncthreads();
+			}
+			T sum = red[0];
+			__syncthreads();
+			return sum;
+		}
+
+		// c = (I - tau*v*v^T)*c, v[0] = 1 implied
+		template <typename T>
+		__device__ void leaf_reflect(int len, const T * v, T tau, T * c, T * red)
+		{
+			T w = threadIdx.x == 0 ? c[0] : T(0);
+			for (int i = 1 + threadIdx.x; i < len; i += LeafThreads)
+				w += v[i]*c[i];
+			w = leaf_sum(w, red);
+
+			for (int i = 1 + threadIdx.x; i < len; i += LeafThreads)
+				c[i] -= tau*w*v[i];
+			if (threadIdx.x == 0)
+				c[0] -= tau*w;
+			__syncthreads();
+		}
+
+		template <typename T>
+		__global__ void _tsqr_leaves(int leaves, int mb, int last, int n, T * W, int ldw, int nrhs, T * WB, int ldwb,
+			T * S, int lds, T * SB, int ldsb)
+		{
+			__shared__ T red[LeafThreads];
+			__shared__ T h[2];
+
+			int leaf = blockIdx.x;
+			int rows = leaf + 1 < leaves ? mb : last;
+			T * A = W + (size_t)leaf*mb;
+			T * B = WB + (size_t)leaf*mb;
+
+			for (int k = 0; k < n; ++k)
+			{
+				int len = rows - k;
+				T * x = A + k + (size_t)k*ldw;
+
+				T ss = 0;
+				for (int i = 1 + threadIdx.x; i < len; i += LeafThreads)
+					ss += x[i]*x[i];
+				ss = leaf_sum(ss, red);
+
+				// as householder(): H*x = (beta, 0, ..., 0)
+				if (threadIdx.x == 0)
+				{
+					T alpha = x[0], tau = 0, scale = 0;
+					if (ss != T(0))
+					{
+						T beta = alpha >= T(0) ? -hypot(alpha,sqrt(ss)) : hypot(alpha,sqrt(ss));
+						tau = (beta - alpha)/beta;
+						scale = T(1)/(alpha - beta);
+						x[0] = beta;
+					}
+					h[0] = tau;
+					h[1] = scale;
+				}
+				__syncthreads();
+
+				T tau = h[0];
+				if (tau == T(0))
+					continue;
+
+				for (int i = 1 + threadIdx.x; i < len; i += LeafThreads)
+					x[i] *= h[1];
+				__syncthreads();
+
+				for (int j = k + 1; j < n; ++j)
+					leaf_reflect(len, x, tau, A + k + (size_t)j*ldw, red);
+				for (int j = 0; j < nrhs; ++j)
+					leaf_reflect(len, x, tau, B + k + (size_t)j*ldwb, red);
+			}
+
+			for (int idx = threadIdx.x; idx < n*n; idx += LeafThreads)
+			{
+				int i = idx % n, j = idx / n;
+				S[leaf*n + i + (size_t)j*lds] = i <= j ? A[i + (size_t)j*ldw] : T(0);
+			}
+			for (int idx = threadIdx.x; idx < n*nrhs; idx += LeafThreads)
+			{
+				int i = idx % n, j = idx / n;
+				SB[leaf*n + i + (size_t)j*ldsb] = B[i + (size_t)j*ldwb];
+			}
+		}
+
+		template <typename T>
+		void tsqr(int m, int n, const T * A, int lda, int nrhs, const T * B, int ldb, T * R, int ldr, T * QtB, int ldq, int block_rows)
+		{
+			GPUMATRIX_TRACE_SCOPE("impl::tsqr",m,n,nrhs,(double(m)*(n + nrhs) + double(n)*(n + nrhs))*sizeof(T),2.0*m*n*n);
+
+			// every leaf has mb rows but the last, which takes the rest (< 2mb)
+			int mb = block_rows > 2*n ? block_rows : 2*n;
+			int leaves = m/mb > 1 ? m/mb : 1;
+			int last = m - (leaves - 1)*mb;
+
+			T * W = alloc<T>((size_t)m*n);
+			T * WB = nrhs > 0 ? alloc<T>((size_t)m*nrhs) : 0;
+
+			copy2d(W, m, A, lda, m, n);
+			if (nrhs > 0)
+				copy2d(WB, m, B, ldb, m, nrhs);
+
+			if (leaves == 1)
+			{
+				// a single leaf has the whole device to itself
+				T * tau = alloc<T>(n);
+				geqrf(m, n, W, m, tau);
+				ormqr('T', m, nrhs, n, W, m, tau, WB, m);
+				free(tau);
+
+				copy2d(R, ldr, W, m, n, n);
+				_zero_lower<T><<<triangle_grid(n,n),256>>>(n, n, R, ldr);
+				if (nrhs > 0)
+					copy2d(QtB, ldq, WB, m, n, nrhs);
+
+				free(W);
+				if (WB)
+					free(WB);
+			}
+			else
+			{
+				int stacked = leaves*n;
+				T * S = alloc<T>((size_t)stacked*n);
+				T * SB = nrhs > 0 ? alloc<T>((size_t)stacked*nrhs) : 0;
+
+				_tsqr_leaves<T><<<leaves,LeafThreads>>>(leaves, mb, last, n, W, m, nrhs, WB, m, S, stacked, SB, stacked);
+
+				free(W);
+				if (WB)
+					free(WB);
+
+				tsqr(stacked, n, S, stacked, nrhs, SB, stacked, R, ldr, QtB, ldq, block_rows);
+
+				free(S);
+				if (SB)
+					free(SB);
+			}
+		}
+
+		template void geqrf<float>(int m, int n, float * A, int lda, float * tau);
+		template void geqrf<double>(int m, int n, double * A, int lda, double * tau);
+		template void ormqr<float>(char trans, int m, int n, int k, const float * A, int lda, const float * tau, float * C, int ldc);
+		template void ormqr<double>(char trans, int m, int n, int k, const double * A, int lda, const double * tau, double * C, int ldc);
+		template void tsqr<float>(int m, int n, const float * A, int lda, int nrhs, const float * B, int ldb, float * R, int ldr, float * QtB, int ldq, int block_rows);
+		template void tsqr<double>(int m, int n, const double * A, int lda, int nrhs, const double * B, int ldb, double * R, int ldr, double * QtB, int ldq, int block_rows);
+
+	}
+}
@@ -0,0 +1,29 @@
+#ifndef FIXED_FACTOR_CU_H
+#define FIXED_FACTOR_CU_H
+
+
+namespace gpumatrix
+{
+	namespace impl
+	{
+		// a fixed factor goes by value as a kernel argument, so every
+		// thread reads it from the constant bank and no copy is made
+		template <typename T, int R, int C>
+		struct FixedFactor
+		{
+			T v[R*C];
+
+			// F held on the host, column major
+			static FixedFactor load(const T * F)
+			{
+				FixedFactor f;
+				for (int i = 0; i < R*C; i++)
+					f.v[i] = F[i];
+				return f;
+			}
+		};
+	}
+}
+
+
+#endif
@@ -0,0 +1,93 @@
+#include <cuda.h>
+#include <cublas.h>
+#include <cuda_runtime.h>
+
+#include <gpumatrix/impl/backend/FixedInterface.h>
+#include <gpumatrix/Trace.h>
+
+#include "FixedFactor.cuh"
+
+namespace gpumatrix
+{
+	namespace impl
+	{
+		// one thread per column of X and Y
+		template <typename T, int R, int C>
+		__global__ void _fixed_mm_left(FixedFactor<T,R,C> F, int n, const T * X, int ldx, T * Y, int ldy)
+		{
+			int j = blockIdx.x * blockDim.x + threadIdx.x;
+			if (j >= n)
+				return;
+
+			T x[C];
+			#pragma unroll
+			for (int k = 0; k < C; k++)
+				x[k] = X[k + (std::size_t)j*ldx];
+
+			#pragma unroll
+			for (int i = 0; i < R; i++)
+			{
+				T y = 0;
+				#pragma unroll
+				for (int k = 0; k < C; k++)
+					y += F.v[i + k*R]*x[k];
+				Y[i + (std::size_t)j*ldy] = y;
+			}
+		}
+
+		// one thread per row of X and Y, so loads and stores are coalesced
+		template <typename T, int R, int C>
+		__global__ void _fixed_mm_right(FixedFactor<T,R,C> F, int m, const T * X, int ldx, T * Y, int ldy)
+		{
+			int i = blockIdx.x * blockDim.x + threadIdx.x;
+			if (i >= m)
+				return;
+
+			T x[R];
+			#pragma unroll
+			for (int k = 0; k < R; k++)
+				x[k] = X[i + (std::size_t)k*ldx];
+
+			#pragma unroll
+			for (int j = 0; j < C; j++)
+			{
+				T y = 0;
+				#pragma unroll
+				for (int k = 0; k < R; k++)
+					y += x[k]*F.v[k + j*R];
+				Y[i + (std::size_t)j*ldy] = y;
+			}
+		}
+
+		template <typename T, int R, int C> void fixed_mm_left(const T *F, int n, const T *X, int ldx, T *Y, int ldy)
+		{
+			GPUMATRIX_TRACE_SCOPE("impl::fixed_mm_left",R,n,C,(double(C) + R)*n*sizeof(T),2.0*R*C*n);
+
+			if (n == 0)
+				return;
+
+			_fixed_mm_left<T,R,C><<<(n + 256 -1)/256,256>>>(FixedFactor<T,R,C>::load(F), n, X, ldx, Y, ldy);
+		}
+
+		template <typename T, int R, int C> void fixed_mm_right(int m, const T *X, int ldx, const T *F, T *Y, int ldy)
+		{
+			GPUMATRIX_TRACE_SCOPE("impl::fixed_mm_right",m,C,R,(double(R) + C)*m*sizeof(T),2.0*R*C*m);
+
+			if (m == 0)
+				return;
+
+			_fixed_mm_right<T,R,C><<<(m + 256 -1)/256,256>>>(FixedFactor<T,R,C>::load(F), m, X, ldx, Y, ldy);
+		}
+
+		#define GPUMATRIX_FIXED_MM(T,R,C)																\
+			template void fixed_mm_left<T,R,C>(const T *F, int n, const T *X, int ldx, T *Y, int ldy);	\
+			template void fixed_mm_right<T,R,C>(int m, const T *X, int ldx, const T *F, T *Y, int ldy);
+
+		#define GPUMATRIX_FIXED_MM_ROWS(T,R)															\
+			GPUMATRIX_FIXED_MM(T,R,1) GPUMATRIX_FIXED_MM(T,R,2) GPUMATRIX_FIXED_MM(T,R,3) GPUMATRIX_FIXED_MM(T,R,4)
+
+		// every R x C up to FixedDeviceMaxSize
+		GPUMATRIX_FIXED_MM_ROWS(float,1) GPUMATRIX_FIXED_MM_ROWS(float,2) GPUMATRIX_FIXED_MM_ROWS(float,3) GPUMATRIX_FIXED_MM_ROWS(float,4)
+		GPUMATRIX_FIXED_MM_ROWS(double,1) GPUMATRIX_FIXED_MM_ROWS(double,2) GPUMATRIX_FIXED_MM_ROWS(double,3) GPUMATRIX_FIXED_MM_ROWS(double,4)
+	}
+}
@@ -3,11 +3,18 @@
 #include <cuda_runtime.h>
 
 #include <gpumatrix/impl/backend/FunctionInterface.h>
+#include <gpumatrix/impl/backend/BlasInterface.h>
+#include <gpumatrix/Trace.h>
 
 #include <thrust/device_ptr.h>
 #include <thrust/reduce.h>
 #include <thrust/extrema.h>
 #include <thrust/functional.h>
+#include <thrust/inner_product.h>
+#include <thrust/transform_reduce.h>
+#include <thrust/count.h>
+#include <thrust/iterator/counting_iterator.h>
+#include <thrust/iterator/transform_iterator.h>
 
 
 #include "shared_mem.cuh"
@@ -21,22 +28,20 @@ namespace gpumatrix
 		  
 		#define BINARY_ARRAY_FUNC(FUNCNAME, FUNC, TYPE) \
 	\
-	__global__ void _array_##FUNCNAME (TYPE *odata, const TYPE  * idata1, const TYPE * idata2,  int size) \
+	__global__ void _array_##FUNCNAME (TYPE *odata, const TYPE  * idata1, const TYPE * idata2,  std::size_t size) \
 			{																			\
 			\
-			unsigned int index = blockIdx.x * blockDim.x + threadIdx.x;				\
-			\
-			if(index < size )														\
-			{																		\
+			GPUMATRIX_ELEMENTWISE_LOOP(index, size, \
 			odata[index] = FUNC(idata1[index],idata2[index])  ;								\
-			}																		\
+			) \
 			\
 			}																			\
 			\
-			void array_##FUNCNAME( TYPE *odata, const TYPE  * idata1, const TYPE * idata2,  int size)  \
+			void array_##FUNCNAME( TYPE *odata, const TYPE  * idata1, const TYPE * idata2,  std::size_t size)  \
 			{																						\
-			int numGrid = (size + 256 -1)/256;													\
-			_array_##FUNCNAME<<<numGrid,256>>>(odata, idata1, idata2, size);						\
+				GPUMATRIX_TRACE_SCOPE("impl::array_" #FUNCNAME,size,0,0,3.0*size*sizeof(TYPE),size);		\
+			unsigned int numGrid = elementwise_blocks(size);													\
+			_array_##FUNCNAME<<<numGrid,ElementwiseThreads>>>(odata, idata1, idata2, size);						\
 			}			
 
 
@@ -54,61 +59,40 @@ __device__ double cross_entropy_diff( double x, double r)
 			BINARY_ARRAY_FUNC(cross_entropy_diff, cross_entropy_diff, double)
 
 		  
-			__device__ double arrayinv(double val)
-			{
-				return 1.0/val;
-			}
+#define UNARY_ARRAY_OP(OPNAME, TYPE) \
+	template void unary_array_op< Fcnl_##OPNAME<TYPE> >(TYPE *odata, const TYPE  * idata, std::size_t size, const Fcnl_##OPNAME<TYPE> & func);
 
-			__device__ float arrayinv(float val)
-			{
-				return 1.0/val;
-			}
+			// 16 bit storage: the value converts to float on load, so the
+			// float overloads do the work and the result rounds back on store
+#define UNARY_ARRAY_OP_ALL_TYPES(OPNAME) \
+	UNARY_ARRAY_OP(OPNAME, double) \
+	UNARY_ARRAY_OP(OPNAME, float) \
+	UNARY_ARRAY_OP(OPNAME, half) \
+	UNARY_ARRAY_OP(OPNAME, bfloat16)
 
+			GPUMATRIX_UNARY_FUNCTIONALS(UNARY_ARRAY_OP_ALL_TYPES)
+			GPUMATRIX_FAST_UNARY_FUNCTIONALS(UNARY_ARRAY_OP_ALL_TYPES)
 
-			__device__ double logistic(double val)
-			{
-				return 1.0/(1.0+exp(-val));
-			}
+			UNARY_ARRAY_OP(not, bool)
 
-			__device__ float logistic(float val)
-			{
-				return 1.0/(1.0+exp(-val));
-			}
 
-#define UNARY_ARRAY_OP(OPNAME, OP, TYPE) \
-	\
-	__global__ void _unary_array_op (TYPE *odata, const TYPE  * idata, int size, const Fcnl_##OPNAME<TYPE> * func) \
-			{																			\
-			\
-			unsigned int index = blockIdx.x * blockDim.x + threadIdx.x;				\
-			\
-			if(index < size )														\
-			{																		\
-			odata[index] = OP(idata[index]);								\
-			}																		\
-			\
-			}																			\
-			\
-			void unary_array_op( TYPE *odata, const TYPE  * idata, int size,const Fcnl_##OPNAME<TYPE> & func)  \
-			{																						\
-			int numGrid = (size + 256 -1)/256;													\
-			_unary_array_op<<<numGrid,256>>>(odata, idata , size,&func);						\
-			}	
+#define BINARY_ARRAY_OP(OPNAME, TYPE) \
+	template void binary_array_op< Fcnl_##OPNAME<TYPE,TYPE> >(TYPE *odata, const TYPE * idata1, const TYPE * idata2, std::size_t size, const Fcnl_##OPNAME<TYPE,TYPE> & func); \
+	template void binary_array_op< Fcnl_##OPNAME<TYPE,TYPE> >(TYPE *odata, const TYPE * idata1, TYPE beta, std::size_t size, const Fcnl_##OPNAME<TYPE,TYPE> & func); \
+	template void binary_array_op< Fcnl_##OPNAME<TYPE,TYPE> >(TYPE *odata, TYPE alpha, const TYPE * idata2, std::size_t size, const Fcnl_##OPNAME<TYPE,TYPE> & func);
 
-			UNARY_ARRAY_OP(exp, exp, double)
-			UNARY_ARRAY_OP(exp, exp, float)
-			UNARY_ARRAY_OP(log, log, double)
-			UNARY_ARRAY_OP(log, log, float)
-			UNARY_ARRAY_OP(neg, - , double)
-			UNARY_ARRAY_OP(neg, - , float)
-			UNARY_ARRAY_OP(arrayinv, arrayinv, double)
-			UNARY_ARRAY_OP(arrayinv, arrayinv, float)
-			UNARY_ARRAY_OP(logistic, logistic, double)
-			UNARY_ARRAY_OP(logistic, logistic, float)
+#define BINARY_ARRAY_OP_ALL_TYPES(OPNAME) \
+	BINARY_ARRAY_OP(OPNAME, double) \
+	BINARY_ARRAY_OP(OPNAME, float) \
+	BINARY_ARRAY_OP(OPNAME, half) \
+	BINARY_ARRAY_OP(OPNAME, bfloat16)
 
+			GPUMATRIX_BINARY_FUNCTIONALS(BINARY_ARRAY_OP_ALL_TYPES)
 
-			template<typename T> T sum(const T * data, int size)
+
+			template<typename T> T sum(const T * data, std::size_t size)
 			{
+				GPUMATRIX_TRACE_SCOPE("impl::sum",size,0,0,double(size)*sizeof(T),size);
 
 				thrust::device_ptr<T> dev_ptr(const_cast<T *>(data));
 
@@ -118,11 +102,12 @@ __device__ double cross_entropy_diff( double x, double r)
 				return x;
 			}
 
-			template double sum<double>(const double * data, int size);
-			template float sum<float>(const float * data, int size);
+			template double sum<double>(const double * data, std::size_t size);
+			template float sum<float>(const float * data, std::size_t size);
 
-			template<typename T> T max_element(const T * data, int size)
+			template<typename T> T max_element(const T * data, std::size_t size)
 			{
+				GPUMATRIX_TRACE_SCOPE("impl::max_element",size,0,0,double(size)*sizeof(T),size);
 //#ifdef _DEBUG
 //				return 255;
 //#endif
@@ -134,11 +119,12 @@ __device__ double cross_entropy_diff( double x, double r)
 			}
 
 
-			template double max_element<double>(const double * data, int size);
-			template float max_element<float>(const float * data, int size);
+			template double max_element<double>(const double * data, std::size_t size);
+			template float max_element<float>(const float * data, std::size_t size);
 
-			template<typename T> T min_element(const T * data, int size)
+			template<typename T> T min_element(const T * data, std::size_t size)
 			{
+				GPUMATRIX_TRACE_SCOPE("impl::min_element",size,0,0,double(size)*sizeof(T),size);
 //#ifdef _DEBUG
 //				return 0.0;
 //#endif
@@ -146,7 +132,7 @@ __device__ double cross_entropy_diff( double x, double r)
 
 				thrust::device_ptr<T> x = thrust::min_element(dev_ptr, dev_ptr + size);
 
-				int index = x - dev_ptr;
+				std::size_t index = x - dev_ptr;
 
 				if (index > size)
 					std::cout << "min_element Error occured!" << std::endl;
@@ -155,8 +141,195 @@ __device__ double cross_entropy_diff( double x, double r)
 
 			}
 
-			template double min_element<double>(const double * data, int size);
-			template float min_element<float>(const float * data, int size);
+			template double min_element<double>(const double * data, std::size_t size);
+			template float min_element<float>(const float * data, std::size_t size);
+
+			template half max_element<half>(const half * data, std::size_t size);
+			template bfloat16 max_element<bfloat16>(const bfloat16 * data, std::size_t size);
+			template half min_element<half>(const half * data, std::size_t size);
+			template bfloat16 min_element<bfloat16>(const bfloat16 * data, std::size_t size);
+
+			// A 16 bit running sum would lose everything past the 11th bit,
+			// so the reduction keeps a float accumulator.
+			template<> half sum<half>(const half * data, std::size_t size)
+			{
+				GPUMATRIX_TRACE_SCOPE("impl::sum",size,0,0,double(size)*sizeof(half),size);
+				thrust::device_ptr<half> dev_ptr(const_cast<half *>(data));
+
+				return thrust::reduce(dev_ptr, dev_ptr+size, 0.0f, thrust::plus<float>());
+			}
+
+			template<> bfloat16 sum<bfloat16>(const bfloat16 * data, std::size_t size)
+			{
+				GPUMATRIX_TRACE_SCOPE("impl::sum",size,0,0,double(size)*sizeof(bfloat16),size);
+				thrust::device_ptr<bfloat16> dev_ptr(const_cast<bfloat16 *>(data));
+
+				return thrust::reduce(dev_ptr, dev_ptr+size, 0.0f, thrust::plus<float>());
+			}
+
+
+			// The init value fixes the accumulator type of thrust::reduce, so
+			// passing a double widens the running sum while every element is
+			// still read once as float.
+			struct widen_square
+			{
+				__host__ __device__ double operator()(float x) const
+				{
+					return double(x)*double(x);
+				}
+			};
+
+			double wide_sum(const float * data, std::size_t size)
+			{
+				GPUMATRIX_TRACE_SCOPE("impl::wide_sum",size,0,0,double(size)*sizeof(float),size);
+				thrust::device_ptr<float> dev_ptr(const_cast<float *>(data));
+
+				return thrust::reduce(dev_ptr, dev_ptr+size, 0.0, thrust::plus<double>());
+			}
+
+			double wide_squared_norm(const float * data, std::size_t size)
+			{
+				GPUMATRIX_TRACE_SCOPE("impl::wide_squared_norm",size,0,0,double(size)*sizeof(float),2.0*size);
+				thrust::device_ptr<float> dev_ptr(const_cast<float *>(data));
+
+				return thrust::transform_reduce(dev_ptr, dev_ptr+size, widen_square(), 0.0, thrust::plus<double>());
+			}
+
+			double wide_dot(const float * x, const float * y, std::size_t size)
+			{
+				GPUMATRIX_TRACE_SCOPE("impl::wide_dot",size,0,0,2.0*size*sizeof(float),2.0*size);
+				thrust::device_ptr<float> x_ptr(const_cast<float *>(x));
+				thrust::device_ptr<float> y_ptr(const_cast<float *>(y));
+
+				return thrust::inner_product(x_ptr, x_ptr+size, y_ptr, 0.0, thrust::plus<double>(), thrust::multiplies<double>());
+			}
+
+
+			// cuBLAS has no 16 bit nrm2/dot, both reduce with a float accumulator.
+			// Entry i of x is x[i*incx], counted from the far end for a negative
+			// stride as BLAS does.
+			template<typename T> struct widen16_strided
+			{
+				const T * x;
+				int inc;
+
+				widen16_strided(int n, const T * x, int inc)
+					: x(inc < 0 ? x - std::ptrdiff_t(n - 1)*inc : x), inc(inc)
+				{ }
+
+				__host__ __device__ float operator()(int i) const
+				{
+					return float(x[std::ptrdiff_t(i)*inc]);
+				}
+			};
+
+			template<typename T> struct widen16_strided_square
+			{
+				widen16_strided<T> at;
+
+				widen16_strided_square(int n, const T * x, int inc) : at(n, x, inc) { }
+
+				__host__ __device__ float operator()(int i) const
+				{
+					float v = at(i);
+					return v*v;
+				}
+			};
+
+			template <typename T> float nrm2_16(int n, const T *x, int incx)
+			{
+				// as the BLAS, no entries for a stride that is not positive
+				if (n <= 0 || incx <= 0)
+					return 0.0f;
+
+				thrust::counting_iterator<int> first(0);
+				return sqrtf(thrust::transform_reduce(first, first+n, widen16_strided_square<T>(n, x, incx), 0.0f, thrust::plus<float>()));
+			}
+
+			template <typename T> float dot16(int n, const T *x, int incx, const T * y, int incy)
+			{
+				if (n <= 0)
+					return 0.0f;
+
+				thrust::counting_iterator<int> first(0);
+				return thrust::inner_product(
+					thrust::make_transform_iterator(first, widen16_strided<T>(n, x, incx)),
+					thrust::make_transform_iterator(first+n, widen16_strided<T>(n, x, incx)),
+					thrust::make_transform_iterator(first, widen16_strided<T>(n, y, incy)),
+					0.0f, thrust::plus<float>(), thrust::multiplies<float>());
+			}
+
+			template <> half nrm2<half>(int n, const half *x, int incx)
+			{
+				GPUMATRIX_TRACE_SCOPE("impl::nrm2",n,0,0,double(n)*sizeof(half),2.0*n);
+				return nrm2_16(n, x, incx);
+			}
+
+			template <> bfloat16 nrm2<bfloat16>(int n, const bfloat16 *x, int incx)
+			{
+				GPUMATRIX_TRACE_SCOPE("impl::nrm2",n,0,0,double(n)*sizeof(bfloat16),2.0*n);
+				return nrm2_16(n, x, incx);
+			}
+
+			template <> half dot<half>(int n, const half *x, int incx, const half * y, int incy)
+			{
+				GPUMATRIX_TRACE_SCOPE("impl::dot",n,0,0,2.0*n*sizeof(half),2.0*n);
+				return dot16(n, x, incx, y, incy);
+			}
+
+			template <> bfloat16 dot<bfloat16>(int n, const bfloat16 *x, int incx, const bfloat16 * y, int incy)
+			{
+				GPUMATRIX_TRACE_SCOPE("impl::dot",n,0,0,2.0*n*sizeof(bfloat16),2.0*n);
+				return dot16(n, x, incx, y, incy);
+			}
+			
+
+			std::size_t count(const bool * mask, std::size_t size)
+			{
+				GPUMATRIX_TRACE_SCOPE("impl::count",size,0,0,double(size)*sizeof(bool),size);
+				thrust::device_ptr<bool> dev_ptr(const_cast<bool *>(mask));
+
+				return thrust::count(dev_ptr, dev_ptr+size, true);
+			}
+
+			// selects instead of multiplying by the mask, 0*NaN would still be NaN
+			template<typename T, typename Acc> struct masked_value
+			{
+				__host__ __device__ Acc operator()(T x, bool m) const
+				{
+					return m ? Acc(x) : Acc(0);
+				}
+			};
+
+			template<typename T> T masked_sum(const T * data, const bool * mask, std::size_t size)
+			{
+				GPUMATRIX_TRACE_SCOPE("impl::masked_sum",size,0,0,double(size)*(sizeof(T) + sizeof(bool)),size);
+				thrust::device_ptr<T> x_ptr(const_cast<T *>(data));
+				thrust::device_ptr<bool> m_ptr(const_cast<bool *>(mask));
+
+				return thrust::inner_product(x_ptr, x_ptr+size, m_ptr, T(0), thrust::plus<T>(), masked_value<T,T>());
+			}
+
+			template double masked_sum<double>(const double * data, const bool * mask, std::size_t size);
+			template float masked_sum<float>(const float * data, const bool * mask, std::size_t size);
+
+			template<> half masked_sum<half>(const half * data, const bool * mask, std::size_t size)
+			{
+				GPUMATRIX_TRACE_SCOPE("impl::masked_sum",size,0,0,double(size)*(sizeof(half) + sizeof(bool)),size);
+				thrust::device_ptr<half> x_ptr(const_cast<half *>(data));
+				thrust::device_ptr<bool> m_ptr(const_cast<bool *>(mask));
+
+				return thrust::inner_product(x_ptr, x_ptr+size, m_ptr, 0.0f, thrust::plus<float>(), masked_value<half,float>());
+			}
+
+			template<> bfloat16 masked_sum<bfloat16>(const bfloat16 * data, const bool * mask, std::size_t size)
+			{
+				GPUMATRIX_TRACE_SCOPE("impl::masked_sum",size,0,0,double(size)*(sizeof(bfloat16) + sizeof(bool)),size);
+				thrust::device_ptr<bfloat16> x_ptr(const_cast<bfloat16 *>(data));
+				thrust::device_ptr<bool> m_ptr(const_cast<bool *>(mask));
+
+				return thrust::inner_product(x_ptr, x_ptr+size, m_ptr, 0.0f, thrust::plus<float>(), masked_value<bfloat16,float>());
+			}
 			
 			
 			
@@ -173,8 +346,8 @@ __device__ double cross_entropy_diff( double x, double r)
 			    unsigned int tidx   = threadIdx.x;
 
 			    // 累加开始点
-			    unsigned int idx    = __mul24(tidx, r) + cur_row ;		  // idata(cur_row,tidx)
-			    unsigned int endidx = __mul24(c-1, r) +  cur_row +1;      // idata(r-1,columnid);
+			    std::size_t idx    = (std::size_t)tidx * r + cur_row ;		  // idata(cur_row,tidx)
+			    std::size_t endidx = (std::size_t)(c-1) * r +  cur_row +1;      // idata(r-1,columnid);
 
 			    float temp_sum = 0;
 
@@ -182,7 +355,7 @@ __device__ double cross_entropy_diff( double x, double r)
 			    // have covered the whole column
 			    while (idx < endidx) {
 				temp_sum += idata[idx];
-				idx += blocksize * r;
+				idx += (std::size_t)blocksize * r;
 			    }
 			    buff[tidx] = temp_sum;
 
@@ -241,6 +414,7 @@ __device__ double cross_entropy_diff( double x, double r)
 
 			template <typename T> void rowwise_sum( T *odata, const T *idata,  int r, int c)  
 			{													
+				GPUMATRIX_TRACE_SCOPE("impl::rowwise_sum",r,c,0,(double(r)*c + r)*sizeof(T),double(r)*c);
 				int threadsize = min((int)512,(int)pow(2,ceil(log2((double)c))));
 				dim3 dimBlock(r,1);
 				dim3 dimGrid(threadsize,1,1);	
@@ -263,8 +437,8 @@ __device__ double cross_entropy_diff( double x, double r)
 			    unsigned int tidx   = threadIdx.x;
 
 			    // 累加开始点
-			    unsigned int idx    = __mul24(cur_col, r) + tidx ;		  // idata(tidx,cur_col)
-			    unsigned int endidx = __mul24(cur_col, r) +  r;      // idata(columnid,c-1);
+			    std::size_t idx    = (std::size_t)cur_col * r + tidx ;		  // idata(tidx,cur_col)
+			    std::size_t endidx = (std::size_t)cur_col * r +  r;      // idata(columnid,c-1);
 
 			    float temp_sum = 0;
 
@@ -331,6 +505,7 @@ __device__ double cross_entropy_diff( double x, double r)
 
 			template <typename T> void colwise_sum( T *odata, const T *idata,  int r, int c)  
 			{													
+				GPUMATRIX_TRACE_SCOPE("impl::colwise_sum",r,c,0,(double(r)*c + c)*sizeof(T),double(r)*c);
 				int threadsize = min((int)512,(int)pow(2,ceil(log2((double)r))));
 				dim3 dimBlock(c,1);
 				dim3 dimGrid(threadsize,1,1);	
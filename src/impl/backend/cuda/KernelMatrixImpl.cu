@@ -0,0 +1,108 @@
+#include <cuda.h>
+#include <cublas.h>
+#include <cuda_runtime.h>
+
+#include <gpumatrix/impl/backend/KernelMatrixInterface.h>
+#include <gpumatrix/impl/backend/LaunchInterface.h>
+#include <gpumatrix/Trace.h>
+
+namespace gpumatrix
+{
+	namespace impl
+	{
+		// one warp per column: the lanes stride the column, then fold in shared memory
+		template <typename T>
+		__global__ void _column_squared_norms(int d, int n, const T * X, int ldx, T * norms)
+		{
+			__shared__ T partial[256];
+
+			int lane = threadIdx.x & 31;
+			int col = (blockIdx.x * blockDim.x + threadIdx.x) >> 5;
+
+			T sum = 0;
+			if (col < n)
+				for (int i = lane; i < d; i += 32)
+				{
+					T x = X[i + (std::size_t)col*ldx];
+					sum += x*x;
+				}
+			partial[threadIdx.x] = sum;
+
+			for (int s = 16; s > 0; s >>= 1)
+			{
+				__syncthreads();
+				if (lane < s)
+					partial[threadIdx.x] += partial[threadIdx.x + s];
+			}
+
+			if (lane == 0 && col < n)
+				norms[col] = partial[threadIdx.x];
+		}
+
+		template <typename T>
+		__device__ inline T kernel_pow(T x, int degree)
+		{
+			T r = 1;
+			for (; degree > 0; degree >>= 1, x *= x)
+				if (degree & 1)
+					r *= x;
+			return r;
+		}
+
+		// the gemm result is read and the kernel value written in the same pass
+		template <typename T>
+		__global__ void _kernel_epilogue(int kernel, int m, int n, T gamma, T coef0, int degree,
+			const T * xnorm, const T * ynorm, T * K, int ldk)
+		{
+			std::size_t size = (std::size_t)m*n;
+
+			GPUMATRIX_ELEMENTWISE_LOOP(id, size,
+				int i = id % m;
+				int j = id / m;
+				std::size_t k = i + (std::size_t)j*ldk;
+				T g = K[k];
+
+				if (kernel == 1)
+					g = kernel_pow(gamma*g + coef0, degree);
+				else if (kernel == 2)
+				{
+					// rounding can leave a small negative distance between near points
+					T d = xnorm[i] + ynorm[j] - 2*g;
+					g = exp(-gamma*(d > 0 ? d : T(0)));
+				}
+
+				K[k] = g;
+			)
+		}
+
+		template <typename T> void column_squared_norms(int d, int n, const T *X, int ldx, T *norms)
+		{
+			GPUMATRIX_TRACE_SCOPE("impl::column_squared_norms",d,n,0,(double(d) + 1)*n*sizeof(T),2.0*d*n);
+
+			if (n == 0)
+				return;
+
+			int numGrid = (n + 8 -1)/8;
+			_column_squared_norms<T><<<numGrid,256>>>(d, n, X, ldx, norms);
+		}
+
+		template <typename T> void kernel_epilogue(int kernel, int m, int n, T gamma, T coef0, int degree,
+			const T *xnorm, const T *ynorm, T *K, int ldk)
+		{
+			GPUMATRIX_TRACE_SCOPE("impl::kernel_epilogue",m,n,0,(2.0*m*n + m + n)*sizeof(T),4.0*m*n);
+
+			if (kernel == 0 || m == 0 || n == 0)
+				return;
+
+			_kernel_epilogue<T><<<elementwise_blocks((std::size_t)m*n),ElementwiseThreads>>>(kernel, m, n, gamma, coef0, degree, xnorm, ynorm, K, ldk);
+		}
+
+		template void column_squared_norms<float>(int d, int n, const float *X, int ldx, float *norms);
+		template void column_squared_norms<double>(int d, int n, const double *X, int ldx, double *norms);
+
+		template void kernel_epilogue<float>(int kernel, int m, int n, float gamma, float coef0, int degree,
+			const float *xnorm, const float *ynorm, float *K, int ldk);
+		template void kernel_epilogue<double>(int kernel, int m, int n, double gamma, double coef0, int degree,
+			const double *xnorm, const double *ynorm, double *K, int ldk);
+	}
+}
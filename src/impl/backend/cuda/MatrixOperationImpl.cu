@@ -18,7 +18,11 @@
 #include <cublas.h>
 #include <cuda_runtime.h>
 
+#include <stdexcept>
+
 #include <gpumatrix/impl/backend/MatrixOperationInterface.h>
+#include <gpumatrix/impl/backend/BlasInterface.h>
+#include <gpumatrix/Trace.h>
 
 #include "shared_mem.cuh"
 
@@ -60,6 +64,7 @@ template <typename T> __global__ void _row_major_transpose(T *odata, const T *id
 
 template <typename T> void transpose( T *odata, const T *idata,  int r, int c)  
 {									
+	GPUMATRIX_TRACE_SCOPE("impl::transpose",r,c,0,2.0*r*c*sizeof(T),0);
 
 
 	dim3 dimGrid(BLOCK_DIM,BLOCK_DIM,1);;
@@ -72,6 +77,174 @@ template <typename T> void transpose( T *odata, const T *idata,  int r, int c)
 
 template void transpose<double>( double *odata, const double *idata,  int r, int c) ; 
 template void transpose<float>( float *odata, const float *idata,  int r, int c)  ;
+template void transpose<half>( half *odata, const half *idata,  int r, int c)  ;
+template void transpose<bfloat16>( bfloat16 *odata, const bfloat16 *idata,  int r, int c)  ;
+
+
+// Mirrors the triangle uplo of A onto the other one. Each block writes one
+// tile of the destination triangle from the transposed tile of the source,
+// staged in shared memory as in _row_major_transpose; blocks of the source
+// triangle return at once.
+template <typename T> __global__ void _symmetrize(bool lower, T *A, int n, int lda)
+{
+	__shared__ T block[BLOCK_DIM][BLOCK_DIM+1];
+
+	if (lower ? blockIdx.x > blockIdx.y : blockIdx.x < blockIdx.y)
+		return;
+
+	// source tile (blockIdx.y, blockIdx.x)
+	int r = blockIdx.y * BLOCK_DIM + threadIdx.x;
+	int c = blockIdx.x * BLOCK_DIM + threadIdx.y;
+	if (r < n && c < n)
+		block[threadIdx.y][threadIdx.x] = A[r + c*lda];
+
+	__syncthreads();
+
+	// destination tile (blockIdx.x, blockIdx.y)
+	r = blockIdx.x * BLOCK_DIM + threadIdx.x;
+	c = blockIdx.y * BLOCK_DIM + threadIdx.y;
+	if (r < n && c < n && (lower ? r < c : r > c))
+		A[r + c*lda] = block[threadIdx.x][threadIdx.y];
+}
+
+template <typename T> void symmetrize(char uplo, int n, T *A, int lda)
+{
+	GPUMATRIX_TRACE_SCOPE("impl::symmetrize",n,n,0,double(n)*(n-1)*sizeof(T),0);
+
+	dim3 dimThreads(BLOCK_DIM,BLOCK_DIM,1);
+	dim3 dimBlocks((n + BLOCK_DIM - 1)/BLOCK_DIM,(n + BLOCK_DIM - 1)/BLOCK_DIM);
+
+	_symmetrize<T><<<dimBlocks,dimThreads>>>(uplo == 'L' || uplo == 'l', A, n, lda);
+}
+
+template void symmetrize<double>(char uplo, int n, double *A, int lda);
+template void symmetrize<float>(char uplo, int n, float *A, int lda);
+template void symmetrize<half>(char uplo, int n, half *A, int lda);
+template void symmetrize<bfloat16>(char uplo, int n, bfloat16 *A, int lda);
+
+
+// cuBLAS has no 16 bit gemm in the legacy API, so half and bfloat16 use this
+// tiled kernel. Tiles of op(A) and op(B) are widened to float when they are
+// staged in shared memory, the dot products accumulate in float and only the
+// final C(i,j) is rounded back to 16 bit. Storage is column major as in cuBLAS.
+// A negative tri restricts C to its lower triangle and a positive one to the
+// upper, as syrk does; blocks entirely outside it return at once.
+template <typename T> __global__ void _gemm16(bool transa, bool transb, int m, int n, int k,
+	float alpha, const T *A, int lda, const T *B, int ldb, float beta, T *C, int ldc, int tri)
+{
+	__shared__ float As[BLOCK_DIM][BLOCK_DIM+1];
+	__shared__ float Bs[BLOCK_DIM][BLOCK_DIM+1];
+
+	if (tri < 0 ? blockIdx.x < blockIdx.y : tri > 0 && blockIdx.x > blockIdx.y)
+		return;
+
+	int row = blockIdx.x * BLOCK_DIM + threadIdx.x;
+	int col = blockIdx.y * BLOCK_DIM + threadIdx.y;
+
+	float acc = 0;
+
+	for (int t = 0; t < k; t += BLOCK_DIM)
+	{
+		// op(A)(row, t+ty) and op(B)(t+tx, col)
+		int ka = t + threadIdx.y;
+		int kb = t + threadIdx.x;
+
+		As[threadIdx.x][threadIdx.y] = (row < m && ka < k) ? float(transa ? A[ka + row*lda] : A[row + ka*lda]) : 0.0f;
+		Bs[threadIdx.x][threadIdx.y] = (kb < k && col < n) ? float(transb ? B[col + kb*ldb] : B[kb + col*ldb]) : 0.0f;
+
+		__syncthreads();
+
+		for (int i = 0; i < BLOCK_DIM; ++i)
+			acc += As[threadIdx.x][i] * Bs[i][threadIdx.y];
+
+		__syncthreads();
+	}
+
+	if (row < m && col < n && (tri < 0 ? row >= col : tri == 0 || row <= col))
+	{
+		float c = alpha * acc;
+		if (beta != 0.0f)
+			c += beta * float(C[row + col*ldc]);
+		C[row + col*ldc] = T(c);
+	}
+}
+
+template <typename T> void gemm16(char transa, char transb, int m, int n, int k, 
+	float alpha, const T *A, int lda, const T *B, int ldb, float beta, T *C, int ldc)
+{
+	GPUMATRIX_TRACE_SCOPE("impl::gemm16",m,n,k,(double(m)*k + double(k)*n + 2.0*m*n)*sizeof(T),2.0*m*n*k);
+
+	dim3 dimThreads(BLOCK_DIM,BLOCK_DIM,1);
+	dim3 dimBlocks((m + BLOCK_DIM - 1)/BLOCK_DIM,(n + BLOCK_DIM - 1)/BLOCK_DIM);
+
+	bool ta = transa == 'T' || transa == 't' || transa == 'C' || transa == 'c';
+	bool tb = transb == 'T' || transb == 't' || transb == 'C' || transb == 'c';
+
+	_gemm16<T><<<dimBlocks,dimThreads>>>(ta, tb, m, n, k, alpha, A, lda, B, ldb, beta, C, ldc, 0);
+}
+
+template <typename T> void syrk16(char uplo, char trans, int n, int k, 
+	float alpha, const T *A, int lda, float beta, T *C, int ldc)
+{
+	GPUMATRIX_TRACE_SCOPE("impl::syrk16",n,n,k,(double(n)*k + double(n)*(n+1))*sizeof(T),double(n)*(n+1)*k);
+
+	dim3 dimThreads(BLOCK_DIM,BLOCK_DIM,1);
+	dim3 dimBlocks((n + BLOCK_DIM - 1)/BLOCK_DIM,(n + BLOCK_DIM - 1)/BLOCK_DIM);
+
+	// op(A)*op(A)^T is A^T*A for trans 'T' and A*A^T otherwise
+	bool t = trans == 'T' || trans == 't' || trans == 'C' || trans == 'c';
+	int tri = uplo == 'L' || uplo == 'l' ? -1 : 1;
+
+	_gemm16<T><<<dimBlocks,dimThreads>>>(t, !t, n, n, k, alpha, A, lda, A, lda, beta, C, ldc, tri);
+}
+
+template<> void gemm<half>(char transa, char transb, int m, int n, int k, 
+	half alpha, const half *A, int lda, const half *B, int ldb, half beta, half *C, int ldc)
+{
+	gemm16(transa, transb, m, n, k, alpha, A, lda, B, ldb, beta, C, ldc);
+}
+
+template<> void gemm<bfloat16>(char transa, char transb, int m, int n, int k, 
+	bfloat16 alpha, const bfloat16 *A, int lda, const bfloat16 *B, int ldb, bfloat16 beta, bfloat16 *C, int ldc)
+{
+	gemm16(transa, transb, m, n, k, alpha, A, lda, B, ldb, beta, C, ldc);
+}
+
+template<> void syrk<half>(char uplo, char trans, int n, int k, 
+	half alpha, const half *A, int lda, half beta, half *C, int ldc)
+{
+	syrk16(uplo, trans, n, k, alpha, A, lda, beta, C, ldc);
+}
+
+template<> void syrk<bfloat16>(char uplo, char trans, int n, int k, 
+	bfloat16 alpha, const bfloat16 *A, int lda, bfloat16 beta, bfloat16 *C, int ldc)
+{
+	syrk16(uplo, trans, n, k, alpha, A, lda, beta, C, ldc);
+}
+
+// y^T = alpha * x^T * op(A)^T + beta * y^T as an m = 1 gemm: x and y are
+// 1 row matrices whose leading dimensions are their strides
+template <typename T> void gemv16(char trans, int m, int n, float alpha, const T *A, int lda, 
+	const T *x, int incx, float beta, T *y, int incy)
+{
+	if (incx <= 0 || incy <= 0)
+		throw std::runtime_error("gemv takes positive strides for half and bfloat16");
+
+	bool t = trans == 'T' || trans == 't' || trans == 'C' || trans == 'c';
+	gemm16('N', t ? 'N' : 'T', 1, t ? n : m, t ? m : n, alpha, x, incx, A, lda, beta, y, incy);
+}
+
+template<> void gemv<half>(char trans, int m, int n, half alpha, const half *A, int lda, 
+	const half *x, int incx, half beta, half *y, int incy)
+{
+	gemv16(trans, m, n, alpha, A, lda, x, incx, beta, y, incy);
+}
+
+template<> void gemv<bfloat16>(char trans, int m, int n, bfloat16 alpha, const bfloat16 *A, int lda, 
+	const bfloat16 *x, int incx, bfloat16 beta, bfloat16 *y, int incy)
+{
+	gemv16(trans, m, n, alpha, A, lda, x, incx, beta, y, incy);
+}
 
 //
 //def _row_wise_sum(tgt, src):
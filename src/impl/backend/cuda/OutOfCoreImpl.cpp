@@ -0,0 +1,160 @@
+#include <gpumatrix/Context.h>
+#include <gpumatrix/impl/backend/OutOfCoreInterface.h>
+#include <gpumatrix/impl/backend/ContextInterface.h>
+#include <gpumatrix/impl/backend/BlasInterface.h>
+#include <gpumatrix/Trace.h>
+
+#include <cuda.h>
+#include <cuda_runtime.h>
+
+#include <cstring>
+#include <stdexcept>
+
+namespace gpumatrix
+{
+	namespace impl
+	{
+		static void ooc_check(cudaError_t cudaError)
+		{
+			if (cudaError != cudaSuccess)
+				throw std::runtime_error(cudaGetErrorString(cudaError));
+		}
+
+		// Tiles of one out of core product. Loads go through the pinned
+		// staging of their slot on a stream of their own, multiplies run on the
+		// thread's stream, so slot s+1 uploads while slot s multiplies.
+		// loaded[s] orders the multiply of s after its upload, consumed[s]
+		// orders the next upload into s after that multiply.
+		template <typename T> struct OutOfCoreState
+		{
+			std::size_t tile_rows, tile_cols, tile_depth;
+
+			T * C;
+			T * A[2];
+			T * B[2];
+			T * staging[2];
+
+			cudaStream_t transfer;
+			cudaEvent_t loaded[2];
+			cudaEvent_t consumed[2];
+		};
+
+		std::size_t device_free_bytes()
+		{
+			std::size_t free_bytes = 0, total_bytes = 0;
+			ooc_check(cudaMemGetInfo(&free_bytes,&total_bytes));
+
+			// blocks cached by this thread's context are free to its allocations
+			return free_bytes + cached_bytes();
+		}
+
+		template <typename T> void * ooc_begin(std::size_t tile_rows, std::size_t tile_cols, std::size_t tile_depth)
+		{
+			GPUMATRIX_TRACE_SCOPE("impl::ooc_begin",tile_rows,tile_cols,tile_depth,0,0);
+
+			std::size_t a_size = tile_rows*tile_depth, b_size = tile_depth*tile_cols;
+
+			OutOfCoreState<T> * state = new OutOfCoreState<T>();
+			state->tile_rows = tile_rows;
+			state->tile_cols = tile_cols;
+			state->tile_depth = tile_depth;
+
+			state->C = (T *)context_alloc(tile_rows*tile_cols*sizeof(T));
+			ooc_check(cudaStreamCreateWithFlags(&state->transfer,cudaStreamNonBlocking));
+			for (int s = 0; s < 2; s++)
+			{
+				state->A[s] = (T *)context_alloc(a_size*sizeof(T));
+				state->B[s] = (T *)context_alloc(b_size*sizeof(T));
+				ooc_check(cudaMallocHost((void **)&state->staging[s],(a_size + b_size)*sizeof(T)));
+				ooc_check(cudaEventCreateWithFlags(&state->loaded[s],cudaEventDisableTiming));
+				ooc_check(cudaEventCreateWithFlags(&state->consumed[s],cudaEventDisableTiming));
+			}
+
+			return state;
+		}
+
+		template <typename T> void ooc_load(void * state, int slot, const T *A, std::size_t lda, const T *B, std::size_t ldb,
+			std::size_t rows, std::size_t cols, std::size_t depth)
+		{
+			GPUMATRIX_TRACE_SCOPE("impl::ooc_load",rows,cols,depth,(double(rows)*depth + double(depth)*cols)*sizeof(T),0);
+
+			OutOfCoreState<T> * s = (OutOfCoreState<T> *)state;
+
+			// the previous upload from this staging buffer has to be done with it
+			ooc_check(cudaEventSynchronize(s->loaded[slot]));
+
+			// pack the tiles, so each goes up in one contiguous copy
+			T * a = s->staging[slot];
+			T * b = a + rows*depth;
+			for (std::size_t j = 0; j < depth; j++)
+				std::memcpy(a + j*rows,A + j*lda,rows*sizeof(T));
+			for (std::size_t j = 0; j < cols; j++)
+				std::memcpy(b + j*depth,B + j*ldb,depth*sizeof(T));
+
+			ooc_check(cudaStreamWaitEvent(s->transfer,s->consumed[slot],0));
+			ooc_check(cudaMemcpyAsync(s->A[slot],a,rows*depth*sizeof(T),cudaMemcpyHostToDevice,s->transfer));
+			ooc_check(cudaMemcpyAsync(s->B[slot],b,depth*cols*sizeof(T),cudaMemcpyHostToDevice,s->transfer));
+			ooc_check(cudaEventRecord(s->loaded[slot],s->transfer));
+		}
+
+		template <typename T> void ooc_multiply(void * state, int slot, std::size_t rows, std::size_t cols, std::size_t depth, bool accumulate)
+		{
+			GPUMATRIX_TRACE_SCOPE("impl::ooc_multiply",rows,cols,depth,0,2.0*rows*cols*depth);
+
+			OutOfCoreState<T> * s = (OutOfCoreState<T> *)state;
+
+			ooc_check(cudaStreamWaitEvent(cudaStreamPerThread,s->loaded[slot],0));
+			gemm<T>('N','N',rows,cols,depth,T(1),s->A[slot],rows,s->B[slot],depth,accumulate ? T(1) : T(0),s->C,rows);
+			ooc_check(cudaEventRecord(s->consumed[slot],cudaStreamPerThread));
+		}
+
+		template <typename T> void ooc_store(void * state, T *C, std::size_t ldc, std::size_t rows, std::size_t cols)
+		{
+			GPUMATRIX_TRACE_SCOPE("impl::ooc_store",rows,cols,0,double(rows)*cols*sizeof(T),0);
+
+			OutOfCoreState<T> * s = (OutOfCoreState<T> *)state;
+
+			ooc_check(cudaMemcpy2DAsync(C,ldc*sizeof(T),s->C,rows*sizeof(T),rows*sizeof(T),cols,cudaMemcpyDeviceToHost,cudaStreamPerThread));
+			ooc_check(cudaStreamSynchronize(cudaStreamPerThread));
+		}
+
+		template <typename T> void ooc_end(void * state)
+		{
+			GPUMATRIX_TRACE_SCOPE("impl::ooc_end",0,0,0,0,0);
+
+			OutOfCoreState<T> * s = (OutOfCoreState<T> *)state;
+
+			// release everything before reporting a failure of the pending work
+			cudaError_t cudaError = cudaStreamSynchronize(s->transfer);
+			cudaError_t perThreadError = cudaStreamSynchronize(cudaStreamPerThread);
+
+			context_free(s->C);
+			for (int slot = 0; slot < 2; slot++)
+			{
+				context_free(s->A[slot]);
+				context_free(s->B[slot]);
+				cudaFreeHost(s->staging[slot]);
+				cudaEventDestroy(s->loaded[slot]);
+				cudaEventDestroy(s->consumed[slot]);
+			}
+			cudaStreamDestroy(s->transfer);
+			delete s;
+
+			ooc_check(cudaError);
+			ooc_check(perThreadError);
+		}
+
+		template void * ooc_begin<float>(std::size_t tile_rows, std::size_t tile_cols, std::size_t tile_depth);
+		template void * ooc_begin<double>(std::size_t tile_rows, std::size_t tile_cols, std::size_t tile_depth);
+		template void ooc_load<float>(void * state, int slot, const float *A, std::size_t lda, const float *B, std::size_t ldb,
+			std::size_t rows, std::size_t cols, std::size_t depth);
+		template void ooc_load<double>(void * state, int slot, const double *A, std::size_t lda, const double *B, std::size_t ldb,
+			std::size_t rows, std::size_t cols, std::size_t depth);
+		template void ooc_multiply<float>(void * state, int slot, std::size_t rows, std::size_t cols, std::size_t depth, bool accumulate);
+		template void ooc_multiply<double>(void * state, int slot, std::size_t rows, std::size_t cols, std::size_t depth, bool accumulate);
+		template void ooc_store<float>(void * state, float *C, std::size_t ldc, std::size_t rows, std::size_t cols);
+		template void ooc_store<double>(void * state, double *C, std::size_t ldc, std::size_t rows, std::size_t cols);
+		template void ooc_end<float>(void * state);
+		template void ooc_end<double>(void * state);
+	}
+}
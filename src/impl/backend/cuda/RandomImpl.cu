@@ -0,0 +1,141 @@
+#include <cuda.h>
+#include <cublas.h>
+#include <cuda_runtime.h>
+
+#include <gpumatrix/impl/backend/RandomInterface.h>
+#include <gpumatrix/Trace.h>
+
+namespace gpumatrix
+{
+	namespace impl
+	{
+		// One thread per Philox block, striding over the grid when there
+		// are more blocks. Block b writes elements b*K .. b*K+K-1, so element
+		// i only depends on (seed, offset, i).
+
+		__device__ inline void philox_uniform(float * u, const Philox4x32 & r)
+		{
+			for (int k = 0; k < 4; ++k)
+				u[k] = philox_unit_float(r.v[k]);
+		}
+
+		__device__ inline void philox_uniform(double * u, const Philox4x32 & r)
+		{
+			u[0] = philox_unit_double(r.v[0], r.v[1]);
+			u[1] = philox_unit_double(r.v[2], r.v[3]);
+		}
+
+		// Box-Muller on consecutive pairs; 1-u keeps the log argument in (0,1]
+		__device__ inline void box_muller(float & z0, float & z1, float u0, float u1)
+		{
+			float r = sqrtf(-2.0f*logf(1.0f - u0));
+			float s, c;
+			sincospif(2.0f*u1, &s, &c);
+			z0 = r*c;
+			z1 = r*s;
+		}
+
+		__device__ inline void box_muller(double & z0, double & z1, double u0, double u1)
+		{
+			double r = sqrt(-2.0*log(1.0 - u0));
+			double s, c;
+			sincospi(2.0*u1, &s, &c);
+			z0 = r*c;
+			z1 = r*s;
+		}
+
+		// low + (high - low)*u can round up to high even though u < 1, so
+		// the result is clamped to the largest value below high.
+		__device__ inline float uniform_below(float x, float low, float high)
+		{
+			return x < high ? x : nextafterf(high, low);
+		}
+
+		__device__ inline double uniform_below(double x, double low, double high)
+		{
+			return x < high ? x : nextafter(high, low);
+		}
+
+		template <typename T>
+		__global__ void _random_uniform(T *odata, std::size_t size, T low, T high, unsigned long long seed, unsigned long long offset)
+		{
+			const int K = PhiloxValuesPerBlock<T>::value;
+			std::size_t blocks = (size + K - 1)/K;
+
+			GPUMATRIX_ELEMENTWISE_LOOP(block, blocks,
+				std::size_t first = block*(std::size_t)K;
+				T u[K];
+				philox_uniform(u, Philox4x32(offset + block, seed));
+
+				for (int k = 0; k < K && first + k < size; ++k)
+					odata[first + k] = uniform_below(low + (high - low)*u[k], low, high);
+			)
+		}
+
+		template <typename T>
+		__global__ void _random_normal(T *odata, std::size_t size, T mean, T stddev, unsigned long long seed, unsigned long long offset)
+		{
+			const int K = PhiloxValuesPerBlock<T>::value;
+			std::size_t blocks = (size + K - 1)/K;
+
+			GPUMATRIX_ELEMENTWISE_LOOP(block, blocks,
+				std::size_t first = block*(std::size_t)K;
+				T u[K];
+				T z[K];
+				philox_uniform(u, Philox4x32(offset + block, seed));
+
+				for (int k = 0; k < K; k += 2)
+					box_muller(z[k], z[k+1], u[k], u[k+1]);
+
+				for (int k = 0; k < K && first + k < size; ++k)
+					odata[first + k] = mean + stddev*z[k];
+			)
+		}
+
+		template <typename T>
+		__global__ void _random_bernoulli(T *odata, std::size_t size, T p, unsigned long long seed, unsigned long long offset)
+		{
+			const int K = PhiloxValuesPerBlock<T>::value;
+			std::size_t blocks = (size + K - 1)/K;
+
+			GPUMATRIX_ELEMENTWISE_LOOP(block, blocks,
+				std::size_t first = block*(std::size_t)K;
+				T u[K];
+				philox_uniform(u, Philox4x32(offset + block, seed));
+
+				for (int k = 0; k < K && first + k < size; ++k)
+					odata[first + k] = u[k] < p ? T(1) : T(0);
+			)
+		}
+
+#define RANDOM_OP(TYPE) \
+	\
+			void random_uniform( TYPE *odata, std::size_t size, TYPE low, TYPE high, unsigned long long seed, unsigned long long offset)  \
+			{																						\
+				GPUMATRIX_TRACE_SCOPE("impl::random_uniform",size,0,0,double(size)*sizeof(TYPE),0);		\
+			std::size_t blocks = (size + PhiloxValuesPerBlock<TYPE>::value - 1)/PhiloxValuesPerBlock<TYPE>::value;	\
+			unsigned int numGrid = elementwise_blocks(blocks);													\
+			_random_uniform<TYPE><<<numGrid,ElementwiseThreads>>>(odata, size, low, high, seed, offset);			\
+			}																						\
+			\
+			void random_normal( TYPE *odata, std::size_t size, TYPE mean, TYPE stddev, unsigned long long seed, unsigned long long offset)  \
+			{																						\
+				GPUMATRIX_TRACE_SCOPE("impl::random_normal",size,0,0,double(size)*sizeof(TYPE),0);		\
+			std::size_t blocks = (size + PhiloxValuesPerBlock<TYPE>::value - 1)/PhiloxValuesPerBlock<TYPE>::value;	\
+			unsigned int numGrid = elementwise_blocks(blocks);													\
+			_random_normal<TYPE><<<numGrid,ElementwiseThreads>>>(odata, size, mean, stddev, seed, offset);			\
+			}																						\
+			\
+			void random_bernoulli( TYPE *odata, std::size_t size, TYPE p, unsigned long long seed, unsigned long long offset)  \
+			{																						\
+				GPUMATRIX_TRACE_SCOPE("impl::random_bernoulli",size,0,0,double(size)*sizeof(TYPE),0);		\
+			std::size_t blocks = (size + PhiloxValuesPerBlock<TYPE>::value - 1)/PhiloxValuesPerBlock<TYPE>::value;	\
+			unsigned int numGrid = elementwise_blocks(blocks);													\
+			_random_bernoulli<TYPE><<<numGrid,ElementwiseThreads>>>(odata, size, p, seed, offset);					\
+			}
+
+			RANDOM_OP(float)
+			RANDOM_OP(double)
+
+	}
+}
@@ -0,0 +1,190 @@
+#include <cuda.h>
+#include <cublas.h>
+#include <cuda_runtime.h>
+
+#include <gpumatrix/impl/backend/SparseInterface.h>
+#include <gpumatrix/Trace.h>
+
+namespace gpumatrix
+{
+	namespace impl
+	{
+		// The second grid dimension is capped, kernels stride over it
+		static const int SparseMaxGridY = 65535;
+
+		__device__ inline void sparse_atomic_add(float * p, float v)
+		{
+			atomicAdd(p, v);
+		}
+
+		__device__ inline void sparse_atomic_add(double * p, double v)
+		{
+#if __CUDA_ARCH__ >= 600
+			atomicAdd(p, v);
+#else
+			unsigned long long * a = (unsigned long long *)p;
+			unsigned long long old = *a, assumed;
+			do
+			{
+				assumed = old;
+				old = atomicCAS(a, assumed, __double_as_longlong(v + __longlong_as_double(assumed)));
+			} while (assumed != old);
+#endif
+		}
+
+		// C = A*B, A is m x k: thread (i, j) sums row i of A against column j of B
+		template <typename T>
+		__global__ void _csrmm_gather(int m, int n, int k, const int * outer, const int * inner, const T * values, const T * B, T * C)
+		{
+			int i = blockIdx.x * blockDim.x + threadIdx.x;
+			if (i >= m)
+				return;
+
+			int begin = outer[i], end = outer[i+1];
+			for (int j = blockIdx.y; j < n; j += gridDim.y)
+			{
+				const T * b = B + (size_t)j*k;
+				T sum = 0;
+				for (int p = begin; p < end; ++p)
+					sum += values[p]*b[inner[p]];
+				C[i + (size_t)j*m] = sum;
+			}
+		}
+
+		// C += A^T*B, A is k x m: thread (r, j) scatters row r of A times B(r,j) into column j of C
+		template <typename T>
+		__global__ void _csrmm_scatter(int m, int n, int k, const int * outer, const int * inner, const T * values, const T * B, T * C)
+		{
+			int r = blockIdx.x * blockDim.x + threadIdx.x;
+			if (r >= k)
+				return;
+
+			int begin = outer[r], end = outer[r+1];
+			for (int j = blockIdx.y; j < n; j += gridDim.y)
+			{
+				T b = B[r + (size_t)j*k];
+				T * c = C + (size_t)j*m;
+				for (int p = begin; p < end; ++p)
+					sparse_atomic_add(c + inner[p], values[p]*b);
+			}
+		}
+
+		// C = B*A^T, A is n x k: thread (i, j) sums row i of B against row j of A
+		template <typename T>
+		__global__ void _csrmm_right_gather(int m, int n, int k, const int * outer, const int * inner, const T * values, const T * B, T * C)
+		{
+			int i = blockIdx.x * blockDim.x + threadIdx.x;
+			if (i >= m)
+				return;
+
+			for (int j = blockIdx.y; j < n; j += gridDim.y)
+			{
+				T sum = 0;
+				for (int p = outer[j]; p < outer[j+1]; ++p)
+					sum += B[i + (size_t)inner[p]*m]*values[p];
+				C[i + (size_t)j*m] = sum;
+			}
+		}
+
+		// C += B*A, A is k x n: thread (i, r) scatters B(i,r) times row r of A into row i of C
+		template <typename T>
+		__global__ void _csrmm_right_scatter(int m, int n, int k, const int * outer, const int * inner, const T * values, const T * B, T * C)
+		{
+			int i = blockIdx.x * blockDim.x + threadIdx.x;
+			if (i >= m)
+				return;
+
+			for (int r = blockIdx.y; r < k; r += gridDim.y)
+			{
+				T b = B[i + (size_t)r*m];
+				for (int p = outer[r]; p < outer[r+1]; ++p)
+					sparse_atomic_add(C + i + (size_t)inner[p]*m, b*values[p]);
+			}
+		}
+
+		// y = A*x, one warp per row: the lanes stride the row, then fold in shared memory
+		template <typename T>
+		__global__ void _csrmv_vector(int m, const int * outer, const int * inner, const T * values, const T * x, T * y)
+		{
+			__shared__ T partial[256];
+
+			int lane = threadIdx.x & 31;
+			int row = (blockIdx.x * blockDim.x + threadIdx.x) >> 5;
+
+			T sum = 0;
+			if (row < m)
+				for (int p = outer[row] + lane; p < outer[row+1]; p += 32)
+					sum += values[p]*x[inner[p]];
+			partial[threadIdx.x] = sum;
+
+			for (int s = 16; s > 0; s >>= 1)
+			{
+				__syncthreads();
+				if (lane < s)
+					partial[threadIdx.x] += partial[threadIdx.x + s];
+			}
+
+			if (lane == 0 && row < m)
+				y[row] = partial[threadIdx.x];
+		}
+
+		static dim3 sparse_grid(int x, int y)
+		{
+			return dim3((x + 256 -1)/256, y < SparseMaxGridY ? y : SparseMaxGridY);
+		}
+
+#define SPARSE_OP(TYPE) \
+	\
+			void csrmm(char trans, int m, int n, int k, int nnz, const int * outer, const int * inner, const TYPE * values, const TYPE * B, TYPE * C)	\
+			{																						\
+				GPUMATRIX_TRACE_SCOPE("impl::csrmm",m,n,k,double(nnz)*(sizeof(TYPE) + sizeof(int)) + (double(k) + m)*n*sizeof(TYPE),2.0*nnz*n);	\
+			if (m == 0 || n == 0)																	\
+				return;																				\
+			if (trans == 'N')																		\
+				_csrmm_gather<TYPE><<<sparse_grid(m,n),256>>>(m, n, k, outer, inner, values, B, C);	\
+			else																					\
+			{																						\
+				cudaMemset(C, 0, sizeof(TYPE)*m*n);													\
+				if (k > 0)																			\
+					_csrmm_scatter<TYPE><<<sparse_grid(k,n),256>>>(m, n, k, outer, inner, values, B, C);	\
+			}																						\
+			}																						\
+			\
+			void csrmm_right(char trans, int m, int n, int k, int nnz, const int * outer, const int * inner, const TYPE * values, const TYPE * B, TYPE * C)	\
+			{																						\
+				GPUMATRIX_TRACE_SCOPE("impl::csrmm_right",m,n,k,double(nnz)*(sizeof(TYPE) + sizeof(int)) + (double(k) + n)*m*sizeof(TYPE),2.0*nnz*m);	\
+			if (m == 0 || n == 0)																	\
+				return;																				\
+			if (trans == 'T')																		\
+				_csrmm_right_gather<TYPE><<<sparse_grid(m,n),256>>>(m, n, k, outer, inner, values, B, C);	\
+			else																					\
+			{																						\
+				cudaMemset(C, 0, sizeof(TYPE)*m*n);													\
+				if (k > 0)																			\
+					_csrmm_right_scatter<TYPE><<<sparse_grid(m,k),256>>>(m, n, k, outer, inner, values, B, C);	\
+			}																						\
+			}																						\
+			\
+			void csrmv(char trans, int m, int k, int nnz, const int * outer, const int * inner, const TYPE * values, const TYPE * x, TYPE * y)	\
+			{																						\
+				GPUMATRIX_TRACE_SCOPE("impl::csrmv",m,0,k,double(nnz)*(sizeof(TYPE) + sizeof(int)) + (double(k) + m)*sizeof(TYPE),2.0*nnz);	\
+			if (m == 0)																				\
+				return;																				\
+			if (trans == 'N')																		\
+			{																						\
+				int numGrid = (m + 8 -1)/8;															\
+				_csrmv_vector<TYPE><<<numGrid,256>>>(m, outer, inner, values, x, y);				\
+			}																						\
+			else																					\
+			{																						\
+				cudaMemset(y, 0, sizeof(TYPE)*m);													\
+				if (k > 0)																			\
+					_csrmm_scatter<TYPE><<<sparse_grid(k,1),256>>>(m, 1, k, outer, inner, values, x, y);	\
+			}																						\
+			}
+
+			SPARSE_OP(float)
+			SPARSE_OP(double)
+
+	}
+}
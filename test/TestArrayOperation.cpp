@@ -8,6 +8,7 @@
 //
 #include <tut/tut.hpp>
 #include <stdexcept>
+#include <climits>
 #include <ctime>
 #include <iostream>
 #include "Util.h"
@@ -149,4 +150,177 @@ namespace tut
 		}
 	}
 
-}
\ No newline at end of file
+	// Test Comparison Masks, Select and Masked Reductions
+	template<>
+	template<>
+	void object::test<5>()
+	{
+		typedef Eigen::Matrix<bool,Eigen::Dynamic,Eigen::Dynamic> MatrixXb;
+
+		for (int i = 0;i<10;i++)
+		{
+			int row = rand()%1000+1;
+			int col = rand()%1000+1;
+
+			Eigen::MatrixXd h_A = Eigen::MatrixXd::Random(row,col);
+			Eigen::MatrixXd h_B = Eigen::MatrixXd::Random(row,col);
+
+			gpumatrix::Matrix<double> d_A(h_A), d_B(h_B), d_R;
+
+			// ReLU
+			d_R = select(d_A.array() > 0, d_A.array(), 0).matrix();
+			Eigen::MatrixXd h_R = (h_A.array() > 0).select(h_A.array(), 0.0).matrix();
+
+			ensure(check_diff(h_R,d_R));
+
+			Mask d_M = d_A.array() > d_B.array();
+			MatrixXb h_M = (h_A.array() > h_B.array()).matrix();
+
+			ensure(h_M == (MatrixXb)d_M);
+			ensure(count(d_M) == (std::size_t)h_M.count());
+
+			// literal on the left uses the mirrored comparison
+			Mask d_L = 0.5 < d_A.array();
+			MatrixXb h_L = (h_A.array() > 0.5).matrix();
+
+			ensure(h_L == (MatrixXb)d_L);
+
+			// operands of different element types are promoted
+			gpumatrix::Matrix<float> d_F(h_B.cast<float>());
+			Eigen::MatrixXd h_F = h_B.cast<float>().cast<double>();
+
+			Mask d_P = d_A.array() > d_F.array();
+			MatrixXb h_P = (h_A.array() > h_F.array()).matrix();
+
+			ensure(h_P == (MatrixXb)d_P);
+
+			d_R = select(d_P, d_F.array(), d_A.array()).matrix();
+			h_R = h_P.array().select(h_F.array(), h_A.array()).matrix();
+
+			ensure(check_diff(h_R,d_R));
+
+			Mask d_N = !d_M;
+			ensure(count(d_N) + count(d_M) == (std::size_t)(row*col));
+
+			d_R = select(d_M, d_A.array(), d_B.array()).matrix();
+			h_R = h_M.array().select(h_A.array(), h_B.array()).matrix();
+
+			ensure(check_diff(h_R,d_R));
+
+			double d_sum = masked_sum(d_A.array(), d_M && (d_A.array() < 0.5));
+			double h_sum = (h_M.array() && (h_A.array() < 0.5)).select(h_A.array(), 0.0).sum();
+
+			ensure(std::abs(d_sum - h_sum) < 1e-8*row*col);
+		}
+	}
+
+	// Test Binary Functions with a Scalar on Either Side
+	template<>
+	template<>
+	void object::test<6>()
+	{
+		for (int i = 0;i<10;i++)
+		{
+			int row = rand()%1000+1;
+			int col = rand()%1000+1;
+
+			Eigen::MatrixXd h_A = Eigen::MatrixXd::Random(row,col);
+			Eigen::MatrixXd h_B = Eigen::MatrixXd::Random(row,col);
+			Eigen::MatrixXd h_P = h_A.array().abs() + 0.1;
+
+			gpumatrix::Matrix<double> d_A(h_A), d_B(h_B), d_P(h_P), d_R;
+
+			d_R = cwiseMax(d_A.array(), 0).matrix();
+			ensure(check_diff(Eigen::MatrixXd(h_A.array().max(0.0).matrix()),d_R));
+
+			d_R = cwiseMin(d_A.array(), d_B.array()).matrix();
+			ensure(check_diff(Eigen::MatrixXd(h_A.array().min(h_B.array()).matrix()),d_R));
+
+			d_R = cwiseMin(d_A, 2*d_B);
+			ensure(check_diff(Eigen::MatrixXd(h_A.array().min(2*h_B.array()).matrix()),d_R));
+
+			d_R = pow(d_P.array(), 1.5).matrix();
+			ensure(check_diff(Eigen::MatrixXd(h_P.array().pow(1.5).matrix()),d_R));
+
+			d_R = pow(2.0, d_A.array()).matrix();
+			ensure(check_diff(Eigen::MatrixXd((h_A.array()*std::log(2.0)).exp().matrix()),d_R));
+
+			d_R = pow(d_P, 2);
+			ensure(check_diff(Eigen::MatrixXd(h_P.array().square().matrix()),d_R));
+
+			Eigen::MatrixXd h_R(row,col);
+			for (int k = 0; k < row*col; k++)
+				h_R(k) = std::atan2(h_A(k), h_B(k));
+
+			d_R = atan2(d_A.array(), d_B.array()).matrix();
+			ensure(check_diff(h_R,d_R));
+
+			for (int k = 0; k < row*col; k++)
+				h_R(k) = std::hypot(h_A(k), 0.5);
+
+			d_R = hypot(d_A.array(), 0.5).matrix();
+			ensure(check_diff(h_R,d_R));
+
+			for (int k = 0; k < row*col; k++)
+				h_R(k) = std::fmod(3.0, h_P(k));
+
+			d_R = fmod(3.0, d_P.array()).matrix();
+			ensure(check_diff(h_R,d_R));
+		}
+	}
+
+	// Test Launch Geometry and Element Wise Kernels past 2^31 Elements
+	template<>
+	template<>
+	void object::test<7>()
+	{
+		const std::size_t big = (std::size_t(1) << 31) + 64;
+		const std::size_t sizes[] = { 0, 1, 255, 256, 257, impl::Index32Max, impl::Index32Max + 1, big, 3*big + 7, std::size_t(1) << 36 };
+
+		for (std::size_t size : sizes)
+		{
+			std::size_t blocks = impl::elementwise_blocks(size);
+			std::size_t threads = blocks*impl::ElementwiseThreads;
+
+			ensure(blocks >= 1 && blocks <= impl::ElementwiseMaxBlocks);
+
+			// one thread per element while the grid allows, past that every
+			// thread strides over the largest grid
+			if (size <= impl::ElementwiseMaxBlocks*impl::ElementwiseThreads)
+				ensure(threads >= size && (size == 0 || threads - size < impl::ElementwiseThreads));
+			else
+				ensure(threads == impl::ElementwiseMaxBlocks*impl::ElementwiseThreads);
+
+			// the 32 bit loop never wraps stepping past its last index
+			if (size > 0 && size <= impl::Index32Max)
+				ensure(size - 1 + threads <= 0xffffffffu);
+
+			// cuBLAS level 1 chunks fit an int and cover the array once
+			std::size_t covered = impl::blas_chunk(size,0);
+			for (std::size_t i = impl::BlasChunk; i < size; i += impl::BlasChunk)
+			{
+				ensure(impl::blas_chunk(size,i) > 0 && impl::blas_chunk(size,i) <= INT_MAX);
+				covered += impl::blas_chunk(size,i);
+			}
+			ensure(covered == size);
+		}
+
+		// a mask past 2^31 entries, whose last entries an int size never reached
+		std::size_t free_bytes = 0, total_bytes = 0;
+		cudaMemGetInfo(&free_bytes,&total_bytes);
+		if (free_bytes < 2*big + (std::size_t(1) << 28))
+			return;
+
+		bool last = true;
+		Mask d_M(big,1);
+		impl::zero(d_M.data(),big);
+		impl::set(d_M.data() + big - 1,&last,1);
+
+		ensure(impl::count(d_M.data(),big) == 1);
+
+		Mask d_N = !d_M;
+
+		ensure(impl::count(d_N.data(),big) == big - 1);
+	}
+
+}
\ No newline at end of file
@@ -4,6 +4,12 @@
 #include <gpumatrix/Matrix.h>
 #include <gpumatrix/Vector.h>
 #include <gpumatrix/Array.h>
+#include <gpumatrix/Storage.h>
+#include <gpumatrix/Csv.h>
+#include <gpumatrix/OutOfCore.h>
+#include <gpumatrix/Trace.h>
+#include <gpumatrix/Materialize.h>
+#include <gpumatrix/Context.h>
 
 
 
@@ -13,6 +19,11 @@
 #include <stdexcept>
 #include <ctime>
 #include <iostream>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include <type_traits>
 
 using std::runtime_error;
 using namespace std;
@@ -460,6 +471,614 @@ namespace tut
 		}
 	}
 
+	// Test Random Matrix Generation
+	template<>
+	template<>
+	void object::test<12>()
+	{
+		// Philox4x32-10 known answer, counter 0 and key 0
+		gpumatrix::impl::Philox4x32 r(0,0);
+		ensure(r.v[0] == 0x6627e8d5u && r.v[1] == 0xe169c58du && r.v[2] == 0xbc57ac4cu && r.v[3] == 0x9b00dbd8u);
+
+		int row = 500, col = 401;
+
+		set_random_seed(42);
+		Eigen::MatrixXd h_U = Matrix<double>::Random(row,col);
+		Eigen::MatrixXd h_N = Matrix<double>::Normal(row,col);
+		Eigen::MatrixXd h_B = Matrix<double>::Bernoulli(row,col,0.3);
+		Eigen::MatrixXf h_F = Matrix<float>::Uniform(row,col,2,3);
+
+		// same seed, same sequence of calls: same bits
+		set_random_seed(42);
+		ensure(h_U == (Eigen::MatrixXd)Matrix<double>::Random(row,col));
+		ensure(h_N == (Eigen::MatrixXd)Matrix<double>::Normal(row,col));
+		ensure(h_B == (Eigen::MatrixXd)Matrix<double>::Bernoulli(row,col,0.3));
+		ensure(h_F == (Eigen::MatrixXf)Matrix<float>::Uniform(row,col,2,3));
+
+		// the stream moves on between calls
+		ensure(h_U != (Eigen::MatrixXd)Matrix<double>::Random(row,col));
+
+		double n = row*col;
+
+		ensure(h_U.minCoeff() >= -1 && h_U.maxCoeff() < 1);
+		ensure(std::abs(h_U.mean()) < 0.01);
+
+		ensure(h_F.minCoeff() >= 2 && h_F.maxCoeff() < 3);
+
+		// one ulp wide, so half the unclamped values would round up to high
+		float high = std::nextafter(1.0f,2.0f);
+		Eigen::MatrixXf h_T = Matrix<float>::Uniform(row,col,1.0f,high);
+		ensure(h_T.minCoeff() == 1.0f && h_T.maxCoeff() < high);
+
+		double var = (h_N.array() - h_N.mean()).square().sum()/n;
+		ensure(std::abs(h_N.mean()) < 0.01);
+		ensure(std::abs(var - 1) < 0.02);
+
+		ensure(((h_B.array() == 0) || (h_B.array() == 1)).all());
+		ensure(std::abs(h_B.mean() - 0.3) < 0.01);
+	}
+
+	// Test Binary Storage
+	template<>
+	template<>
+	void object::test<13>()
+	{
+		const char * path = "TestGPUMatrix.gmx";
+
+		Eigen::MatrixXd h_A = Eigen::MatrixXd::Random(300,77);
+		Eigen::VectorXf h_v = Eigen::VectorXf::Random(1001);
+		Eigen::ArrayXXd h_R = Eigen::ArrayXXd::Random(5,9);
+		Eigen::MatrixXf h_H = Eigen::MatrixXf::Random(17,3);
+
+		// small chunks so every payload takes several trips
+		set_storage_chunk_bytes(4096);
+
+		{
+			StorageWriter writer(path);
+			writer.write("A",Matrix<double>(h_A));
+			writer.write("v",Vector<float>(h_v));
+			writer.write("R",Array<double,2>(h_R));
+			writer.write("H",h_H.data(),h_H.rows(),h_H.cols());
+		}
+
+		StorageFile file(path);
+		ensure(file.size() == 4);
+		ensure(file.contains("R") && !file.contains("B"));
+
+		for (std::size_t i = 0; i < file.size(); ++i)
+			ensure(file.record(i).offset % file.alignment() == 0);
+
+		ensure(file.find("A").rank == 2 && file.find("v").rank == 1);
+		ensure(file.map<double>("A") == h_A);
+		ensure(file.map<float>("H") == h_H);
+
+		Matrix<double> d_A;
+		file.load("A",d_A);
+		ensure(h_A == (Eigen::MatrixXd)d_A);
+
+		Vector<float> d_v;
+		file.load("v",d_v);
+		ensure(h_v == (Eigen::VectorXf)d_v);
+
+		Array<double,2> d_R;
+		file.load("R",d_R);
+		ensure(h_R.matrix() == (Eigen::MatrixXd)d_R);
+
+		// float on disk into a double matrix
+		Matrix<double> d_H;
+		file.load("H",d_H);
+		ensure(h_H.cast<double>() == (Eigen::MatrixXd)d_H);
+
+		set_storage_chunk_bytes(16 << 20);
+		std::remove(path);
+	}
+
+	// Test CSV Reader and Writer
+	template<>
+	template<>
+	void object::test<14>()
+	{
+		const char * path = "TestGPUMatrix.csv";
+
+		Eigen::MatrixXd h_A = Eigen::MatrixXd::Random(5000,40);
+		h_A(3,4) = 1e300;
+		h_A(5,6) = -2.5e-310;
+		h_A(7,1) = 123456789012345678901234.0;
+
+		// default precision round trips exactly
+		Matrix<double> d_A(h_A), d_B;
+		write_csv(path,d_A);
+		read_csv(path,d_B);
+		ensure(h_A == (Eigen::MatrixXd)d_B);
+
+		// tab separated with a header on a fixed number of threads
+		Eigen::MatrixXf h_F = Eigen::MatrixXf::Random(333,7);
+		CsvFormat tsv('\t',true);
+		tsv.threads = 3;
+
+		Matrix<float> d_F(h_F), d_G;
+		write_csv(path,d_F,tsv);
+		read_csv(path,d_G,tsv);
+		ensure(h_F == (Eigen::MatrixXf)d_G);
+
+		{
+			std::ofstream out(path);
+			out << "a,b\r\n 1 , 2\r\n\r\n-inf,0.25\r\n0.1,1e-5";
+		}
+		read_csv(path,d_B,CsvFormat(',',true));
+		Eigen::MatrixXd h_B = d_B;
+		ensure(h_B.rows() == 3 && h_B.cols() == 2);
+		ensure(h_B(0,1) == 2 && h_B(1,0) == -HUGE_VAL && h_B(2,0) == 0.1 && h_B(2,1) == 1e-5);
+
+		{
+			std::ofstream out(path);
+			out << "1,2,3\n4,5\n";
+		}
+		bool thrown = false;
+		try
+		{
+			read_csv(path,d_B);
+		}
+		catch (std::runtime_error &)
+		{
+			thrown = true;
+		}
+		ensure(thrown);
+
+		// space separated, padded only by the delimiter itself
+		{
+			std::ofstream out(path);
+			out << "1 2 3\n4 \t5 6\r\n";
+		}
+		read_csv(path,d_B,CsvFormat(' '));
+		h_B = d_B;
+		ensure(h_B.rows() == 2 && h_B.cols() == 3);
+		ensure(h_B(0,2) == 3 && h_B(1,0) == 4 && h_B(1,1) == 5 && h_B(1,2) == 6);
+
+		write_csv(path,d_F,CsvFormat(' '));
+		read_csv(path,d_G,CsvFormat(' '));
+		ensure(h_F == (Eigen::MatrixXf)d_G);
+
+		std::remove(path);
+	}
+
+	// Test Op Tracing
+	template<>
+	template<>
+	void object::test<15>()
+	{
+		Eigen::MatrixXd h_A = Eigen::MatrixXd::Random(30,20);
+
+		clear_trace();
+		set_tracing(true);
+
+		Matrix<double> d_A(h_A), d_B;
+		d_B = d_A.transpose();
+		Eigen::MatrixXd h_B = d_B;
+
+		std::thread worker([&h_A]() { Matrix<double> d_C(h_A); });
+		worker.join();
+
+		set_tracing(false);
+		Matrix<double> d_D(h_A);
+
+		std::ostringstream os;
+		write_chrome_trace(os);
+		std::string json = os.str();
+
+		ensure(json.find("\"traceEvents\":[") != std::string::npos);
+		ensure(h_B == h_A.transpose());
+
+#if defined(GPUMATRIX_TRACE)
+		ensure(json.find("\"name\":\"impl::set\"") != std::string::npos);
+		ensure(json.find("\"name\":\"impl::get\"") != std::string::npos);
+		ensure(json.find("\"name\":\"impl::transpose\"") != std::string::npos);
+		ensure(json.find("\"m\":600") != std::string::npos);
+		ensure(json.find("XprMatrixTranspose") != std::string::npos);
+		ensure(json.find("\"tid\":1") != std::string::npos && json.find("\"tid\":2") != std::string::npos);
+
+		// one alloc and one set for each of d_A and d_C, nothing once stopped
+		std::size_t sets = 0;
+		for (std::size_t p = json.find("impl::set"); p != std::string::npos; p = json.find("impl::set",p + 1))
+			sets++;
+		ensure(sets == 2);
+
+		// the ring keeps the newest events
+		set_trace_capacity(3);
+		clear_trace();
+		set_tracing(true);
+		for (int i = 0; i < 10; i++)
+			d_A = d_D;
+		set_tracing(false);
+
+		os.str("");
+		write_chrome_trace(os);
+		json = os.str();
+		std::size_t events = 0;
+		for (std::size_t p = json.find("\"ph\":\"X\""); p != std::string::npos; p = json.find("\"ph\":\"X\"",p + 1))
+			events++;
+		ensure(events == 3);
+
+		set_trace_capacity(1 << 16);
+		clear_trace();
+#endif
+	}
+
+	// Test Materialization Report
+	template<>
+	template<>
+	void object::test<16>()
+	{
+		Eigen::MatrixXd h_A = Eigen::MatrixXd::Random(30,30);
+		Eigen::MatrixXd h_C = Eigen::MatrixXd::Random(30,30);
+		Matrix<double> d_A(h_A), d_C(h_C), d_B;
+		Vector<double> d_x(30);
+
+		static_assert(temporaries<Matrix<double>>() == 0, "");
+		static_assert(temporaries<decltype(d_A.transpose())>() == 1, "");
+		static_assert(temporaries<decltype(d_A.transpose())>(true) == 0, "");
+		static_assert(temporaries<decltype(d_A*d_C)>(true) == 0, "");
+		static_assert(temporaries<decltype((d_A + d_C)*d_A)>() == 2, "");
+		static_assert(temporaries<decltype((d_A + d_C)*d_A)>(true) == 1, "");
+		static_assert(temporaries<decltype((d_A*d_C).transpose()*(d_A + d_C))>(true) == 2, "");
+		static_assert(temporaries<decltype(d_A.transpose()*d_x)>(true) == 0, "");
+		static_assert(temporaries<decltype((d_A.array()*d_C.array()).exp())>(true) == 1, "");
+
+		XprCost cost = xpr_cost((d_A + d_C)*d_A,true);
+		ensure(cost.temporaries == 1);
+		ensure(cost.flops == 2.0*30*30*30 + 30*30);
+		ensure(cost.bytes == (3 + 3)*30*30*sizeof(double));
+
+		cost = xpr_cost(d_A.transpose()*d_x);
+		ensure(cost.temporaries == 1 && cost.flops == 2.0*30*30);
+		ensure(cost.bytes == (30*30 + 30 + 30 + 2*30)*sizeof(double));
+
+		std::ostringstream log;
+		set_materialize_log(&log);
+		reset_materialize_stats();
+
+		d_B.noalias() = d_A.transpose();
+		ensure(materialize_stats().count == 0);
+
+		d_B = d_A.transpose();
+		ensure(materialize_stats().count == 1);
+		ensure(materialize_stats().bytes == 30*30*sizeof(double));
+
+		d_B.noalias() = (d_A + d_C).transpose();
+		ensure(materialize_stats().count == 2);
+
+		set_materialize_log(0);
+		d_B = (d_A + d_C).transpose();
+		ensure(materialize_stats().count == 4);
+
+		ensure(log.str().find("assignment without noalias()") != std::string::npos);
+		ensure(log.str().find("operand of a kernel") != std::string::npos);
+		ensure(log.str().find("XprMatrixTranspose") != std::string::npos);
+		ensure(log.str().find("XprBinOp") != std::string::npos);
+
+		Eigen::MatrixXd h_B = d_B;
+		ensure((h_B - (h_A + h_C).transpose()).norm() < 1e-12);
+	}
+
+	// Test Per Thread Contexts
+	template<>
+	template<>
+	void object::test<17>()
+	{
+		const int threads = 4;
+		std::vector<double> errors(threads,1);
+		std::vector<std::size_t> live(threads,1), cached(threads,1), released(threads,1);
+
+		std::vector<std::thread> workers;
+		for (int t = 0; t < threads; t++)
+			workers.push_back(std::thread([t,&errors,&live,&cached,&released]() {
+				Eigen::MatrixXd h_A = Eigen::MatrixXd::Random(100 + t,80);
+				Eigen::MatrixXd h_B = Eigen::MatrixXd::Random(80,60);
+				{
+					Matrix<double> d_A(h_A), d_B(h_B), d_C;
+					for (int i = 0; i < 10; i++)
+						d_C = d_A*d_B;
+					Eigen::MatrixXd h_C = d_C;
+					errors[t] = (h_C - h_A*h_B).norm();
+				}
+				live[t] = allocated_bytes();
+				cached[t] = cached_bytes();
+				release_cached_memory();
+				released[t] = cached_bytes();
+			}));
+		for (int t = 0; t < threads; t++)
+			workers[t].join();
+
+		for (int t = 0; t < threads; t++)
+		{
+			ensure(errors[t] < 1e-10);
+			ensure(live[t] == 0);
+			ensure(cached[t] > 0);
+			ensure(released[t] == 0);
+		}
+
+		// the second product reuses the block the first one freed
+		std::size_t before = allocated_bytes();
+		Matrix<double> d_A(Eigen::MatrixXd(Eigen::MatrixXd::Random(50,50)));
+		{ Matrix<double> d_B = d_A*d_A; }
+		std::size_t reused = cached_bytes();
+		{ Matrix<double> d_B = d_A*d_A; }
+		ensure(cached_bytes() == reused);
+		ensure(allocated_bytes() > before);
+
+		// a matrix freed by another thread than its own
+		Matrix<double> * d_M = 0;
+		std::thread maker([&d_M]() { d_M = new Matrix<double>(Eigen::MatrixXd(Eigen::MatrixXd::Ones(20,20))); synchronize(); });
+		maker.join();
+		Eigen::MatrixXd h_M = *d_M;
+		delete d_M;
+		ensure(h_M == Eigen::MatrixXd::Ones(20,20));
+
+		// a matrix of this thread freed by another goes back to this cache
+		int blocks = gpumatrix::impl::memory_check();
+		std::size_t bytes = allocated_bytes();
+		Matrix<double> * d_N = new Matrix<double>(Eigen::MatrixXd(Eigen::MatrixXd::Ones(30,30)));
+		ensure(allocated_bytes() > bytes);
+		synchronize();
+		std::thread freer([&d_N]() { delete d_N; });
+		freer.join();
+		ensure(gpumatrix::impl::memory_check() == blocks);
+		ensure(allocated_bytes() == bytes);
+		ensure(cached_bytes() >= 30*30*sizeof(double));
+	}
+
+	// Test Out Of Core Product
+	template<>
+	template<>
+	void object::test<18>()
+	{
+		const std::size_t m = 130, k = 90, n = 70;
+
+		Eigen::MatrixXd h_A = Eigen::MatrixXd::Random(m,k);
+		Eigen::MatrixXd h_B = Eigen::MatrixXd::Random(k,n);
+		Eigen::MatrixXd h_C = h_A*h_B;
+
+		// from everything on the device down to tiles of a few columns
+		const std::size_t caps[] = { 1 << 20, 64 << 10, 9000, 1000, 40 };
+		for (std::size_t c = 0; c < sizeof(caps)/sizeof(caps[0]); c++)
+		{
+			OutOfCorePlan plan = out_of_core_plan<double>(m,n,k,caps[c]);
+			ensure(plan.footprint()*sizeof(double) <= caps[c]);
+			ensure(plan.rows <= m && plan.cols <= n && plan.depth <= k);
+
+			impl::HostOutOfCoreDevice<double> dev(plan,caps[c]);
+			Eigen::MatrixXd C(m,n);
+			impl::out_of_core_gemm<double>(dev,plan,m,n,k,h_A.data(),m,h_B.data(),k,C.data(),m);
+			ensure((C - h_C).norm() < 1e-10);
+
+			std::size_t mt = (m + plan.rows - 1)/plan.rows, nt = (n + plan.cols - 1)/plan.cols;
+			std::size_t kt = (k + plan.depth - 1)/plan.depth;
+
+			// A is read once per column of tiles, B once per row of tiles
+			ensure(dev.loadedBytes() == (m*k*nt + k*n*mt)*sizeof(double));
+
+			// every step loads the next one before it multiplies
+			const std::string & log = dev.log();
+			std::size_t loads = 0, multiplies = 0, stores = 0;
+			for (std::size_t i = 0; i < log.size(); i++)
+			{
+				loads += log[i] == 'L';
+				multiplies += log[i] == 'M';
+				stores += log[i] == 'S';
+				if (log[i] == 'M')
+					ensure(loads == std::min(multiplies + 1,mt*nt*kt));
+			}
+			ensure(multiplies == mt*nt*kt && loads == multiplies && stores == mt*nt);
+		}
+
+		// a tile too large for the device, and a device too small for any tile
+		OutOfCorePlan plan = out_of_core_plan<double>(m,n,k,64 << 10);
+		bool refused = false;
+		try { impl::HostOutOfCoreDevice<double> dev(plan,32 << 10); } catch (std::runtime_error &) { refused = true; }
+		ensure(refused);
+
+		refused = false;
+		try { out_of_core_plan<double>(m,n,k,32); } catch (std::runtime_error &) { refused = true; }
+		ensure(refused);
+
+		// operands memory mapped from storage, C a block of a larger matrix
+		const char * path = "TestGPUMatrix.gmx";
+		{
+			StorageWriter writer(path);
+			writer.write("A",h_A.data(),m,k);
+			writer.write("B",h_B.data(),k,n);
+		}
+
+		StorageFile file(path);
+		Eigen::MatrixXd h_D = Eigen::MatrixXd::Zero(m + 3,n);
+		{
+			OutOfCorePlan mapped = out_of_core_plan<double>(m,n,k,9000);
+			impl::HostOutOfCoreDevice<double> dev(mapped,9000);
+			impl::out_of_core_gemm<double>(dev,mapped,m,n,k,file.data<double>("A"),m,file.data<double>("B"),k,h_D.data() + 3,m + 3);
+		}
+		ensure((h_D.bottomRows(m) - h_C).norm() < 1e-10);
+		ensure(h_D.topRows(3).isZero());
+
+		// and through the device
+		Eigen::MatrixXd h_E;
+		outOfCoreProduct(file.map<double>("A"),file.map<double>("B"),h_E,9000);
+		ensure((h_E - h_C).norm() < 1e-10);
+
+		std::remove(path);
+	}
+
+	// Test Copy On Write Storage
+	template<>
+	template<>
+	void object::test<19>()
+	{
+		Eigen::MatrixXd h_A = Eigen::MatrixXd::Random(40,30);
+		Eigen::VectorXd h_v = Eigen::VectorXd::Random(40);
+
+		Matrix<double> A(h_A);
+		const Matrix<double> & cA = A;
+
+		// copies take a reference, no device memory
+		std::size_t before = allocated_bytes();
+		Matrix<double> B = A;
+		std::vector<Matrix<double> > copies(4,A);
+		Matrix<double> C;
+		C = B;
+		const Matrix<double> & cB = B;
+		const Matrix<double> & cC = C;
+		ensure(allocated_bytes() == before);
+		ensure(cB.data() == cA.data() && cC.data() == cA.data() && copies[3].size() == A.size());
+
+		// the first write copies, the other holders keep the old buffer
+		B += A;
+		ensure(cB.data() != cA.data() && cC.data() == cA.data());
+		ensure((Eigen::MatrixXd)A == h_A);
+		ensure(((Eigen::MatrixXd)B - 2*h_A).norm() < 1e-12);
+
+		C *= 3.0;
+		ensure((Eigen::MatrixXd)A == h_A && (Eigen::MatrixXd)copies[0] == h_A);
+
+		// writes through views
+		Matrix<double> D = A;
+		D.col(2) = Vector<double>(h_v);
+		Matrix<double> E = A;
+		E.colwise() += Vector<double>(h_v);
+		ensure((Eigen::MatrixXd)A == h_A);
+		ensure((((Eigen::MatrixXd)D).col(2) - h_v).norm() == 0);
+		ensure(((Eigen::MatrixXd)E - (h_A.colwise() + h_v)).norm() < 1e-12);
+
+		// views of a const matrix read the shared buffer without copying it,
+		// and are expressions that no writable view can be made of
+		static_assert(!std::is_convertible<decltype(cA.col(2)), Map<Vector<double>>>::value, "");
+		static_assert(!std::is_convertible<decltype(cA.block(0,1,40,2)), Map<Matrix<double>>>::value, "");
+		static_assert(!std::is_convertible<decltype(cA.array()), Map<Array<double,2>>>::value, "");
+		before = allocated_bytes();
+		Matrix<double> K = A;
+		const Matrix<double> & cK = K;
+		ensure(cK.col(2).expr().data() == cA.data() + 2*40 && cK.block(0,1,40,2).expr().data() == cA.data() + 40);
+		ensure((Eigen::VectorXd)cK.col(2) == h_A.col(2) && cK.array().expr().data() == cA.data());
+		ensure(cK.data() == cA.data() && allocated_bytes() == before);
+
+		// assignment keeps a buffer held alone at the right size, so a map
+		// of the destination stays valid
+		Matrix<double> M(h_A);
+		const Matrix<double> & cM = M;
+		Map<Vector<double>> m2 = M.col(2);
+		const double * kept = cM.data();
+		M = A + A;
+		ensure(cM.data() == kept && ((Eigen::VectorXd)m2 - 2*h_A.col(2)).norm() < 1e-12);
+		M = B;
+		ensure(cM.data() == kept && cB.data() != kept);
+		ensure((Eigen::VectorXd)m2 == ((Eigen::MatrixXd)B).col(2));
+
+		// resize and setZero drop the shared buffer without copying it
+		Matrix<double> F = A, G = A;
+		F.resize(5,5);
+		G.setZero(40,30);
+		ensure((Eigen::MatrixXd)A == h_A && ((Eigen::MatrixXd)G).isZero());
+
+		// an expression result is handed to the destination
+		Matrix<double> H;
+		H = A + A;
+		ensure(((Eigen::MatrixXd)H - 2*h_A).norm() < 1e-12);
+
+		Vector<double> x(h_v), y = x;
+		y *= 2.0;
+		ensure((Eigen::VectorXd)x == h_v && ((Eigen::VectorXd)y - 2*h_v).norm() < 1e-12);
+
+		Array<double,2> R(Eigen::ArrayXXd(h_A.array())), S = R;
+		S *= R;
+		ensure((Eigen::MatrixXd)R == h_A && ((Eigen::MatrixXd)S - h_A.cwiseProduct(h_A)).norm() < 1e-12);
+
+		// copies written and dropped on other threads
+		synchronize();
+		std::vector<std::thread> workers;
+		std::vector<double> errors(3,1);
+		for (int t = 0; t < 3; t++)
+			workers.push_back(std::thread([t,A,&h_A,&errors]() mutable {
+				A *= double(t + 2);
+				Eigen::MatrixXd h = A;
+				errors[t] = (h - (t + 2)*h_A).norm();
+			}));
+		for (int t = 0; t < 3; t++)
+			workers[t].join();
+		for (int t = 0; t < 3; t++)
+			ensure(errors[t] < 1e-12);
+		ensure((Eigen::MatrixXd)A == h_A);
+	}
+
+	// Test In Place Assignment
+	template<>
+	template<>
+	void object::test<20>()
+	{
+		Eigen::MatrixXd h_A = Eigen::MatrixXd::Random(40,30);
+		Eigen::MatrixXd h_B = Eigen::MatrixXd::Random(40,30);
+		Eigen::MatrixXd h_C = Eigen::MatrixXd::Random(30,30);
+		Eigen::VectorXd h_v = Eigen::VectorXd::Random(40);
+
+		Matrix<double> A(h_A), B(h_B), C(h_C);
+		Vector<double> v(h_v);
+		const Matrix<double> & cA = A;
+		const double * data = cA.data();
+
+		static_assert(temporaries<decltype(A + B)>() == 0, "");
+		static_assert(temporaries<decltype((A + B)*C)>() == 2, "");
+
+		// elementwise right hand sides reading A run in A, without a temporary
+		reset_materialize_stats();
+		A = A + B;
+		A = 2.0*A;
+		A = B - A;
+		A = A/4.0;
+		A = A.colwise() + v;
+		ensure(materialize_stats().count == 0 && cA.data() == data);
+		Eigen::MatrixXd h_R = ((h_B - 2*(h_A + h_B))/4).colwise() + h_v;
+		ensure(((Eigen::MatrixXd)A - h_R).norm() < 1e-12);
+
+		// an operand that is an expression still takes its own
+		A = A + B*C;
+		ensure(materialize_stats().count == 1 && cA.data() == data);
+		h_R += h_B*h_C;
+		ensure(((Eigen::MatrixXd)A - h_R).norm() < 1e-10);
+
+		Array<double,2> S(Eigen::ArrayXXd(h_A.array())), T(Eigen::ArrayXXd(h_B.array()));
+		const double * s_data = static_cast<const Array<double,2> &>(S).data();
+		S = S + T;
+		S = S.exp();
+		S = 1.0 - S;
+		ensure(static_cast<const Array<double,2> &>(S).data() == s_data);
+		Eigen::ArrayXXd h_S = 1.0 - (h_A.array() + h_B.array()).exp();
+		ensure(((Eigen::MatrixXd)S - h_S.matrix()).norm() < 1e-10);
+
+		// products and transposes read entries already written, and a column
+		// of dest overlaps it only in part: all three keep the temporary
+		Matrix<double> D(h_C), E(h_A);
+		reset_materialize_stats();
+		D = D*C;
+		D = D.transpose();
+		E = E.colwise() + E.col(0);
+		ensure(materialize_stats().count == 3);
+		ensure(((Eigen::MatrixXd)D - (h_C*h_C).transpose()).norm() < 1e-10);
+		ensure(((Eigen::MatrixXd)E - (h_A.colwise() + h_A.col(0))).norm() < 1e-12);
+
+		// a right hand side that changes the shape of dest reads it through
+		// an expression, so dest keeps its buffer until that is evaluated
+		Eigen::MatrixXd h_P = Eigen::MatrixXd::Random(30,20);
+		Matrix<double> G(h_A), W(h_A), P(h_P);
+		G = G.transpose()*2.0;
+		W = (W*P)*0.5;
+		ensure(G.rows() == 30 && G.cols() == 40 && W.rows() == 40 && W.cols() == 20);
+		ensure(((Eigen::MatrixXd)G - h_A.transpose()*2.0).norm() < 1e-12);
+		ensure(((Eigen::MatrixXd)W - (h_A*h_P)*0.5).norm() < 1e-10);
+
+		// a shared destination is copied before it is written
+		Matrix<double> F = A;
+		F = F + B;
+		ensure(((Eigen::MatrixXd)A - h_R).norm() < 1e-10);
+		ensure(((Eigen::MatrixXd)F - (h_R + h_B)).norm() < 1e-10);
+	}
+
 }
 
 
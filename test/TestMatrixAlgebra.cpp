@@ -1,6 +1,10 @@
 
 
 #include <gpumatrix/CORE>
+#include <gpumatrix/SparseMatrix.h>
+#include <Eigen/Cholesky>
+#include <Eigen/QR>
+#include <Eigen/LU>
 
 
 
@@ -320,6 +324,485 @@ namespace tut
 		
 	}
 
+	// Test 16 bit Storage, Computation in float
+	template<>
+	template<>
+	void object::test<8>()
+	{
+		for (int i = 0;i<10;i++)
+		{
+			int row = rand()%200+1;
+			int inner = rand()%200+1;
+			int col = rand()%200+1;
+
+			Eigen::MatrixXf h_A = Eigen::MatrixXf::Random(row,inner);
+			Eigen::MatrixXf h_B = Eigen::MatrixXf::Random(inner,col);
+			Eigen::MatrixXf h_C = Eigen::MatrixXf::Random(row,inner);
+
+			Matrix<half> d_A(h_A);
+			Matrix<half> d_B(h_B);
+			Matrix<half> d_C(h_C);
+
+			Matrix<half> d_D = d_A*d_B;
+			Matrix<half> d_E = d_A.array()*d_C.array() + 2*d_A.array();
+
+			Eigen::MatrixXf h_D = d_D.cast<float>();
+			Eigen::MatrixXf h_E = d_E.cast<float>();
+
+			// inputs round to 11 bits, the products accumulate in float
+			ensure((h_D - h_A*h_B).cwiseAbs().maxCoeff() < 2e-3*inner);
+			ensure((h_E - (h_A.array()*h_C.array() + 2*h_A.array()).matrix()).cwiseAbs().maxCoeff() < 1e-2);
+
+			Matrix<bfloat16> d_F(h_A);
+			Matrix<bfloat16> d_H = d_F.transpose()*d_F + d_F.transpose()*d_F;
+
+			Eigen::MatrixXf h_H = d_H.cast<float>();
+			Eigen::MatrixXf h_F = d_F.cast<float>();
+
+			ensure((h_F - h_A).cwiseAbs().maxCoeff() < 4e-3);
+			ensure((h_H - 2*h_A.transpose()*h_A).cwiseAbs().maxCoeff() < 2e-2*row);
+
+			// any two element types convert on the device
+			Matrix<double> d_G(Eigen::MatrixXd(h_A.cast<double>()));
+			Eigen::MatrixXf h_G = d_G.cast<half>().cast<bfloat16>().cast<double>().cast<float>();
+			ensure((h_G - h_A).cwiseAbs().maxCoeff() < 8e-3);
+			Eigen::MatrixXf h_K = d_F.cast<half>().cast<float>();
+			ensure((h_K - h_F).cwiseAbs().maxCoeff() < 1e-3);
+		}
+	}
+
+	template <typename T, int Options>
+	Eigen::SparseMatrix<T,Options,int> random_sparse(int rows, int cols, double density)
+	{
+		std::vector<Eigen::Triplet<T> > entries;
+		for (int j = 0; j < cols; j++)
+			for (int i = 0; i < rows; i++)
+				if (rand() < density*RAND_MAX)
+					entries.push_back(Eigen::Triplet<T>(i,j,T(rand())/RAND_MAX - T(0.5)));
+
+		Eigen::SparseMatrix<T,Options,int> S(rows,cols);
+		S.setFromTriplets(entries.begin(),entries.end());
+		return S;
+	}
+
+	// Sparse Dense Products, CSR and CSC
+	template<>
+	template<>
+	void object::test<9>()
+	{
+		for (int i = 0;i<10;i++)
+		{
+			int row = rand()%300+1;
+			int inner = rand()%300+1;
+			int col = rand()%50+1;
+
+			Eigen::SparseMatrix<double,Eigen::RowMajor,int> h_R = random_sparse<double,Eigen::RowMajor>(row,inner,0.05);
+			Eigen::SparseMatrix<double,Eigen::ColMajor,int> h_S = random_sparse<double,Eigen::ColMajor>(row,inner,0.05);
+
+			Eigen::MatrixXd h_B = Eigen::MatrixXd::Random(inner,col);
+			Eigen::MatrixXd h_Bt = Eigen::MatrixXd::Random(row,col);
+			Eigen::MatrixXd h_L = Eigen::MatrixXd::Random(col,row);
+			Eigen::MatrixXd h_Lt = Eigen::MatrixXd::Random(col,inner);
+
+			SparseMatrix<double> d_R(h_R);
+			SparseMatrix<double> d_S(h_S);
+			ensure(d_R.format() == SparseCSR && d_S.format() == SparseCSC);
+			ensure(d_R.nonZeros() == (std::size_t)h_R.nonZeros());
+
+			Matrix<double> d_B(h_B), d_Bt(h_Bt), d_L(h_L), d_Lt(h_Lt);
+
+			Matrix<double> d_C = d_R*d_B;
+			Matrix<double> d_D = d_S*d_B;
+			ensure(check_diff(Eigen::MatrixXd(h_R*h_B),d_C));
+			ensure(check_diff(Eigen::MatrixXd(h_S*h_B),d_D));
+
+			d_C = d_R.transpose()*d_Bt;
+			d_D = d_S.transpose()*d_Bt;
+			ensure(check_diff(Eigen::MatrixXd(h_R.transpose()*h_Bt),d_C));
+			ensure(check_diff(Eigen::MatrixXd(h_S.transpose()*h_Bt),d_D));
+
+			d_C = d_L*d_R;
+			d_D = d_L*d_S;
+			ensure(check_diff(Eigen::MatrixXd(h_L*h_R),d_C));
+			ensure(check_diff(Eigen::MatrixXd(h_L*h_S),d_D));
+
+			d_C = d_Lt*d_R.transpose();
+			d_D = d_Lt*d_S.transpose();
+			ensure(check_diff(Eigen::MatrixXd(h_Lt*h_R.transpose()),d_C));
+			ensure(check_diff(Eigen::MatrixXd(h_Lt*h_S.transpose()),d_D));
+
+			// inside larger expressions
+			d_C.noalias() = d_R*(d_B + d_B);
+			ensure(check_diff(Eigen::MatrixXd(h_R*(2*h_B)),d_C));
+
+			d_D = d_S*d_B + d_Bt*d_B.transpose()*d_B;
+			ensure(check_diff(Eigen::MatrixXd(h_S*h_B + h_Bt*h_B.transpose()*h_B),d_D));
+		}
+	}
+
+	// Sparse Matrix Vector Products and Transfers
+	template<>
+	template<>
+	void object::test<10>()
+	{
+		for (int i = 0;i<10;i++)
+		{
+			int row = rand()%2000+1;
+			int col = rand()%500+1;
+
+			Eigen::SparseMatrix<float,Eigen::RowMajor,int> h_R = random_sparse<float,Eigen::RowMajor>(row,col,0.02);
+			Eigen::SparseMatrix<float,Eigen::ColMajor,int> h_S = random_sparse<float,Eigen::ColMajor>(row,col,0.02);
+
+			Eigen::VectorXf h_x = Eigen::VectorXf::Random(col);
+			Eigen::VectorXf h_y = Eigen::VectorXf::Random(row);
+
+			SparseMatrix<float> d_R(h_R);
+			SparseMatrix<float> d_S(h_S);
+			Vector<float> d_x(h_x), d_y(h_y);
+
+			Vector<float> d_u = d_R*d_x;
+			Vector<float> d_v = d_S*d_x;
+			ensure(check_diff(Eigen::VectorXf(h_R*h_x),d_u));
+			ensure(check_diff(Eigen::VectorXf(h_S*h_x),d_v));
+
+			d_u = d_R.transpose()*d_y;
+			d_v = d_S.transpose()*d_y;
+			ensure(check_diff(Eigen::VectorXf(h_R.transpose()*h_y),d_u));
+			ensure(check_diff(Eigen::VectorXf(h_S.transpose()*h_y),d_v));
+
+			d_u = d_R*(d_x*2.0f);
+			ensure(check_diff(Eigen::VectorXf(h_R*(h_x*2.0f)),d_u));
+
+			// back to the host in either order, copies are deep
+			SparseMatrix<float> d_T(d_S);
+			d_S = d_R;
+
+			Eigen::SparseMatrix<float,Eigen::ColMajor,int> h_T = d_T;
+			Eigen::SparseMatrix<float,Eigen::ColMajor,int> h_U = d_S;
+			ensure((Eigen::MatrixXf(h_T) - Eigen::MatrixXf(h_S)).cwiseAbs().maxCoeff() == 0);
+			ensure((Eigen::MatrixXf(h_U) - Eigen::MatrixXf(h_R)).cwiseAbs().maxCoeff() == 0);
+		}
+	}
+
+	// Cholesky Factorisation and Solve
+	template<>
+	template<>
+	void object::test<11>()
+	{
+		for (int i = 0;i<5;i++)
+		{
+			int n = rand()%500+1;
+			int col = rand()%20+1;
+
+			Eigen::MatrixXd h_G = Eigen::MatrixXd::Random(n,n);
+			Eigen::MatrixXd h_A = h_G*h_G.transpose() + n*Eigen::MatrixXd::Identity(n,n);
+			Eigen::MatrixXd h_B = Eigen::MatrixXd::Random(n,col);
+			Eigen::VectorXd h_b = Eigen::VectorXd::Random(n);
+
+			Matrix<double> d_A(h_A), d_B(h_B);
+			Vector<double> d_b(h_b);
+
+			LLT<double> llt = d_A.llt();
+			ensure(llt.info() == Eigen::Success);
+
+			Eigen::MatrixXd h_L = h_A.llt().matrixL();
+			ensure(check_diff(h_L,llt.matrixL()));
+
+			Matrix<double> d_X = llt.solve(d_B);
+			Vector<double> d_x = llt.solve(d_b);
+			ensure(check_diff(Eigen::MatrixXd(h_A.llt().solve(h_B)),d_X));
+			ensure(check_diff(Eigen::VectorXd(h_A.llt().solve(h_b)),d_x));
+
+			d_X = d_A.llt().solve(d_B + d_B);
+			ensure(check_diff(Eigen::MatrixXd(h_A.llt().solve(2*h_B)),d_X));
+		}
+
+		Eigen::MatrixXf h_N = Eigen::MatrixXf::Identity(100,100);
+		h_N(70,70) = -1;
+
+		Matrix<float> d_N(h_N);
+		LLT<float> llt(d_N);
+		ensure(llt.info() == Eigen::NumericalIssue);
+
+		bool thrown = false;
+		try { llt.solve(d_N); } catch (std::runtime_error &) { thrown = true; }
+		ensure(thrown);
+	}
+
+	// Householder QR and Least Squares
+	template<>
+	template<>
+	void object::test<12>()
+	{
+		for (int i = 0;i<5;i++)
+		{
+			int col = rand()%100+1;
+			int row = col + rand()%500;
+
+			Eigen::MatrixXd h_A = Eigen::MatrixXd::Random(row,col);
+			Eigen::MatrixXd h_B = Eigen::MatrixXd::Random(row,3);
+			Eigen::VectorXd h_b = Eigen::VectorXd::Random(row);
+
+			Matrix<double> d_A(h_A), d_B(h_B);
+			Vector<double> d_b(h_b);
+
+			Eigen::HouseholderQR<Eigen::MatrixXd> h_qr(h_A);
+			HouseholderQR<double> d_qr = d_A.qr();
+
+			Eigen::MatrixXd h_R = h_qr.matrixQR().triangularView<Eigen::Upper>();
+			Eigen::MatrixXd d_R = Eigen::MatrixXd(d_qr.matrixQR()).triangularView<Eigen::Upper>();
+			ensure(check_diff(h_R,d_R));
+			ensure(check_diff(h_qr.hCoeffs(),d_qr.hCoeffs()));
+
+			Matrix<double> d_X = d_qr.solve(d_B);
+			Vector<double> d_x = d_qr.solve(d_b);
+			ensure(check_diff(Eigen::MatrixXd(h_qr.solve(h_B)),d_X));
+			ensure(check_diff(Eigen::VectorXd(h_qr.solve(h_b)),d_x));
+
+			// small row blocks so that the R factors are stacked twice
+			d_X = tsqr_solve(d_A,d_B,2*col);
+			d_x = tsqr_solve(d_A,d_b,2*col);
+			ensure(check_diff(Eigen::MatrixXd(h_qr.solve(h_B)),d_X));
+			ensure(check_diff(Eigen::VectorXd(h_qr.solve(h_b)),d_x));
+
+			Eigen::MatrixXd d_T = tsqr(d_A,2*col);
+			ensure(check_diff(Eigen::MatrixXd(h_R.topRows(col).cwiseAbs()),Matrix<double>(d_T.cwiseAbs())));
+		}
+
+		// many leaves, factored together, and their stacked R factors again
+		for (int i = 0;i<5;i++)
+		{
+			int col = rand()%8+1;
+			int row = col*(16 + rand()%16) + rand()%col;
+
+			Eigen::MatrixXd h_A = Eigen::MatrixXd::Random(row,col);
+			Eigen::MatrixXd h_B = Eigen::MatrixXd::Random(row,2);
+			Matrix<double> d_A(h_A), d_B(h_B);
+
+			Eigen::HouseholderQR<Eigen::MatrixXd> h_qr(h_A);
+			Eigen::MatrixXd h_R = h_qr.matrixQR().topRows(col).triangularView<Eigen::Upper>();
+
+			ensure(check_diff(Eigen::MatrixXd(h_qr.solve(h_B)),tsqr_solve(d_A,d_B,2*col)));
+			Eigen::MatrixXd d_T = tsqr(d_A,2*col);
+			ensure(check_diff(Eigen::MatrixXd(h_R.cwiseAbs()),Matrix<double>(d_T.cwiseAbs())));
+		}
+
+		Matrix<float> d_W(3,5);
+		bool thrown = false;
+		try { d_W.qr().solve(Vector<float>(3)); } catch (std::runtime_error &) { thrown = true; }
+		ensure(thrown);
+	}
+
+	// Gram Matrices through syrk
+	template<>
+	template<>
+	void object::test<13>()
+	{
+		for (int i = 0;i<5;i++)
+		{
+			int row = rand()%1000+1;
+			int col = rand()%1000+1;
+
+			Eigen::MatrixXd h_A = Eigen::MatrixXd::Random(row,col);
+			Eigen::MatrixXd h_B = Eigen::MatrixXd::Random(row,col);
+
+			Matrix<double> d_A(h_A), d_B(h_B);
+
+			// same operand, syrk and mirror
+			Matrix<double> d_C = d_A.transpose()*d_A;
+			Matrix<double> d_D = d_A*d_A.transpose();
+			ensure(check_diff(Eigen::MatrixXd(h_A.transpose()*h_A),d_C));
+			ensure(check_diff(Eigen::MatrixXd(h_A*h_A.transpose()),d_D));
+
+			// different operands of the same shape still go through gemm
+			d_C = d_A.transpose()*d_B;
+			d_D = d_A*d_B.transpose();
+			ensure(check_diff(Eigen::MatrixXd(h_A.transpose()*h_B),d_C));
+			ensure(check_diff(Eigen::MatrixXd(h_A*h_B.transpose()),d_D));
+
+			Eigen::MatrixXf h_F = Eigen::MatrixXf::Random(row,col);
+			Matrix<float> d_F(h_F);
+			Matrix<float> d_G = d_F.transpose()*d_F;
+			ensure(check_diff(Eigen::MatrixXf(h_F.transpose()*h_F),d_G));
+		}
+	}
+
+	// Kernel Matrices
+	template<>
+	template<>
+	void object::test<14>()
+	{
+		for (int i = 0;i<5;i++)
+		{
+			int d = rand()%50+1;
+			int m = rand()%500+1;
+			int n = rand()%500+1;
+
+			Eigen::MatrixXd h_X = Eigen::MatrixXd::Random(d,m);
+			Eigen::MatrixXd h_Y = Eigen::MatrixXd::Random(d,n);
+
+			Matrix<double> d_X(h_X), d_Y(h_Y);
+
+			double gamma = 0.5, coef0 = 1.5;
+
+			Eigen::MatrixXd h_G = h_X.transpose()*h_Y;
+			Eigen::MatrixXd h_P = (gamma*h_G.array() + coef0).cube().matrix();
+			Eigen::MatrixXd h_D = (h_X.colwise().squaredNorm().transpose()*Eigen::RowVectorXd::Ones(n)
+				+ Eigen::VectorXd::Ones(m)*h_Y.colwise().squaredNorm() - 2*h_G).cwiseMax(0);
+			Eigen::MatrixXd h_R = (-gamma*h_D.array()).exp().matrix();
+
+			ensure(check_diff(h_G,kernelMatrix(d_X,d_Y,Kernel<double>::Linear())));
+			ensure(check_diff(h_P,kernelMatrix(d_X,d_Y,Kernel<double>::Polynomial(gamma,coef0,3))));
+			ensure(check_diff(h_R,kernelMatrix(d_X,d_Y,Kernel<double>::Rbf(gamma))));
+
+			// X against itself goes through syrk
+			Eigen::MatrixXd h_XX = h_X.transpose()*h_X;
+			Eigen::MatrixXd h_DX = (h_X.colwise().squaredNorm().transpose()*Eigen::RowVectorXd::Ones(m)
+				+ Eigen::VectorXd::Ones(m)*h_X.colwise().squaredNorm() - 2*h_XX).cwiseMax(0);
+			Matrix<double> d_K = kernelMatrix(d_X,Kernel<double>::Rbf(gamma));
+			ensure(check_diff(Eigen::MatrixXd((-gamma*h_DX.array()).exp().matrix()),d_K));
+			Eigen::MatrixXd h_K = d_K;
+			ensure(check_diff(Eigen::VectorXd(Eigen::VectorXd::Ones(m)),Eigen::VectorXd(h_K.diagonal())));
+		}
+
+		Matrix<float> d_A(3,5), d_B(4,5);
+		bool thrown = false;
+		try { kernelMatrix(d_A,d_B,Kernel<float>::Linear()); } catch (std::runtime_error &) { thrown = true; }
+		ensure(thrown);
+
+		thrown = false;
+		try { Kernel<float>::Polynomial(1,0,-1); } catch (std::runtime_error &) { thrown = true; }
+		ensure(thrown);
+	}
+
+	// Fixed size matrices
+	template<>
+	template<>
+	void object::test<15>()
+	{
+		Eigen::Matrix3d h_F = Eigen::Matrix3d::Random();
+		Eigen::Matrix3d h_G = Eigen::Matrix3d::Random();
+		Eigen::Matrix<double,3,4> h_H = Eigen::Matrix<double,3,4>::Random();
+
+		FixedMatrix<double,3,3> F(h_F), G(h_G);
+		FixedMatrix<double,3,4> H(h_H);
+
+		// host arithmetic
+		ensure(check_diff(Eigen::Matrix3d(h_F + 2.0*h_G),FixedMatrix<double,3,3>(F + 2.0*G)));
+		ensure(check_diff(Eigen::Matrix3d(h_F - h_G/4.0),FixedMatrix<double,3,3>(F - G/4.0)));
+		ensure(check_diff(Eigen::Matrix<double,3,4>(h_F*h_H),FixedMatrix<double,3,4>(F*H)));
+		ensure(check_diff(Eigen::Matrix<double,4,3>(h_H.transpose()),FixedMatrix<double,4,3>(H.transpose())));
+		ensure(check_diff(Eigen::Matrix3d(Eigen::Matrix3d::Identity()),FixedMatrix<double,3,3>::Identity()));
+
+		for (int i = 0;i<5;i++)
+		{
+			int n = rand()%1000+1;
+
+			Eigen::MatrixXd h_A = Eigen::MatrixXd::Random(3,n);
+			Eigen::MatrixXd h_B = Eigen::MatrixXd::Random(n,3);
+
+			Matrix<double> d_A(h_A), d_B(h_B);
+
+			// F*M and M*F, alone and inside expressions
+			Matrix<double> d_C = F*d_A;
+			ensure(check_diff(Eigen::MatrixXd(h_F*h_A),d_C));
+			d_C = d_B*H;
+			ensure(check_diff(Eigen::MatrixXd(h_B*h_H),d_C));
+			d_C = H.transpose()*d_B.transpose();
+			ensure(check_diff(Eigen::MatrixXd(h_H.transpose()*h_B.transpose()),d_C));
+			d_C = d_B*H + d_A.transpose()*H;
+			ensure(check_diff(Eigen::MatrixXd(h_B*h_H + h_A.transpose()*h_H),d_C));
+
+			Eigen::MatrixXf h_X = Eigen::MatrixXf::Random(n,2);
+			Eigen::Matrix2f h_R = Eigen::Matrix2f::Random();
+			Matrix<float> d_X(h_X);
+			Matrix<float> d_Y = d_X*FixedMatrix<float,2,2>(h_R);
+			ensure(check_diff(Eigen::MatrixXf(h_X*h_R),d_Y));
+		}
+
+		// round trip through the device
+		ensure(check_diff(h_H,FixedMatrix<double,3,4>(H.toDevice())));
+
+		Matrix<double> d_W(4,5);
+		bool thrown = false;
+		try { Matrix<double> d_V = F*d_W; } catch (std::runtime_error &) { thrown = true; }
+		ensure(thrown);
+	}
+
+	// Batches of small matrices
+	template<>
+	template<>
+	void object::test<16>()
+	{
+		for (int i = 0;i<5;i++)
+		{
+			int n = rand()%1000+1;
+
+			std::vector<FixedMatrix<double,3,3> > h_A(n), h_B(n);
+			std::vector<FixedMatrix<double,3,4> > h_C(n);
+			for (int b = 0;b<n;b++)
+			{
+				// diagonally dominant, so every instance is well conditioned
+				h_A[b] = Eigen::Matrix3d(Eigen::Matrix3d::Random() + 4*Eigen::Matrix3d::Identity());
+				h_B[b] = Eigen::Matrix3d(Eigen::Matrix3d::Random());
+				h_C[b] = Eigen::Matrix<double,3,4>(Eigen::Matrix<double,3,4>::Random());
+			}
+
+			MatrixBatch<double,3,3> d_A(h_A), d_B(h_B);
+			MatrixBatch<double,3,4> d_C(h_C);
+			FixedMatrix<double,3,3> F(Eigen::Matrix3d(Eigen::Matrix3d::Random()));
+
+			std::vector<FixedMatrix<double,3,3> > h_S = d_A + 2.0*d_B;
+			std::vector<FixedMatrix<double,3,4> > h_P = d_A*d_C;
+			std::vector<FixedMatrix<double,3,4> > h_FP = F*d_C;
+			std::vector<FixedMatrix<double,4,3> > h_PF = d_C.transpose()*F;
+			std::vector<FixedMatrix<double,3,3> > h_I = d_A.inverse();
+			Eigen::VectorXd h_D = d_A.determinant();
+
+			for (int b = 0;b<n;b++)
+			{
+				Eigen::Matrix3d A = h_A[b], B = h_B[b];
+				Eigen::Matrix<double,3,4> C = h_C[b];
+
+				ensure(check_diff(Eigen::Matrix3d(A + 2*B),h_S[b]));
+				ensure(check_diff(Eigen::Matrix<double,3,4>(A*C),h_P[b]));
+				ensure(check_diff(Eigen::Matrix<double,3,4>(Eigen::Matrix3d(F)*C),h_FP[b]));
+				ensure(check_diff(Eigen::Matrix<double,4,3>(C.transpose()*Eigen::Matrix3d(F)),h_PF[b]));
+				ensure(check_diff(Eigen::Matrix3d(A.inverse()),h_I[b]));
+				ensure(std::abs(A.determinant() - h_D(b)) < 1e-8*std::abs(A.determinant()) + 1e-10);
+			}
+
+			// single instances and entries
+			int b = rand()%n;
+			ensure(check_diff(Eigen::Matrix<double,3,4>(h_C[b]),d_C.instance(b)));
+			d_C.setInstance(b,h_C[0]);
+			ensure(check_diff(Eigen::Matrix<double,3,4>(h_C[0]),d_C.instance(b)));
+			Eigen::VectorXd h_E = d_A.element(1,2);
+			ensure(std::abs(h_E(b) - h_A[b](1,2)) < 1e-12);
+		}
+
+		// 2x2 and 4x4 inverses in float
+		std::vector<FixedMatrix<float,4,4> > h_Q(100);
+		std::vector<FixedMatrix<float,2,2> > h_T(100);
+		for (int b = 0;b<100;b++)
+		{
+			h_Q[b] = Eigen::Matrix4f(Eigen::Matrix4f::Random() + 4*Eigen::Matrix4f::Identity());
+			h_T[b] = Eigen::Matrix2f(Eigen::Matrix2f::Random() + 4*Eigen::Matrix2f::Identity());
+		}
+		std::vector<FixedMatrix<float,4,4> > h_QI = MatrixBatch<float,4,4>(h_Q).inverse();
+		std::vector<FixedMatrix<float,2,2> > h_TI = MatrixBatch<float,2,2>(h_T).inverse();
+		for (int b = 0;b<100;b++)
+		{
+			ensure(check_diff(Eigen::Matrix4f(Eigen::Matrix4f(h_Q[b]).inverse()),h_QI[b]));
+			ensure(check_diff(Eigen::Matrix2f(Eigen::Matrix2f(h_T[b]).inverse()),h_TI[b]));
+		}
+
+		MatrixBatch<double,3,3> d_X(10), d_Y(11);
+		bool thrown = false;
+		try { d_X*d_Y; } catch (std::runtime_error &) { thrown = true; }
+		ensure(thrown);
+	}
+
 
 
 
@@ -213,4 +213,53 @@ namespace tut
 		}
 	}
 
-}
\ No newline at end of file
+	// Test rowwise/colwise Broadcasting
+	template<>
+	template<>
+	void object::test<7>()
+	{
+		for (int i = 0;i<10;i++)
+		{
+			int row = rand()%1000+1;
+			int col = rand()%1000+1;
+
+			Eigen::MatrixXd h_A = Eigen::MatrixXd::Random(row,col);
+			Eigen::VectorXd h_r = Eigen::VectorXd::Random(col).array() + 2;
+			Eigen::VectorXd h_c = Eigen::VectorXd::Random(row).array() + 2;
+
+			Matrix<double> d_A(h_A), d_R;
+			Vector<double> d_r(h_r), d_c(h_c);
+
+			// centre the columns and scale them to unit norm
+			Eigen::VectorXd h_mean = h_A.colwise().sum().transpose()/row;
+			Eigen::VectorXd h_norm = h_A.colwise().norm().transpose();
+			Vector<double> d_mean(h_mean), d_norm(h_norm);
+
+			d_R = (d_A.rowwise() - d_mean).rowwise() / d_norm;
+			Eigen::MatrixXd h_R = (h_A.rowwise() - h_mean.transpose()).array().rowwise() / h_norm.transpose().array();
+			ensure(check_diff(h_R,d_R));
+
+			d_R = 2*(d_A.colwise() * d_c) + d_A;
+			h_R = 2*(h_A.array().colwise() * h_c.array()).matrix() + h_A;
+			ensure(check_diff(h_R,d_R));
+
+			Array<double,2> d_X = d_A.array().rowwise() * d_r;
+			h_R = (h_A.array().rowwise() * h_r.transpose().array()).matrix();
+			d_R = d_X.matrix();
+			ensure(check_diff(h_R,d_R));
+
+			d_A.colwise() -= d_c;
+			h_A.colwise() -= h_c;
+			ensure(check_diff(h_A,d_A));
+
+			d_A.rowwise() *= d_r;
+			h_A.array().rowwise() *= h_r.transpose().array();
+			ensure(check_diff(h_A,d_A));
+
+			d_A.colwise() /= d_c;
+			h_A.array().colwise() /= h_c.array();
+			ensure(check_diff(h_A,d_A));
+		}
+	}
+
+}
\ No newline at end of file
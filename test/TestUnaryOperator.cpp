@@ -10,6 +10,7 @@
 #include <stdexcept>
 #include <ctime>
 #include <iostream>
+#include <thread>
 #include "Util.h"
 
 using std::runtime_error;
@@ -137,4 +138,123 @@ namespace tut
 
 		}
 	}
-}
\ No newline at end of file
+
+	// Test float reductions with a widened accumulator
+	template<>
+	template<>
+	void object::test<4>()
+	{
+		for (int i = 0;i<10;i++)
+		{
+			int row = rand()%1000+1;
+			int col = rand()%1000+1;
+
+			Eigen::MatrixXf h_A = Eigen::MatrixXf::Random(row,col);
+			Eigen::VectorXf h_x = Eigen::VectorXf::Random(row);
+			Eigen::VectorXf h_y = Eigen::VectorXf::Random(row);
+
+			Matrix<float> d_A(h_A);
+			Vector<float> d_x(h_x), d_y(h_y);
+
+			double sum2 = h_A.cast<double>().sum();
+			double norm2 = h_A.cast<double>().squaredNorm();
+			double dot2 = h_x.cast<double>().dot(h_y.cast<double>());
+
+			float sum1 = d_A.sum(AccumulateWide);
+			float norm1 = d_A.squaredNorm(AccumulateWide);
+			float dot1 = d_x.dot(d_y,AccumulateWide);
+
+			ensure("wide sum operation pass", abs(sum1-sum2) < 1e-2);
+			ensure("wide squared norm operation pass", abs(norm1-norm2)/norm2 < 1e-6);
+			ensure("wide dot operation pass", abs(dot1-dot2) < 1e-3);
+
+			set_accumulation_policy(AccumulateWide);
+			ensure("wide sum policy pass", d_A.sum() == sum1);
+
+			AccumulationPolicy other = AccumulateWide;
+			std::thread t([&other]() { other = accumulation_policy(); });
+			t.join();
+			ensure("policy is per thread", other == AccumulateNative);
+			set_accumulation_policy(AccumulateNative);
+		}
+	}
+
+	// Test element wise functionals through the generic unary kernel
+	template<>
+	template<>
+	void object::test<5>()
+	{
+		for (int i = 0;i<10;i++)
+		{
+			int row = rand()%1000+1;
+			int col = rand()%1000+1;
+
+			Eigen::MatrixXd h_A = Eigen::MatrixXd::Random(row,col);
+
+			Matrix<double> d_A(h_A), d_R;
+
+			d_R = sin(d_A.array()).matrix();
+			ensure("sin operation pass", check_diff(Eigen::MatrixXd(h_A.array().sin()),d_R));
+
+			d_R = tanh(d_A.array()).matrix();
+			ensure("tanh operation pass", check_diff(Eigen::MatrixXd(h_A.array().tanh()),d_R));
+
+			d_R = sqrt(abs(d_A.array())).matrix();
+			ensure("sqrt abs operation pass", check_diff(Eigen::MatrixXd(h_A.array().abs().sqrt()),d_R));
+
+			d_R = logistic(d_A.array()).matrix();
+			ensure("logistic operation pass", check_diff(Eigen::MatrixXd(1/(1+(-h_A.array()).exp())),d_R));
+
+			d_R = floor(d_A);
+			ensure("floor operation pass", check_diff(Eigen::MatrixXd(h_A.array().floor()),d_R));
+
+			// the host apply_on is the reference for functionals Eigen lacks
+			d_R = erf(d_A.array()).matrix();
+			Eigen::MatrixXd h_R = h_A.unaryExpr([](double x) { return Fcnl_erf<double>::apply_on(x); });
+			ensure("erf operation pass", check_diff(h_R,d_R));
+		}
+	}
+
+	// Test the polynomial transcendentals against libm and the strict mode
+	template<>
+	template<>
+	void object::test<6>()
+	{
+		for (int i = 0;i<100000;i++)
+		{
+			double x = (rand()/(double)RAND_MAX - 0.5)*60;
+			float xf = (float)x;
+
+			ensure("fast exp pass", std::abs(impl::fast_exp(x) - std::exp(x)) <= 6e-16*std::exp(x));
+			ensure("fast expf pass", std::abs(impl::fast_exp(xf) - std::exp(xf)) <= 4e-7f*std::exp(xf));
+			ensure("fast tanh pass", std::abs(impl::fast_tanh(x) - std::tanh(x)) <= 6e-16*std::abs(std::tanh(x)));
+			ensure("fast erff pass", std::abs(impl::fast_erf(xf) - std::erf(xf)) <= 4e-7f*std::abs(std::erf(xf)));
+
+			double y = std::abs(x) + 1e-300;
+			ensure("fast log pass", std::abs(impl::fast_log(y) - std::log(y)) <= 6e-16*std::abs(std::log(y)));
+		}
+
+		for (int i = 0;i<10;i++)
+		{
+			int row = rand()%1000+1;
+			int col = rand()%1000+1;
+
+			Eigen::MatrixXf h_A = Eigen::MatrixXf::Random(row,col)*10;
+
+			Matrix<float> d_A(h_A), d_F, d_S;
+
+			ensure(math_mode() == MathStrict);
+			set_math_mode(MathFast);
+			d_F = tanh(d_A.array()).matrix();
+			set_math_mode(MathStrict);
+			d_S = tanh(d_A.array()).matrix();
+
+			Eigen::MatrixXf h_F = d_F, h_S = d_S;
+			ensure("fast tanh kernel pass", (h_F - h_S).cwiseAbs().maxCoeff() < 1e-6);
+
+			d_F = softplus(d_A.array()).matrix();
+			Eigen::MatrixXf h_R = h_A.unaryExpr([](float x) { return Fcnl_softplus<float>::apply_on(x); });
+			ensure("softplus operation pass", check_diff(h_R,d_F));
+		}
+	}
+}
\ No newline at end of file